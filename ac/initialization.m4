@@ -18,5 +18,5 @@ AC_CHECK_TOOL(STRINGS, strings, :)
 AC_CHECK_TOOL(OBJDUMP, objdump, :)
 PKG_PROG_PKG_CONFIG
 AC_PROG_EGREP
-AC_CHECK_HEADERS([inttypes.h stdint.h sys/types.h sys/syscall.h stropts.h])
-AC_CHECK_FUNCS([syscall],,)
+AC_CHECK_HEADERS([inttypes.h stdint.h sys/types.h sys/syscall.h stropts.h sys/inotify.h])
+AC_CHECK_FUNCS([syscall fallocate posix_fadvise],,)
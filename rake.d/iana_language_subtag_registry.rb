@@ -54,7 +54,7 @@ mtx::bcp47::language_c
 preferred_values_init_t::sub_t::parse()
   const {
 
-  auto language = tag ? mtx::bcp47::language_c::parse(tag) : mtx::bcp47::language_c{};
+  auto language = tag ? mtx::bcp47::language_c::parse(tag, mtx::bcp47::normalization_mode_e::none) : mtx::bcp47::language_c{};
 
   if (region)
     language.set_region(region);
@@ -123,14 +123,10 @@ init() {
 
 void
 init_preferred_values() {
-  mtx::bcp47::language_c::set_normalization_mode(mtx::bcp47::normalization_mode_e::none);
-
   g_preferred_values.reserve(<%= content_of[:num_preferred_values] %>);
 
   for (auto const *preferred_value = s_preferred_values_init, *end = preferred_value + <%= content_of[:num_preferred_values] %>; preferred_value < end; ++preferred_value)
     g_preferred_values.emplace_back(preferred_value->from.parse(), preferred_value->to.parse());
-
-  mtx::bcp47::language_c::set_normalization_mode(mtx::bcp47::normalization_mode_e::default_mode);
 }
 
 } // namespace mtx::iana::language_subtag_registry
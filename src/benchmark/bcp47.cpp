@@ -0,0 +1,100 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit https://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+
+   benchmarks for BCP 47 language tag parsing & registry look-ups
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <chrono>
+
+#include <benchmark/benchmark.h>
+
+#include "common/bcp47.h"
+#include "common/iso639.h"
+#include "common/iso3166.h"
+#include "common/iso15924.h"
+
+namespace {
+
+// Typical values of mkvmerge's '--language' and of the GUI's language
+// selections, including ISO 639-2 codes that have to be normalized.
+std::vector<std::string> const s_tags{
+  "de"s, "ger"s, "en-US"s, "es-419"s, "zh-yue-Hant-HK"s, "sl-rozaj-biske"s,
+  "de-CH-1996"s, "en-a-bbb-x-a-ccc"s, "x-private"s, "i-klingon"s, "und"s, "mul"s,
+};
+
+void
+BM_Parse(benchmark::State &state) {
+  for (auto _ : state)
+    for (auto const &tag : s_tags)
+      benchmark::DoNotOptimize(mtx::bcp47::language_c::parse(tag));
+
+  state.SetItemsProcessed(state.iterations() * s_tags.size());
+}
+
+void
+BM_LookUpISO639Code(benchmark::State &state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(mtx::iso639::look_up("deu"s));
+    benchmark::DoNotOptimize(mtx::iso639::look_up("ger"s));
+    benchmark::DoNotOptimize(mtx::iso639::look_up("zu"s));
+  }
+
+  state.SetItemsProcessed(state.iterations() * 3);
+}
+
+void
+BM_LookUpISO639Name(benchmark::State &state) {
+  for (auto _ : state)
+    benchmark::DoNotOptimize(mtx::iso639::look_up("Zulu"s, true));
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+void
+BM_LookUpRegionAndScript(benchmark::State &state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(mtx::iso3166::look_up("ZW"s));
+    benchmark::DoNotOptimize(mtx::iso15924::look_up("Zyyy"s));
+  }
+
+  state.SetItemsProcessed(state.iterations() * 2);
+}
+
+}
+
+BENCHMARK(BM_Parse);
+BENCHMARK(BM_LookUpISO639Code);
+BENCHMARK(BM_LookUpISO639Name);
+BENCHMARK(BM_LookUpRegionAndScript);
+
+int
+main(int argc,
+     char **argv) {
+  // The initialization only happens once per process and is therefore
+  // timed separately. The language tables are initialized on first use
+  // during the first benchmark.
+  auto start = std::chrono::steady_clock::now();
+
+  mtx_common_init("bcp47", argv[0]);
+
+  auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+  std::cout << fmt::format("mtx_common_init: {0} µs\n", duration.count());
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  return 0;
+}
@@ -0,0 +1,69 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit https://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+
+   benchmarks for mtx::bytes::buffer_c
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <benchmark/benchmark.h>
+
+#include "common/byte_buffer.h"
+
+namespace {
+
+// The amount of data pushed through the buffer per iteration. At
+// 1.5 MBit/s (DTS) that's about six minutes of audio; the throughput
+// reported scales linearly to multi-hour tracks.
+std::size_t const s_data_per_iteration = 64 * 1024 * 1024;
+
+/* Simulates an audio frame parser: payloads of transport stream
+   packets or PES packets are added and complete frames are removed
+   from the front as soon as they're available. `backlog` bytes are
+   kept in the buffer at all times, e.g. while a parser is searching
+   for the next sync word or a reader buffers whole PES packets.
+*/
+void
+BM_ParseFrames(benchmark::State &state) {
+  auto payload_size = static_cast<std::size_t>(state.range(0));
+  auto frame_size   = static_cast<std::size_t>(state.range(1));
+  auto backlog      = static_cast<std::size_t>(state.range(2));
+  auto payload      = std::vector<uint8_t>(payload_size, 0x42);
+
+  for (auto _ : state) {
+    mtx::bytes::buffer_c buffer;
+    auto processed = std::size_t{};
+
+    while (processed < s_data_per_iteration) {
+      buffer.add(payload.data(), payload.size());
+      processed += payload.size();
+
+      while (buffer.get_size() >= (backlog + frame_size)) {
+        benchmark::DoNotOptimize(buffer.get_buffer()[frame_size - 1]);
+        buffer.remove(frame_size);
+      }
+    }
+  }
+
+  state.SetBytesProcessed(state.iterations() * s_data_per_iteration);
+}
+
+}
+
+// AC-3 at 448 kbit/s from MPEG transport stream packets
+BENCHMARK(BM_ParseFrames)->Args({  184, 1792,           0 });
+// DTS at 1.5 MBit/s from whole PES packets
+BENCHMARK(BM_ParseFrames)->Args({ 8192, 2013,           0 });
+// TrueHD with a large amount of data kept in the buffer
+BENCHMARK(BM_ParseFrames)->Args({ 8192,   80,  256 * 1024 });
+// DTS-HD MA frames with a large amount of data kept in the buffer
+BENCHMARK(BM_ParseFrames)->Args({ 8192, 4096, 1024 * 1024 });
+
+BENCHMARK_MAIN();
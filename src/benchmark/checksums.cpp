@@ -0,0 +1,117 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit https://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+
+   benchmarks for the Adler-32, CRC-32 & MD5 implementations
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <random>
+
+#include <benchmark/benchmark.h>
+
+#include "common/checksums/adler32.h"
+#include "common/checksums/crc.h"
+#include "common/checksums/md5.h"
+
+namespace {
+
+// 4 KiB is a typical size of audio frames & of the frames mkvinfo
+// calculates checksums of.
+std::size_t const s_frame_size = 4096;
+
+std::vector<memory_cptr>
+create_frames(std::size_t num_frames) {
+  std::mt19937 generator{42};
+  std::vector<memory_cptr> frames;
+
+  for (auto idx = 0u; idx < num_frames; ++idx) {
+    auto frame = memory_c::alloc(s_frame_size);
+
+    for (auto byte_idx = 0u; byte_idx < s_frame_size; ++byte_idx)
+      frame->get_buffer()[byte_idx] = static_cast<uint8_t>(generator());
+
+    frames.push_back(frame);
+  }
+
+  return frames;
+}
+
+void
+BM_Adler32(benchmark::State &state,
+           mtx::checksum::adler32::update_fn update) {
+  auto frame = create_frames(1)[0];
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(update(1, frame->get_buffer(), s_frame_size));
+
+  state.SetBytesProcessed(state.iterations() * s_frame_size);
+}
+
+void
+BM_Crc32IeeeLe(benchmark::State &state,
+               mtx::checksum::crc32_ieee_le::update_fn update) {
+  auto frame = create_frames(1)[0];
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(update(0xffffffff, frame->get_buffer(), s_frame_size));
+
+  state.SetBytesProcessed(state.iterations() * s_frame_size);
+}
+
+void
+BM_MD5Single(benchmark::State &state) {
+  auto frames = create_frames(state.range(0));
+
+  for (auto _ : state)
+    for (auto const &frame : frames) {
+      mtx::checksum::md5_c md5;
+      md5.add(*frame);
+      md5.finish();
+      benchmark::DoNotOptimize(md5.get_result());
+    }
+
+  state.SetBytesProcessed(state.iterations() * frames.size() * s_frame_size);
+}
+
+void
+BM_MD5Multi(benchmark::State &state) {
+  auto frames = create_frames(state.range(0));
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(mtx::checksum::md5_multi_c::calculate(frames));
+
+  state.SetBytesProcessed(state.iterations() * frames.size() * s_frame_size);
+}
+
+}
+
+BENCHMARK(BM_MD5Single)->Arg(1)->Arg(8)->Arg(64);
+BENCHMARK(BM_MD5Multi)->Arg(1)->Arg(8)->Arg(64);
+
+int
+main(int argc,
+     char **argv) {
+  // The Adler-32 & CRC-32 implementations available depend on the CPU.
+  for (auto const &implementation : mtx::checksum::adler32::get_implementations())
+    benchmark::RegisterBenchmark(fmt::format("BM_Adler32/{0}", implementation.name).c_str(), BM_Adler32, implementation.update);
+
+  for (auto const &implementation : mtx::checksum::crc32_ieee_le::get_implementations())
+    benchmark::RegisterBenchmark(fmt::format("BM_Crc32IeeeLe/{0}", implementation.name).c_str(), BM_Crc32IeeeLe, implementation.update);
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  return 0;
+}
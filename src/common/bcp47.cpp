@@ -14,9 +14,9 @@
 #include "common/common_pch.h"
 
 #include <fmt/ranges.h>
+#include <unordered_set>
 
 #include "common/bcp47.h"
-#include "common/bcp47_re.h"
 #include "common/iana_language_subtag_registry.h"
 #include "common/iso639.h"
 #include "common/iso3166.h"
@@ -31,6 +31,158 @@ namespace mtx::bcp47 {
 bool language_c::ms_disabled                           = false;
 normalization_mode_e language_c::ms_normalization_mode = normalization_mode_e::default_mode;
 
+namespace {
+
+// The components of a tag as determined by its general structure.
+// Variants and extensions keep their leading '-' each; private use
+// subtags are stored without the 'x'.
+struct tokenized_tag_t {
+  std::string language, extlang, language4, language5_8, script, region, variants, extensions;
+  std::vector<std::string> private_use, global_private_use;
+};
+
+bool
+is_alpha(char c) {
+  return (c >= 'a') && (c <= 'z');
+}
+
+bool
+is_digit(char c) {
+  return (c >= '0') && (c <= '9');
+}
+
+bool
+is_alnum(char c) {
+  return is_alpha(c) || is_digit(c);
+}
+
+bool
+is_all(std::string const &subtag,
+       std::size_t min_length,
+       std::size_t max_length,
+       bool (*test)(char)) {
+  return (subtag.size() >= min_length)
+      && (subtag.size() <= max_length)
+      && std::all_of(subtag.begin(), subtag.end(), test);
+}
+
+bool
+is_variant(std::string const &subtag) {
+  return is_all(subtag, 5, 8, is_alnum)
+      || ((subtag.size() == 4) && is_digit(subtag[0]) && is_all(subtag, 4, 4, is_alnum));
+}
+
+bool
+is_singleton(std::string const &subtag) {
+  return (subtag.size() == 1) && is_alnum(subtag[0]) && (subtag[0] != 'x');
+}
+
+/** \brief Splits a lower-case tag into its components
+
+   Implements the general structure of RFC 5646 section 2.1 without
+   grandfathered tags. Each component can only be followed by subtags
+   that differ from it in length or character class, therefore the
+   subtags can be assigned greedily from left to right without any
+   backtracking.
+
+   \return The components or an empty optional if the tag doesn't adhere
+   to the general structure.
+*/
+std::optional<tokenized_tag_t>
+tokenize(std::string const &tag) {
+  tokenized_tag_t result;
+  std::vector<std::string> subtags;
+  std::size_t start = 0;
+
+  while (true) {
+    auto end = tag.find('-', start);
+    subtags.emplace_back(tag.substr(start, end == std::string::npos ? std::string::npos : end - start));
+
+    if (!is_all(subtags.back(), 1, 8, is_alnum))
+      return {};
+
+    if (end == std::string::npos)
+      break;
+
+    start = end + 1;
+  }
+
+  auto current = subtags.begin(), end = subtags.end();
+
+  auto take_private_use = [&current, &end](std::vector<std::string> &target) {
+    if (++current == end)
+      return false;
+
+    target.assign(current, end);
+    current = end;
+
+    return true;
+  };
+
+  if (*current == "x") {
+    if (!take_private_use(result.global_private_use))
+      return {};
+    return result;
+  }
+
+  if (!is_all(*current, 2, 8, is_alpha))
+    return {};
+
+  auto &language = current->size() <= 3 ? result.language
+                 : current->size() == 4 ? result.language4
+                 :                        result.language5_8;
+  language       = *current++;
+
+  if ((current != end) && !result.language.empty() && is_all(*current, 3, 3, is_alpha))
+    result.extlang = *current++;
+
+  if ((current != end) && is_all(*current, 4, 4, is_alpha))
+    result.script = *current++;
+
+  if ((current != end) && (is_all(*current, 2, 2, is_alpha) || is_all(*current, 3, 3, is_digit)))
+    result.region = *current++;
+
+  while ((current != end) && is_variant(*current))
+    result.variants += "-"s + *current++;
+
+  while ((current != end) && is_singleton(*current)) {
+    result.extensions += "-"s + *current++;
+
+    auto num_subtags = 0u;
+    for (; (current != end) && is_all(*current, 2, 8, is_alnum); ++current, ++num_subtags)
+      result.extensions += "-"s + *current;
+
+    if (!num_subtags)
+      return {};
+  }
+
+  if ((current != end) && (*current == "x") && !take_private_use(result.private_use))
+    return {};
+
+  if (current != end)
+    return {};
+
+  return result;
+}
+
+bool
+is_grandfathered(std::string const &tag_lower) {
+  static auto const s_grandfathered = []() {
+    mtx::iana::language_subtag_registry::ensure_initialized();
+
+    std::unordered_set<std::string> grandfathered;
+
+    for (auto const &entry : mtx::iana::language_subtag_registry::g_grandfathered)
+      grandfathered.insert(mtx::string::to_lower_ascii(entry.code));
+
+    return grandfathered;
+  }();
+
+  return s_grandfathered.find(tag_lower) != s_grandfathered.end();
+}
+
+} // anonymous namespace
+
 bool
 operator <(language_c::extension_t const &a,
            language_c::extension_t const &b) {
@@ -502,62 +654,58 @@ language_c::validate_extensions() {
 language_c
 language_c::parse(std::string const &language,
                   normalization_mode_e normalization_mode) {
-  init_re();
-
   language_c l;
   auto language_lower = mtx::string::to_lower_ascii(language);
-  auto matches        = s_bcp47_grandfathered_re->match(Q(language_lower));
 
-  if (matches.hasMatch()) {
+  if (is_grandfathered(language_lower)) {
     l.m_grandfathered = language;
     l.m_valid         = true;
     return l.normalize(normalization_mode);
   }
 
-  matches = s_bcp47_re->match(Q(language_lower));
+  auto tag = tokenize(language_lower);
 
-  if (!matches.hasMatch()) {
+  if (!tag) {
     l.m_parser_error = Y("The value does not adhere to the general structure of IETF BCP 47/RFC 5646 language tags.");
     return l;
   }
 
   // global private use
-  if (matches.capturedLength(10)) {
-    l.m_private_use = mtx::string::split(to_utf8(matches.captured(10)).substr(1), "-");
+  if (!tag->global_private_use.empty()) {
+    l.m_private_use = tag->global_private_use;
     l.m_valid       = true;
     return l.normalize(normalization_mode);
   }
 
-  if (matches.capturedLength(1) && !l.parse_language(to_utf8(matches.captured(1))))
+  if (!tag->language.empty() && !l.parse_language(tag->language))
     return l;
 
-  if (matches.capturedLength(2) && !l.parse_extlang(to_utf8(matches.captured(2))))
+  if (!tag->extlang.empty() && !l.parse_extlang(tag->extlang))
     return l;
 
-  if (matches.capturedLength(3)) {
+  if (!tag->language4.empty()) {
     l.m_parser_error = Y("Four-letter language codes are reserved for future use and not supported.");
     return l;
   }
 
-  if (matches.capturedLength(4)) {
+  if (!tag->language5_8.empty()) {
     l.m_parser_error = Y("Five- to eight-letter language codes are currently not supported.");
     return l;
   }
 
-  if (matches.capturedLength(5) && !l.parse_script(to_utf8(matches.captured(5))))
+  if (!tag->script.empty() && !l.parse_script(tag->script))
     return l;
 
-  if (matches.capturedLength(6) && !l.parse_region(to_utf8(matches.captured(6))))
+  if (!tag->region.empty() && !l.parse_region(tag->region))
     return l;
 
-  if (matches.capturedLength(7) && !l.parse_variants(to_utf8(matches.captured(7))))
+  if (!tag->variants.empty() && !l.parse_variants(tag->variants))
     return l;
 
-  if (matches.capturedLength(8) && !l.parse_extensions(to_utf8(matches.captured(8))))
+  if (!tag->extensions.empty() && !l.parse_extensions(tag->extensions))
     return l;
 
-  if (matches.capturedLength(9))
-    l.m_private_use = mtx::string::split(to_utf8(matches.captured(9)).substr(1), "-");
+  l.m_private_use = tag->private_use;
 
   if (!l.validate_extlang() || !l.validate_variants())
     return l;
@@ -815,6 +963,8 @@ language_c::find_best_match(std::vector<language_c> const &potential_matches)
 
 language_c &
 language_c::canonicalize_preferred_values() {
+  mtx::iana::language_subtag_registry::ensure_preferred_values_initialized();
+
   auto &preferred_values = mtx::iana::language_subtag_registry::g_preferred_values;
 
   for (auto const &[match, preferred] : preferred_values) {
@@ -932,6 +1082,8 @@ language_c::should_script_be_suppressed()
     if (!language)
       return false;
 
+    mtx::iana::language_subtag_registry::ensure_initialized();
+
     auto const &suppressions = mtx::iana::language_subtag_registry::g_suppress_scripts;
     auto itr                 = suppressions.find(language->alpha_3_code);
 
@@ -142,8 +142,6 @@ public:
   static bool is_disabled();
 };
 
-void init_re();
-
 inline std::ostream &
 operator<<(std::ostream &out,
            language_c::extension_t const &extension) {
@@ -19,6 +19,15 @@
 
 namespace mtx::bytes {
 
+/* A FIFO byte buffer whose content is always available as one
+   contiguous memory area.
+
+   Data removed from the front is not moved immediately. The remaining
+   data is only moved to the front of the memory area when more space
+   is needed at the back and the data to move isn't bigger than the
+   space freed at the front. Therefore each byte is moved at most once
+   on average no matter how the data is added and removed.
+*/
 class buffer_c {
 private:
   memory_cptr m_data;
@@ -42,40 +51,26 @@ public:
   {
   };
 
+  // Moves the data to the front and releases memory not needed
+  // anymore.
   void trim() {
-    if (m_offset == 0)
-      return;
-
-    auto buffer = m_data->get_buffer();
-    std::memmove(buffer, &buffer[m_offset], m_filled);
-
-    m_offset             = 0;
-    std::size_t new_size = (m_filled / m_chunk_size + 1) * m_chunk_size;
-
-    if (new_size != m_size) {
-      m_data->resize(new_size);
-      m_size = new_size;
-
-      count_alloc(new_size);
-    }
+    reallocate(0, m_filled);
   }
 
   void add(uint8_t const *new_data, std::size_t new_size, position_e const add_where = at_back) {
-    if ((m_offset != 0) && ((m_offset + m_filled + new_size) >= m_chunk_size))
-      trim();
+    if (!new_size)
+      return;
 
-    if ((m_offset + m_filled + new_size) > m_size) {
-      m_size = ((m_offset + m_filled + new_size) / m_chunk_size + 1) * m_chunk_size;
-      m_data->resize(m_size);
-      count_alloc(m_size);
-    }
+    if (add_where == at_front) {
+      if (m_offset < new_size)
+        reallocate(new_size, m_filled + new_size);
+
+      m_offset -= new_size;
+      std::memcpy(m_data->get_buffer() + m_offset, new_data, new_size);
 
-    if (add_where == at_back)
+    } else {
+      make_room_at_back(new_size);
       std::memcpy(m_data->get_buffer() + m_offset + m_filled, new_data, new_size);
-    else {
-      auto target = m_data->get_buffer() + m_offset;
-      std::memmove(target + new_size, target, m_filled);
-      std::memcpy(target, new_data, new_size);
     }
 
     m_filled += new_size;
@@ -101,8 +96,9 @@ public:
       m_offset += num;
     m_filled -= num;
 
-    if (m_filled >= m_chunk_size)
-      trim();
+    // Starting from the front again is free if nothing's left.
+    if (!m_filled)
+      m_offset = 0;
   }
 
   void clear() {
@@ -124,6 +120,50 @@ public:
   }
 
 private:
+  void make_room_at_back(std::size_t new_size) {
+    auto needed = m_filled + new_size;
+
+    if ((m_offset + needed) <= m_size)
+      return;
+
+    // Moving is cheap enough if the data to move isn't bigger than
+    // what has been removed from the front.
+    if ((needed <= m_size) && (m_filled <= m_offset)) {
+      auto buffer = m_data->get_buffer();
+      std::memmove(buffer, &buffer[m_offset], m_filled);
+      m_offset = 0;
+      return;
+    }
+
+    // Otherwise grow generously so that enough data will have been
+    // removed from the front by the time the space runs out again.
+    reallocate(0, 2 * needed);
+  }
+
+  // Copies the data into a new memory area large enough for
+  // `min_size` bytes, leaving `headroom` bytes in front of it.
+  void reallocate(std::size_t headroom, std::size_t min_size) {
+    auto new_size = (min_size / m_chunk_size + 1) * m_chunk_size;
+
+    if ((new_size == m_size) && (m_offset == headroom))
+      return;
+
+    if (new_size == m_size) {
+      auto buffer = m_data->get_buffer();
+      std::memmove(&buffer[headroom], &buffer[m_offset], m_filled);
+
+    } else {
+      auto new_data = memory_c::alloc(new_size);
+      std::memcpy(new_data->get_buffer() + headroom, get_buffer(), m_filled);
+
+      m_data = new_data;
+      m_size = new_size;
+
+      count_alloc(new_size);
+    }
+
+    m_offset = headroom;
+  }
 
   void count_alloc(size_t filled) {
     ++m_num_reallocs;
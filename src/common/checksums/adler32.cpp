@@ -13,24 +13,208 @@
 
 #include "common/common_pch.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define MTX_ADLER32_X86_SIMD
+# include <immintrin.h>
+#endif
+
 #include "common/checksums/adler32.h"
 #include "common/endian.h"
 
 namespace mtx::checksum {
 
+namespace adler32 {
+
+namespace {
+
+uint32_t const s_mod_adler = 65521;
+
+// The largest number of bytes that can be summed up before the sums
+// have to be reduced modulo s_mod_adler without overflowing 32 bits.
+std::size_t const s_max_unreduced = 5552;
+
+uint32_t
+update_portable(uint32_t adler,
+                uint8_t const *buffer,
+                size_t size) {
+  auto a = adler & 0xffff;
+  auto b = adler >> 16;
+
+  while (size) {
+    auto block_size  = std::min(size, s_max_unreduced);
+    size            -= block_size;
+
+    for (; block_size >= 8; block_size -= 8, buffer += 8) {
+      a += buffer[0]; b += a;
+      a += buffer[1]; b += a;
+      a += buffer[2]; b += a;
+      a += buffer[3]; b += a;
+      a += buffer[4]; b += a;
+      a += buffer[5]; b += a;
+      a += buffer[6]; b += a;
+      a += buffer[7]; b += a;
+    }
+
+    for (; block_size; --block_size, ++buffer) {
+      a += *buffer;
+      b += a;
+    }
+
+    a %= s_mod_adler;
+    b %= s_mod_adler;
+  }
+
+  return (b << 16) | a;
+}
+
+#if defined(MTX_ADLER32_X86_SIMD)
+
+// Both SIMD variants process blocks of 32 bytes. For each block the
+// plain sum of the bytes is added to a, and the bytes weighted with
+// 32…1 are added to b. a's value before each block contributes
+// 32 × a to b; those contributions are collected in v_prev_a and
+// multiplied by 32 once per run of blocks.
+
+__attribute__((target("ssse3")))
+uint32_t
+update_ssse3(uint32_t adler,
+             uint8_t const *buffer,
+             size_t size) {
+  auto a          = adler & 0xffff;
+  auto b          = adler >> 16;
+  auto num_blocks = size / 32;
+  size           -= num_blocks * 32;
+
+  auto const weights_1 = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17);
+  auto const weights_2 = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10,  9,  8,  7,  6,  5,  4,  3,  2,  1);
+  auto const zero      = _mm_setzero_si128();
+  auto const ones      = _mm_set1_epi16(1);
+
+  while (num_blocks) {
+    auto n      = std::min<size_t>(num_blocks, s_max_unreduced / 32);
+    num_blocks -= n;
+
+    auto v_prev_a = _mm_set_epi32(0, 0, 0, static_cast<int>(a * n));
+    auto v_b      = _mm_set_epi32(0, 0, 0, static_cast<int>(b));
+    auto v_a      = _mm_setzero_si128();
+
+    do {
+      auto bytes_1 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(buffer));
+      auto bytes_2 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(buffer + 16));
+
+      v_prev_a     = _mm_add_epi32(v_prev_a, v_a);
+
+      v_a          = _mm_add_epi32(v_a, _mm_sad_epu8(bytes_1, zero));
+      v_b          = _mm_add_epi32(v_b, _mm_madd_epi16(_mm_maddubs_epi16(bytes_1, weights_1), ones));
+      v_a          = _mm_add_epi32(v_a, _mm_sad_epu8(bytes_2, zero));
+      v_b          = _mm_add_epi32(v_b, _mm_madd_epi16(_mm_maddubs_epi16(bytes_2, weights_2), ones));
+
+      buffer      += 32;
+    } while (--n);
+
+    v_b = _mm_add_epi32(v_b, _mm_slli_epi32(v_prev_a, 5));
+
+    v_a = _mm_add_epi32(v_a, _mm_shuffle_epi32(v_a, _MM_SHUFFLE(2, 3, 0, 1)));
+    v_a = _mm_add_epi32(v_a, _mm_shuffle_epi32(v_a, _MM_SHUFFLE(1, 0, 3, 2)));
+    v_b = _mm_add_epi32(v_b, _mm_shuffle_epi32(v_b, _MM_SHUFFLE(2, 3, 0, 1)));
+    v_b = _mm_add_epi32(v_b, _mm_shuffle_epi32(v_b, _MM_SHUFFLE(1, 0, 3, 2)));
+
+    a = (a + static_cast<uint32_t>(_mm_cvtsi128_si32(v_a))) % s_mod_adler;
+    b =      static_cast<uint32_t>(_mm_cvtsi128_si32(v_b))  % s_mod_adler;
+  }
+
+  return update_portable((b << 16) | a, buffer, size);
+}
+
+__attribute__((target("avx2")))
+uint32_t
+update_avx2(uint32_t adler,
+            uint8_t const *buffer,
+            size_t size) {
+  auto a          = adler & 0xffff;
+  auto b          = adler >> 16;
+  auto num_blocks = size / 32;
+  size           -= num_blocks * 32;
+
+  auto const weights = _mm256_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17,
+                                        16, 15, 14, 13, 12, 11, 10,  9,  8,  7,  6,  5,  4,  3,  2,  1);
+  auto const zero    = _mm256_setzero_si256();
+  auto const ones    = _mm256_set1_epi16(1);
+
+  while (num_blocks) {
+    auto n      = std::min<size_t>(num_blocks, s_max_unreduced / 32);
+    num_blocks -= n;
+
+    auto v_prev_a = _mm256_set_epi32(0, 0, 0, 0, 0, 0, 0, static_cast<int>(a * n));
+    auto v_b      = _mm256_set_epi32(0, 0, 0, 0, 0, 0, 0, static_cast<int>(b));
+    auto v_a      = _mm256_setzero_si256();
+
+    do {
+      auto bytes  = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(buffer));
+
+      v_prev_a    = _mm256_add_epi32(v_prev_a, v_a);
+      v_a         = _mm256_add_epi32(v_a, _mm256_sad_epu8(bytes, zero));
+      v_b         = _mm256_add_epi32(v_b, _mm256_madd_epi16(_mm256_maddubs_epi16(bytes, weights), ones));
+
+      buffer     += 32;
+    } while (--n);
+
+    v_b       = _mm256_add_epi32(v_b, _mm256_slli_epi32(v_prev_a, 5));
+
+    auto s_a  = _mm_add_epi32(_mm256_castsi256_si128(v_a), _mm256_extracti128_si256(v_a, 1));
+    auto s_b  = _mm_add_epi32(_mm256_castsi256_si128(v_b), _mm256_extracti128_si256(v_b, 1));
+
+    s_a       = _mm_add_epi32(s_a, _mm_shuffle_epi32(s_a, _MM_SHUFFLE(2, 3, 0, 1)));
+    s_a       = _mm_add_epi32(s_a, _mm_shuffle_epi32(s_a, _MM_SHUFFLE(1, 0, 3, 2)));
+    s_b       = _mm_add_epi32(s_b, _mm_shuffle_epi32(s_b, _MM_SHUFFLE(2, 3, 0, 1)));
+    s_b       = _mm_add_epi32(s_b, _mm_shuffle_epi32(s_b, _MM_SHUFFLE(1, 0, 3, 2)));
+
+    a = (a + static_cast<uint32_t>(_mm_cvtsi128_si32(s_a))) % s_mod_adler;
+    b =      static_cast<uint32_t>(_mm_cvtsi128_si32(s_b))  % s_mod_adler;
+  }
+
+  return update_portable((b << 16) | a, buffer, size);
+}
+
+#endif  // MTX_ADLER32_X86_SIMD
+
+} // anonymous namespace
+
+std::vector<implementation_t> const &
+get_implementations() {
+  static auto const s_implementations = []() {
+    std::vector<implementation_t> implementations{ { "portable", update_portable } };
+
+#if defined(MTX_ADLER32_X86_SIMD)
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("ssse3"))
+      implementations.push_back({ "ssse3", update_ssse3 });
+
+    if (__builtin_cpu_supports("avx2"))
+      implementations.push_back({ "avx2", update_avx2 });
+#endif
+
+    return implementations;
+  }();
+
+  return s_implementations;
+}
+
+} // namespace adler32
+
 adler32_c::adler32_c()
-  : m_a{1}
-  , m_b{0}
+  : m_adler{1}
+  , m_update{adler32::get_implementations().back().update}
 {
 }
 
 memory_cptr
 adler32_c::get_result()
   const {
-  auto result = (m_b << 16) | m_a;
   uint8_t buf[4];
 
-  put_uint32_be(buf, result);
+  put_uint32_be(buf, m_adler);
 
   return memory_c::clone(buf, 4);
 }
@@ -38,16 +222,13 @@ adler32_c::get_result()
 uint64_t
 adler32_c::get_result_as_uint()
   const {
-  return (m_b << 16) | m_a;
+  return m_adler;
 }
 
 void
 adler32_c::add_impl(uint8_t const *buffer,
                     size_t size) {
-  for (auto idx = 0u; idx < size; ++idx) {
-    m_a = (m_a + buffer[idx]) % msc_mod_adler;
-    m_b = (m_b + m_a)         % msc_mod_adler;
-  }
+  m_adler = m_update(m_adler, buffer, size);
 }
 
 } // namespace mtx::checksum
@@ -19,10 +19,26 @@
 
 namespace mtx::checksum {
 
+namespace adler32 {
+
+using update_fn = uint32_t (*)(uint32_t adler, uint8_t const *buffer, size_t size);
+
+struct implementation_t {
+  char const *name;
+  update_fn update;
+};
+
+// All implementations the current CPU supports, ordered from the
+// slowest (the portable one) to the fastest one. The fastest one is
+// used by adler32_c.
+std::vector<implementation_t> const &get_implementations();
+
+} // namespace adler32
+
 class adler32_c: public base_c, public uint_result_c {
 protected:
-  static uint32_t const msc_mod_adler = 65521;
-  uint32_t m_a, m_b;
+  uint32_t m_adler;
+  adler32::update_fn m_update;
 
 public:
   adler32_c();
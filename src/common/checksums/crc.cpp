@@ -16,13 +16,30 @@
 
 #include "common/common_pch.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define MTX_CRC32_X86_PCLMUL
+# include <immintrin.h>
+#endif
+
+#if defined(__ARM_FEATURE_CRC32)
+# include <arm_acle.h>
+#endif
+
 #include "common/bswap.h"
 #include "common/checksums/crc.h"
 #include "common/endian.h"
 
 namespace mtx::checksum {
 
-crc_base_c::table_parameters_t const crc_base_c::ms_table_parameters[6] = {
+namespace {
+
+struct table_parameters_t {
+  uint8_t  le;
+  uint8_t  bits;
+  uint32_t poly;
+};
+
+table_parameters_t const s_table_parameters[6] = {
   { 0,  8,       0x07 },
   { 0, 16,     0x8005 },
   { 0, 16,     0x1021 },
@@ -31,55 +48,250 @@ crc_base_c::table_parameters_t const crc_base_c::ms_table_parameters[6] = {
   { 0, 16,     0x002d },
 };
 
-crc_base_c::crc_base_c(type_e type,
-                       table_t &table,
-                       uint32_t crc)
-  : m_type{type}
-  , m_table{table}
-  , m_crc{crc}
-  , m_xor_result{}
-  , m_result_in_le{}
-{
-  if (m_table.empty())
-    init_table();
-}
+unsigned int const s_num_slices        = 8;
+unsigned int const s_crc_32_ieee_le_idx = 4;
 
 #ifdef COMP_MSC
 #pragma warning(disable:4146)	//unary minus operator applied to unsigned type, result still unsigned
 #endif
 
-void
-crc_base_c::init_table() {
-  auto &parameters = ms_table_parameters[m_type];
-
+std::vector<uint32_t>
+create_table(table_parameters_t const &parameters) {
   if ((parameters.bits < 8) || (parameters.bits > 32) || (parameters.poly >= (1LL<<parameters.bits)))
     throw std::domain_error{"Invalid CRC parameters"};
 
-  m_table.resize(256);
+  std::vector<uint32_t> table(s_num_slices * 256);
 
   for (auto i = 0u; i < 256u; i++) {
     if (parameters.le) {
       uint32_t c = i;
       for (auto j = 0u; j < 8u; j++)
         c = (c >> 1) ^ (parameters.poly & (-(c & 1)));
-      m_table[i] = c;
+      table[i] = c;
 
     } else {
       uint32_t c = i << 24;
       for (auto j = 0u; j < 8u; j++)
         c = (c << 1) ^ ((parameters.poly << (32 - parameters.bits)) & (static_cast<int32_t>(c) >> 31));
-      m_table[i] = mtx::bytes::swap_32(c);
+      table[i] = mtx::bytes::swap_32(c);
     }
   }
 
+  // Tables for slice-by-8: entry i of slice n is the CRC of byte i
+  // followed by n zero bytes.
+  for (auto slice = 1u; slice < s_num_slices; ++slice)
+    for (auto i = 0u; i < 256u; i++) {
+      auto previous          = table[(slice - 1) * 256 + i];
+      table[slice * 256 + i] = (previous >> 8) ^ table[previous & 0xff];
+    }
+
   // for (auto row = 0u; row < (256u / 4); ++row)
-  //   mxinfo(fmt::format("0x{0:08x} 0x{1:08x} 0x{2:08x} 0x{3:08x}\n", m_table[row * 4 + 0], m_table[row * 4 + 1], m_table[row * 4 + 2], m_table[row * 4 + 3]));
+  //   mxinfo(fmt::format("0x{0:08x} 0x{1:08x} 0x{2:08x} 0x{3:08x}\n", table[row * 4 + 0], table[row * 4 + 1], table[row * 4 + 2], table[row * 4 + 3]));
+
+  return table;
+}
+
+std::vector<uint32_t> const &
+get_table(unsigned int type) {
+  // Checksums may be calculated from several threads at the same
+  // time, e.g. while probing files in parallel. All tables are
+  // created once when they're needed for the first time.
+  static auto const s_tables = []() {
+    std::vector<std::vector<uint32_t>> tables;
+
+    for (auto const &parameters : s_table_parameters)
+      tables.emplace_back(create_table(parameters));
+
+    return tables;
+  }();
+
+  return s_tables[type];
+}
+
+uint32_t
+update_sliced(uint32_t const *table,
+              uint32_t crc,
+              uint8_t const *buffer,
+              size_t size) {
+  auto end = buffer + size;
+
+  // The CRC register is always kept in the reflected byte order (the
+  // tables for the big endian variants are byte-swapped). Therefore
+  // eight bytes can be processed at once for all variants.
+  while ((end - buffer) >= 8) {
+    auto one = crc ^ get_uint32_le(buffer);
+    auto two = get_uint32_le(buffer + 4);
+
+    crc = table[7 * 256 + ( one        & 0xff)]
+        ^ table[6 * 256 + ((one >>  8) & 0xff)]
+        ^ table[5 * 256 + ((one >> 16) & 0xff)]
+        ^ table[4 * 256 + ( one >> 24        )]
+        ^ table[3 * 256 + ( two        & 0xff)]
+        ^ table[2 * 256 + ((two >>  8) & 0xff)]
+        ^ table[1 * 256 + ((two >> 16) & 0xff)]
+        ^ table[0 * 256 + ( two >> 24        )];
+
+    buffer += 8;
+  }
+
+  while (buffer < end) {
+    crc = table[(crc & 0xff) ^ *buffer] ^ (crc >> 8);
+    ++buffer;
+  }
+
+  return crc;
+}
+
+uint32_t
+update_crc32_ieee_le_portable(uint32_t crc,
+                              uint8_t const *buffer,
+                              size_t size) {
+  return update_sliced(get_table(s_crc_32_ieee_le_idx).data(), crc, buffer, size);
+}
+
+#if defined(MTX_CRC32_X86_PCLMUL)
+
+// Folds the 128 bits in value forward over the distance the constants
+// were calculated for & adds the data found there.
+__attribute__((target("pclmul,sse4.1")))
+inline __m128i
+fold(__m128i value,
+     __m128i constants,
+     __m128i data) {
+  return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(value, constants, 0x00), _mm_clmulepi64_si128(value, constants, 0x11)), data);
+}
+
+// Folding with carry-less multiplication as described in Intel's white
+// paper "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ
+// Instruction". The constants are the ones for the bit-reflected
+// IEEE 802.3 polynomial given at its end.
+__attribute__((target("pclmul,sse4.1")))
+uint32_t
+update_crc32_ieee_le_pclmul(uint32_t crc,
+                            uint8_t const *buffer,
+                            size_t size) {
+  if (size < 64)
+    return update_crc32_ieee_le_portable(crc, buffer, size);
+
+  auto const k1k2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+  auto const k3k4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+  auto const k5   = _mm_set_epi64x(0,            0x0163cd6124);
+  auto const poly = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+  auto const mask = _mm_setr_epi32(~0, 0, ~0, 0);
+
+  auto x1 = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<__m128i const *>(buffer)), _mm_cvtsi32_si128(static_cast<int>(crc)));
+  auto x2 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(buffer + 16));
+  auto x3 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(buffer + 32));
+  auto x4 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(buffer + 48));
+
+  buffer += 64;
+  size   -= 64;
+
+  // Four blocks of 128 bits are folded in parallel…
+  while (size >= 64) {
+    x1      = fold(x1, k1k2, _mm_loadu_si128(reinterpret_cast<__m128i const *>(buffer)));
+    x2      = fold(x2, k1k2, _mm_loadu_si128(reinterpret_cast<__m128i const *>(buffer + 16)));
+    x3      = fold(x3, k1k2, _mm_loadu_si128(reinterpret_cast<__m128i const *>(buffer + 32)));
+    x4      = fold(x4, k1k2, _mm_loadu_si128(reinterpret_cast<__m128i const *>(buffer + 48)));
+
+    buffer += 64;
+    size   -= 64;
+  }
+
+  // …then into a single one…
+  x1 = fold(x1, k3k4, x2);
+  x1 = fold(x1, k3k4, x3);
+  x1 = fold(x1, k3k4, x4);
+
+  while (size >= 16) {
+    x1      = fold(x1, k3k4, _mm_loadu_si128(reinterpret_cast<__m128i const *>(buffer)));
+
+    buffer += 16;
+    size   -= 16;
+  }
+
+  // …which is reduced to 64 bits & then to the 32 bits of the CRC
+  // with a Barrett reduction.
+  x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), _mm_clmulepi64_si128(x1, k3k4, 0x10));
+  x1 = _mm_xor_si128(_mm_srli_si128(x1, 4), _mm_clmulepi64_si128(_mm_and_si128(x1, mask), k5, 0x00));
+
+  x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), poly, 0x10);
+  x2 = _mm_clmulepi64_si128(_mm_and_si128(x2, mask), poly, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+
+  return update_crc32_ieee_le_portable(static_cast<uint32_t>(_mm_extract_epi32(x1, 1)), buffer, size);
+}
+
+#endif  // MTX_CRC32_X86_PCLMUL
+
+#if defined(__ARM_FEATURE_CRC32)
+
+// The ARMv8 CRC32 instructions implement exactly the reflected
+// IEEE 802.3 polynomial used by crc_32_ieee_le.
+uint32_t
+update_crc32_ieee_le_arm(uint32_t crc,
+                         uint8_t const *buffer,
+                         size_t size) {
+  auto end = buffer + size;
+
+  while ((end - buffer) >= 8) {
+    crc     = __crc32d(crc, get_uint64_le(buffer));
+    buffer += 8;
+  }
+
+  while (buffer < end) {
+    crc = __crc32b(crc, *buffer);
+    ++buffer;
+  }
+
+  return crc;
+}
+
+#endif  // __ARM_FEATURE_CRC32
+
+} // anonymous namespace
+
+namespace crc32_ieee_le {
+
+std::vector<implementation_t> const &
+get_implementations() {
+  static auto const s_implementations = []() {
+    std::vector<implementation_t> implementations{ { "slice-by-8", update_crc32_ieee_le_portable } };
+
+#if defined(MTX_CRC32_X86_PCLMUL)
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1"))
+      implementations.push_back({ "pclmul", update_crc32_ieee_le_pclmul });
+#endif
+
+#if defined(__ARM_FEATURE_CRC32)
+    implementations.push_back({ "arm-crc32", update_crc32_ieee_le_arm });
+#endif
+
+    return implementations;
+  }();
+
+  return s_implementations;
+}
+
+} // namespace crc32_ieee_le
+
+crc_base_c::crc_base_c(type_e type,
+                       uint32_t crc)
+  : m_type{type}
+  , m_table{get_table(type)}
+  , m_update{type == crc_32_ieee_le ? crc32_ieee_le::get_implementations().back().update : nullptr}
+  , m_crc{crc}
+  , m_xor_result{}
+  , m_result_in_le{}
+{
 }
 
 memory_cptr
 crc_base_c::get_result()
   const {
-  auto result_length = ms_table_parameters[m_type].bits / 8;
+  auto result_length = s_table_parameters[m_type].bits / 8;
   auto result        = m_crc ^ m_xor_result;
 
   if (m_result_in_le)
@@ -124,65 +336,48 @@ crc_base_c::set_result_in_le(bool result_in_le) {
 void
 crc_base_c::add_impl(uint8_t const *buffer,
                      size_t size) {
-  auto end = buffer + size;
-
-  while (buffer < end) {
-    m_crc = m_table[(m_crc & 0xff) ^ *buffer] ^ (m_crc >> 8);
-    ++buffer;
-  }
+  m_crc = m_update ? m_update(m_crc, buffer, size) : update_sliced(m_table.data(), m_crc, buffer, size);
 }
 
 // ----------------------------------------------------------------------
 
-crc_base_c::table_t crc8_atm_c::ms_table;
-
 crc8_atm_c::crc8_atm_c(uint32_t initial_value)
-  : crc_base_c{crc_8_atm, ms_table, initial_value}
+  : crc_base_c{crc_8_atm, initial_value}
 {
 }
 
 // ----------------------------------------------------------------------
 
-crc_base_c::table_t crc16_ansi_c::ms_table;
-
 crc16_ansi_c::crc16_ansi_c(uint32_t initial_value)
-  : crc_base_c{crc_16_ansi, ms_table, initial_value}
+  : crc_base_c{crc_16_ansi, initial_value}
 {
 }
 
 // ----------------------------------------------------------------------
 
-crc_base_c::table_t crc16_ccitt_c::ms_table;
-
 crc16_ccitt_c::crc16_ccitt_c(uint32_t initial_value)
-  : crc_base_c{crc_16_ccitt, ms_table, initial_value}
+  : crc_base_c{crc_16_ccitt, initial_value}
 {
 }
 
 // ----------------------------------------------------------------------
 
-crc_base_c::table_t crc16_002d_c::ms_table;
-
 crc16_002d_c::crc16_002d_c(uint32_t initial_value)
-  : crc_base_c{crc_16_002d, ms_table, initial_value}
+  : crc_base_c{crc_16_002d, initial_value}
 {
 }
 
 // ----------------------------------------------------------------------
 
-crc_base_c::table_t crc32_ieee_c::ms_table;
-
 crc32_ieee_c::crc32_ieee_c(uint32_t initial_value)
-  : crc_base_c{crc_32_ieee, ms_table, initial_value}
+  : crc_base_c{crc_32_ieee, initial_value}
 {
 }
 
 // ----------------------------------------------------------------------
 
-crc_base_c::table_t crc32_ieee_le_c::ms_table;
-
 crc32_ieee_le_c::crc32_ieee_le_c(uint32_t initial_value)
-  : crc_base_c{crc_32_ieee_le, ms_table, initial_value}
+  : crc_base_c{crc_32_ieee_le, initial_value}
 {
 }
 
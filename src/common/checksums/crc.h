@@ -19,6 +19,22 @@
 
 namespace mtx::checksum {
 
+namespace crc32_ieee_le {
+
+using update_fn = uint32_t (*)(uint32_t crc, uint8_t const *buffer, size_t size);
+
+struct implementation_t {
+  char const *name;
+  update_fn update;
+};
+
+// All implementations of the reflected IEEE 802.3 CRC-32 the current
+// CPU supports, ordered from the slowest (the portable one) to the
+// fastest one. The fastest one is used by crc32_ieee_le_c.
+std::vector<implementation_t> const &get_implementations();
+
+} // namespace crc32_ieee_le
+
 class crc_base_c: public base_c, public uint_result_c, public set_initial_value_c {
 protected:
   enum type_e {
@@ -30,27 +46,16 @@ protected:
     crc_16_002d    = 5,
   };
 
-  using table_t = std::vector<uint32_t>;
-
-  struct table_parameters_t {
-    uint8_t  le;
-    uint8_t  bits;
-    uint32_t poly;
-  };
-
-  static table_parameters_t const ms_table_parameters[6];
-
 protected:
   type_e m_type;
-  table_t &m_table;
+  std::vector<uint32_t> const &m_table;
+  crc32_ieee_le::update_fn m_update;
   uint32_t m_crc;
   uint64_t m_xor_result;
   bool m_result_in_le;
 
 protected:
-  crc_base_c(type_e type, table_t &table, uint32_t crc);
-
-  void init_table();
+  crc_base_c(type_e type, uint32_t crc);
 
 public:
   virtual ~crc_base_c() = default;
@@ -69,54 +74,36 @@ protected:
 };
 
 class crc8_atm_c: public crc_base_c {
-protected:
-  static table_t ms_table;
-
 public:
   crc8_atm_c(uint32_t initial_value = 0);
   virtual ~crc8_atm_c() = default;
 };
 
 class crc16_ansi_c: public crc_base_c {
-protected:
-  static table_t ms_table;
-
 public:
   crc16_ansi_c(uint32_t initial_value = 0);
   virtual ~crc16_ansi_c() = default;
 };
 
 class crc16_ccitt_c: public crc_base_c {
-protected:
-  static table_t ms_table;
-
 public:
   crc16_ccitt_c(uint32_t initial_value = 0);
   virtual ~crc16_ccitt_c() = default;
 };
 
 class crc16_002d_c: public crc_base_c {
-protected:
-  static table_t ms_table;
-
 public:
   crc16_002d_c(uint32_t initial_value = 0);
   virtual ~crc16_002d_c() = default;
 };
 
 class crc32_ieee_c: public crc_base_c {
-protected:
-  static table_t ms_table;
-
 public:
   crc32_ieee_c(uint32_t initial_value = 0);
   virtual ~crc32_ieee_c() = default;
 };
 
 class crc32_ieee_le_c: public crc_base_c {
-protected:
-  static table_t ms_table;
-
 public:
   crc32_ieee_le_c(uint32_t initial_value = 0);
   virtual ~crc32_ieee_le_c() = default;
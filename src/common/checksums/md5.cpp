@@ -15,6 +15,10 @@
 
 #include "common/common_pch.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define MTX_MD5_X86_SIMD
+#endif
+
 #include "common/checksums/md5.h"
 #include "common/endian.h"
 
@@ -32,10 +36,105 @@ namespace mtx::checksum {
   (a)  = (((a) << (s)) | (((a) & 0xffffffff) >> (32 - (s)))); \
   (a) += (b);
 
-// SET reads 4 input bytes in little-endian byte order and stores them
-// in a properly aligned word in host byte order.
-#define SET(n) (m_block[(n)]) = get_uint32_le(&data[(n) * 4])
-#define GET(n) (m_block[(n)])
+#define GET(n) (x[(n)])
+
+namespace {
+
+// All four rounds for one 64-byte block. 'V' is either a single
+// 32-bit word or a vector of them, in which case several independent
+// blocks are transformed at once (see md5_multi_c). 'x' contains the
+// block's sixteen words in host byte order.
+template<typename V>
+inline void
+transform(V &a,
+          V &b,
+          V &c,
+          V &d,
+          V const *x) {
+  auto saved_a = a;
+  auto saved_b = b;
+  auto saved_c = c;
+  auto saved_d = d;
+
+  // Round 1
+  STEP(F, a, b, c, d, GET(0), 0xd76aa478, 7);
+  STEP(F, d, a, b, c, GET(1), 0xe8c7b756, 12);
+  STEP(F, c, d, a, b, GET(2), 0x242070db, 17);
+  STEP(F, b, c, d, a, GET(3), 0xc1bdceee, 22);
+  STEP(F, a, b, c, d, GET(4), 0xf57c0faf, 7);
+  STEP(F, d, a, b, c, GET(5), 0x4787c62a, 12);
+  STEP(F, c, d, a, b, GET(6), 0xa8304613, 17);
+  STEP(F, b, c, d, a, GET(7), 0xfd469501, 22);
+  STEP(F, a, b, c, d, GET(8), 0x698098d8, 7);
+  STEP(F, d, a, b, c, GET(9), 0x8b44f7af, 12);
+  STEP(F, c, d, a, b, GET(10), 0xffff5bb1, 17);
+  STEP(F, b, c, d, a, GET(11), 0x895cd7be, 22);
+  STEP(F, a, b, c, d, GET(12), 0x6b901122, 7);
+  STEP(F, d, a, b, c, GET(13), 0xfd987193, 12);
+  STEP(F, c, d, a, b, GET(14), 0xa679438e, 17);
+  STEP(F, b, c, d, a, GET(15), 0x49b40821, 22);
+
+  // Round 2
+  STEP(G, a, b, c, d, GET(1), 0xf61e2562, 5);
+  STEP(G, d, a, b, c, GET(6), 0xc040b340, 9);
+  STEP(G, c, d, a, b, GET(11), 0x265e5a51, 14);
+  STEP(G, b, c, d, a, GET(0), 0xe9b6c7aa, 20);
+  STEP(G, a, b, c, d, GET(5), 0xd62f105d, 5);
+  STEP(G, d, a, b, c, GET(10), 0x02441453, 9);
+  STEP(G, c, d, a, b, GET(15), 0xd8a1e681, 14);
+  STEP(G, b, c, d, a, GET(4), 0xe7d3fbc8, 20);
+  STEP(G, a, b, c, d, GET(9), 0x21e1cde6, 5);
+  STEP(G, d, a, b, c, GET(14), 0xc33707d6, 9);
+  STEP(G, c, d, a, b, GET(3), 0xf4d50d87, 14);
+  STEP(G, b, c, d, a, GET(8), 0x455a14ed, 20);
+  STEP(G, a, b, c, d, GET(13), 0xa9e3e905, 5);
+  STEP(G, d, a, b, c, GET(2), 0xfcefa3f8, 9);
+  STEP(G, c, d, a, b, GET(7), 0x676f02d9, 14);
+  STEP(G, b, c, d, a, GET(12), 0x8d2a4c8a, 20);
+
+  // Round 3
+  STEP(H, a, b, c, d, GET(5), 0xfffa3942, 4);
+  STEP(H2, d, a, b, c, GET(8), 0x8771f681, 11);
+  STEP(H, c, d, a, b, GET(11), 0x6d9d6122, 16);
+  STEP(H2, b, c, d, a, GET(14), 0xfde5380c, 23);
+  STEP(H, a, b, c, d, GET(1), 0xa4beea44, 4);
+  STEP(H2, d, a, b, c, GET(4), 0x4bdecfa9, 11);
+  STEP(H, c, d, a, b, GET(7), 0xf6bb4b60, 16);
+  STEP(H2, b, c, d, a, GET(10), 0xbebfbc70, 23);
+  STEP(H, a, b, c, d, GET(13), 0x289b7ec6, 4);
+  STEP(H2, d, a, b, c, GET(0), 0xeaa127fa, 11);
+  STEP(H, c, d, a, b, GET(3), 0xd4ef3085, 16);
+  STEP(H2, b, c, d, a, GET(6), 0x04881d05, 23);
+  STEP(H, a, b, c, d, GET(9), 0xd9d4d039, 4);
+  STEP(H2, d, a, b, c, GET(12), 0xe6db99e5, 11);
+  STEP(H, c, d, a, b, GET(15), 0x1fa27cf8, 16);
+  STEP(H2, b, c, d, a, GET(2), 0xc4ac5665, 23);
+
+  // Round 4
+  STEP(I, a, b, c, d, GET(0), 0xf4292244, 6);
+  STEP(I, d, a, b, c, GET(7), 0x432aff97, 10);
+  STEP(I, c, d, a, b, GET(14), 0xab9423a7, 15);
+  STEP(I, b, c, d, a, GET(5), 0xfc93a039, 21);
+  STEP(I, a, b, c, d, GET(12), 0x655b59c3, 6);
+  STEP(I, d, a, b, c, GET(3), 0x8f0ccc92, 10);
+  STEP(I, c, d, a, b, GET(10), 0xffeff47d, 15);
+  STEP(I, b, c, d, a, GET(1), 0x85845dd1, 21);
+  STEP(I, a, b, c, d, GET(8), 0x6fa87e4f, 6);
+  STEP(I, d, a, b, c, GET(15), 0xfe2ce6e0, 10);
+  STEP(I, c, d, a, b, GET(6), 0xa3014314, 15);
+  STEP(I, b, c, d, a, GET(13), 0x4e0811a1, 21);
+  STEP(I, a, b, c, d, GET(4), 0xf7537e82, 6);
+  STEP(I, d, a, b, c, GET(11), 0xbd3af235, 10);
+  STEP(I, c, d, a, b, GET(2), 0x2ad7d2bb, 15);
+  STEP(I, b, c, d, a, GET(9), 0xeb86d391, 21);
+
+  a += saved_a;
+  b += saved_b;
+  c += saved_c;
+  d += saved_d;
+}
+
+} // anonymous namespace
 
 md5_c::md5_c()
   : m_a{0x67452301}
@@ -57,87 +156,10 @@ md5_c::work(uint8_t const *data,
   auto d = m_d;
 
   do {
-    auto saved_a = a;
-    auto saved_b = b;
-    auto saved_c = c;
-    auto saved_d = d;
-
-    // Round 1
-    STEP(F, a, b, c, d, SET(0), 0xd76aa478, 7);
-    STEP(F, d, a, b, c, SET(1), 0xe8c7b756, 12);
-    STEP(F, c, d, a, b, SET(2), 0x242070db, 17);
-    STEP(F, b, c, d, a, SET(3), 0xc1bdceee, 22);
-    STEP(F, a, b, c, d, SET(4), 0xf57c0faf, 7);
-    STEP(F, d, a, b, c, SET(5), 0x4787c62a, 12);
-    STEP(F, c, d, a, b, SET(6), 0xa8304613, 17);
-    STEP(F, b, c, d, a, SET(7), 0xfd469501, 22);
-    STEP(F, a, b, c, d, SET(8), 0x698098d8, 7);
-    STEP(F, d, a, b, c, SET(9), 0x8b44f7af, 12);
-    STEP(F, c, d, a, b, SET(10), 0xffff5bb1, 17);
-    STEP(F, b, c, d, a, SET(11), 0x895cd7be, 22);
-    STEP(F, a, b, c, d, SET(12), 0x6b901122, 7);
-    STEP(F, d, a, b, c, SET(13), 0xfd987193, 12);
-    STEP(F, c, d, a, b, SET(14), 0xa679438e, 17);
-    STEP(F, b, c, d, a, SET(15), 0x49b40821, 22);
-
-    // Round 2
-    STEP(G, a, b, c, d, GET(1), 0xf61e2562, 5);
-    STEP(G, d, a, b, c, GET(6), 0xc040b340, 9);
-    STEP(G, c, d, a, b, GET(11), 0x265e5a51, 14);
-    STEP(G, b, c, d, a, GET(0), 0xe9b6c7aa, 20);
-    STEP(G, a, b, c, d, GET(5), 0xd62f105d, 5);
-    STEP(G, d, a, b, c, GET(10), 0x02441453, 9);
-    STEP(G, c, d, a, b, GET(15), 0xd8a1e681, 14);
-    STEP(G, b, c, d, a, GET(4), 0xe7d3fbc8, 20);
-    STEP(G, a, b, c, d, GET(9), 0x21e1cde6, 5);
-    STEP(G, d, a, b, c, GET(14), 0xc33707d6, 9);
-    STEP(G, c, d, a, b, GET(3), 0xf4d50d87, 14);
-    STEP(G, b, c, d, a, GET(8), 0x455a14ed, 20);
-    STEP(G, a, b, c, d, GET(13), 0xa9e3e905, 5);
-    STEP(G, d, a, b, c, GET(2), 0xfcefa3f8, 9);
-    STEP(G, c, d, a, b, GET(7), 0x676f02d9, 14);
-    STEP(G, b, c, d, a, GET(12), 0x8d2a4c8a, 20);
-
-    // Round 3
-    STEP(H, a, b, c, d, GET(5), 0xfffa3942, 4);
-    STEP(H2, d, a, b, c, GET(8), 0x8771f681, 11);
-    STEP(H, c, d, a, b, GET(11), 0x6d9d6122, 16);
-    STEP(H2, b, c, d, a, GET(14), 0xfde5380c, 23);
-    STEP(H, a, b, c, d, GET(1), 0xa4beea44, 4);
-    STEP(H2, d, a, b, c, GET(4), 0x4bdecfa9, 11);
-    STEP(H, c, d, a, b, GET(7), 0xf6bb4b60, 16);
-    STEP(H2, b, c, d, a, GET(10), 0xbebfbc70, 23);
-    STEP(H, a, b, c, d, GET(13), 0x289b7ec6, 4);
-    STEP(H2, d, a, b, c, GET(0), 0xeaa127fa, 11);
-    STEP(H, c, d, a, b, GET(3), 0xd4ef3085, 16);
-    STEP(H2, b, c, d, a, GET(6), 0x04881d05, 23);
-    STEP(H, a, b, c, d, GET(9), 0xd9d4d039, 4);
-    STEP(H2, d, a, b, c, GET(12), 0xe6db99e5, 11);
-    STEP(H, c, d, a, b, GET(15), 0x1fa27cf8, 16);
-    STEP(H2, b, c, d, a, GET(2), 0xc4ac5665, 23);
-
-    // Round 4
-    STEP(I, a, b, c, d, GET(0), 0xf4292244, 6);
-    STEP(I, d, a, b, c, GET(7), 0x432aff97, 10);
-    STEP(I, c, d, a, b, GET(14), 0xab9423a7, 15);
-    STEP(I, b, c, d, a, GET(5), 0xfc93a039, 21);
-    STEP(I, a, b, c, d, GET(12), 0x655b59c3, 6);
-    STEP(I, d, a, b, c, GET(3), 0x8f0ccc92, 10);
-    STEP(I, c, d, a, b, GET(10), 0xffeff47d, 15);
-    STEP(I, b, c, d, a, GET(1), 0x85845dd1, 21);
-    STEP(I, a, b, c, d, GET(8), 0x6fa87e4f, 6);
-    STEP(I, d, a, b, c, GET(15), 0xfe2ce6e0, 10);
-    STEP(I, c, d, a, b, GET(6), 0xa3014314, 15);
-    STEP(I, b, c, d, a, GET(13), 0x4e0811a1, 21);
-    STEP(I, a, b, c, d, GET(4), 0xf7537e82, 6);
-    STEP(I, d, a, b, c, GET(11), 0xbd3af235, 10);
-    STEP(I, c, d, a, b, GET(2), 0x2ad7d2bb, 15);
-    STEP(I, b, c, d, a, GET(9), 0xeb86d391, 21);
-
-    a    += saved_a;
-    b    += saved_b;
-    c    += saved_c;
-    d    += saved_d;
+    for (auto idx = 0; idx < 16; ++idx)
+      m_block[idx] = get_uint32_le(&data[idx * 4]);
+
+    transform(a, b, c, d, m_block);
 
     data += 64;
 
@@ -216,4 +238,282 @@ md5_c::get_result()
   return memory_c::clone(m_result, 16);
 }
 
+// ----------------------------------------------------------------------
+
+namespace {
+
+struct segment_t {
+  uint8_t const *m_data{};
+  std::size_t m_num_blocks{};
+};
+
+// The blocks of one stream that are hashed in one go: the buffered
+// block from a previous call followed by the new data's full blocks.
+struct job_t {
+  uint32_t *m_state{};
+  segment_t m_segments[2];
+};
+
+template<typename V>
+inline uint32_t
+get_lane(V const &v,
+         std::size_t lane) {
+  return v[lane];
+}
+
+inline uint32_t
+get_lane(uint32_t const &v,
+         std::size_t) {
+  return v;
+}
+
+template<typename V>
+inline void
+set_lane(V &v,
+         std::size_t lane,
+         uint32_t value) {
+  v[lane] = value;
+}
+
+inline void
+set_lane(uint32_t &v,
+         std::size_t,
+         uint32_t value) {
+  v = value;
+}
+
+/** \brief Hashes the blocks of all jobs using \c N lanes
+
+   Each lane works on one job at a time and picks up the next pending
+   job as soon as its current one has run out of blocks. Lanes for
+   which no work is left hash a dummy block whose result is ignored.
+*/
+template<typename V, std::size_t N>
+void
+run_lanes(std::vector<job_t> const &jobs) {
+  static uint8_t const s_idle_block[64]{};
+
+  V a{}, b{}, c{}, d{}, x[16];
+  job_t const *lane_jobs[N]{};
+  std::size_t lane_segments[N]{}, lane_blocks[N]{};
+  uint8_t const *lane_data[N];
+  alignas(32) uint32_t words[16][N];
+  auto next_job = jobs.begin();
+
+  auto next_block = [&](std::size_t lane) -> uint8_t const * {
+    while (true) {
+      if (lane_jobs[lane]) {
+        auto &job = *lane_jobs[lane];
+
+        for (; lane_segments[lane] < 2; ++lane_segments[lane], lane_blocks[lane] = 0) {
+          auto const &segment = job.m_segments[lane_segments[lane]];
+          if (lane_blocks[lane] < segment.m_num_blocks)
+            return segment.m_data + 64 * lane_blocks[lane]++;
+        }
+
+        job.m_state[0]  = get_lane(a, lane);
+        job.m_state[1]  = get_lane(b, lane);
+        job.m_state[2]  = get_lane(c, lane);
+        job.m_state[3]  = get_lane(d, lane);
+        lane_jobs[lane] = nullptr;
+      }
+
+      if (next_job == jobs.end())
+        return nullptr;
+
+      lane_jobs[lane]     = &*next_job++;
+      lane_segments[lane] = 0;
+      lane_blocks[lane]   = 0;
+
+      set_lane(a, lane, lane_jobs[lane]->m_state[0]);
+      set_lane(b, lane, lane_jobs[lane]->m_state[1]);
+      set_lane(c, lane, lane_jobs[lane]->m_state[2]);
+      set_lane(d, lane, lane_jobs[lane]->m_state[3]);
+    }
+  };
+
+  while (true) {
+    auto active = false;
+
+    for (auto lane = 0u; lane < N; ++lane) {
+      lane_data[lane] = next_block(lane);
+      active         |= !!lane_data[lane];
+      if (!lane_data[lane])
+        lane_data[lane] = s_idle_block;
+    }
+
+    if (!active)
+      return;
+
+    for (auto word = 0u; word < 16; ++word) {
+      for (auto lane = 0u; lane < N; ++lane)
+        words[word][lane] = get_uint32_le(&lane_data[lane][word * 4]);
+
+      std::memcpy(&x[word], words[word], sizeof(V));
+    }
+
+    transform(a, b, c, d, x);
+  }
+}
+
+#if defined(__GNUC__)
+using lanes4_t = uint32_t __attribute__((vector_size(16)));
+#endif
+
+#if defined(MTX_MD5_X86_SIMD)
+using lanes8_t = uint32_t __attribute__((vector_size(32)));
+
+__attribute__((target("avx2"), flatten))
+void
+run_lanes_avx2(std::vector<job_t> const &jobs) {
+  run_lanes<lanes8_t, 8>(jobs);
+}
+#endif
+
+void
+run_jobs(std::vector<job_t> const &jobs) {
+#if defined(MTX_MD5_X86_SIMD)
+  static auto const s_have_avx2 = []() {
+    __builtin_cpu_init();
+    return !!__builtin_cpu_supports("avx2");
+  }();
+
+  if (s_have_avx2 && (jobs.size() > 4)) {
+    run_lanes_avx2(jobs);
+    return;
+  }
+#endif
+
+#if defined(__GNUC__)
+  if (jobs.size() > 1) {
+    run_lanes<lanes4_t, 4>(jobs);
+    return;
+  }
+#endif
+
+  run_lanes<uint32_t, 1>(jobs);
+}
+
+} // anonymous namespace
+
+md5_multi_c::md5_multi_c(std::size_t num_streams)
+  : m_streams(num_streams)
+{
+  for (auto &stream : m_streams) {
+    stream.m_state[0] = 0x67452301;
+    stream.m_state[1] = 0xefcdab89;
+    stream.m_state[2] = 0x98badcfe;
+    stream.m_state[3] = 0x10325476;
+  }
+}
+
+void
+md5_multi_c::add(std::vector<chunk_t> const &chunks) {
+  assert(chunks.size() == m_streams.size());
+
+  struct tail_t {
+    uint8_t *m_destination{};
+    uint8_t const *m_source{};
+    std::size_t m_size{};
+  };
+
+  std::vector<job_t> jobs;
+  std::vector<tail_t> tails;
+
+  jobs.reserve(m_streams.size());
+  tails.reserve(m_streams.size());
+
+  for (auto idx = 0u; idx < m_streams.size(); ++idx) {
+    auto &stream  = m_streams[idx];
+    auto data     = static_cast<uint8_t const *>(chunks[idx].buffer);
+    auto size     = chunks[idx].size;
+    auto used     = stream.m_size & 0x3f;
+    stream.m_size += size;
+
+    if (!size)
+      continue;
+
+    job_t job;
+    job.m_state = stream.m_state;
+
+    if (used) {
+      auto available = std::min<std::size_t>(64 - used, size);
+
+      std::memcpy(&stream.m_buffer[used], data, available);
+      data += available;
+      size -= available;
+
+      if ((used + available) < 64)
+        continue;
+
+      job.m_segments[0] = { stream.m_buffer, 1 };
+    }
+
+    job.m_segments[1] = { data, size / 64 };
+
+    if (size & 0x3f)
+      tails.push_back({ stream.m_buffer, data + (size & ~static_cast<std::size_t>(0x3f)), size & 0x3f });
+
+    if (job.m_segments[0].m_num_blocks || job.m_segments[1].m_num_blocks)
+      jobs.push_back(job);
+  }
+
+  run_jobs(jobs);
+
+  // The partial blocks can only be buffered once the buffered full
+  // blocks have been hashed.
+  for (auto const &tail : tails)
+    std::memcpy(tail.m_destination, tail.m_source, tail.m_size);
+}
+
+std::vector<memory_cptr>
+md5_multi_c::finish() {
+  std::vector<job_t> jobs;
+
+  jobs.reserve(m_streams.size());
+
+  for (auto &stream : m_streams) {
+    auto used                = stream.m_size & 0x3f;
+    auto num_blocks          = used < 56 ? 1u : 2u;
+
+    stream.m_buffer[used++]  = 0x80;
+    std::memset(&stream.m_buffer[used], 0, num_blocks * 64 - used);
+    put_uint64_le(&stream.m_buffer[num_blocks * 64 - 8], stream.m_size << 3);
+
+    jobs.push_back({ stream.m_state, { { stream.m_buffer, num_blocks } } });
+  }
+
+  run_jobs(jobs);
+
+  std::vector<memory_cptr> results;
+
+  results.reserve(m_streams.size());
+
+  for (auto const &stream : m_streams) {
+    auto result = memory_c::alloc(16);
+
+    for (auto idx = 0; idx < 4; ++idx)
+      put_uint32_le(result->get_buffer() + idx * 4, stream.m_state[idx]);
+
+    results.push_back(result);
+  }
+
+  return results;
+}
+
+std::vector<memory_cptr>
+md5_multi_c::calculate(std::vector<memory_cptr> const &buffers) {
+  md5_multi_c md5{buffers.size()};
+  std::vector<chunk_t> chunks;
+
+  chunks.reserve(buffers.size());
+
+  for (auto const &buffer : buffers)
+    chunks.push_back({ buffer->get_buffer(), buffer->get_size() });
+
+  md5.add(chunks);
+
+  return md5.finish();
+}
+
 } // namespace mtx::checksum
@@ -38,4 +38,40 @@ protected:
   uint8_t const *work(uint8_t const *data, size_t size);
 };
 
+/** \brief Calculates the MD5 sums of several independent streams at once
+
+   The streams are processed in parallel in the lanes of SIMD
+   registers: eight lanes with AVX2, four with SSE2/NEON and a single
+   one if the compiler doesn't support vector extensions. This is
+   considerably faster than hashing many small buffers (e.g. frames)
+   one after the other with \c md5_c. The results are identical to
+   those of \c md5_c.
+*/
+class md5_multi_c {
+public:
+  struct chunk_t {
+    void const *buffer{};
+    size_t size{};
+  };
+
+protected:
+  struct stream_t {
+    uint32_t m_state[4];
+    uint64_t m_size{};
+    uint8_t m_buffer[128];
+  };
+
+  std::vector<stream_t> m_streams;
+
+public:
+  explicit md5_multi_c(std::size_t num_streams);
+
+  // Adds one chunk of data to each stream. 'chunks' must contain
+  // exactly one entry per stream; entries can be empty.
+  void add(std::vector<chunk_t> const &chunks);
+  std::vector<memory_cptr> finish();
+
+  static std::vector<memory_cptr> calculate(std::vector<memory_cptr> const &buffers);
+};
+
 } // namespace mtx::checksum
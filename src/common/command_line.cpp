@@ -25,6 +25,7 @@
 #endif
 #include "common/hacks.h"
 #include "common/json.h"
+#include "common/list_utils.h"
 #include "common/mm_io_x.h"
 #include "common/mm_file_io.h"
 #include "common/mm_proxy_io.h"
@@ -205,6 +206,16 @@ handle_common_args(std::vector<std::string> &args,
       mm_file_io_c::enable_flushing_on_close(true);
       args.erase(args.begin() + i, args.begin() + i + 1);
 
+    } else if (args[i] == "--direct-io") {
+      if ((i + 1) == args.size())
+        mxerror(Y("'--direct-io' lacks its argument.\n"));
+
+      if (!mtx::included_in(args[i + 1], "write"s, "all"s))
+        mxerror(fmt::format(FY("Invalid argument '{0}' for '--direct-io'.\n"), args[i + 1]));
+
+      mm_file_io_c::enable_direct_io(args[i + 1] == "all", true);
+      args.erase(args.begin() + i, args.begin() + i + 2);
+
     } else if (args[i] == "--abort-on-warnings") {
       g_abort_on_warnings = true;
       args.erase(args.begin() + i, args.begin() + i + 1);
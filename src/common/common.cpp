@@ -28,14 +28,11 @@
 #include "common/audio_emphasis.h"
 #include "common/fs_sys_helpers.h"
 #include "common/hacks.h"
-#include "common/iana_language_subtag_registry.h"
-#include "common/iso639.h"
-#include "common/iso3166.h"
-#include "common/iso15924.h"
 #include "common/logger.h"
 #include "common/mm_file_io.h"
 #include "common/mm_stdio.h"
 #include "common/random.h"
+#include "common/startup_timing.h"
 #include "common/stereo_mode.h"
 #include "common/strings/editing.h"
 #include "common/translation.h"
@@ -103,6 +100,8 @@ mxexit(int code) {
   for (auto const &function : s_to_run_before_exit)
     function();
 
+  mtx::startup_timing::report();
+
   mtx_common_cleanup();
 
   if (code != -1)
@@ -114,6 +113,17 @@ mxexit(int code) {
   exit(0);
 }
 
+/** \brief Initializes the parts common to all programs
+
+   Only what's needed by every single invocation is initialized
+   here. This includes the translations as even the help text is
+   translated. Large tables such as the ISO 639 language list & the
+   IANA language subtag registry are initialized on first use instead
+   so that short-lived invocations don't pay for them.
+
+   The duration of each stage is output on exit with '--debug
+   startup_timing'.
+*/
 void
 mtx_common_init(std::string const &program_name,
                 char const *argv0) {
@@ -121,17 +131,21 @@ mtx_common_init(std::string const &program_name,
   ExcHndlInit();
 #endif
 
-  debugging_c::init();
-  mtx::log::init();
-  random_c::init();
-
-  initialize_std_and_boost_filesystem_locales();
+  using mtx::startup_timing::measure;
 
-  g_cc_local_utf8 = charset_converter_c::init("");
+  measure("debugging & logging", []() {
+    debugging_c::init();
+    mtx::log::init();
+  });
 
-  mtx::sys::determine_path_to_current_executable(argv0 ? std::string{argv0} : std::string{});
+  measure("random number generator", []() { random_c::init(); });
+  measure("locales",                 []() { initialize_std_and_boost_filesystem_locales(); });
+  measure("charset converter",       []() { g_cc_local_utf8 = charset_converter_c::init(""); });
 
-  init_common_output(true);
+  measure("executable path & output", [argv0]() {
+    mtx::sys::determine_path_to_current_executable(argv0 ? std::string{argv0} : std::string{});
+    init_common_output(true);
+  });
 
   s_program_name = program_name;
 
@@ -139,19 +153,17 @@ mtx_common_init(std::string const &program_name,
   fix_windows_errormode();
 #endif
 
-  mtx::hacks::init();
-
-  init_locales();
+  measure("hacks", []() { mtx::hacks::init(); });
 
-  init_common_output(false);
+  measure("translations", []() {
+    init_locales();
+    init_common_output(false);
+  });
 
-  mtx::iana::language_subtag_registry::init();
-  mtx::iso639::init();
-  mtx::iso3166::init();
-  mtx::iso15924::init();
-  mtx::iana::language_subtag_registry::init_preferred_values(); // uses language_c::parse() & must therefore be initialized last
-  audio_emphasis_c::init();
-  stereo_mode_c::init();
+  measure("audio emphasis & stereo mode names", []() {
+    audio_emphasis_c::init();
+    stereo_mode_c::init();
+  });
 }
 
 std::string const &
@@ -117,6 +117,27 @@ content_decoder_c::reverse(memory_cptr &memory,
       memory = ce.compressor->decompress(memory);
 }
 
+// Returns by how much the size of each frame increases when
+// reversing the block-scoped encodings, or nothing if the increase
+// cannot be determined without decoding the frame itself.
+std::optional<int64_t>
+content_decoder_c::get_block_size_increase()
+  const {
+  auto increase = int64_t{};
+
+  for (auto const &enc : encodings) {
+    if (0 == (enc.scope & CONTENT_ENCODING_SCOPE_BLOCK))
+      continue;
+
+    if (3 != enc.comp_algo)
+      return {};
+
+    increase += enc.comp_settings->get_size();
+  }
+
+  return increase;
+}
+
 std::string
 content_decoder_c::descriptive_algorithm_list() {
   std::string list;
@@ -51,5 +51,6 @@ public:
   bool has_encodings() {
     return !encodings.empty();
   }
+  std::optional<int64_t> get_block_size_increase() const;
   std::string descriptive_algorithm_list();
 };
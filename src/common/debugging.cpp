@@ -13,6 +13,7 @@
 
 #include "common/common_pch.h"
 
+#include <mutex>
 #include <sstream>
 
 #include <ebml/EbmlDate.h>
@@ -156,23 +157,29 @@ debugging_c::hexdump(memory_c const &buffer_to_dump,
 
 // ------------------------------------------------------------
 
-std::vector<debugging_option_c::option_c> debugging_option_c::ms_registered_options;
+std::deque<debugging_option_c::option_c> debugging_option_c::ms_registered_options;
 
-size_t
+namespace {
+std::mutex s_registered_options_mutex;
+}
+
+debugging_option_c::option_c &
 debugging_option_c::register_option(std::string const &option) {
+  std::lock_guard<std::mutex> lock{s_registered_options_mutex};
+
   auto itr = std::find_if(ms_registered_options.begin(), ms_registered_options.end(), [&option](option_c const &opt) { return opt.m_option == option; });
   if (itr != ms_registered_options.end())
-    return std::distance(ms_registered_options.begin(), itr);
+    return *itr;
 
-  ms_registered_options.emplace_back(option);
-
-  return ms_registered_options.size() - 1;
+  return ms_registered_options.emplace_back(option);
 }
 
 void
 debugging_option_c::invalidate_cache() {
+  std::lock_guard<std::mutex> lock{s_registered_options_mutex};
+
   for (auto &opt : ms_registered_options)
-    opt.m_requested.reset();
+    opt.m_requested = -1;
 }
 
 // ------------------------------------------------------------
@@ -68,6 +68,14 @@ get_list() {
   hacks.emplace_back("keep_whitespaces_in_text_subtitles", svec{ Y("Normally spaces & tabs are removed from the beginning & the end of each line in text subtitles."),
                                                                  Y("If this hack is enabled, they won't be removed.") });
   hacks.emplace_back("always_write_block_add_ids",         svec{ Y("If enabled, the BlockAddID element will be written even if it's set to its default value of 1.") });
+  hacks.emplace_back("parallel_probing",                   svec{ Y("Evaluate the probers for the source files' types concurrently on multiple threads instead of one after the other."),
+                                                                 Y("The order of priority used for picking the detected type stays the same.") });
+  hacks.emplace_back("stream_mp4_fragments",               svec{ Y("Only parse the first fragments of fragmented MP4 files when reading the headers and parse the following ones while multiplexing."),
+                                                                 Y("Multiplexing starts right away, and memory usage doesn't grow with the number of fragments.") });
+  hacks.emplace_back("parallel_file_headers",              svec{ Y("Probe the types of all source files and read their headers concurrently on multiple threads instead of one file after the other."),
+                                                                 Y("Messages are still output in the order of the source files.") });
+  hacks.emplace_back("mp4_file_order",                     svec{ Y("Read the samples of MP4/QuickTime files in the order they're stored in the file as long as the requested track's next sample is close by instead of one track after the other."),
+                                                                 Y("This turns reading well-interleaved files into sequential I/O, e.g. on network storage.") });
   hacks.emplace_back("cow",                                svec{ Y("No help available.") });
 
   return hacks;
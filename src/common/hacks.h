@@ -47,7 +47,11 @@ constexpr unsigned int APPEND_AND_SPLIT_FLAC              = 22;
 constexpr unsigned int DONT_NORMALIZE_PARAMETER_SETS      = 23;
 constexpr unsigned int KEEP_WHITESPACES_IN_TEXT_SUBTITLES = 24;
 constexpr unsigned int ALWAYS_WRITE_BLOCK_ADD_IDS         = 25;
-constexpr unsigned int MAX_IDX                            = 25;
+constexpr unsigned int PARALLEL_PROBING                   = 26;
+constexpr unsigned int STREAM_MP4_FRAGMENTS               = 27;
+constexpr unsigned int PARALLEL_FILE_HEADERS              = 28;
+constexpr unsigned int MP4_FILE_ORDER                     = 29;
+constexpr unsigned int MAX_IDX                            = 29;
 }
 
 struct hack_t {
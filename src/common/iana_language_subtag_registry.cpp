@@ -13,45 +13,81 @@
 
 #include "common/common_pch.h"
 
+#include <mutex>
+#include <unordered_map>
+
 #include "common/iana_language_subtag_registry.h"
+#include "common/startup_timing.h"
 #include "common/strings/formatting.h"
 
 namespace mtx::iana::language_subtag_registry {
 
 namespace {
 
+using index_t = std::unordered_map<std::string, std::size_t>;
+
+// The indexes are built on first use. For codes present in several
+// entries the first entry wins, just like with a linear search.
+index_t
+build_index(std::vector<entry_t> const &entries) {
+  ensure_initialized();
+
+  index_t index;
+  index.reserve(entries.size());
+
+  for (auto idx = 0u; idx < entries.size(); ++idx)
+    index.emplace(mtx::string::to_lower_ascii(entries[idx].code), idx);
+
+  return index;
+}
+
 std::optional<entry_t>
 look_up_entry(std::string const &s,
-             std::vector<entry_t> const &entries) {
+              std::vector<entry_t> const &entries,
+              index_t const &index) {
   if (s.empty())
     return {};
 
-  auto s_lower = mtx::string::to_lower_ascii(s);
-  auto itr     = std::find_if(entries.begin(), entries.end(), [&s_lower](auto const &entry) {
-    return s_lower == mtx::string::to_lower_ascii(entry.code);
-  });
+  auto itr = index.find(mtx::string::to_lower_ascii(s));
 
-  if (itr != entries.end())
-    return *itr;
+  if (itr != index.end())
+    return entries[itr->second];
 
   return {};
 }
 
 }
 
+void
+ensure_initialized() {
+  static std::once_flag s_once;
+  std::call_once(s_once, []() { mtx::startup_timing::measure("IANA language subtag registry (on first use)", init); });
+}
+
+// The preferred values are language tags themselves. Parsing them
+// requires the other lists.
+void
+ensure_preferred_values_initialized() {
+  static std::once_flag s_once;
+  std::call_once(s_once, []() { mtx::startup_timing::measure("IANA language subtag registry preferred values (on first use)", init_preferred_values); });
+}
+
 std::optional<entry_t>
 look_up_extlang(std::string const &s) {
-  return look_up_entry(s, g_extlangs);
+  static auto const s_index = build_index(g_extlangs);
+  return look_up_entry(s, g_extlangs, s_index);
 }
 
 std::optional<entry_t>
 look_up_variant(std::string const &s) {
-  return look_up_entry(s, g_variants);
+  static auto const s_index = build_index(g_variants);
+  return look_up_entry(s, g_variants, s_index);
 }
 
 std::optional<entry_t>
 look_up_grandfathered(std::string const &s) {
-  return look_up_entry(s, g_grandfathered);
+  static auto const s_index = build_index(g_grandfathered);
+  return look_up_entry(s, g_grandfathered, s_index);
 }
 
 } // namespace mtx::iana::language_subtag_registry
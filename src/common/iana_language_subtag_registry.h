@@ -40,6 +40,8 @@ extern std::unordered_map<std::string, std::string> g_suppress_scripts;
 
 void init();
 void init_preferred_values();
+void ensure_initialized();
+void ensure_preferred_values_initialized();
 std::optional<entry_t> look_up_extlang(std::string const &s);
 std::optional<entry_t> look_up_variant(std::string const &s);
 std::optional<entry_t> look_up_grandfathered(std::string const &s);
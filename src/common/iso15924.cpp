@@ -13,23 +13,54 @@
 
 #include "common/common_pch.h"
 
+#include <mutex>
+#include <unordered_map>
+
 #include "common/iso15924.h"
+#include "common/startup_timing.h"
 #include "common/strings/formatting.h"
 
 namespace mtx::iso15924 {
 
+namespace {
+
+// Built on first use. For codes present in several entries the first
+// entry wins, just like with a linear search.
+std::unordered_map<std::string, std::size_t> const &
+code_index() {
+  static auto const s_index = []() {
+    ensure_initialized();
+
+    std::unordered_map<std::string, std::size_t> index;
+    index.reserve(g_scripts.size());
+
+    for (auto idx = 0u; idx < g_scripts.size(); ++idx)
+      index.emplace(mtx::string::to_lower_ascii(g_scripts[idx].code), idx);
+
+    return index;
+  }();
+
+  return s_index;
+}
+
+} // anonymous namespace
+
+void
+ensure_initialized() {
+  static std::once_flag s_once;
+  std::call_once(s_once, []() { mtx::startup_timing::measure("ISO 15924 scripts (on first use)", init); });
+}
+
 std::optional<script_t>
 look_up(std::string const &s) {
   if (s.empty())
     return {};
 
-  auto s_lower = mtx::string::to_lower_ascii(s);
-  auto itr     = std::find_if(g_scripts.begin(), g_scripts.end(), [&s_lower](auto const &script) {
-    return s_lower == mtx::string::to_lower_ascii(script.code);
-  });
+  auto &index = code_index();
+  auto itr    = index.find(mtx::string::to_lower_ascii(s));
 
-  if (itr != g_scripts.end())
-    return *itr;
+  if (itr != index.end())
+    return g_scripts[itr->second];
 
   return {};
 }
@@ -35,6 +35,7 @@ struct script_t {
 extern std::vector<script_t> g_scripts;
 
 void init();
+void ensure_initialized();
 std::optional<script_t> look_up(std::string const &s);
 
 } // namespace mtx::iso15924
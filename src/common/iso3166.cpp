@@ -13,7 +13,11 @@
 
 #include "common/common_pch.h"
 
+#include <mutex>
+#include <unordered_map>
+
 #include "common/iso3166.h"
+#include "common/startup_timing.h"
 #include "common/strings/formatting.h"
 
 namespace mtx::iso3166 {
@@ -33,35 +37,75 @@ std::map<std::string, std::string> const s_deprecated_cctlds{
   { "TP", "TL" },
 };
 
+// Built on first use. For codes present in several entries the first
+// entry wins, just like with a linear search.
+std::unordered_map<std::string, std::size_t> const &
+code_index() {
+  static auto const s_index = []() {
+    ensure_initialized();
+
+    std::unordered_map<std::string, std::size_t> index;
+    index.reserve(g_regions.size() * 2);
+
+    for (auto idx = 0u; idx < g_regions.size(); ++idx)
+      for (auto const &code : { g_regions[idx].alpha_2_code, g_regions[idx].alpha_3_code })
+        if (!code.empty())
+          index.emplace(code, idx);
+
+    return index;
+  }();
+
+  return s_index;
+}
+
+std::unordered_map<unsigned int, std::size_t> const &
+number_index() {
+  static auto const s_index = []() {
+    ensure_initialized();
+
+    std::unordered_map<unsigned int, std::size_t> index;
+    index.reserve(g_regions.size());
+
+    for (auto idx = 0u; idx < g_regions.size(); ++idx)
+      index.emplace(g_regions[idx].number, idx);
+
+    return index;
+  }();
+
+  return s_index;
+}
+
+template<typename Tkey>
 std::optional<region_t>
-look_up(std::function<bool(region_t const &)> const &test) {
-  auto itr = std::find_if(g_regions.begin(), g_regions.end(), test);
+look_up_in(std::unordered_map<Tkey, std::size_t> const &index,
+           Tkey const &key) {
+  auto itr = index.find(key);
 
-  if (itr != g_regions.end())
-    return *itr;
+  if (itr != index.end())
+    return g_regions[itr->second];
 
   return {};
 }
 
 } // anonymous namespace
 
+void
+ensure_initialized() {
+  static std::once_flag s_once;
+  std::call_once(s_once, []() { mtx::startup_timing::measure("ISO 3166 regions (on first use)", init); });
+}
+
 std::optional<region_t>
 look_up(std::string const &s) {
   if (s.empty())
     return {};
 
-  auto s_upper = mtx::string::to_upper_ascii(s);
-
-  return look_up([&s_upper](auto const &country) {
-    return (s_upper == country.alpha_2_code) || (s_upper == country.alpha_3_code);
-  });
+  return look_up_in(code_index(), mtx::string::to_upper_ascii(s));
 }
 
 std::optional<region_t>
 look_up(unsigned int number) {
-  return look_up([number](auto const &country) {
-    return country.number == number;
-  });
+  return look_up_in(number_index(), number);
 }
 
 std::optional<region_t>
@@ -82,9 +126,7 @@ look_up_cctld(std::string const &s) {
   if (cctld_itr != s_cctlds_only.end())
     return *cctld_itr;
 
-  return look_up([&s_upper](auto const &country) {
-    return (s_upper == country.alpha_2_code) || (s_upper == country.alpha_3_code);
-  });
+  return look_up_in(code_index(), s_upper);
 }
 
 } // namespace mtx::iso3166
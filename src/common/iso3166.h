@@ -37,6 +37,7 @@ struct region_t {
 extern std::vector<region_t> g_regions;
 
 void init();
+void ensure_initialized();
 std::optional<region_t> look_up(std::string const &s);
 std::optional<region_t> look_up(unsigned int number);
 
@@ -14,9 +14,11 @@
 #include "common/common_pch.h"
 
 #include <boost/version.hpp>
+#include <mutex>
 #include <unordered_map>
 
 #include "common/iso639.h"
+#include "common/startup_timing.h"
 #include "common/strings/editing.h"
 #include "common/strings/table_formatter.h"
 #include "common/strings/utf8.h"
@@ -35,10 +37,60 @@ std::unordered_map<std::string, std::string> s_deprecated_1_and_2_codes{
   { "mol", "rum" },
 };
 
+// The indexes are built on first use so that programs that never look
+// up a language don't pay for them during startup. For codes and names
+// present in several entries the first entry wins, just like with a
+// linear search.
+std::unordered_map<std::string, std::size_t> const &
+code_index() {
+  static auto const s_index = []() {
+    std::unordered_map<std::string, std::size_t> index;
+    index.reserve(g_languages.size() * 2);
+
+    for (auto idx = 0u; idx < g_languages.size(); ++idx)
+      for (auto const &code : { g_languages[idx].alpha_3_code, g_languages[idx].terminology_abbrev, g_languages[idx].alpha_2_code })
+        if (!code.empty())
+          index.emplace(code, idx);
+
+    return index;
+  }();
+
+  return s_index;
+}
+
+std::unordered_map<std::string, std::size_t> const &
+name_index() {
+  static auto const s_index = []() {
+    std::unordered_map<std::string, std::size_t> index;
+    index.reserve(g_languages.size());
+
+    for (auto idx = 0u; idx < g_languages.size(); ++idx) {
+      auto names = mtx::string::split(g_languages[idx].english_name, ";");
+
+      mtx::string::strip(names);
+
+      for (auto const &name : names)
+        index.emplace(balg::to_lower_copy(name), idx);
+    }
+
+    return index;
+  }();
+
+  return s_index;
+}
+
 } // anonymous namespace
 
+void
+ensure_initialized() {
+  static std::once_flag s_once;
+  std::call_once(s_once, []() { mtx::startup_timing::measure("ISO 639 languages (on first use)", init); });
+}
+
 void
 list_languages() {
+  ensure_initialized();
+
   mtx::string::table_formatter_c formatter;
   formatter.set_header({ Y("English language name"), Y("ISO 639-3 code"), Y("ISO 639-2 code"), Y("ISO 639-1 code") });
 
@@ -65,29 +117,25 @@ look_up(std::string const &s,
   if (s.empty())
     return {};
 
+  ensure_initialized();
+
   auto source          = s;
   auto deprecated_code = s_deprecated_1_and_2_codes.find(source);
   if (deprecated_code != s_deprecated_1_and_2_codes.end())
     source = deprecated_code->second;
 
-  auto lang_code = std::find_if(g_languages.begin(), g_languages.end(), [&source](auto const &lang) { return (lang.alpha_3_code == source) || (lang.terminology_abbrev == source) || (lang.alpha_2_code == source); });
-  if (lang_code != g_languages.end())
-    return *lang_code;
+  auto &codes   = code_index();
+  auto code_itr = codes.find(source);
+  if (code_itr != codes.end())
+    return g_languages[code_itr->second];
 
   if (!also_look_up_by_name)
     return {};
 
-  for (auto const &language : g_languages) {
-    auto const &english_name = language.english_name;
-    auto s_lower             = balg::to_lower_copy(s);
-    auto names               = mtx::string::split(english_name, ";");
-
-    mtx::string::strip(names);
-
-    for (auto const &name : names)
-      if (balg::to_lower_copy(name) == s_lower)
-        return language;
-  }
+  auto &names   = name_index();
+  auto name_itr = names.find(balg::to_lower_copy(s));
+  if (name_itr != names.end())
+    return g_languages[name_itr->second];
 
   for (auto const &language : g_languages) {
     auto names = mtx::string::split(language.english_name, ";");
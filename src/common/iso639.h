@@ -20,6 +20,7 @@
 namespace mtx::iso639 {
 
 void init();
+void ensure_initialized();
 std::optional<language_t> look_up(std::string const &s, bool also_look_up_by_name = false);
 void list_languages();
 
@@ -138,4 +138,176 @@ dump(nlohmann::json const &json,
   return json_fixed.dump(indentation);
 }
 
+// ------------------------------------------------------------
+
+streaming_writer_c::streaming_writer_c(output_cb_t const &output,
+                                       unsigned int indentation,
+                                       std::vector<std::string> const &top_level_key_order)
+  : m_output{output}
+  , m_indentation{indentation}
+  , m_top_level_key_order{top_level_key_order}
+{
+}
+
+void
+streaming_writer_c::output(std::string const &text) {
+  if (m_kept_top_level_value)
+    *m_kept_top_level_value += text;
+  else
+    m_output(text);
+}
+
+std::string
+streaming_writer_c::indent()
+  const {
+  return std::string(m_levels.size() * m_indentation, ' ');
+}
+
+std::size_t
+streaming_writer_c::get_top_level_key_position(std::string const &key)
+  const {
+  auto itr = std::find(m_top_level_key_order.begin(), m_top_level_key_order.end(), key);
+
+  if (itr == m_top_level_key_order.end())
+    mxerror(fmt::format("streaming_writer_c::get_top_level_key_position(): programming error: key '{0}' is not part of the top-level key order\n", key));
+
+  auto position = static_cast<std::size_t>(std::distance(m_top_level_key_order.begin(), itr));
+
+  if (position < m_next_top_level_key)
+    mxerror(fmt::format("streaming_writer_c::get_top_level_key_position(): programming error: key '{0}' added after a key following it in the top-level key order\n", key));
+
+  return position;
+}
+
+void
+streaming_writer_c::write_kept_top_level_values(std::size_t up_to_position) {
+  auto &level = m_levels.front();
+
+  while (!m_kept_top_level_values.empty() && (m_kept_top_level_values.begin()->first < up_to_position)) {
+    auto const &[position, value] = *m_kept_top_level_values.begin();
+
+    m_output(fmt::format("{0}\n{1}{2}: {3}", level.m_has_values ? "," : "", indent(), dump(nlohmann::json(m_top_level_key_order[position])), value));
+
+    level.m_has_values   = true;
+    m_next_top_level_key = std::max(m_next_top_level_key, position + 1);
+
+    m_kept_top_level_values.erase(m_kept_top_level_values.begin());
+  }
+}
+
+void
+streaming_writer_c::start_value(std::optional<std::string> const &key,
+                                bool may_be_kept) {
+  if (m_levels.empty())
+    return;
+
+  auto &level = m_levels.back();
+
+  if (!m_top_level_key_order.empty() && (m_levels.size() == 1) && key) {
+    auto position = get_top_level_key_position(*key);
+
+    if (may_be_kept && (position > m_next_top_level_key)) {
+      // Keys before this one may still follow. The separator, the
+      // indentation & the key are written once its place is reached.
+      level.m_keys.insert(*key);
+      m_kept_top_level_value = &m_kept_top_level_values[position];
+      return;
+    }
+
+    write_kept_top_level_values(position);
+    m_next_top_level_key = position + 1;
+  }
+
+  output(fmt::format("{0}\n{1}", level.m_has_values ? "," : "", indent()));
+  level.m_has_values = true;
+
+  if (!key)
+    return;
+
+  level.m_keys.insert(*key);
+  output(fmt::format("{0}: ", dump(nlohmann::json(*key))));
+}
+
+void
+streaming_writer_c::start_level(std::optional<std::string> const &key,
+                                bool is_object) {
+  start_value(key, false);
+  output(is_object ? "{" : "[");
+  m_levels.push_back({ is_object });
+}
+
+void
+streaming_writer_c::start_object() {
+  start_level({}, true);
+}
+
+void
+streaming_writer_c::start_object(std::string const &key) {
+  start_level(key, true);
+}
+
+void
+streaming_writer_c::start_array() {
+  start_level({}, false);
+}
+
+void
+streaming_writer_c::start_array(std::string const &key) {
+  start_level(key, false);
+}
+
+void
+streaming_writer_c::write_value(nlohmann::json const &value) {
+  // Nested values are dumped on their own and then indented to the
+  // current level.
+  output(balg::replace_all_copy(dump(value, m_indentation), "\n", "\n"s + indent()));
+}
+
+void
+streaming_writer_c::add(nlohmann::json const &value) {
+  start_value({}, false);
+  write_value(value);
+}
+
+void
+streaming_writer_c::add(std::string const &key,
+                        nlohmann::json const &value) {
+  start_value(key, true);
+  write_value(value);
+
+  m_kept_top_level_value = nullptr;
+}
+
+void
+streaming_writer_c::end() {
+  if (m_levels.empty())
+    return;
+
+  if (m_levels.size() == 1)
+    write_kept_top_level_values(m_top_level_key_order.size());
+
+  auto level = std::move(m_levels.back());
+  m_levels.pop_back();
+
+  output(fmt::format("{0}{1}", level.m_has_values ? "\n"s + indent() : ""s, level.m_is_object ? "}" : "]"));
+}
+
+void
+streaming_writer_c::end_to_depth(std::size_t depth) {
+  while (m_levels.size() > depth)
+    end();
+}
+
+std::size_t
+streaming_writer_c::get_depth()
+  const {
+  return m_levels.size();
+}
+
+bool
+streaming_writer_c::has_key(std::string const &key)
+  const {
+  return !m_levels.empty() && (m_levels.back().m_keys.find(key) != m_levels.back().m_keys.end());
+}
+
 } // namespace mtx::json
@@ -13,6 +13,8 @@
 
 #include "common/common_pch.h"
 
+#include <unordered_set>
+
 #if HAVE_NLOHMANN_JSONCPP != 2 // 0 == internal, 1 == system in subdirectory, 2 == system without subdirectory
 # include <nlohmann/json.hpp>
 #else
@@ -24,4 +26,69 @@ namespace mtx::json {
 nlohmann::json parse(nlohmann::json::string_t const &data, nlohmann::json::parser_callback_t callback = nullptr);
 nlohmann::json::string_t dump(nlohmann::json const &json, int indentation = 0);
 
+/* Writes a JSON document piece by piece as its values become known
+   instead of building the whole document in memory first. The output
+   is formatted exactly like `dump()` formats it with the same
+   indentation, apart from the order of object keys: they're written in
+   the order they're added in.
+
+   If `top_level_key_order` is given, the keys of the top-level object
+   are written in that order no matter in which order they're added.
+   Objects & arrays started at the top level are written right away, so
+   they must be started in that order; a key whose place has been
+   passed cannot be added anymore. A value added with `add()` before
+   its place has been reached is kept as text until a key following it
+   is started or the object is ended. This is meant for small values
+   only as the big ones can be streamed in order.
+
+   Values written with `add()` are arbitrary JSON values which are
+   dumped right away. Objects & arrays opened with `start_object()` &
+   `start_array()` stay open until `end()` is called.
+*/
+class streaming_writer_c {
+public:
+  using output_cb_t = std::function<void(std::string const &)>;
+
+protected:
+  struct level_t {
+    bool m_is_object{}, m_has_values{};
+    std::unordered_set<std::string> m_keys;
+  };
+
+  output_cb_t m_output;
+  unsigned int m_indentation;
+  std::vector<level_t> m_levels;
+
+  std::vector<std::string> m_top_level_key_order;
+  std::size_t m_next_top_level_key{};
+  std::map<std::size_t, std::string> m_kept_top_level_values;
+  std::string *m_kept_top_level_value{};
+
+public:
+  streaming_writer_c(output_cb_t const &output, unsigned int indentation = 2, std::vector<std::string> const &top_level_key_order = {});
+
+  void start_object();
+  void start_object(std::string const &key);
+  void start_array();
+  void start_array(std::string const &key);
+
+  void add(nlohmann::json const &value);
+  void add(std::string const &key, nlohmann::json const &value);
+
+  void end();
+  void end_to_depth(std::size_t depth);
+
+  std::size_t get_depth() const;
+  bool has_key(std::string const &key) const;
+
+protected:
+  void start_value(std::optional<std::string> const &key, bool may_be_kept);
+  void start_level(std::optional<std::string> const &key, bool is_object);
+  void write_value(nlohmann::json const &value);
+  std::size_t get_top_level_key_position(std::string const &key) const;
+  void write_kept_top_level_values(std::size_t up_to_position);
+  void output(std::string const &text);
+  std::string indent() const;
+};
+
 } // namespace mtx::json
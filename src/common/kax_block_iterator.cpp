@@ -0,0 +1,370 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit https://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+
+   pull-based iteration over the blocks of a Matroska cluster
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <matroska/KaxBlock.h>
+#include <matroska/KaxBlockData.h>
+#include <matroska/KaxCluster.h>
+
+#include "common/ebml.h"
+#include "common/kax_block_iterator.h"
+#include "common/list_utils.h"
+#include "common/mm_io_x.h"
+#include "common/mm_mem_io.h"
+#include "common/vint.h"
+
+namespace mtx::kax {
+
+namespace {
+
+debugging_option_c s_debug{"kax_block_iterator"};
+
+uint64_t
+read_uint(mm_io_c &io,
+          uint64_t size) {
+  auto value = uint64_t{};
+
+  for (auto idx = 0u; (idx < size) && (idx < 8); ++idx)
+    value = (value << 8) | io.read_uint8();
+
+  return value;
+}
+
+int64_t
+read_int(mm_io_c &io,
+         uint64_t size) {
+  if (!size || (size > 8))
+    return 0;
+
+  auto value = read_uint(io, size);
+  auto shift = 64 - 8 * size;
+
+  // Sign-extend from the element's actual size.
+  return static_cast<int64_t>(value << shift) >> shift;
+}
+
+}
+
+bool
+block_iterator_c::load_cluster(mm_io_c &in,
+                               uint64_t end,
+                               uint64_t max_size) {
+  static auto const s_cluster_id = EBML_ID(libmatroska::KaxCluster).GetValue();
+
+  auto position = in.getFilePointer();
+
+  m_data.reset();
+  m_data_io.reset();
+
+  try {
+    auto id   = vint_c::read_ebml_id(in);
+    auto size = vint_c::read(in);
+
+    if (   !id.is_valid()
+        || (id.m_value != s_cluster_id)
+        || !size.is_valid()
+        || size.is_unknown()
+        || (static_cast<uint64_t>(size.m_value) > max_size)
+        || ((in.getFilePointer() + size.m_value) > end)) {
+      mxdebug_if(s_debug, fmt::format("load_cluster: no cluster with a known size of at most {0} bytes ending before {1} at {2}\n", max_size, end, position));
+      in.setFilePointer(position);
+      return false;
+    }
+
+    auto data = memory_c::alloc(size.m_value);
+
+    if (in.read(data->get_buffer(), size.m_value) != static_cast<uint64_t>(size.m_value)) {
+      in.setFilePointer(position);
+      return false;
+    }
+
+    m_data       = data;
+    m_position   = position;
+    m_data_start = in.getFilePointer() - size.m_value;
+    m_timestamp  = 0;
+
+    // Verify the structure of all blocks before handing out the first
+    // one so that the caller can still read the cluster differently.
+    // This also determines the cluster's timestamp no matter where in
+    // the cluster it's stored.
+    if (!validate_structure()) {
+      mxdebug_if(s_debug, fmt::format("load_cluster: invalid structure in cluster at {0}\n", position));
+      m_data.reset();
+      in.setFilePointer(position);
+      return false;
+    }
+
+    m_data_io = std::make_unique<mm_mem_io_c>(static_cast<uint8_t const *>(m_data->get_buffer()), m_data->get_size());
+
+    return true;
+
+  } catch (mtx::mm_io::exception &ex) {
+    mxdebug_if(s_debug, fmt::format("load_cluster: I/O exception at {0}: {1}\n", position, ex.what()));
+  }
+
+  m_data.reset();
+  in.setFilePointer(position);
+
+  return false;
+}
+
+uint64_t
+block_iterator_c::get_position()
+  const {
+  return m_position;
+}
+
+uint64_t
+block_iterator_c::get_timestamp()
+  const {
+  return m_timestamp;
+}
+
+memory_cptr
+block_iterator_c::slice(uint64_t offset,
+                        uint64_t size)
+  const {
+  return memory_c::share(m_data, offset, size);
+}
+
+memory_cptr
+block_iterator_c::get_raw_element(block_header_t const &header)
+  const {
+  return slice(header.position - m_data_start, header.size);
+}
+
+bool
+block_iterator_c::validate_structure() {
+  static auto const s_cluster_timestamp_id = EBML_ID(kax_cluster_timestamp_c).GetValue();
+  static auto const s_simple_block_id      = EBML_ID(libmatroska::KaxSimpleBlock).GetValue();
+  static auto const s_block_group_id       = EBML_ID(libmatroska::KaxBlockGroup).GetValue();
+
+  mm_mem_io_c io{static_cast<uint8_t const *>(m_data->get_buffer()), m_data->get_size()};
+  block_t block;
+
+  try {
+    while (io.getFilePointer() < io.get_size()) {
+      auto id   = vint_c::read_ebml_id(io);
+      auto size = vint_c::read(io);
+
+      if (!id.is_valid() || !size.is_valid() || size.is_unknown())
+        return false;
+
+      auto element_end = io.getFilePointer() + size.m_value;
+      if (element_end > io.get_size())
+        return false;
+
+      if (id.m_value == s_cluster_timestamp_id)
+        m_timestamp = read_uint(io, size.m_value);
+
+      else if (id.m_value == s_simple_block_id) {
+        if (!cluster_scanner_c::read_block_header(io, size.m_value, block.header))
+          return false;
+
+      } else if (id.m_value == s_block_group_id) {
+        if (!parse_block_group(io, element_end, block, true))
+          return false;
+      }
+
+      io.setFilePointer(element_end);
+    }
+
+  } catch (mtx::mm_io::exception &) {
+    return false;
+  }
+
+  return true;
+}
+
+block_t const *
+block_iterator_c::next() {
+  static auto const s_simple_block_id = EBML_ID(libmatroska::KaxSimpleBlock).GetValue();
+  static auto const s_block_group_id  = EBML_ID(libmatroska::KaxBlockGroup).GetValue();
+
+  if (!m_data_io)
+    return nullptr;
+
+  auto &io = *m_data_io;
+
+  try {
+    while (io.getFilePointer() < io.get_size()) {
+      auto element_position = io.getFilePointer();
+      auto id               = vint_c::read_ebml_id(io);
+      auto size             = vint_c::read(io);
+      auto element_end      = io.getFilePointer() + size.m_value;
+
+      if (!mtx::included_in(id.m_value, s_simple_block_id, s_block_group_id)) {
+        io.setFilePointer(element_end);
+        continue;
+      }
+
+      auto &header           = m_block.header;
+      header                 = block_header_t{};
+      header.position        = element_position;
+      header.size            = element_end - element_position;
+      header.is_simple_block = id.m_value == s_simple_block_id;
+
+      m_block.references.clear();
+      m_block.additions.clear();
+      m_block.frames.clear();
+      m_block.discard_padding.reset();
+      m_block.codec_state.reset();
+
+      // The structure has been verified while loading the cluster.
+      auto ok = header.is_simple_block ? cluster_scanner_c::read_block_header(io, size.m_value, header)
+              :                          parse_block_group(io, element_end, m_block, false);
+
+      io.setFilePointer(element_end);
+
+      if (!ok)
+        continue;
+
+      m_block.frames.reserve(header.frame_sizes.size());
+
+      auto frame_position = header.frames_position;
+      for (auto frame_size : header.frame_sizes) {
+        m_block.frames.emplace_back(slice(frame_position, frame_size));
+        frame_position += frame_size;
+      }
+
+      // Positions in the header are reported relative to the file.
+      header.position        += m_data_start;
+      header.frames_position += m_data_start;
+
+      return &m_block;
+    }
+
+  } catch (mtx::mm_io::exception &ex) {
+    mxdebug_if(s_debug, fmt::format("next: I/O exception in cluster at {0}: {1}\n", m_position, ex.what()));
+  }
+
+  return nullptr;
+}
+
+bool
+block_iterator_c::parse_block_group(mm_io_c &io,
+                                    uint64_t content_end,
+                                    block_t &block,
+                                    bool validate_only) {
+  static auto const s_block_id            = EBML_ID(libmatroska::KaxBlock).GetValue();
+  static auto const s_block_duration_id   = EBML_ID(libmatroska::KaxBlockDuration).GetValue();
+  static auto const s_reference_block_id  = EBML_ID(libmatroska::KaxReferenceBlock).GetValue();
+  static auto const s_codec_state_id      = EBML_ID(libmatroska::KaxCodecState).GetValue();
+  static auto const s_discard_padding_id  = EBML_ID(libmatroska::KaxDiscardPadding).GetValue();
+  static auto const s_block_additions_id  = EBML_ID(libmatroska::KaxBlockAdditions).GetValue();
+
+  auto block_found = false;
+
+  while (io.getFilePointer() < content_end) {
+    auto id   = vint_c::read_ebml_id(io);
+    auto size = vint_c::read(io);
+
+    if (!id.is_valid() || !size.is_valid() || size.is_unknown())
+      return false;
+
+    auto child_start = io.getFilePointer();
+    auto child_end   = child_start + size.m_value;
+    if (child_end > content_end)
+      return false;
+
+    if (id.m_value == s_block_id) {
+      if (!cluster_scanner_c::read_block_header(io, size.m_value, block.header))
+        return false;
+      block_found = true;
+
+    } else if (id.m_value == s_block_duration_id)
+      block.header.duration = read_uint(io, size.m_value);
+
+    else if (id.m_value == s_reference_block_id) {
+      ++block.header.num_references;
+      if (!validate_only)
+        block.references.push_back(read_int(io, size.m_value));
+
+    } else if (id.m_value == s_discard_padding_id)
+      block.discard_padding = read_int(io, size.m_value);
+
+    else if ((id.m_value == s_codec_state_id) && !validate_only)
+      block.codec_state = slice(child_start, size.m_value);
+
+    else if ((id.m_value == s_block_additions_id) && !parse_block_additions(io, child_end, block, validate_only))
+      return false;
+
+    io.setFilePointer(child_end);
+  }
+
+  return block_found;
+}
+
+bool
+block_iterator_c::parse_block_additions(mm_io_c &io,
+                                        uint64_t content_end,
+                                        block_t &block,
+                                        bool validate_only) {
+  static auto const s_block_more_id       = EBML_ID(libmatroska::KaxBlockMore).GetValue();
+  static auto const s_block_add_id_id     = EBML_ID(libmatroska::KaxBlockAddID).GetValue();
+  static auto const s_block_additional_id = EBML_ID(libmatroska::KaxBlockAdditional).GetValue();
+
+  while (io.getFilePointer() < content_end) {
+    auto id   = vint_c::read_ebml_id(io);
+    auto size = vint_c::read(io);
+
+    if (!id.is_valid() || !size.is_valid() || size.is_unknown())
+      return false;
+
+    auto more_end = io.getFilePointer() + size.m_value;
+    if (more_end > content_end)
+      return false;
+
+    if (id.m_value != s_block_more_id) {
+      io.setFilePointer(more_end);
+      continue;
+    }
+
+    auto addition       = block_addition_t{};
+    auto has_additional = false;
+
+    while (io.getFilePointer() < more_end) {
+      auto child_id   = vint_c::read_ebml_id(io);
+      auto child_size = vint_c::read(io);
+
+      if (!child_id.is_valid() || !child_size.is_valid() || child_size.is_unknown())
+        return false;
+
+      auto child_start = io.getFilePointer();
+      auto child_end   = child_start + child_size.m_value;
+      if (child_end > more_end)
+        return false;
+
+      if (child_id.m_value == s_block_add_id_id)
+        addition.id = read_uint(io, child_size.m_value);
+
+      else if (child_id.m_value == s_block_additional_id) {
+        has_additional = true;
+        if (!validate_only)
+          addition.data = slice(child_start, child_size.m_value);
+      }
+
+      io.setFilePointer(child_end);
+    }
+
+    if (has_additional && !validate_only)
+      block.additions.emplace_back(std::move(addition));
+
+    io.setFilePointer(more_end);
+  }
+
+  return true;
+}
+
+}
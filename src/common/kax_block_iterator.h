@@ -0,0 +1,78 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit https://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+
+   pull-based iteration over the blocks of a Matroska cluster
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#pragma once
+
+#include "common/common_pch.h"
+
+#include "common/kax_cluster_scanner.h"
+
+namespace mtx::kax {
+
+struct block_addition_t {
+  uint64_t id{1};
+  memory_cptr data;
+};
+
+struct block_t {
+  block_header_t header;
+  std::vector<int64_t> references;
+  std::optional<int64_t> discard_padding;
+  memory_cptr codec_state;
+  std::vector<block_addition_t> additions;
+  // The frames' payloads. They share the cluster's buffer without
+  // copying it and keep it alive.
+  std::vector<memory_cptr> frames;
+};
+
+// Reads a whole cluster with a single read operation and decodes its
+// blocks directly from that buffer one at a time without creating
+// libebml objects for them. Clusters with an unknown size or an
+// invalid structure are rejected so that the caller can fall back to
+// reading them with libebml.
+class block_iterator_c {
+protected:
+  memory_cptr m_data;
+  std::unique_ptr<mm_io_c> m_data_io;
+  uint64_t m_position{}, m_data_start{}, m_timestamp{};
+  block_t m_block;
+
+public:
+  block_iterator_c() = default;
+
+  // Loads the cluster starting at the current position of in. On
+  // success the position of in is set to the end of the cluster. On
+  // failure it remains unchanged.
+  bool load_cluster(mm_io_c &in, uint64_t end, uint64_t max_size);
+
+  uint64_t get_position() const;
+  uint64_t get_timestamp() const;
+
+  // Returns the next SimpleBlock or BlockGroup of the loaded cluster
+  // or nullptr once all have been returned. The block is only valid
+  // until the next call.
+  block_t const *next();
+
+  // Returns the whole SimpleBlock or BlockGroup element of a block
+  // returned by next() exactly as stored in the file. It shares the
+  // cluster's buffer, too.
+  memory_cptr get_raw_element(block_header_t const &header) const;
+
+protected:
+  bool validate_structure();
+  bool parse_block_group(mm_io_c &io, uint64_t content_end, block_t &block, bool validate_only);
+  bool parse_block_additions(mm_io_c &io, uint64_t content_end, block_t &block, bool validate_only);
+  memory_cptr slice(uint64_t offset, uint64_t size) const;
+};
+
+}
@@ -0,0 +1,339 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit https://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+
+   header-only scanning of Matroska clusters & blocks
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <matroska/KaxBlock.h>
+#include <matroska/KaxCluster.h>
+
+#include "common/ebml.h"
+#include "common/kax_cluster_scanner.h"
+#include "common/kax_file.h"
+#include "common/list_utils.h"
+#include "common/mm_io_x.h"
+#include "common/vint.h"
+
+namespace mtx::kax {
+
+namespace {
+debugging_option_c s_debug{"kax_cluster_scanner"};
+}
+
+lacing_e
+block_header_t::get_lacing()
+  const {
+  auto lacing = (flags >> 1) & 0x03;
+
+  return 0 == lacing ? lacing_e::none
+       : 1 == lacing ? lacing_e::xiph
+       : 2 == lacing ? lacing_e::fixed
+       :               lacing_e::ebml;
+}
+
+bool
+block_header_t::is_key_frame()
+  const {
+  return is_simple_block ? (flags & 0x80) == 0x80 : !num_references;
+}
+
+bool
+block_header_t::is_discardable()
+  const {
+  return is_simple_block && ((flags & 0x01) == 0x01);
+}
+
+uint64_t
+block_header_t::get_payload_size()
+  const {
+  return std::accumulate(frame_sizes.begin(), frame_sizes.end(), 0ull);
+}
+
+// ------------------------------------------------------------
+
+cluster_scanner_c::cluster_scanner_c(mm_io_c &in,
+                                     std::optional<uint64_t> end)
+  : m_in{in}
+  , m_end{end ? std::min<uint64_t>(*end, in.get_size()) : in.get_size()}
+{
+}
+
+bool
+cluster_scanner_c::read_block_header(mm_io_c &in,
+                                     uint64_t content_size,
+                                     block_header_t &header) {
+  auto content_start = in.getFilePointer();
+  auto content_end   = content_start + content_size;
+  auto track_number  = vint_c::read(in);
+
+  if (!track_number.is_valid() || (content_size < static_cast<uint64_t>(track_number.m_coded_size + 3)))
+    return false;
+
+  header.track_number       = track_number.m_value;
+  header.relative_timestamp = static_cast<int16_t>(in.read_uint16_be());
+  header.flags              = in.read_uint8();
+  header.frame_sizes.clear();
+
+  auto lacing = header.get_lacing();
+
+  if (lacing_e::none == lacing) {
+    header.frames_position = in.getFilePointer();
+    header.frame_sizes.push_back(content_end - header.frames_position);
+    return true;
+  }
+
+  auto num_frames = in.read_uint8() + 1u;
+  auto total_size = uint64_t{};
+
+  header.frame_sizes.reserve(num_frames);
+
+  if (lacing_e::xiph == lacing) {
+    for (auto idx = 1u; idx < num_frames; ++idx) {
+      auto frame_size = uint64_t{};
+      auto byte       = uint8_t{};
+
+      do {
+        byte        = in.read_uint8();
+        frame_size += byte;
+      } while (0xff == byte);
+
+      header.frame_sizes.push_back(frame_size);
+      total_size += frame_size;
+    }
+
+  } else if ((lacing_e::ebml == lacing) && (1 < num_frames)) {
+    auto first_size = vint_c::read(in);
+    if (!first_size.is_valid())
+      return false;
+
+    auto frame_size = first_size.m_value;
+    header.frame_sizes.push_back(frame_size);
+    total_size += frame_size;
+
+    for (auto idx = 2u; idx < num_frames; ++idx) {
+      auto difference = vint_c::read(in);
+      if (!difference.is_valid())
+        return false;
+
+      // EBML lacing uses signed values with a range-dependent bias.
+      frame_size += difference.m_value - ((1ll << (7 * difference.m_coded_size - 1)) - 1);
+      if (0 > frame_size)
+        return false;
+
+      header.frame_sizes.push_back(frame_size);
+      total_size += frame_size;
+    }
+  }
+
+  header.frames_position = in.getFilePointer();
+
+  if (header.frames_position > content_end)
+    return false;
+
+  auto remaining = content_end - header.frames_position;
+
+  if (lacing_e::fixed == lacing) {
+    if (remaining % num_frames)
+      return false;
+
+    header.frame_sizes.assign(num_frames, remaining / num_frames);
+    return true;
+  }
+
+  if (total_size > remaining)
+    return false;
+
+  header.frame_sizes.push_back(remaining - total_size);
+
+  return true;
+}
+
+uint64_t
+cluster_scanner_c::read_uint(uint64_t size) {
+  auto value = uint64_t{};
+
+  for (auto idx = 0u; (idx < size) && (idx < 8); ++idx)
+    value = (value << 8) | m_in.read_uint8();
+
+  return value;
+}
+
+bool
+cluster_scanner_c::scan_block_group(uint64_t content_end,
+                                    block_header_t &header) {
+  static auto const s_block_id           = EBML_ID(libmatroska::KaxBlock).GetValue();
+  static auto const s_block_duration_id  = EBML_ID(libmatroska::KaxBlockDuration).GetValue();
+  static auto const s_reference_block_id = EBML_ID(libmatroska::KaxReferenceBlock).GetValue();
+
+  auto block_found = false;
+
+  while (m_in.getFilePointer() < content_end) {
+    auto id   = vint_c::read_ebml_id(m_in);
+    auto size = vint_c::read(m_in);
+
+    if (!id.is_valid() || !size.is_valid() || size.is_unknown())
+      return false;
+
+    auto child_end = m_in.getFilePointer() + size.m_value;
+    if (child_end > content_end)
+      return false;
+
+    if (id.m_value == s_block_id)
+      block_found = read_block_header(m_in, size.m_value, header);
+
+    else if (id.m_value == s_block_duration_id)
+      header.duration = read_uint(size.m_value);
+
+    else if (id.m_value == s_reference_block_id)
+      ++header.num_references;
+
+    m_in.setFilePointer(child_end);
+  }
+
+  return block_found;
+}
+
+std::optional<cluster_t>
+cluster_scanner_c::scan_cluster(uint64_t position) {
+  static auto const s_cluster_id           = EBML_ID(libmatroska::KaxCluster).GetValue();
+  static auto const s_cluster_timestamp_id = EBML_ID(kax_cluster_timestamp_c).GetValue();
+  static auto const s_simple_block_id      = EBML_ID(libmatroska::KaxSimpleBlock).GetValue();
+  static auto const s_block_group_id       = EBML_ID(libmatroska::KaxBlockGroup).GetValue();
+
+  try {
+    m_in.setFilePointer(position);
+
+    auto id   = vint_c::read_ebml_id(m_in);
+    auto size = vint_c::read(m_in);
+
+    if (!id.is_valid() || (id.m_value != s_cluster_id) || !size.is_valid())
+      return {};
+
+    auto unknown_size = size.is_unknown();
+    auto content_end  = unknown_size ? m_end : std::min<uint64_t>(m_end, m_in.getFilePointer() + size.m_value);
+    auto cluster      = cluster_t{};
+    cluster.position  = position;
+    cluster.damaged   = !unknown_size && (content_end < (m_in.getFilePointer() + size.m_value));
+
+    while (m_in.getFilePointer() < content_end) {
+      auto element_position = m_in.getFilePointer();
+      auto element_id       = vint_c::read_ebml_id(m_in);
+      auto element_size     = vint_c::read(m_in);
+
+      if (!element_id.is_valid() || !element_size.is_valid() || element_size.is_unknown()) {
+        m_in.setFilePointer(element_position);
+        cluster.damaged = true;
+        break;
+      }
+
+      // Clusters with an unknown size end where the next level 1
+      // element starts.
+      if (unknown_size && kax_file_c::is_level1_element_id(element_id)) {
+        m_in.setFilePointer(element_position);
+        break;
+      }
+
+      auto element_end = m_in.getFilePointer() + element_size.m_value;
+      if (element_end > content_end) {
+        mxdebug_if(s_debug, fmt::format("scan_cluster: element at {0} with size {1} exceeds the cluster's end {2}\n", element_position, element_size.m_value, content_end));
+        m_in.setFilePointer(element_position);
+        cluster.damaged = true;
+        break;
+      }
+
+      if (element_id.m_value == s_cluster_timestamp_id)
+        cluster.timestamp = read_uint(element_size.m_value);
+
+      else if (mtx::included_in(element_id.m_value, s_simple_block_id, s_block_group_id)) {
+        auto header            = block_header_t{};
+        header.position        = element_position;
+        header.size            = element_end - element_position;
+        header.is_simple_block = element_id.m_value == s_simple_block_id;
+
+        auto ok = header.is_simple_block ? read_block_header(m_in, element_size.m_value, header)
+                :                          scan_block_group(element_end, header);
+
+        if (ok)
+          cluster.blocks.emplace_back(std::move(header));
+
+        else {
+          mxdebug_if(s_debug, fmt::format("scan_cluster: invalid block at {0}\n", element_position));
+          cluster.damaged = true;
+        }
+      }
+
+      m_in.setFilePointer(element_end);
+    }
+
+    cluster.size = m_in.getFilePointer() - position;
+
+    return cluster;
+
+  } catch (mtx::mm_io::exception &ex) {
+    mxdebug_if(s_debug, fmt::format("scan_cluster: I/O exception at cluster {0}: {1}\n", position, ex.what()));
+  }
+
+  return {};
+}
+
+std::vector<uint64_t>
+cluster_scanner_c::find_cluster_positions(uint64_t start) {
+  static auto const s_cluster_id = EBML_ID(libmatroska::KaxCluster).GetValue();
+
+  std::vector<uint64_t> positions;
+
+  try {
+    auto position = start;
+
+    while (position < m_end) {
+      m_in.setFilePointer(position);
+
+      auto id   = vint_c::read_ebml_id(m_in);
+      auto size = vint_c::read(m_in);
+
+      if (!id.is_valid() || !size.is_valid())
+        break;
+
+      if (id.m_value != s_cluster_id) {
+        if (size.is_unknown())
+          break;
+
+        position = m_in.getFilePointer() + size.m_value;
+        continue;
+      }
+
+      positions.push_back(position);
+
+      if (!size.is_unknown()) {
+        position = m_in.getFilePointer() + size.m_value;
+        continue;
+      }
+
+      // The end of a cluster with an unknown size can only be
+      // determined by walking its children.
+      auto cluster = scan_cluster(position);
+      if (!cluster || !cluster->size)
+        break;
+
+      position += cluster->size;
+    }
+
+  } catch (mtx::mm_io::exception &ex) {
+    mxdebug_if(s_debug, fmt::format("find_cluster_positions: I/O exception: {0}\n", ex.what()));
+  }
+
+  mxdebug_if(s_debug, fmt::format("find_cluster_positions: found {0} clusters\n", positions.size()));
+
+  return positions;
+}
+
+}
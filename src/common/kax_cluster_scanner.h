@@ -0,0 +1,88 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit https://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+
+   header-only scanning of Matroska clusters & blocks
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#pragma once
+
+#include "common/common_pch.h"
+
+namespace mtx::kax {
+
+enum class lacing_e {
+  none,
+  xiph,
+  fixed,
+  ebml,
+};
+
+struct block_header_t {
+  // Position & size of the whole element including its EBML ID &
+  // size, either of the SimpleBlock or of the BlockGroup.
+  uint64_t position{}, size{};
+  // Position of the first frame's payload. The payloads of all laced
+  // frames follow each other without gaps.
+  uint64_t frames_position{};
+  uint64_t track_number{};
+  int16_t relative_timestamp{};
+  uint8_t flags{};
+  unsigned int num_references{};
+  bool is_simple_block{};
+  std::optional<uint64_t> duration;
+  std::vector<uint64_t> frame_sizes;
+
+  lacing_e get_lacing() const;
+  bool is_key_frame() const;
+  bool is_discardable() const;
+  uint64_t get_payload_size() const;
+};
+
+struct cluster_t {
+  uint64_t position{}, size{}, timestamp{};
+  std::vector<block_header_t> blocks;
+  // Set if scanning stopped early or skipped blocks due to invalid
+  // elements.
+  bool damaged{};
+};
+
+// Walks clusters by only reading the EBML IDs & sizes of the elements
+// and the headers of blocks including their lacing headers. Block
+// payloads are skipped over. This is much cheaper than reading whole
+// clusters via kax_file_c if only the frames' sizes & timestamps are
+// needed.
+class cluster_scanner_c {
+protected:
+  mm_io_c &m_in;
+  uint64_t m_end;
+
+public:
+  cluster_scanner_c(mm_io_c &in, std::optional<uint64_t> end = std::nullopt);
+
+  // Returns the positions of all clusters between start & the end
+  // of the range by skipping over all level 1 elements.
+  std::vector<uint64_t> find_cluster_positions(uint64_t start);
+
+  // Scans the cluster whose EBML ID starts at position.
+  std::optional<cluster_t> scan_cluster(uint64_t position);
+
+public:
+  // Parses the header of a Block or a SimpleBlock starting at the
+  // current position of in. content_size is the size of the block's
+  // content without its EBML ID & size. On success the file pointer
+  // is positioned at the start of the first frame's payload.
+  static bool read_block_header(mm_io_c &in, uint64_t content_size, block_header_t &header);
+
+protected:
+  bool scan_block_group(uint64_t content_end, block_header_t &header);
+  uint64_t read_uint(uint64_t size);
+};
+
+}
@@ -337,7 +337,8 @@ kax_file_c::set_last_timestamp(int64_t last_timestamp) {
 
 void
 kax_file_c::set_segment_end(libmatroska::KaxSegment const &segment) {
-  m_segment_end = segment.IsFiniteSize() ? segment.GetDataStart() + segment.GetSize() : m_in.get_size();
+  m_segment_size_unknown = !segment.IsFiniteSize();
+  m_segment_end          = segment.IsFiniteSize() ? segment.GetDataStart() + segment.GetSize() : m_in.get_size();
 }
 
 uint64_t
@@ -346,6 +347,21 @@ kax_file_c::get_segment_end()
   return m_segment_end;
 }
 
+/** \brief Stop treating the current end of the file as the end
+
+   Used for files that are still being written to. Neither the end of
+   a segment with an unknown size nor the end of the file are known
+   yet. The underlying I/O reports the end of the file once no more
+   data arrives.
+*/
+void
+kax_file_c::follow_growing_file() {
+  m_file_size = std::numeric_limits<uint64_t>::max();
+
+  if (m_segment_size_unknown)
+    m_segment_end = 0;
+}
+
 void
 kax_file_c::enable_reporting(bool enable) {
   m_reporting_enabled = enable;
@@ -23,7 +23,7 @@
 class kax_file_c {
 protected:
   mm_io_c &m_in;
-  bool m_resynced, m_reporting_enabled{true};
+  bool m_resynced, m_reporting_enabled{true}, m_segment_size_unknown{};
   uint64_t m_resync_start_pos, m_file_size, m_segment_end;
   int64_t m_timestamp_scale, m_last_timestamp;
   std::shared_ptr<libebml::EbmlStream> m_es;
@@ -47,6 +47,7 @@ public:
   virtual void set_last_timestamp(int64_t last_timestamp);
   virtual void set_segment_end(libmatroska::KaxSegment const &segment);
   virtual uint64_t get_segment_end() const;
+  virtual void follow_growing_file();
 
   virtual void enable_reporting(bool enable);
 
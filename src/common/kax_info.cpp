@@ -54,6 +54,7 @@
 #include "common/fourcc.h"
 #include "common/hevc/util.h"
 #include "common/hevc/hevcc.h"
+#include "common/kax_cluster_scanner.h"
 #include "common/kax_element_names.h"
 #include "common/kax_file.h"
 #include "common/kax_info.h"
@@ -68,6 +69,7 @@
 #include "common/stereo_mode.h"
 #include "common/strings/editing.h"
 #include "common/strings/formatting.h"
+#include "common/thread_pool.h"
 #include "common/translation.h"
 #include "common/version.h"
 #include "common/xml/ebml_chapters_converter.h"
@@ -76,6 +78,29 @@
 
 using namespace mtx::kax_info;
 
+namespace {
+
+void
+for_each_frame(libmatroska::KaxCluster &cluster,
+               std::function<void(libmatroska::DataBuffer &)> const &worker) {
+  auto handle_block = [&worker](libmatroska::KaxInternalBlock &block) {
+    for (int idx = 0, num_frames = block.NumberFrames(); idx < num_frames; ++idx)
+      worker(block.GetBuffer(idx));
+  };
+
+  for (auto child : cluster) {
+    if (auto simple_block = dynamic_cast<libmatroska::KaxSimpleBlock *>(child); simple_block)
+      handle_block(*simple_block);
+
+    else if (auto block_group = dynamic_cast<libmatroska::KaxBlockGroup *>(child); block_group)
+      for (auto group_child : *block_group)
+        if (auto block = dynamic_cast<libmatroska::KaxBlock *>(group_child); block)
+          handle_block(*block);
+  }
+}
+
+}
+
 namespace mtx {
 
 kax_info_c::kax_info_c()
@@ -158,6 +183,11 @@ kax_info_c::set_hexdump_max_size(int max_size) {
   p_func()->m_hexdump_max_size = max_size;
 }
 
+void
+kax_info_c::set_num_threads(unsigned int num_threads) {
+  p_func()->m_num_threads = std::max(num_threads, 1u);
+}
+
 void
 kax_info_c::set_destination_file_name(std::string const &file_name) {
   p_func()->m_destination_file_name = file_name;
@@ -359,6 +389,21 @@ kax_info_c::create_hexdump(uint8_t const *buf,
   return hex;
 }
 
+frame_info_t
+kax_info_c::create_frame_info(libmatroska::DataBuffer &data) {
+  auto p = p_func();
+
+  frame_info_t info;
+
+  if (p->m_calc_checksums)
+    info.m_adler = mtx::checksum::calculate_as_uint(mtx::checksum::algorithm_e::adler32, data.Buffer(), data.Size());
+
+  if (p->m_show_hexdump)
+    info.m_hexdump = create_hexdump(data.Buffer(), data.Size());
+
+  return info;
+}
+
 std::string
 kax_info_c::create_codec_dependent_private_info(libmatroska::KaxCodecPrivate &c_priv,
                                                 char track_type,
@@ -915,64 +960,82 @@ kax_info_c::post_block(libebml::EbmlElement &e) {
   for (int i = 0, num_frames = block.NumberFrames(); i < num_frames; ++i)
     frame_pos -= block.GetBuffer(i).Size();
 
+  p->m_frames_start = frame_pos;
+
   for (int i = 0, num_frames = block.NumberFrames(); i < num_frames; ++i) {
     auto &data = block.GetBuffer(i);
-    auto adler = mtx::checksum::calculate_as_uint(mtx::checksum::algorithm_e::adler32, data.Buffer(), data.Size());
+    auto info  = get_frame_info(data);
+    auto &hex  = info.m_hexdump;
 
     std::string adler_str;
-    if (p->m_calc_checksums)
-      adler_str = fmt::format(FY(" (adler: 0x{0:08x})"), adler);
-
-    std::string hex;
-    if (p->m_show_hexdump)
-      hex = create_hexdump(data.Buffer(), data.Size());
+    if (info.m_adler) {
+      adler_str = fmt::format(FY(" (adler: 0x{0:08x})"), *info.m_adler);
+      p->m_frame_adlers.push_back(*info.m_adler);
+    }
 
     auto text = p->m_show_size ? fmt::format(FY("Frame{0}{1}"),                            adler_str, hex)
               :                  fmt::format(FY("Frame with size {0}{1}{2}"), data.Size(), adler_str, hex);
     show_element(nullptr, p->m_level + 1, text, frame_pos, data.Size());
 
     p->m_frame_sizes.push_back(data.Size());
-    p->m_frame_adlers.push_back(adler);
     p->m_frame_hexdumps.push_back(hex);
 
     frame_pos += data.Size();
   }
 }
 
+frame_info_t
+kax_info_c::get_frame_info(libmatroska::DataBuffer &data) {
+  auto p   = p_func();
+  auto itr = p->m_frame_info.find(&data);
+
+  if (itr == p->m_frame_info.end())
+    return create_frame_info(data);
+
+  auto info = std::move(itr->second);
+  p->m_frame_info.erase(itr);
+
+  return info;
+}
+
 void
-kax_info_c::show_frame_summary(libebml::EbmlElement &e) {
+kax_info_c::show_frame_summary(char frame_type) {
   auto p         = p_func();
-  auto frame_pos = e.GetElementPosition() + e.ElementSize();
-
-  for (auto size : p->m_frame_sizes)
-    frame_pos -= size;
+  auto frame_pos = p->m_frames_start;
 
   for (auto fidx = 0u; fidx < p->m_frame_sizes.size(); fidx++) {
-    std::string position;
+    std::string position, adler, hex;
 
     if (p->m_show_positions) {
       position   = fmt::format(p->m_hex_positions ? FY(", position 0x{0:x}") : FY(", position {0}"), frame_pos);
       frame_pos += p->m_frame_sizes[fidx];
     }
 
+    // Checksums & hex dumps are only available if they were requested.
+    if (fidx < p->m_frame_adlers.size())
+      adler = fmt::format(FY(", adler 0x{0:08x}"), p->m_frame_adlers[fidx]);
+
+    if (fidx < p->m_frame_hexdumps.size())
+      hex = p->m_frame_hexdumps[fidx];
+
     if (p->m_block_duration)
-      p->m_out->puts(fmt::format(FY("{0} frame, track {1}, timestamp {2}, duration {3}, size {4}, adler 0x{5:08x}{6}{7}\n"),
-                                 (p->m_num_references >= 2 ? 'B' : p->m_num_references == 1 ? 'P' : 'I'),
+      p->m_out->puts(fmt::format(FY("{0} frame, track {1}, timestamp {2}, duration {3}, size {4}{5}{6}{7}\n"),
+                                 frame_type,
                                  p->m_lf_tnum,
                                  mtx::string::format_timestamp(p->m_lf_timestamp),
                                  mtx::string::format_timestamp(*p->m_block_duration),
                                  p->m_frame_sizes[fidx],
-                                 p->m_frame_adlers[fidx],
-                                 p->m_frame_hexdumps[fidx],
+                                 adler,
+                                 hex,
                                  position));
     else
-      p->m_out->puts(fmt::format(FY("{0} frame, track {1}, timestamp {2}, size {3}, adler 0x{4:08x}{5}{6}\n"),
-                                 (p->m_num_references >= 2 ? 'B' : p->m_num_references == 1 ? 'P' : 'I'),
+      p->m_out->puts(fmt::format(FY("{0} frame, track {1}, timestamp {2}, size {3}{4}{5}{6}\n"),
+                                 frame_type,
                                  p->m_lf_tnum,
                                  mtx::string::format_timestamp(p->m_lf_timestamp),
                                  p->m_frame_sizes[fidx],
-                                 p->m_frame_adlers[fidx],
-                                 p->m_frame_hexdumps[fidx],
+                                 adler,
+                                 hex,
                                  position));
   }
 }
@@ -993,11 +1056,16 @@ kax_info_c::pre_block_group(libebml::EbmlElement &) {
 }
 
 void
-kax_info_c::post_block_group(libebml::EbmlElement &e) {
+kax_info_c::post_block_group(libebml::EbmlElement &) {
+  finish_block_group();
+}
+
+void
+kax_info_c::finish_block_group() {
   auto p = p_func();
 
   if (p->m_show_summary)
-    show_frame_summary(e);
+    show_frame_summary(p->m_num_references >= 2 ? 'B' : p->m_num_references == 1 ? 'P' : 'I');
 
   auto &tinfo = p->m_track_info[p->m_lf_tnum];
 
@@ -1052,67 +1120,109 @@ kax_info_c::format_simple_block(libebml::EbmlElement &e) {
 
 void
 kax_info_c::post_simple_block(libebml::EbmlElement &e) {
-  auto p            = p_func();
+  auto p         = p_func();
 
-  auto &block       = static_cast<libmatroska::KaxSimpleBlock &>(e);
-  auto &tinfo       = p->m_track_info[block.TrackNum()];
-  auto timestamp_ns = mtx::math::to_signed(get_global_timestamp(block));
-  int num_frames    = block.NumberFrames();
-  auto frames_start = block.GetElementPosition() + block.ElementSize();
+  auto &block    = static_cast<libmatroska::KaxSimpleBlock &>(e);
+  int num_frames = block.NumberFrames();
+  auto frame_pos = block.GetElementPosition() + block.ElementSize();
 
   for (int idx = 0; idx < num_frames; ++idx)
-    frames_start -= block.GetBuffer(idx).Size();
+    frame_pos -= block.GetBuffer(idx).Size();
 
-  auto frame_pos = frames_start;
+  p->m_lf_timestamp   = mtx::math::to_signed(get_global_timestamp(block));
+  p->m_lf_tnum        = block.TrackNum();
+  p->m_frames_start   = frame_pos;
+  p->m_block_duration = std::nullopt;
 
   for (int idx = 0; idx < num_frames; ++idx) {
     auto &data = block.GetBuffer(idx);
-    auto adler = mtx::checksum::calculate_as_uint(mtx::checksum::algorithm_e::adler32, data.Buffer(), data.Size());
+    auto info  = get_frame_info(data);
+    auto &hex  = info.m_hexdump;
 
     std::string adler_str;
-    if (p->m_calc_checksums)
-      adler_str = fmt::format(FY(" (adler: 0x{0:08x})"), adler);
-
-    std::string hex;
-    if (p->m_show_hexdump)
-      hex = create_hexdump(data.Buffer(), data.Size());
+    if (info.m_adler) {
+      adler_str = fmt::format(FY(" (adler: 0x{0:08x})"), *info.m_adler);
+      p->m_frame_adlers.push_back(*info.m_adler);
+    }
 
     auto text = p->m_show_size ? fmt::format(FY("Frame{0}{1}"),                            adler_str, hex)
               :                  fmt::format(FY("Frame with size {0}{1}{2}"), data.Size(), adler_str, hex);
     show_element(nullptr, p->m_level + 1, text, frame_pos, data.Size());
 
     p->m_frame_sizes.push_back(data.Size());
-    p->m_frame_adlers.push_back(adler);
 
     frame_pos += data.Size();
   }
 
-  if (p->m_show_summary) {
-    std::string position;
-    frame_pos = frames_start;
+  finish_simple_block(block.IsKeyframe(), block.IsDiscardable());
+}
 
-    for (int idx = 0; idx < num_frames; idx++) {
-      if (p->m_show_positions) {
-        position   = fmt::format(p->m_hex_positions ? FY(", position 0x{0:x}") : FY(", position {0}"), frame_pos);
-        frame_pos += p->m_frame_sizes[idx];
-      }
+void
+kax_info_c::finish_simple_block(bool key_frame,
+                                bool discardable) {
+  auto p = p_func();
 
-      p->m_out->puts(fmt::format(FY("{0} frame, track {1}, timestamp {2}, size {3}, adler 0x{4:08x}{5}\n"),
-                                 (block.IsKeyframe() ? 'I' : block.IsDiscardable() ? 'B' : 'P'),
-                                 block.TrackNum(),
-                                 mtx::string::format_timestamp(timestamp_ns),
-                                 p->m_frame_sizes[idx],
-                                 p->m_frame_adlers[idx],
-                                 position));
-    }
+  if (p->m_show_summary)
+    show_frame_summary(key_frame ? 'I' : discardable ? 'B' : 'P');
+
+  auto &tinfo     = p->m_track_info[p->m_lf_tnum];
+  auto num_frames = static_cast<int64_t>(p->m_frame_sizes.size());
+
+  tinfo.m_blocks                                                 += num_frames;
+  tinfo.m_blocks_by_ref_num[key_frame ? 0 : discardable ? 2 : 1] += num_frames;
+  tinfo.m_min_timestamp                                           = std::min(tinfo.m_min_timestamp ? *tinfo.m_min_timestamp : p->m_lf_timestamp, p->m_lf_timestamp);
+  tinfo.m_max_timestamp                                           = std::max(tinfo.m_max_timestamp ? *tinfo.m_max_timestamp : p->m_lf_timestamp, p->m_lf_timestamp);
+  tinfo.m_add_duration_for_n_packets                              = num_frames;
+  tinfo.m_size                                                   += std::accumulate(p->m_frame_sizes.begin(), p->m_frame_sizes.end(), 0);
+}
+
+/** \brief Summarizes a cluster by reading nothing but element and block headers
+
+   In summary mode the frame contents are only needed for checksums
+   and hex dumps. Without those the payloads of all blocks are skipped
+   instead of being read, which is where nearly all of the time goes
+   for large files.
+
+   Returns \c false if the element at the current position isn't a
+   cluster or if the cluster is damaged. The file position is restored
+   in that case so that the caller can fall back to reading the element
+   with libebml, including its error recovery. Otherwise the file
+   position is at the end of the cluster afterwards.
+*/
+bool
+kax_info_c::summarize_cluster_from_headers(uint64_t segment_end) {
+  auto p       = p_func();
+  auto start   = p->m_in->getFilePointer();
+  auto cluster = mtx::kax::cluster_scanner_c{*p->m_in, segment_end}.scan_cluster(start);
+
+  if (!cluster || cluster->damaged) {
+    p->m_in->setFilePointer(start);
+    return false;
   }
 
-  tinfo.m_blocks                                                                    += block.NumberFrames();
-  tinfo.m_blocks_by_ref_num[block.IsKeyframe() ? 0 : block.IsDiscardable() ? 2 : 1] += block.NumberFrames();
-  tinfo.m_min_timestamp                                                              = std::min(tinfo.m_min_timestamp ? *tinfo.m_min_timestamp : static_cast<int64_t>(timestamp_ns), static_cast<int64_t>(timestamp_ns));
-  tinfo.m_max_timestamp                                                              = std::max(tinfo.m_max_timestamp ? *tinfo.m_max_timestamp : static_cast<int64_t>(timestamp_ns), static_cast<int64_t>(timestamp_ns));
-  tinfo.m_add_duration_for_n_packets                                                 = block.NumberFrames();
-  tinfo.m_size                                                                      += std::accumulate(p->m_frame_sizes.begin(), p->m_frame_sizes.end(), 0);
+  for (auto const &block : cluster->blocks) {
+    p->m_lf_timestamp   = mtx::math::to_signed((cluster->timestamp + block.relative_timestamp) * p->m_ts_scale);
+    p->m_lf_tnum        = block.track_number;
+    p->m_frames_start   = block.frames_position;
+    p->m_num_references = block.num_references;
+    p->m_block_duration = std::nullopt;
+
+    if (block.duration)
+      p->m_block_duration = static_cast<double>(*block.duration) * p->m_ts_scale;
+
+    p->m_frame_sizes.assign(block.frame_sizes.begin(), block.frame_sizes.end());
+    p->m_frame_adlers.clear();
+    p->m_frame_hexdumps.clear();
+
+    if (block.is_simple_block)
+      finish_simple_block(block.is_key_frame(), block.is_discardable());
+    else
+      finish_block_group();
+  }
+
+  p->m_in->setFilePointer(start + cluster->size);
+
+  return true;
 }
 
 kax_info_c::result_e
@@ -1129,18 +1239,66 @@ kax_info_c::handle_segment(libmatroska::KaxSegment &l0) {
   // Prevent reporting "first timestamp after resync":
   kax_file->set_timestamp_scale(-1);
 
-  while ((l1 = kax_file->read_next_level1_element())) {
-    retain_element(l1);
+  auto segment_end   = l0.IsFiniteSize() ? std::min<uint64_t>(l0.GetDataStart() + l0.GetSize(), p->m_file_size) : p->m_file_size;
+  auto skip_payloads = p->m_show_summary && !p->m_calc_checksums && !p->m_show_hexdump && !p->m_use_gui && !p->m_retain_elements;
 
-    if (is_type<libmatroska::KaxCluster>(*l1) && !p->m_continue_at_cluster && !p->m_show_summary) {
-      ui_show_element(*l1);
-      return result_e::succeeded;
+  // With several threads the checksums & hex dumps of the frames are
+  // calculated on worker threads for the clusters read ahead of the
+  // one currently being handled. The elements themselves are still
+  // handled in order on this thread.
+  std::unique_ptr<mtx::thread_pool_c> pool;
+  std::deque<std::pair<std::shared_ptr<libebml::EbmlElement>, std::future<frame_info_map_t>>> pending;
 
-    } else
-      handle_elements_generic(*l1);
+  if (   (p->m_num_threads > 1)
+      && (p->m_calc_checksums      || p->m_show_hexdump)
+      && (p->m_continue_at_cluster || p->m_show_summary))
+    pool = std::make_unique<mtx::thread_pool_c>(p->m_num_threads);
 
-    if (!p->m_in->setFilePointer2(l1->GetElementPosition() + kax_file->get_element_size(*l1)))
-      break;
+  auto handle_next_pending = [this, p, &pending]() {
+    auto [element, frame_info] = std::move(pending.front());
+    pending.pop_front();
+
+    if (frame_info.valid())
+      p->m_frame_info = frame_info.get();
+
+    handle_elements_generic(*element);
+    p->m_frame_info.clear();
+  };
+
+  while (true) {
+    if (!skip_payloads || !summarize_cluster_from_headers(segment_end)) {
+      if (!(l1 = kax_file->read_next_level1_element()))
+        break;
+
+      retain_element(l1);
+
+      if (is_type<libmatroska::KaxCluster>(*l1) && !p->m_continue_at_cluster && !p->m_show_summary) {
+        ui_show_element(*l1);
+        return result_e::succeeded;
+
+      } else if (pool) {
+        std::future<frame_info_map_t> frame_info;
+
+        if (is_type<libmatroska::KaxCluster>(*l1))
+          frame_info = pool->submit([this, l1]() {
+            frame_info_map_t infos;
+            for_each_frame(static_cast<libmatroska::KaxCluster &>(*l1), [this, &infos](libmatroska::DataBuffer &data) {
+              infos.emplace(&data, create_frame_info(data));
+            });
+            return infos;
+          });
+
+        pending.emplace_back(l1, std::move(frame_info));
+
+        if (pending.size() > 2 * p->m_num_threads)
+          handle_next_pending();
+
+      } else
+        handle_elements_generic(*l1);
+
+      if (!p->m_in->setFilePointer2(l1->GetElementPosition() + kax_file->get_element_size(*l1)))
+        break;
+    }
 
     auto in_parent = !l0.IsFiniteSize()
                   || (p->m_in->getFilePointer() < (l0.GetDataStart() + l0.GetSize()));
@@ -1150,7 +1308,14 @@ kax_info_c::handle_segment(libmatroska::KaxSegment &l0) {
     if (p->m_abort)
       return result_e::aborted;
 
-  } // while (l1)
+  } // while (true)
+
+  while (!pending.empty()) {
+    handle_next_pending();
+
+    if (p->m_abort)
+      return result_e::aborted;
+  }
 
   return result_e::succeeded;
 }
@@ -29,6 +29,7 @@ public:
   }
 };
 
+struct frame_info_t;
 struct track_t;
 class private_c;
 
@@ -64,6 +65,7 @@ public:
   void set_show_track_info(bool enable);
   void set_hex_positions(bool enable);
   void set_hexdump_max_size(int max_size);
+  void set_num_threads(unsigned int num_threads);
   void set_destination_file_name(std::string const &file_name);
   void set_source_file(mm_io_cptr const &file);
   void set_source_file_name(std::string const &file_name);
@@ -79,6 +81,7 @@ public:
   std::string create_unknown_element_text(libebml::EbmlElement &e);
   std::string create_known_element_but_not_allowed_here_text(libebml::EbmlElement &e);
   std::string create_hexdump(uint8_t const *buf, int size);
+  kax_info::frame_info_t create_frame_info(libmatroska::DataBuffer &data);
   std::string create_codec_dependent_private_info(libmatroska::KaxCodecPrivate &c_priv, char track_type, std::string const &codec_id);
   std::string create_text_representation(libebml::EbmlElement &e);
   std::string format_binary(libebml::EbmlBinary &bin);
@@ -116,7 +119,10 @@ protected:
   void init_custom_element_value_formatters_and_processors();
 
   void show_element(libebml::EbmlElement *l, int level, std::string const &info, std::optional<int64_t> position = {}, std::optional<int64_t> size = {});
-  void show_frame_summary(libebml::EbmlElement &e);
+  void show_frame_summary(char frame_type);
+  kax_info::frame_info_t get_frame_info(libmatroska::DataBuffer &data);
+  void finish_block_group();
+  void finish_simple_block(bool key_frame, bool discardable);
 
   void add_track(std::shared_ptr<kax_info::track_t> const &t);
   kax_info::track_t *find_track(int tnum);
@@ -126,6 +132,7 @@ protected:
   void handle_block_group(libebml::EbmlElement *&l2, libmatroska::KaxCluster *&cluster);
   void handle_elements_generic(libebml::EbmlElement &e);
   result_e handle_segment(libmatroska::KaxSegment &l0);
+  bool summarize_cluster_from_headers(uint64_t segment_end);
 
   void display_track_info();
 
@@ -25,6 +25,16 @@ struct track_t {
   std::string codec_id, fourcc;
 };
 
+// Results of the CPU-heavy parts of formatting a frame. They're
+// calculated on worker threads ahead of time if several threads are
+// used.
+struct frame_info_t {
+  std::optional<uint32_t> m_adler;
+  std::string m_hexdump;
+};
+
+using frame_info_map_t = std::unordered_map<libmatroska::DataBuffer const *, frame_info_t>;
+
 struct track_info_t {
   int64_t m_size{}, m_blocks{}, m_blocks_by_ref_num[3]{0, 0, 0}, m_add_duration_for_n_packets{};
   std::optional<int64_t> m_min_timestamp, m_max_timestamp;
@@ -49,13 +59,15 @@ public:
   std::vector<int> m_frame_sizes;
   std::vector<uint32_t> m_frame_adlers;
   std::vector<std::string> m_frame_hexdumps;
-  int64_t m_num_references{}, m_lf_timestamp{}, m_lf_tnum{};
+  int64_t m_num_references{}, m_lf_timestamp{}, m_lf_tnum{}, m_frames_start{};
   std::optional<int64_t> m_block_duration;
   std::optional<uint64_t> m_block_add_id_type;
   memory_cptr m_block_add_id_extra_data;
+  frame_info_map_t m_frame_info;
 
   bool m_use_gui{}, m_calc_checksums{}, m_show_summary{}, m_show_hexdump{}, m_show_size{}, m_show_positions{}, m_show_track_info{}, m_hex_positions{}, m_retain_elements{}, m_continue_at_cluster{}, m_show_all_elements{};
   int m_hexdump_max_size{};
+  unsigned int m_num_threads{1};
 
   bool m_abort{};
 
@@ -15,6 +15,7 @@
 
 #include "common/memory.h"
 #include "common/error.h"
+#include "common/profiling.h"
 
 void
 memory_c::resize(size_t new_size)
@@ -33,6 +34,7 @@ memory_c::resize(size_t new_size)
     m_ptr      = tmp;
     m_is_owned = true;
     m_size     = new_size;
+    m_parent.reset();
   }
 }
 
@@ -145,6 +147,8 @@ _safememdup(const void *s,
   if (!s)
     return nullptr;
 
+  mtx::profiling::count_allocation(size);
+
   auto copy = reinterpret_cast<uint8_t *>(malloc(size));
   if (!copy)
     mxerror(fmt::format(FY("memory.cpp/safememdup() called from file {0}, line {1}: malloc() returned nullptr for a size of {2} bytes.\n"), file, line, size));
@@ -157,6 +161,8 @@ uint8_t *
 _safemalloc(size_t size,
             const char *file,
             int line) {
+  mtx::profiling::count_allocation(size);
+
   auto mem = reinterpret_cast<uint8_t *>(malloc(size));
   if (!mem)
     mxerror(fmt::format(FY("memory.cpp/safemalloc() called from file {0}, line {1}: malloc() returned nullptr for a size of {2} bytes.\n"), file, line, size));
@@ -173,6 +179,8 @@ _saferealloc(void *mem,
     // Do this so realloc() may not return nullptr on success.
     size = 1;
 
+  mtx::profiling::count_allocation(size);
+
   mem = realloc(mem, size);
   if (!mem)
     mxerror(fmt::format(FY("memory.cpp/saferealloc() called from file {0}, line {1}: realloc() returned nullptr for a size of {2} bytes.\n"), file, line, size));
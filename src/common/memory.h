@@ -86,6 +86,7 @@ private:
   uint8_t *m_ptr{};
   std::size_t m_size{}, m_offset{};
   bool m_is_owned{};
+  memory_cptr m_parent;         // keeps the storage of shared slices alive
 
   explicit memory_c(void *ptr,
                     std::size_t size,
@@ -137,8 +138,13 @@ public:
     return m_is_owned;
   }
 
+  bool is_shared() const {
+    return !!m_parent;
+  }
+
   void take_ownership() {
-    if (m_is_owned)
+    // Shared slices keep their storage alive on their own.
+    if (m_is_owned || m_parent)
       return;
 
     m_ptr       = static_cast<uint8_t *>(safememdup(get_buffer(), get_size()));
@@ -198,6 +204,18 @@ public:
     return borrow(&buffer[0], buffer.length());
   }
 
+  // Returns a view on a part of another buffer without copying
+  // it. The view keeps the other buffer alive for as long as it
+  // exists itself.
+  static inline memory_cptr
+  share(memory_cptr const &parent,
+        std::size_t offset,
+        std::size_t length) {
+    auto slice      = memory_cptr{ new memory_c(parent->get_buffer() + offset, length, false) };
+    slice->m_parent = parent;
+    return slice;
+  }
+
   static memory_cptr
   alloc(std::size_t size) {
     return take_ownership(safemalloc(size), size);
@@ -15,10 +15,25 @@
 
 #include "common/common_pch.h"
 
+#include <chrono>
+
 #include <ebml/StdIOCallback.h>
 
 class mm_file_io_private_c;
 class mm_file_io_c: public mm_io_c {
+public:
+  // Direct I/O requires file positions, transfer sizes & memory
+  // addresses to be multiples of the storage's block size. This value
+  // is a multiple of all commonly used block sizes.
+  static constexpr std::size_t direct_io_alignment = 4096;
+
+  struct direct_io_statistics_t {
+    uint64_t num_files{}, num_fallbacks{};
+    uint64_t bytes_read_directly{}, bytes_read_buffered{};
+    uint64_t bytes_written_directly{}, bytes_written_buffered{};
+    std::chrono::nanoseconds duration{};
+  };
+
 protected:
   MTX_DECLARE_PRIVATE(mm_file_io_private_c)
 
@@ -37,6 +52,11 @@ public:
   virtual bool eof() override;
   virtual void clear_eof() override;
   virtual int truncate(int64_t pos) override;
+  virtual bool preallocate(int64_t size) override;
+  virtual void advise_sequential_access() override;
+  virtual void sync() override;
+  virtual size_t writev(chunks_t const &chunks) override;
+  virtual bool can_write_vectored() override;
 
   virtual std::string get_file_name() const override;
 
@@ -47,6 +67,8 @@ public:
   static mm_io_cptr open(const std::string &path, const libebml::open_mode mode = libebml::MODE_READ);
 
   static void enable_flushing_on_close(bool enable);
+  static void enable_direct_io(bool for_reading, bool for_writing);
+  static direct_io_statistics_t get_direct_io_statistics();
 
 protected:
   virtual uint32_t _read(void *buffer, size_t size) override;
@@ -18,7 +18,29 @@
 #include "common/mm_file_io_p.h"
 #include "common/path.h"
 
-bool mm_file_io_private_c::ms_flush_on_close = false;
+bool mm_file_io_private_c::ms_flush_on_close        = false;
+bool mm_file_io_private_c::ms_direct_io_for_reading = false;
+bool mm_file_io_private_c::ms_direct_io_for_writing = false;
+std::mutex mm_file_io_private_c::ms_statistics_mutex;
+mm_file_io_c::direct_io_statistics_t mm_file_io_private_c::ms_statistics;
+
+bool
+mm_file_io_private_c::wants_direct_io(libebml::open_mode mode) {
+  return libebml::MODE_READ == mode ? ms_direct_io_for_reading : ms_direct_io_for_writing;
+}
+
+void
+mm_file_io_private_c::add_statistics(mm_file_io_c::direct_io_statistics_t const &statistics) {
+  std::lock_guard<std::mutex> lock{ms_statistics_mutex};
+
+  ms_statistics.num_files              += statistics.num_files;
+  ms_statistics.num_fallbacks          += statistics.num_fallbacks;
+  ms_statistics.bytes_read_directly    += statistics.bytes_read_directly;
+  ms_statistics.bytes_read_buffered    += statistics.bytes_read_buffered;
+  ms_statistics.bytes_written_directly += statistics.bytes_written_directly;
+  ms_statistics.bytes_written_buffered += statistics.bytes_written_buffered;
+  ms_statistics.duration               += statistics.duration;
+}
 
 mm_file_io_c::mm_file_io_c(std::string const &path,
                            libebml::open_mode const mode)
@@ -94,3 +116,17 @@ void
 mm_file_io_c::enable_flushing_on_close(bool enable) {
   mm_file_io_private_c::ms_flush_on_close = enable;
 }
+
+void
+mm_file_io_c::enable_direct_io(bool for_reading,
+                               bool for_writing) {
+  mm_file_io_private_c::ms_direct_io_for_reading = for_reading;
+  mm_file_io_private_c::ms_direct_io_for_writing = for_writing;
+}
+
+mm_file_io_c::direct_io_statistics_t
+mm_file_io_c::get_direct_io_statistics() {
+  std::lock_guard<std::mutex> lock{mm_file_io_private_c::ms_statistics_mutex};
+
+  return mm_file_io_private_c::ms_statistics;
+}
@@ -13,13 +13,17 @@
 
 #include "common/common_pch.h"
 
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
 #endif
+#include <fcntl.h>
+#include <limits.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 
 #include "common/mm_io_x.h"
 #include "common/mm_file_io.h"
@@ -28,6 +32,15 @@
 # include "common/fs_sys_helpers.h"
 #endif
 
+namespace {
+debugging_option_c s_debug_direct_io{"direct_io"};
+
+// Ranges smaller than this are transferred via the page cache. This
+// keeps small reads such as the ones done while probing cheap.
+std::size_t constexpr s_min_direct_io_size = 64 * 1024;
+std::size_t constexpr s_bounce_buffer_size = 1024 * 1024;
+}
+
 mm_file_io_private_c::mm_file_io_private_c(std::string const &p_file_name,
                                            libebml::open_mode const p_mode)
   : file_name{p_file_name}
@@ -78,12 +91,207 @@ mm_file_io_private_c::mm_file_io_private_c(std::string const &p_file_name,
 
   if (!file)
     throw mtx::mm_io::open_x{mtx::mm_io::make_error_code()};
+
+  if (wants_direct_io(mode))
+    open_direct(local_path);
+}
+
+void
+mm_file_io_private_c::open_direct([[maybe_unused]] std::string const &local_path) {
+  direct_io            = true;
+  direct_io_requested  = true;
+  statistics.num_files = 1;
+
+#if defined(O_DIRECT)
+  direct_fd = ::open(local_path.c_str(), (libebml::MODE_READ == mode ? O_RDONLY : O_RDWR) | O_DIRECT);
+#endif
+
+  if (-1 != direct_fd)
+    return;
+
+  // Some file systems such as tmpfs refuse O_DIRECT. Fall back to
+  // regular I/O in that case.
+  mxdebug_if(s_debug_direct_io, fmt::format("{0}: direct I/O not supported, falling back to buffered I/O (errno {1})\n", file_name, errno));
+
+  direct_io                = false;
+  statistics.num_fallbacks = 1;
+}
+
+void
+mm_file_io_private_c::close_direct() {
+  if (!direct_io_requested)
+    return;
+
+  if (-1 != direct_fd) {
+    ::close(direct_fd);
+    direct_fd = -1;
+  }
+
+  if (s_debug_direct_io) {
+    auto seconds = std::chrono::duration<double>(statistics.duration).count();
+    auto total   = statistics.bytes_read_directly + statistics.bytes_read_buffered + statistics.bytes_written_directly + statistics.bytes_written_buffered;
+
+    mxdebug(fmt::format("{0}: read directly {1} buffered {2}; written directly {3} buffered {4}; {5:.1f} MiB/s\n",
+                        file_name,
+                        statistics.bytes_read_directly,    statistics.bytes_read_buffered,
+                        statistics.bytes_written_directly, statistics.bytes_written_buffered,
+                        seconds > 0 ? total / seconds / 1024 / 1024 : 0.0));
+  }
+
+  add_statistics(statistics);
+
+  statistics          = mm_file_io_c::direct_io_statistics_t{};
+  direct_io           = false;
+  direct_io_requested = false;
+}
+
+std::size_t
+mm_file_io_private_c::buffered_transfer(uint8_t *buffer,
+                                        std::size_t size,
+                                        int64_t position,
+                                        bool writing) {
+  auto fd    = fileno(file);
+  auto total = std::size_t{};
+
+  while (total < size) {
+    auto result = writing ? ::pwrite(fd, buffer + total, size - total, position + total)
+                :           ::pread( fd, buffer + total, size - total, position + total);
+
+    if ((-1 == result) && (EINTR == errno))
+      continue;
+
+    if (-1 == result) {
+      if (writing)
+        throw mtx::mm_io::read_write_x{mtx::mm_io::make_error_code()};
+      break;
+    }
+
+    if (!result)
+      break;
+
+    total += result;
+  }
+
+  (writing ? statistics.bytes_written_buffered : statistics.bytes_read_buffered) += total;
+
+  return total;
+}
+
+std::size_t
+mm_file_io_private_c::aligned_transfer(uint8_t *buffer,
+                                       std::size_t size,
+                                       int64_t position,
+                                       bool writing) {
+  auto total = std::size_t{};
+
+  while ((total < size) && (-1 != direct_fd)) {
+    // O_DIRECT requires aligned memory. Use the caller's buffer if it
+    // happens to be aligned, and copy via a bounce buffer otherwise.
+    auto use_bounce_buffer = (reinterpret_cast<uintptr_t>(buffer + total) % mm_file_io_c::direct_io_alignment) != 0;
+    auto chunk_size        = use_bounce_buffer ? std::min(size - total, s_bounce_buffer_size) : size - total;
+    auto chunk             = buffer + total;
+
+    if (use_bounce_buffer) {
+      if (!bounce_buffer)
+        bounce_buffer = memory_c::alloc(s_bounce_buffer_size + mm_file_io_c::direct_io_alignment);
+
+      auto address = reinterpret_cast<uintptr_t>(bounce_buffer->get_buffer());
+      chunk        = reinterpret_cast<uint8_t *>((address + mm_file_io_c::direct_io_alignment - 1) & ~static_cast<uintptr_t>(mm_file_io_c::direct_io_alignment - 1));
+
+      if (writing)
+        std::memcpy(chunk, buffer + total, chunk_size);
+    }
+
+    auto result = writing ? ::pwrite(direct_fd, chunk, chunk_size, position + total)
+                :           ::pread( direct_fd, chunk, chunk_size, position + total);
+
+    if ((-1 == result) && (EINTR == errno))
+      continue;
+
+    if (-1 == result) {
+      // The file system accepted O_DIRECT on open() but refuses the
+      // transfer. Continue with buffered I/O for the rest of the file.
+      mxdebug_if(s_debug_direct_io, fmt::format("{0}: direct {1} at {2} failed (errno {3}), falling back to buffered I/O\n", file_name, writing ? "write" : "read", position + total, errno));
+
+      ::close(direct_fd);
+      direct_fd                = -1;
+      statistics.num_fallbacks = 1;
+      break;
+    }
+
+    if (!writing && use_bounce_buffer)
+      std::memcpy(buffer + total, chunk, result);
+
+    (writing ? statistics.bytes_written_directly : statistics.bytes_read_directly) += result;
+    total                                                                         += result;
+
+    // Short transfers only happen at the end of the file.
+    if (static_cast<std::size_t>(result) != chunk_size)
+      return total;
+  }
+
+  if (total < size)
+    total += buffered_transfer(buffer + total, size - total, position + total, writing);
+
+  return total;
+}
+
+std::size_t
+mm_file_io_private_c::direct_transfer(uint8_t *buffer,
+                                      std::size_t size,
+                                      bool writing) {
+  auto start         = std::chrono::steady_clock::now();
+  auto alignment     = static_cast<int64_t>(mm_file_io_c::direct_io_alignment);
+  auto position      = current_position;
+  auto aligned_start = (position + alignment - 1) / alignment * alignment;
+  auto aligned_end   = (position + static_cast<int64_t>(size)) / alignment * alignment;
+  auto total         = std::size_t{};
+
+  // Only the aligned middle part of the range is transferred
+  // directly. The unaligned head & tail are small and go through the
+  // page cache.
+  if ((-1 == direct_fd) || ((aligned_end - aligned_start) < static_cast<int64_t>(s_min_direct_io_size)))
+    total = buffered_transfer(buffer, size, position, writing);
+
+  else {
+    auto head   = static_cast<std::size_t>(aligned_start - position);
+    auto middle = static_cast<std::size_t>(aligned_end   - aligned_start);
+
+    total = buffered_transfer(buffer, head, position, writing);
+
+    if (total == head)
+      total += aligned_transfer(buffer + head, middle, aligned_start, writing);
+
+    if (total == (head + middle))
+      total += buffered_transfer(buffer + total, size - total, aligned_end, writing);
+  }
+
+  current_position    += total;
+  statistics.duration += std::chrono::steady_clock::now() - start;
+
+  return total;
 }
 
 void
 mm_file_io_c::setFilePointer(int64_t offset,
                              libebml::seek_mode mode) {
   auto p     = p_func();
+
+  if (p->direct_io) {
+    struct stat st;
+    auto new_position = mode == libebml::seek_beginning ? offset
+                      : mode == libebml::seek_end       ? (0 == fstat(fileno(p->file), &st) ? st.st_size : -1) + offset
+                      :                                   p->current_position + offset;
+
+    if (0 > new_position)
+      throw mtx::mm_io::seek_x{mtx::mm_io::make_error_code()};
+
+    p->current_position = new_position;
+    p->direct_eof       = false;
+
+    return;
+  }
+
   int whence = mode == libebml::seek_beginning ? SEEK_SET
              : mode == libebml::seek_end       ? SEEK_END
              :                                   SEEK_CUR;
@@ -98,6 +306,12 @@ size_t
 mm_file_io_c::_write(const void *buffer,
                      size_t size) {
   auto p          = p_func();
+
+  if (p->direct_io) {
+    p->cached_size = -1;
+    return p->direct_transfer(static_cast<uint8_t *>(const_cast<void *>(buffer)), size, true);
+  }
+
   size_t bwritten = fwrite(buffer, 1, size, p->file);
   if (ferror(p->file) != 0)
     throw mtx::mm_io::read_write_x{mtx::mm_io::make_error_code()};
@@ -105,6 +319,9 @@ mm_file_io_c::_write(const void *buffer,
   p->current_position += bwritten;
   p->cached_size       = -1;
 
+  if (p->direct_io_requested)
+    p->statistics.bytes_written_buffered += bwritten;
+
   return bwritten;
 }
 
@@ -112,10 +329,21 @@ uint32_t
 mm_file_io_c::_read(void *buffer,
                     size_t size) {
   auto p        = p_func();
+
+  if (p->direct_io) {
+    auto num_read = p->direct_transfer(static_cast<uint8_t *>(buffer), size, false);
+    p->direct_eof = num_read < size;
+
+    return num_read;
+  }
+
   int64_t bread = fread(buffer, 1, size, p->file);
 
   p->current_position += bread;
 
+  if (p->direct_io_requested)
+    p->statistics.bytes_read_buffered += bread;
+
   return bread;
 }
 
@@ -124,6 +352,8 @@ mm_file_io_c::close() {
   auto p = p_func();
 
   if (p->file) {
+    p->close_direct();
+
     if (mm_file_io_private_c::ms_flush_on_close && (p->mode != libebml::MODE_READ))
       fflush(p->file);
 
@@ -136,12 +366,17 @@ mm_file_io_c::close() {
 
 bool
 mm_file_io_c::eof() {
-  return feof(p_func()->file) != 0;
+  auto p = p_func();
+
+  return p->direct_io ? p->direct_eof : feof(p->file) != 0;
 }
 
 void
 mm_file_io_c::clear_eof() {
-  clearerr(p_func()->file);
+  auto p        = p_func();
+  p->direct_eof = false;
+
+  clearerr(p->file);
 }
 
 int
@@ -150,3 +385,113 @@ mm_file_io_c::truncate(int64_t pos) {
   p->cached_size = -1;
   return ftruncate(fileno(p->file), pos);
 }
+
+bool
+mm_file_io_c::preallocate([[maybe_unused]] int64_t size) {
+#if defined(HAVE_FALLOCATE) && defined(FALLOC_FL_KEEP_SIZE)
+  // posix_fallocate() cannot be used as it changes the file's size,
+  // and the writers rely on the size reflecting what has actually
+  // been written.
+  auto p = p_func();
+
+  fflush(p->file);
+
+  return 0 == fallocate(fileno(p->file), FALLOC_FL_KEEP_SIZE, 0, size);
+
+#else
+  return false;
+#endif
+}
+
+void
+mm_file_io_c::advise_sequential_access() {
+#if defined(HAVE_POSIX_FADVISE)
+  posix_fadvise(fileno(p_func()->file), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+}
+
+void
+mm_file_io_c::sync() {
+  auto p = p_func();
+
+  fflush(p->file);
+
+  if (fsync(fileno(p->file)) != 0)
+    throw mtx::mm_io::read_write_x{mtx::mm_io::make_error_code()};
+}
+
+/** \brief Writes several buffers with a single system call
+
+   The data buffered by stdio is flushed first, and stdio's position is
+   synchronized afterwards so that regular writes can continue where
+   the vectored write ended. With direct I/O the chunks are written one
+   after the other as the chunks' addresses & sizes usually don't meet
+   its alignment requirements.
+*/
+size_t
+mm_file_io_c::writev(chunks_t const &chunks) {
+  auto p = p_func();
+
+  if (p->direct_io)
+    return mm_io_c::writev(chunks);
+
+  std::vector<iovec> vectors;
+  vectors.reserve(chunks.size());
+
+  for (auto const &chunk : chunks)
+    if (chunk.second)
+      vectors.push_back(iovec{ const_cast<void *>(chunk.first), chunk.second });
+
+  auto fd = fileno(p->file);
+
+  if ((fflush(p->file) != 0) || (::lseek(fd, p->current_position, SEEK_SET) == -1))
+    throw mtx::mm_io::read_write_x{mtx::mm_io::make_error_code()};
+
+  auto total = std::size_t{};
+  auto idx   = std::size_t{};
+
+  while (idx < vectors.size()) {
+    auto result = ::writev(fd, &vectors[idx], std::min<std::size_t>(vectors.size() - idx, IOV_MAX));
+
+    if ((-1 == result) && (EINTR == errno))
+      continue;
+
+    if (-1 == result)
+      throw mtx::mm_io::read_write_x{mtx::mm_io::make_error_code()};
+
+    if (!result)
+      break;
+
+    total += result;
+
+    // Skip over what has been written, including partially written
+    // chunks.
+    auto remaining = static_cast<std::size_t>(result);
+
+    while ((idx < vectors.size()) && (remaining >= vectors[idx].iov_len)) {
+      remaining -= vectors[idx].iov_len;
+      ++idx;
+    }
+
+    if (remaining) {
+      vectors[idx].iov_base  = static_cast<uint8_t *>(vectors[idx].iov_base) + remaining;
+      vectors[idx].iov_len  -= remaining;
+    }
+  }
+
+  p->current_position += total;
+  p->cached_size       = -1;
+
+  if (p->direct_io_requested)
+    p->statistics.bytes_written_buffered += total;
+
+  if (fseeko(p->file, p->current_position, SEEK_SET) != 0)
+    throw mtx::mm_io::seek_x{mtx::mm_io::make_error_code()};
+
+  return total;
+}
+
+bool
+mm_file_io_c::can_write_vectored() {
+  return !p_func()->direct_io;
+}
@@ -193,3 +193,32 @@ mm_file_io_c::truncate(int64_t pos) {
 
   return -1;
 }
+
+bool
+mm_file_io_c::preallocate(int64_t size) {
+  // Setting the allocation size doesn't change the end of the file.
+  FILE_ALLOCATION_INFO info{};
+  info.AllocationSize.QuadPart = size;
+
+  return !!SetFileInformationByHandle(p_func()->file, FileAllocationInfo, &info, sizeof(info));
+}
+
+void
+mm_file_io_c::advise_sequential_access() {
+}
+
+void
+mm_file_io_c::sync() {
+  if (!FlushFileBuffers(p_func()->file))
+    throw mtx::mm_io::read_write_x{mtx::mm_io::make_error_code()};
+}
+
+size_t
+mm_file_io_c::writev(chunks_t const &chunks) {
+  return mm_io_c::writev(chunks);
+}
+
+bool
+mm_file_io_c::can_write_vectored() {
+  return false;
+}
@@ -17,6 +17,9 @@
 # include <windows.h>
 #endif
 
+#include <mutex>
+
+#include "common/mm_file_io.h"
 #include "common/mm_io_p.h"
 
 class mm_file_io_c;
@@ -31,10 +34,33 @@ public:
   HANDLE file{};
 #else
   FILE *file{};
+
+  // In direct I/O mode all transfers are done with pread()/pwrite()
+  // instead of via stdio. Aligned ranges use direct_fd, everything
+  // else the regular descriptor. direct_io_requested stays set if
+  // opening with O_DIRECT failed so that the statistics still cover
+  // the file.
+  bool direct_io{}, direct_io_requested{}, direct_eof{};
+  int direct_fd{-1};
+  memory_cptr bounce_buffer;
+  mm_file_io_c::direct_io_statistics_t statistics;
 #endif
 
   explicit mm_file_io_private_c(std::string const &p_file_name, libebml::open_mode const p_mode);
 
+#if !defined(SYS_WINDOWS)
+  void open_direct(std::string const &local_path);
+  void close_direct();
+  std::size_t direct_transfer(uint8_t *buffer, std::size_t size, bool writing);
+  std::size_t buffered_transfer(uint8_t *buffer, std::size_t size, int64_t position, bool writing);
+  std::size_t aligned_transfer(uint8_t *buffer, std::size_t size, int64_t position, bool writing);
+#endif
+
 public:
-  static bool ms_flush_on_close;
+  static bool ms_flush_on_close, ms_direct_io_for_reading, ms_direct_io_for_writing;
+  static std::mutex ms_statistics_mutex;
+  static mm_file_io_c::direct_io_statistics_t ms_statistics;
+
+  static bool wants_direct_io(libebml::open_mode mode);
+  static void add_statistics(mm_file_io_c::direct_io_statistics_t const &statistics);
 };
@@ -0,0 +1,171 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit https://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+
+   IO callback class implementation
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <chrono>
+#include <thread>
+
+#if defined(HAVE_SYS_INOTIFY_H)
+# include <poll.h>
+# include <sys/inotify.h>
+# include <unistd.h>
+#endif
+
+#include "common/locale.h"
+#include "common/mm_follow_io.h"
+
+namespace {
+
+debugging_option_c s_debug{"follow_io"};
+
+// Without inotify the file's size is polled instead. With it the wait
+// is still interrupted regularly in case a notification is missed,
+// e.g. on network file systems.
+auto const s_poll_interval  = std::chrono::milliseconds{100};
+auto const s_max_watch_wait = std::chrono::milliseconds{1000};
+
+}
+
+mm_follow_io_c::mm_follow_io_c(mm_io_cptr const &proxy_io,
+                               std::chrono::milliseconds idle_timeout)
+  : mm_proxy_io_c{proxy_io}
+  , m_idle_timeout{idle_timeout}
+{
+}
+
+mm_follow_io_c::~mm_follow_io_c() {
+  close_watch();
+}
+
+void
+mm_follow_io_c::enable_following() {
+  if (m_following)
+    return;
+
+  m_following = true;
+
+#if defined(HAVE_SYS_INOTIFY_H)
+  m_inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+  if (   (-1 != m_inotify_fd)
+      && (-1 == inotify_add_watch(m_inotify_fd, g_cc_local_utf8->native(get_file_name()).c_str(), IN_MODIFY | IN_CLOSE_WRITE)))
+    close_watch();
+#endif
+
+  mxdebug_if(s_debug, fmt::format("follow_io: following {0} with an idle timeout of {1} ms; using inotify: {2}\n", get_file_name(), m_idle_timeout.count(), -1 != m_inotify_fd));
+}
+
+bool
+mm_follow_io_c::is_following()
+  const {
+  return m_following;
+}
+
+void
+mm_follow_io_c::close() {
+  close_watch();
+  mm_proxy_io_c::close();
+}
+
+void
+mm_follow_io_c::close_watch() {
+#if defined(HAVE_SYS_INOTIFY_H)
+  if (-1 != m_inotify_fd)
+    ::close(m_inotify_fd);
+#endif
+
+  m_inotify_fd = -1;
+}
+
+int64_t
+mm_follow_io_c::get_size() {
+  return m_following ? get_current_size() : mm_proxy_io_c::get_size();
+}
+
+int64_t
+mm_follow_io_c::get_current_size() {
+  auto proxy    = get_proxied();
+  auto position = proxy->getFilePointer();
+
+  proxy->setFilePointer(0, libebml::seek_end);
+  auto size = proxy->getFilePointer();
+  proxy->setFilePointer(position);
+
+  return size;
+}
+
+uint32_t
+mm_follow_io_c::_read(void *buffer,
+                      size_t size) {
+  auto num_read = mm_proxy_io_c::_read(buffer, size);
+
+  while (m_following && (num_read < size) && wait_for_growth(getFilePointer())) {
+    get_proxied()->clear_eof();
+    num_read += mm_proxy_io_c::_read(static_cast<uint8_t *>(buffer) + num_read, size - num_read);
+  }
+
+  return num_read;
+}
+
+bool
+mm_follow_io_c::wait_for_size(int64_t size) {
+  auto current_size = get_current_size();
+
+  while (m_following && (current_size < size)) {
+    if (!wait_for_growth(current_size))
+      return false;
+
+    current_size = get_current_size();
+  }
+
+  return current_size >= size;
+}
+
+bool
+mm_follow_io_c::wait_for_growth(int64_t known_size) {
+  auto deadline = std::chrono::steady_clock::now() + m_idle_timeout;
+
+  while (true) {
+    if (get_current_size() > known_size)
+      return true;
+
+    auto now = std::chrono::steady_clock::now();
+    if (now >= deadline) {
+      mxdebug_if(s_debug, fmt::format("follow_io: {0} hasn't grown beyond {1} within the idle timeout\n", get_file_name(), known_size));
+      return false;
+    }
+
+    wait_for_change(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now));
+  }
+}
+
+void
+mm_follow_io_c::wait_for_change(std::chrono::milliseconds timeout) {
+#if defined(HAVE_SYS_INOTIFY_H)
+  if (-1 != m_inotify_fd) {
+    pollfd watch{m_inotify_fd, POLLIN, 0};
+
+    if (0 < poll(&watch, 1, static_cast<int>(std::min(timeout, s_max_watch_wait).count()))) {
+      // Only the fact that something has changed is relevant.
+      char events[4096];
+      while (0 < ::read(m_inotify_fd, events, sizeof(events)))
+        ;
+    }
+
+    return;
+  }
+#endif
+
+  std::this_thread::sleep_for(std::min(timeout, s_poll_interval));
+}
@@ -0,0 +1,59 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit https://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+
+   IO callback class definitions
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#pragma once
+
+#include "common/common_pch.h"
+
+#include <chrono>
+
+#include "common/mm_proxy_io.h"
+
+/* Reads from a file that is still being written to, e.g. a recording
+   that is still in progress. Once following has been enabled, reads
+   hitting the end of the file wait until more data has been appended
+   instead of returning less data than requested. The end of the file
+   is only reported if the file hasn't grown for the idle timeout.
+*/
+class mm_follow_io_c: public mm_proxy_io_c {
+protected:
+  std::chrono::milliseconds m_idle_timeout;
+  bool m_following{};
+  int m_inotify_fd{-1};
+
+public:
+  mm_follow_io_c(mm_io_cptr const &proxy_io, std::chrono::milliseconds idle_timeout);
+  virtual ~mm_follow_io_c();
+
+  // Until this is called the end of the file is reported right away,
+  // e.g. while probing the file type and reading the headers.
+  void enable_following();
+  bool is_following() const;
+
+  // Waits until the file has reached the given size. Returns false if
+  // it hasn't grown for the idle timeout before that.
+  bool wait_for_size(int64_t size);
+
+  // Returns the file's current size instead of the one determined
+  // when the file was opened.
+  virtual int64_t get_size() override;
+  virtual void close() override;
+
+protected:
+  virtual uint32_t _read(void *buffer, size_t size) override;
+
+  int64_t get_current_size();
+  bool wait_for_growth(int64_t known_size);
+  void wait_for_change(std::chrono::milliseconds timeout);
+  void close_watch();
+};
@@ -140,6 +140,11 @@ mm_io_c::read(size_t size) {
   return buffer;
 }
 
+memory_cptr
+mm_io_c::read_shared(size_t size) {
+  return read(size);
+}
+
 MTX_EBML_IOCALLBACK_READ_RETURN_TYPE
 mm_io_c::read(void *buffer,
               size_t size) {
@@ -385,6 +390,21 @@ mm_io_c::write(const memory_cptr &buffer,
   return size;
 }
 
+size_t
+mm_io_c::writev(chunks_t const &chunks) {
+  auto total = std::size_t{};
+
+  for (auto const &chunk : chunks) {
+    auto num_written  = write(chunk.first, chunk.second);
+    total            += num_written;
+
+    if (num_written != chunk.second)
+      break;
+  }
+
+  return total;
+}
+
 void
 mm_io_c::skip(int64_t num_bytes) {
   uint64_t pos = getFilePointer();
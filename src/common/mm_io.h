@@ -31,6 +31,9 @@ protected:
   explicit mm_io_c(mm_io_private_c &p);
 
 public:
+  // Buffers to be written one after the other: address & size.
+  using chunks_t = std::vector<std::pair<void const *, std::size_t>>;
+
   mm_io_c();
   virtual ~mm_io_c();
 
@@ -38,6 +41,11 @@ public:
   virtual void setFilePointer(int64_t offset, libebml::seek_mode mode = libebml::seek_beginning) override = 0;
   virtual bool setFilePointer2(int64_t offset, libebml::seek_mode mode = libebml::seek_beginning);
   virtual memory_cptr read(size_t size);
+  // Like read(size), but the returned buffer may share its storage
+  // with the object's internal buffer instead of being a copy. The
+  // storage is kept alive by the returned buffer and never reused for
+  // other data while it exists.
+  virtual memory_cptr read_shared(size_t size);
   virtual MTX_EBML_IOCALLBACK_READ_RETURN_TYPE read(void *buffer, size_t size) override;
   virtual uint32_t read(std::string &buffer, size_t size, size_t offset = 0);
   virtual uint32_t read(memory_cptr const &buffer, size_t size, int offset = 0);
@@ -65,13 +73,35 @@ public:
   virtual size_t write(const void *buffer, size_t size) override;
   virtual size_t write(std::string const &buffer);
   virtual size_t write(const memory_cptr &buffer, size_t size = UINT_MAX, size_t offset = 0);
+  // Writes all chunks one after the other. Implementations for which
+  // can_write_vectored() returns true do so with a single system call
+  // without copying the data first.
+  virtual size_t writev(chunks_t const &chunks);
+  virtual bool can_write_vectored() {
+    return false;
+  }
   virtual bool eof() = 0;
   virtual void clear_eof() { }
   virtual void flush() {
   }
+  // Writes all buffered data and waits until it has reached the
+  // storage device.
+  virtual void sync() {
+    flush();
+  }
   virtual int truncate(int64_t) {
     return 0;
   }
+  // Reserves storage for the file up to the given size without
+  // changing its apparent size. Returns whether or not the
+  // reservation succeeded.
+  virtual bool preallocate(int64_t) {
+    return false;
+  }
+  // Hints to the operating system that the file will be read
+  // sequentially.
+  virtual void advise_sequential_access() {
+  }
 
   virtual std::string get_file_name() const = 0;
 
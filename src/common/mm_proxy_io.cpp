@@ -57,6 +57,30 @@ mm_proxy_io_c::eof() {
   return p_func()->proxy_io->eof();
 }
 
+int
+mm_proxy_io_c::truncate(int64_t pos) {
+  auto p = p_func();
+
+  p->cached_size = -1;
+  return p->proxy_io->truncate(pos);
+}
+
+bool
+mm_proxy_io_c::preallocate(int64_t size) {
+  return p_func()->proxy_io->preallocate(size);
+}
+
+void
+mm_proxy_io_c::advise_sequential_access() {
+  p_func()->proxy_io->advise_sequential_access();
+}
+
+void
+mm_proxy_io_c::sync() {
+  flush();
+  p_func()->proxy_io->sync();
+}
+
 std::string
 mm_proxy_io_c::get_file_name()
   const {
@@ -31,6 +31,10 @@ public:
   virtual void clear_eof() override;
   virtual bool eof() override;
   virtual void close() override;
+  virtual int truncate(int64_t pos) override;
+  virtual bool preallocate(int64_t size) override;
+  virtual void advise_sequential_access() override;
+  virtual void sync() override;
   virtual std::string get_file_name() const override;
   virtual mm_io_c *get_proxied() const;
 
@@ -80,9 +80,10 @@ mm_read_buffer_io_c::setFilePointer(int64_t offset,
       throw mtx::mm_io::seek_x();
   }
 
-  // Still within the current buffer?
+  // Still within the current buffer? Data handed out as shared slices
+  // must be read again as their users may have modified it.
   int64_t in_buf = new_pos - p->offset;
-  if ((0 <= in_buf) && (in_buf <= static_cast<int64_t>(p->fill))) {
+  if ((static_cast<int64_t>(p->shared_until) <= in_buf) && (in_buf <= static_cast<int64_t>(p->fill))) {
     p->cursor = in_buf;
     return;
   }
@@ -97,7 +98,7 @@ mm_read_buffer_io_c::setFilePointer(int64_t offset,
   p->offset = p->proxy_io->getFilePointer();
 
   // "Drop" the buffer content
-  p->cursor = p->fill = 0;
+  p->cursor = p->fill = p->shared_until = 0;
 
   mxdebug_if(s_debug_seek, fmt::format("seek on proxy from {0} to {1} relative {2}\n", previous_pos, p->offset, p->offset - previous_pos));
 }
@@ -119,7 +120,6 @@ mm_read_buffer_io_c::_read(void *buffer,
   uint32_t res = 0;
 
   while (0 < size) {
-    // TODO Directly write full blocks into the output buffer when size > p->size
     size_t avail = std::min(size, p->fill - p->cursor);
     if (avail) {
       memcpy(buf, p->buffer + p->cursor, avail);
@@ -130,18 +130,35 @@ mm_read_buffer_io_c::_read(void *buffer,
 
     } else {
       // Refill the buffer
-      p->offset += p->cursor;
-      p->cursor  = 0;
-      p->fill    = 0;
-      avail     = std::min(get_size() - p->offset, static_cast<int64_t>(p->af_buffer->get_size()));
-
-      if (!avail) {
-        // must keep track of eof, as p->proxy_io->eof() will never be reached
-        // because of the above eof calculation
-        p->eof = true;
+      p->offset       += p->cursor;
+      p->cursor        = 0;
+      p->fill          = 0;
+      p->shared_until  = 0;
+
+      // Read requests at least as big as the buffer are served directly
+      // without copying the data through the buffer.
+      if (size >= p->af_buffer->get_size()) {
+        size_t num_read  = p->proxy_io->read(buf, size);
+        p->offset       += num_read;
+        res             += num_read;
+
+        mxdebug_if(s_debug_read, fmt::format("direct physical read from position {2} for {0} returned {1}\n", size, num_read, p->offset - num_read));
+
+        if (num_read != size)
+          p->eof = true;
         break;
       }
 
+      detach_buffer_from_shared_slices();
+
+      avail = std::min(get_size() - p->offset, static_cast<int64_t>(p->af_buffer->get_size()));
+
+      // A file that is still being written to (see mm_follow_io_c) may
+      // deliver more than its current size. Only ask for what's
+      // actually needed in that case as reading waits for the data.
+      if (!avail)
+        avail = std::min(size, p->af_buffer->get_size());
+
       int64_t previous_pos = p->proxy_io->getFilePointer();
 
       p->fill = p->proxy_io->read(p->buffer, avail);
@@ -170,9 +187,10 @@ mm_read_buffer_io_c::enable_buffering(bool enable) {
 
   p->buffering = enable;
   if (!p->buffering) {
-    p->offset = 0;
-    p->cursor = 0;
-    p->fill   = 0;
+    p->offset       = 0;
+    p->cursor       = 0;
+    p->fill         = 0;
+    p->shared_until = 0;
   }
 }
 
@@ -183,7 +201,11 @@ mm_read_buffer_io_c::set_buffer_size(std::size_t new_buffer_size) {
   if (new_buffer_size == p->af_buffer->get_size())
     return;
 
-  p->af_buffer->resize(new_buffer_size);
+  // Resizing might move the storage that shared slices point to.
+  if (p->af_buffer.use_count() > 1)
+    p->af_buffer = memory_c::alloc(new_buffer_size);
+  else
+    p->af_buffer->resize(new_buffer_size);
   p->buffer = p->af_buffer->get_buffer();
 
   if (!p->buffering)
@@ -193,10 +215,80 @@ mm_read_buffer_io_c::set_buffer_size(std::size_t new_buffer_size) {
   p->offset         = previous_pos;
   p->cursor         = 0;
   p->fill           = 0;
+  p->shared_until   = 0;
 
   p->proxy_io->setFilePointer(previous_pos);
 }
 
+memory_cptr
+mm_read_buffer_io_c::read_shared(size_t size) {
+  auto p = p_func();
+
+  // Data bigger than the buffer is read into its own allocation as it
+  // would have to be copied anyway.
+  if (!p->buffering || !size || (size > p->af_buffer->get_size()))
+    return mm_proxy_io_c::read_shared(size);
+
+  if ((p->fill - p->cursor) < size)
+    fill_buffer_for_shared_read(size);
+
+  if ((p->fill - p->cursor) < size) {
+    p->cursor = p->fill;
+    p->eof    = true;
+    throw mtx::mm_io::end_of_file_x{};
+  }
+
+  auto slice       = memory_c::share(p->af_buffer, p->cursor, size);
+  p->cursor       += size;
+  p->shared_until  = p->cursor;
+
+  return slice;
+}
+
+/** \brief Makes \c size bytes available starting at the cursor
+
+   The bytes remaining in the buffer are moved to its start, and the
+   rest is filled from the underlying file. If parts of the buffer have
+   been handed out as shared slices, a new buffer is used instead.
+*/
+void
+mm_read_buffer_io_c::fill_buffer_for_shared_read(std::size_t size) {
+  auto p         = p_func();
+  auto remaining = p->fill - p->cursor;
+  auto source    = p->buffer + p->cursor; // kept alive by the slices if detached
+
+  detach_buffer_from_shared_slices();
+
+  std::memmove(p->buffer, source, remaining);
+
+  p->offset       += p->cursor;
+  p->cursor        = 0;
+  p->fill          = remaining;
+  p->shared_until  = 0;
+
+  // Always ask for at least the missing bytes as the file may still be
+  // growing (see mm_follow_io_c).
+  auto to_read = std::max<int64_t>(std::min<int64_t>(get_size() - p->offset - p->fill, p->af_buffer->get_size() - p->fill), size - p->fill);
+  if (to_read <= 0)
+    return;
+
+  auto num_read  = p->proxy_io->read(p->buffer + p->fill, to_read);
+  p->fill       += num_read;
+
+  mxdebug_if(s_debug_read, fmt::format("physical read for a shared read of {0} from position {3} for {1} returned {2}\n", size, to_read, num_read, p->offset + p->fill - num_read));
+}
+
+void
+mm_read_buffer_io_c::detach_buffer_from_shared_slices() {
+  auto p = p_func();
+
+  if (p->af_buffer.use_count() <= 1)
+    return;
+
+  p->af_buffer = memory_c::alloc(p->af_buffer->get_size());
+  p->buffer    = p->af_buffer->get_buffer();
+}
+
 bool
 mm_read_buffer_io_c::eof() {
   return p_func()->eof;
@@ -36,8 +36,12 @@ public:
   virtual void clear_eof() override;
   virtual void enable_buffering(bool enable);
   virtual void set_buffer_size(std::size_t new_buffer_size = 1 << 17);
+  virtual memory_cptr read_shared(size_t size) override;
 
 protected:
   virtual uint32_t _read(void *buffer, size_t size) override;
   virtual size_t _write(const void *buffer, size_t size) override;
+
+  void fill_buffer_for_shared_read(std::size_t size);
+  void detach_buffer_from_shared_slices();
 };
@@ -26,6 +26,9 @@ public:
   size_t fill{};
   int64_t offset{};
   bool buffering{true};
+  // Data before this position in the buffer has been handed out as
+  // shared slices and may have been modified by their users.
+  std::size_t shared_until{};
 
   explicit mm_read_buffer_io_private_c(mm_io_cptr const &proxy_io,
                                        std::size_t buffer_size)
@@ -14,6 +14,7 @@
 
 #include "common/common_pch.h"
 
+#include "common/list_utils.h"
 #include "common/mm_io_x.h"
 #include "common/mm_proxy_io.h"
 #include "common/mm_text_io.h"
@@ -23,6 +24,12 @@
    Class for handling UTF-8/UTF-16/UTF-32 text files.
 */
 
+namespace {
+
+std::size_t const s_read_ahead_size = 64 * 1024;
+
+}
+
 mm_text_io_private_c::mm_text_io_private_c(mm_io_cptr const &in)
   : mm_proxy_io_private_c{in}
 {
@@ -30,14 +37,11 @@ mm_text_io_private_c::mm_text_io_private_c(mm_io_cptr const &in)
 
   uint8_t buffer[4];
   int num_read = in->read(buffer, 4);
-  if (2 > num_read) {
-    in->setFilePointer(0);
-    return;
-  }
-
-  mm_text_io_c::detect_byte_order_marker(buffer, num_read, byte_order_mark, bom_len);
+  if (2 <= num_read)
+    mm_text_io_c::detect_byte_order_marker(buffer, num_read, byte_order_mark, bom_len);
 
   in->setFilePointer(bom_len);
+  read_ahead_start = bom_len;
 }
 
 mm_text_io_c::mm_text_io_c(mm_io_cptr const &in)
@@ -224,6 +228,9 @@ mm_text_io_c::getline(std::optional<std::size_t> max_chars) {
   if (!p->eol_style_detected)
     detect_eol_style();
 
+  if (mtx::included_in(p->byte_order_mark, byte_order_mark_e::none, byte_order_mark_e::utf8))
+    return getline_utf8(max_chars);
+
   std::string s;
   bool previous_was_carriage_return = false;
   std::size_t num_chars_read{};
@@ -263,10 +270,217 @@ mm_text_io_c::getline(std::optional<std::size_t> max_chars) {
   }
 }
 
+/** \brief Reads a line from an 8-bit or UTF-8 encoded file
+
+   Works directly on the read-ahead buffer: runs of ASCII characters
+   are copied in one go, and only multi-byte UTF-8 sequences are
+   looked at individually. The handling of line endings is identical
+   to the one in \c getline() for other encodings.
+*/
+std::string
+mm_text_io_c::getline_utf8(std::optional<std::size_t> max_chars) {
+  auto p       = p_func();
+  auto is_utf8 = byte_order_mark_e::utf8 == p->byte_order_mark;
+
+  std::string s;
+  bool previous_was_carriage_return = false;
+  std::size_t num_chars_read{};
+
+  while (true) {
+    if ((p->read_ahead_pos == p->read_ahead_end) && !fill_read_ahead(1)) {
+      p->read_ahead_eof = true;
+      return s;
+    }
+
+    auto data = &p->read_ahead[p->read_ahead_pos];
+
+    if (*data == '\r') {
+      if (previous_was_carriage_return && !p->uses_newlines)
+        return s;
+
+      previous_was_carriage_return = true;
+      ++p->read_ahead_pos;
+      continue;
+    }
+
+    if (*data == '\n') {
+      ++p->read_ahead_pos;
+      return s;
+    }
+
+    std::size_t size = !is_utf8 || (*data < 0x80) ?  1
+                     : ((*data & 0xe0) == 0xc0)      ?  2
+                     : ((*data & 0xf0) == 0xe0)      ?  3
+                     : ((*data & 0xf8) == 0xf0)      ?  4
+                     : ((*data & 0xfc) == 0xf8)      ?  5
+                     : ((*data & 0xfe) == 0xfc)      ?  6
+                     :                                 99;
+
+    if (99 == size) {
+      ++p->read_ahead_pos;
+      throw mtx::mm_io::text::invalid_utf8_char_x(*data);
+    }
+
+    if (!fill_read_ahead(size)) {
+      // Truncated sequence at the end of the file.
+      p->read_ahead_pos = p->read_ahead_end;
+      p->read_ahead_eof = true;
+      return s;
+    }
+
+    // A carriage return not followed by a new line ends the line, too.
+    if (previous_was_carriage_return)
+      return s;
+
+    data = &p->read_ahead[p->read_ahead_pos];
+
+    if (1 == size) {
+      // Copy runs of single-byte characters in one go.
+      auto available  = p->read_ahead_end - p->read_ahead_pos;
+      auto max_length = max_chars ? std::min(available, *max_chars - num_chars_read) : available;
+
+      while (   (size < max_length)
+             && (data[size] != '\r')
+             && (data[size] != '\n')
+             && (!is_utf8 || (data[size] < 0x80)))
+        ++size;
+
+      num_chars_read += size;
+
+    } else
+      ++num_chars_read;
+
+    s.append(reinterpret_cast<char const *>(data), size);
+    p->read_ahead_pos += size;
+
+    if (max_chars && (num_chars_read >= *max_chars))
+      return s;
+  }
+}
+
+/** \brief Makes sure that at least \c min_bytes are available in the read-ahead buffer
+
+   Returns \c false if the file doesn't contain that many bytes
+   anymore. The bytes available are kept in the buffer in that case.
+*/
+bool
+mm_text_io_c::fill_read_ahead(std::size_t min_bytes) {
+  auto p         = p_func();
+  auto available = p->read_ahead_end - p->read_ahead_pos;
+
+  if (available >= min_bytes)
+    return true;
+
+  if (p->read_ahead.empty())
+    p->read_ahead.resize(s_read_ahead_size);
+
+  std::memmove(p->read_ahead.data(), &p->read_ahead[p->read_ahead_pos], available);
+
+  p->read_ahead_start += p->read_ahead_pos;
+  p->read_ahead_pos    = 0;
+  p->read_ahead_end    = available + p->proxy_io->read(&p->read_ahead[available], p->read_ahead.size() - available);
+
+  // Reading ahead must not influence eof(), which is determined by
+  // the bytes actually consumed.
+  p->proxy_io->clear_eof();
+
+  return p->read_ahead_end >= min_bytes;
+}
+
+uint32_t
+mm_text_io_c::_read(void *buffer,
+                    size_t size) {
+  auto p           = p_func();
+  auto destination = static_cast<uint8_t *>(buffer);
+  auto num_read    = std::size_t{};
+
+  while (num_read < size) {
+    if ((p->read_ahead_pos == p->read_ahead_end) && !fill_read_ahead(1))
+      break;
+
+    auto to_copy = std::min(size - num_read, p->read_ahead_end - p->read_ahead_pos);
+
+    std::memcpy(&destination[num_read], &p->read_ahead[p->read_ahead_pos], to_copy);
+    p->read_ahead_pos += to_copy;
+    num_read          += to_copy;
+  }
+
+  if (num_read < size)
+    p->read_ahead_eof = true;
+
+  return num_read;
+}
+
+size_t
+mm_text_io_c::_write(const void *buffer,
+                     size_t size) {
+  auto p = p_func();
+
+  // Writing happens at the logical position, not at the end of the
+  // read-ahead data.
+  if (p->read_ahead_end) {
+    p->proxy_io->setFilePointer(p->read_ahead_start + p->read_ahead_pos);
+    p->read_ahead_start += p->read_ahead_pos;
+    p->read_ahead_pos    = 0;
+    p->read_ahead_end    = 0;
+  }
+
+  auto num_written     = mm_proxy_io_c::_write(buffer, size);
+  p->read_ahead_start += num_written;
+
+  return num_written;
+}
+
 void
 mm_text_io_c::setFilePointer(int64_t offset,
                              libebml::seek_mode mode) {
-  mm_proxy_io_c::setFilePointer(((0 == offset) && (libebml::seek_beginning == mode)) ? p_func()->bom_len : offset, mode);
+  auto p = p_func();
+
+  if ((0 == offset) && (libebml::seek_beginning == mode))
+    offset = p->bom_len;
+
+  else if (libebml::seek_current == mode) {
+    offset = getFilePointer() + offset;
+    mode   = libebml::seek_beginning;
+  }
+
+  // Seeking within the read-ahead data doesn't require any I/O, which
+  // is what getline() does when it has to back up a character.
+  if (   (libebml::seek_beginning == mode)
+      && (offset >= static_cast<int64_t>(p->read_ahead_start))
+      && (offset <= static_cast<int64_t>(p->read_ahead_start + p->read_ahead_end))) {
+    p->read_ahead_pos = offset - p->read_ahead_start;
+    p->read_ahead_eof = false;
+    return;
+  }
+
+  mm_proxy_io_c::setFilePointer(offset, mode);
+
+  p->read_ahead_start = mm_proxy_io_c::getFilePointer();
+  p->read_ahead_pos   = 0;
+  p->read_ahead_end   = 0;
+  p->read_ahead_eof   = false;
+}
+
+uint64_t
+mm_text_io_c::getFilePointer() {
+  auto p = p_func();
+
+  return p->read_ahead_start + p->read_ahead_pos;
+}
+
+bool
+mm_text_io_c::eof() {
+  auto p = p_func();
+
+  return p->read_ahead_eof
+      || ((p->read_ahead_pos == p->read_ahead_end) && p->proxy_io->eof());
+}
+
+void
+mm_text_io_c::clear_eof() {
+  p_func()->read_ahead_eof = false;
+  mm_proxy_io_c::clear_eof();
 }
 
 byte_order_mark_e
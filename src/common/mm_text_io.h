@@ -26,6 +26,9 @@ public:
   mm_text_io_c(mm_io_cptr const &in);
 
   virtual void setFilePointer(int64_t offset, libebml::seek_mode mode=libebml::seek_beginning) override;
+  virtual uint64_t getFilePointer() override;
+  virtual bool eof() override;
+  virtual void clear_eof() override;
   virtual std::string getline(std::optional<std::size_t> max_chars = std::nullopt) override;
   virtual std::string read_next_codepoint();
   virtual byte_order_mark_e get_byte_order_mark() const;
@@ -35,6 +38,10 @@ public:
 
 protected:
   virtual void detect_eol_style();
+  virtual std::string getline_utf8(std::optional<std::size_t> max_chars);
+  virtual uint32_t _read(void *buffer, size_t size) override;
+  virtual size_t _write(const void *buffer, size_t size) override;
+  bool fill_read_ahead(std::size_t min_bytes);
 
 public:
   static bool has_byte_order_marker(const std::string &string);
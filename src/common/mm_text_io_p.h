@@ -23,5 +23,14 @@ public:
   unsigned int bom_len{};
   bool uses_carriage_returns{}, uses_newlines{}, eol_style_detected{};
 
+  // Raw bytes read ahead from the proxied I/O in large blocks so that
+  // lines can be decoded without a virtual call per code point. The
+  // proxied I/O is always positioned at the end of the read-ahead
+  // data.
+  std::vector<uint8_t> read_ahead;
+  std::size_t read_ahead_pos{}, read_ahead_end{};
+  uint64_t read_ahead_start{};
+  bool read_ahead_eof{};
+
   explicit mm_text_io_private_c(mm_io_cptr const &in);
 };
@@ -22,6 +22,10 @@
 
 namespace {
 debugging_option_c s_debug_seek{"write_buffer_io|write_buffer_io_seek"}, s_debug_write{"write_buffer_io|write_buffer_io_write"};
+
+// Writes at least this big bypass the buffer if the destination
+// supports vectored writes.
+std::size_t constexpr s_min_vectored_write_size = 256 * 1024;
 }
 
 mm_write_buffer_io_c::mm_write_buffer_io_c(mm_io_cptr const &out,
@@ -77,6 +81,12 @@ mm_write_buffer_io_c::flush() {
   mm_proxy_io_c::flush();
 }
 
+int
+mm_write_buffer_io_c::truncate(int64_t pos) {
+  flush_buffer();
+  return mm_proxy_io_c::truncate(pos);
+}
+
 void
 mm_write_buffer_io_c::close() {
   close_write_buffer_io();
@@ -100,6 +110,36 @@ mm_write_buffer_io_c::_write(const void *buffer,
                              size_t size) {
   auto p = p_func();
 
+  // Large payloads such as video frames are written together with the
+  // buffered data in a single vectored write instead of being copied
+  // into the buffer first.
+  if ((size >= s_min_vectored_write_size) && p->proxy_io->can_write_vectored()) {
+    auto fill    = p->fill;
+    auto written = p->proxy_io->writev({ { p->buffer, fill }, { buffer, size } });
+
+    p->cached_size = -1;
+
+    mxdebug_if(s_debug_write, fmt::format("vectored write at {0} for {1} buffered & {2} new bytes written {3}\n", mm_proxy_io_c::getFilePointer() - written, fill, size, written));
+
+    if (written != (fill + size)) {
+      // Only the buffered bytes that have actually been written may be
+      // removed from the buffer. The others are kept so that they're
+      // written by the next flush just like after a failed non-vectored
+      // write of the new data.
+      auto buffered_written = std::min<std::size_t>(written, fill);
+
+      if (buffered_written < fill)
+        std::memmove(p->buffer, p->buffer + buffered_written, fill - buffered_written);
+      p->fill = fill - buffered_written;
+
+      throw mtx::mm_io::insufficient_space_x();
+    }
+
+    p->fill = 0;
+
+    return size;
+  }
+
   size_t avail;
   const char *buf = static_cast<const char *>(buffer);
   size_t remain   = size;
@@ -111,7 +151,7 @@ mm_write_buffer_io_c::_write(const void *buffer,
       // lousy OS I/O scheduling
       memcpy(p->buffer + p->fill, buf, avail);
       p->fill = p->size;
-      flush_buffer();
+      flush_buffer(true);
       remain -= avail;
       buf    += avail;
 
@@ -137,17 +177,32 @@ mm_write_buffer_io_c::_write(const void *buffer,
 }
 
 void
-mm_write_buffer_io_c::flush_buffer() {
+mm_write_buffer_io_c::flush_buffer(bool keep_unaligned_tail) {
   auto p = p_func();
 
   if (!p->fill)
     return;
 
-  size_t written = mm_proxy_io_c::_write(p->buffer, p->fill);
-  size_t fill    = p->fill;
-  p->fill         = 0;
+  // When flushing a full buffer only write up to the last position
+  // that is a multiple of the direct I/O alignment and keep the rest
+  // in the buffer. That way all following flushes start at aligned
+  // positions & can be written directly.
+  size_t fill = p->fill;
+
+  if (keep_unaligned_tail) {
+    auto tail = (mm_proxy_io_c::getFilePointer() + p->fill) % mm_file_io_c::direct_io_alignment;
+    if (tail < fill)
+      fill -= tail;
+  }
+
+  size_t written = mm_proxy_io_c::_write(p->buffer, fill);
+
+  if (fill < p->fill)
+    std::memmove(p->buffer, p->buffer + fill, p->fill - fill);
+
+  p->fill -= fill;
 
-  mxdebug_if(s_debug_write, fmt::format("flush_buffer() at {0} for {1} written {2}\n", mm_proxy_io_c::getFilePointer() - written, fill, written));
+  mxdebug_if(s_debug_write, fmt::format("flush_buffer() at {0} for {1} written {2} kept {3}\n", mm_proxy_io_c::getFilePointer() - written, fill, written, p->fill));
 
   if (written != fill)
     throw mtx::mm_io::insufficient_space_x();
@@ -33,6 +33,7 @@ public:
   virtual void setFilePointer(int64_t offset, libebml::seek_mode mode = libebml::seek_beginning) override;
   virtual void flush() override;
   virtual void close() override;
+  virtual int truncate(int64_t pos) override;
   virtual void discard_buffer();
 
   static mm_io_cptr open(const std::string &file_name, size_t buffer_size);
@@ -40,6 +41,6 @@ public:
 protected:
   virtual uint32_t _read(void *buffer, size_t size) override;
   virtual size_t _write(const void *buffer, size_t size) override;
-  void flush_buffer();
+  void flush_buffer(bool keep_unaligned_tail = false);
   void close_write_buffer_io();
 };
@@ -13,6 +13,7 @@
 
 #include "common/common_pch.h"
 
+#include "common/mm_file_io.h"
 #include "common/mm_proxy_io_p.h"
 
 class mm_write_buffer_io_c;
@@ -27,9 +28,12 @@ public:
   explicit mm_write_buffer_io_private_c(mm_io_cptr const &p_proxy_io,
                                         std::size_t p_buffer_size)
     : mm_proxy_io_private_c{p_proxy_io}
-    , af_buffer{memory_c::alloc(p_buffer_size)}
-    , buffer{af_buffer->get_buffer()}
+    , af_buffer{memory_c::alloc(p_buffer_size + mm_file_io_c::direct_io_alignment)}
     , size{p_buffer_size}
   {
+    // Align the buffer so that it can be used for direct I/O without
+    // having to be copied.
+    auto address = reinterpret_cast<uintptr_t>(af_buffer->get_buffer());
+    buffer       = reinterpret_cast<uint8_t *>((address + mm_file_io_c::direct_io_alignment - 1) & ~static_cast<uintptr_t>(mm_file_io_c::direct_io_alignment - 1));
   }
 };
@@ -39,6 +39,22 @@ std::shared_ptr<mm_io_c> g_mm_stdio   = std::shared_ptr<mm_io_c>(new mm_stdio_c)
 
 static mxmsg_handler_t s_mxmsg_info_handler, s_mxmsg_warning_handler, s_mxmsg_error_handler;
 static std::vector<std::string> s_warnings_emitted, s_errors_emitted;
+static thread_local mtx::output::captured_messages_t *s_captured_messages{};
+static std::unique_ptr<mtx::json::streaming_writer_c> s_json_output_stream;
+
+static bool
+capture_message(unsigned int level,
+                std::string const &message) {
+  if (!s_captured_messages)
+    return false;
+
+  s_captured_messages->push_back({ level, message });
+
+  if (MXMSG_ERROR == level)
+    throw mtx::output::captured_error_x{};
+
+  return true;
+}
 
 static nlohmann::json
 to_json_array(std::vector<std::string> const &messages) {
@@ -50,12 +66,43 @@ to_json_array(std::vector<std::string> const &messages) {
   return result;
 }
 
+mtx::json::streaming_writer_c &
+start_json_output_stream(std::vector<std::string> const &top_level_key_order) {
+  s_json_output_stream = std::make_unique<mtx::json::streaming_writer_c>([](std::string const &text) { mxinfo(text); }, 2, top_level_key_order);
+  s_json_output_stream->start_object();
+
+  return *s_json_output_stream;
+}
+
+mtx::json::streaming_writer_c *
+get_json_output_stream() {
+  return s_json_output_stream.get();
+}
+
 void
 display_json_output(nlohmann::json json) {
   json["warnings"] = to_json_array(s_warnings_emitted);
   json["errors"]   = to_json_array(s_errors_emitted);
 
-  mxinfo(fmt::format("{0}\n", mtx::json::dump(json, 2)));
+  if (!s_json_output_stream) {
+    mxinfo(fmt::format("{0}\n", mtx::json::dump(json, 2)));
+    return;
+  }
+
+  // Errors may occur while arrays or objects are still open. Values
+  // that have already been output take precedence over new ones for
+  // the same key as keys must be unique.
+  auto stream = std::move(s_json_output_stream);
+
+  stream->end_to_depth(1);
+
+  for (auto const &item : json.items())
+    if (!stream->has_key(item.key()))
+      stream->add(item.key(), item.value());
+
+  stream->end();
+
+  mxinfo("\n");
 }
 
 static void
@@ -160,6 +207,9 @@ default_mxinfo(unsigned int,
 
 void
 mxinfo(std::string const &info) {
+  if (capture_message(MXMSG_INFO, info))
+    return;
+
   if (s_mxmsg_info_handler)
     s_mxmsg_info_handler(MXMSG_INFO, info);
 }
@@ -185,6 +235,9 @@ default_mxwarn(unsigned int,
 
 void
 mxwarn(std::string const &warning) {
+  if (capture_message(MXMSG_WARNING, warning))
+    return;
+
   if (s_mxmsg_warning_handler)
     s_mxmsg_warning_handler(MXMSG_WARNING, warning);
 }
@@ -198,10 +251,39 @@ default_mxerror(unsigned int,
 
 void
 mxerror(std::string const &error) {
+  capture_message(MXMSG_ERROR, error);
+
   if (s_mxmsg_error_handler)
     s_mxmsg_error_handler(MXMSG_ERROR, error);
 }
 
+namespace mtx::output {
+
+message_capture_c::message_capture_c(captured_messages_t &messages)
+  : m_previous{s_captured_messages}
+{
+  s_captured_messages = &messages;
+}
+
+message_capture_c::~message_capture_c() {
+  s_captured_messages = m_previous;
+}
+
+void
+replay_captured_messages(captured_messages_t const &messages) {
+  for (auto const &message : messages)
+    if (MXMSG_INFO == message.level)
+      mxinfo(message.message);
+
+    else if (MXMSG_WARNING == message.level)
+      mxwarn(message.message);
+
+    else
+      mxerror(message.message);
+}
+
+}
+
 void
 mxinfo_fn(const std::string &file_name,
           const std::string &info) {
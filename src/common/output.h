@@ -19,6 +19,7 @@
 
 #include <ebml/EbmlElement.h>
 
+#include "common/error.h"
 #include "common/json.h"
 #include "common/locale.h"
 #include "common/mm_io.h"
@@ -41,6 +42,14 @@ bool stdio_redirected();
 void redirect_warnings_and_errors_to_json();
 void display_json_output(nlohmann::json json);
 
+// Starts a top-level JSON object whose values are output while they're
+// being written. Its keys are output in the given order. A subsequent
+// call to `display_json_output()` completes it with the given values as
+// well as the warnings & errors instead of outputting a separate
+// object.
+mtx::json::streaming_writer_c &start_json_output_stream(std::vector<std::string> const &top_level_key_order);
+mtx::json::streaming_writer_c *get_json_output_stream();
+
 void init_common_output(bool no_charset_detection);
 void set_cc_stdio(const std::string &charset);
 
@@ -60,3 +69,43 @@ void mxwarn_tid(const std::string &file_name, int64_t track_id, const std::strin
 
 void mxerror_fn(const std::string &file_name, const std::string &error);
 void mxerror_tid(const std::string &file_name, int64_t track_id, const std::string &error);
+
+namespace mtx::output {
+
+struct captured_message_t {
+  unsigned int level{};
+  std::string message;
+};
+
+using captured_messages_t = std::vector<captured_message_t>;
+
+// Thrown by mxerror() on a thread whose messages are captured instead
+// of exiting the program.
+class captured_error_x: public mtx::exception {
+public:
+  virtual const char *what() const throw() override {
+    return "error message captured";
+  }
+};
+
+// While an object of this class exists, info, warning & error
+// messages emitted on the creating thread are appended to the given
+// list instead of being output. This allows work done on several
+// threads to report its messages in a deterministic order later on
+// via replay_captured_messages(). Captures can be nested; the
+// previous target is restored on destruction.
+class message_capture_c {
+protected:
+  captured_messages_t *m_previous{};
+
+public:
+  explicit message_capture_c(captured_messages_t &messages);
+  ~message_capture_c();
+
+  message_capture_c(message_capture_c const &) = delete;
+  message_capture_c &operator =(message_capture_c const &) = delete;
+};
+
+void replay_captured_messages(captured_messages_t const &messages);
+
+}
@@ -0,0 +1,104 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit https://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+
+   lightweight counters & timers for performance reports
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#if defined(SYS_WINDOWS)
+# include <windows.h>
+#else
+# include <time.h>
+#endif
+
+#include "common/profiling.h"
+
+namespace mtx::profiling {
+
+bool g_enabled{};
+thread_local allocations_t g_allocations;
+
+std::chrono::nanoseconds
+get_thread_cpu_time() {
+#if defined(SYS_WINDOWS)
+  FILETIME creation_time, exit_time, kernel_time, user_time;
+
+  if (!GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time, &kernel_time, &user_time))
+    return {};
+
+  auto to_100ns = [](FILETIME const &time) {
+    return (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+  };
+
+  return std::chrono::nanoseconds{(to_100ns(kernel_time) + to_100ns(user_time)) * 100};
+
+#else
+  struct timespec now;
+
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now) != 0)
+    return {};
+
+  return std::chrono::seconds{now.tv_sec} + std::chrono::nanoseconds{now.tv_nsec};
+#endif
+}
+
+// ------------------------------------------------------------
+
+counting_io_c::counting_io_c(mm_io_cptr const &proxy_io,
+                             counters_t &read_counters,
+                             counters_t &write_counters)
+  : mm_proxy_io_c{proxy_io}
+  , m_read_counters{read_counters}
+  , m_write_counters{write_counters}
+{
+}
+
+counting_io_c::~counting_io_c() {
+}
+
+uint32_t
+counting_io_c::_read(void *buffer,
+                     size_t size) {
+  scoped_timer_c timer{m_read_counters};
+
+  auto num_read = mm_proxy_io_c::_read(buffer, size);
+  m_read_counters.add(0, num_read);
+
+  return num_read;
+}
+
+size_t
+counting_io_c::_write(const void *buffer,
+                      size_t size) {
+  scoped_timer_c timer{m_write_counters};
+
+  auto num_written = mm_proxy_io_c::_write(buffer, size);
+  m_write_counters.add(0, num_written);
+
+  return num_written;
+}
+
+size_t
+counting_io_c::writev(chunks_t const &chunks) {
+  scoped_timer_c timer{m_write_counters};
+
+  auto num_written = get_proxied()->writev(chunks);
+  m_write_counters.add(0, num_written);
+
+  return num_written;
+}
+
+bool
+counting_io_c::can_write_vectored() {
+  return get_proxied()->can_write_vectored();
+}
+
+}
@@ -0,0 +1,132 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit https://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+
+   lightweight counters & timers for performance reports
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#pragma once
+
+#include "common/common_pch.h"
+
+#include <chrono>
+
+#include "common/mm_proxy_io.h"
+
+namespace mtx::profiling {
+
+// Whether or not counters are collected. All timers and counting
+// functions return right away if this is false, making them cheap
+// enough to be left in place in production code.
+extern bool g_enabled;
+
+// The number & total size of the heap allocations done via
+// safemalloc(), saferealloc() & safememdup() on the calling thread.
+// These cover all memory_c buffers, e.g. the packets' payloads.
+struct allocations_t {
+  uint64_t count{}, bytes{};
+};
+
+extern thread_local allocations_t g_allocations;
+
+inline void
+count_allocation(std::size_t size) {
+  if (!g_enabled)
+    return;
+
+  ++g_allocations.count;
+  g_allocations.bytes += size;
+}
+
+struct counters_t {
+  std::chrono::nanoseconds wall_time{}, cpu_time{};
+  uint64_t calls{}, packets{}, bytes{};
+  uint64_t allocations{}, allocated_bytes{};
+  uint64_t queue_high_water_mark{}, queued_bytes_high_water_mark{};
+
+  void
+  add(uint64_t num_packets,
+      uint64_t num_bytes) {
+    if (!g_enabled)
+      return;
+
+    packets += num_packets;
+    bytes   += num_bytes;
+  }
+
+  void
+  update_queue(uint64_t num_entries,
+               uint64_t num_bytes = 0) {
+    if (!g_enabled)
+      return;
+
+    queue_high_water_mark        = std::max(queue_high_water_mark,        num_entries);
+    queued_bytes_high_water_mark = std::max(queued_bytes_high_water_mark, num_bytes);
+  }
+};
+
+// The CPU time consumed by the calling thread so far.
+std::chrono::nanoseconds get_thread_cpu_time();
+
+// Adds the wall clock & CPU time spent and the allocations done
+// between its construction and its destruction to the counters and
+// increases their number of calls. Nested timers each account the
+// full time spent & allocations done in their scope.
+class scoped_timer_c {
+protected:
+  counters_t *m_counters{};
+  std::chrono::steady_clock::time_point m_wall_start;
+  std::chrono::nanoseconds m_cpu_start{};
+  allocations_t m_allocations_start;
+
+public:
+  explicit scoped_timer_c(counters_t &counters) {
+    if (!g_enabled)
+      return;
+
+    m_counters          = &counters;
+    m_wall_start        = std::chrono::steady_clock::now();
+    m_cpu_start         = get_thread_cpu_time();
+    m_allocations_start = g_allocations;
+  }
+
+  ~scoped_timer_c() {
+    if (!m_counters)
+      return;
+
+    m_counters->wall_time       += std::chrono::steady_clock::now() - m_wall_start;
+    m_counters->cpu_time        += get_thread_cpu_time() - m_cpu_start;
+    m_counters->allocations     += g_allocations.count - m_allocations_start.count;
+    m_counters->allocated_bytes += g_allocations.bytes - m_allocations_start.bytes;
+    ++m_counters->calls;
+  }
+
+  scoped_timer_c(scoped_timer_c const &) = delete;
+  scoped_timer_c &operator =(scoped_timer_c const &) = delete;
+};
+
+// Accounts the time spent in & the number of bytes transferred by
+// the proxied I/O object's read & write operations.
+class counting_io_c: public mm_proxy_io_c {
+protected:
+  counters_t &m_read_counters, &m_write_counters;
+
+public:
+  counting_io_c(mm_io_cptr const &proxy_io, counters_t &read_counters, counters_t &write_counters);
+  virtual ~counting_io_c();
+
+  virtual size_t writev(chunks_t const &chunks) override;
+  virtual bool can_write_vectored() override;
+
+protected:
+  virtual uint32_t _read(void *buffer, size_t size) override;
+  virtual size_t _write(const void *buffer, size_t size) override;
+};
+
+}
@@ -0,0 +1,82 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit https://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+
+   measuring the duration of the initialization stages
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <chrono>
+#include <mutex>
+
+#include "common/startup_timing.h"
+
+namespace mtx::startup_timing {
+
+namespace {
+
+using steady_clock = std::chrono::steady_clock;
+
+struct stage_t {
+  std::string m_name;
+  steady_clock::duration m_duration;
+};
+
+std::mutex s_mutex;
+std::optional<steady_clock::time_point> s_start;
+std::vector<stage_t> s_stages;
+
+double
+to_ms(steady_clock::duration duration) {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+} // anonymous namespace
+
+void
+measure(std::string const &stage,
+        std::function<void()> const &init) {
+  auto start = steady_clock::now();
+
+  init();
+
+  auto duration = steady_clock::now() - start;
+
+  std::lock_guard<std::mutex> lock{s_mutex};
+
+  if (!s_start)
+    s_start = start;
+
+  s_stages.push_back({ stage, duration });
+}
+
+void
+report() {
+  static debugging_option_c s_debug{"startup_timing"};
+
+  if (!s_debug)
+    return;
+
+  std::lock_guard<std::mutex> lock{s_mutex};
+
+  if (!s_start)
+    return;
+
+  auto total = steady_clock::duration{};
+
+  for (auto const &stage : s_stages) {
+    mxdebug(fmt::format("startup_timing: {0}: {1:.3f} ms\n", stage.m_name, to_ms(stage.m_duration)));
+    total += stage.m_duration;
+  }
+
+  mxdebug(fmt::format("startup_timing: all stages: {0:.3f} ms; from the start of the initialization until exit: {1:.3f} ms\n", to_ms(total), to_ms(steady_clock::now() - *s_start)));
+}
+
+}
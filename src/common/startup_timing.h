@@ -0,0 +1,27 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit https://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+
+   measuring the duration of the initialization stages
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#pragma once
+
+#include "common/common_pch.h"
+
+namespace mtx::startup_timing {
+
+// Runs `init` & records how long it took. Can be called from any
+// thread, e.g. for tables initialized on first use.
+void measure(std::string const &stage, std::function<void()> const &init);
+
+// Outputs all recorded stages if '--debug startup_timing' is active.
+void report();
+
+}
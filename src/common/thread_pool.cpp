@@ -0,0 +1,122 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit https://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+
+   a simple fixed-size thread pool
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include "common/thread_pool.h"
+
+namespace mtx {
+
+static thread_local bool s_is_worker_thread{};
+
+thread_pool_c::thread_pool_c(unsigned int num_threads) {
+  if (!num_threads)
+    num_threads = default_num_threads();
+
+  m_workers.reserve(num_threads);
+
+  for (auto idx = 0u; idx < num_threads; ++idx)
+    m_workers.emplace_back([this]() { worker_loop(); });
+}
+
+thread_pool_c::~thread_pool_c() {
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_stopping = true;
+  }
+
+  m_condition.notify_all();
+
+  for (auto &worker : m_workers)
+    worker.join();
+}
+
+void
+thread_pool_c::worker_loop() {
+  s_is_worker_thread = true;
+
+  while (true) {
+    std::function<void()> task;
+
+    {
+      std::unique_lock<std::mutex> lock{m_mutex};
+      m_condition.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+
+      // Drain the queue before stopping so that no future is left
+      // without a result.
+      if (m_queue.empty())
+        return;
+
+      task = std::move(m_queue.front());
+      m_queue.pop_front();
+    }
+
+    task();
+  }
+}
+
+unsigned int
+thread_pool_c::default_num_threads() {
+  return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+bool
+thread_pool_c::is_worker_thread() {
+  return s_is_worker_thread;
+}
+
+void
+run_in_parallel(std::size_t num_tasks,
+                std::function<void(std::size_t)> const &task,
+                unsigned int num_threads) {
+  if (!num_tasks)
+    return;
+
+  if (!num_threads)
+    num_threads = thread_pool_c::default_num_threads();
+
+  num_threads = std::min<std::size_t>(num_threads, num_tasks);
+
+  if (thread_pool_c::is_worker_thread())
+    num_threads = 1;
+
+  if (num_threads == 1) {
+    for (auto idx = 0u; idx < num_tasks; ++idx)
+      task(idx);
+    return;
+  }
+
+  thread_pool_c pool{num_threads};
+  std::vector<std::future<void>> results;
+
+  results.reserve(num_tasks);
+
+  for (auto idx = 0u; idx < num_tasks; ++idx)
+    results.emplace_back(pool.submit([&task, idx]() { task(idx); }));
+
+  std::exception_ptr first_exception;
+
+  for (auto &result : results) {
+    try {
+      result.get();
+    } catch (...) {
+      if (!first_exception)
+        first_exception = std::current_exception();
+    }
+  }
+
+  if (first_exception)
+    std::rethrow_exception(first_exception);
+}
+
+}
@@ -0,0 +1,85 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit https://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+
+   a simple fixed-size thread pool
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#pragma once
+
+#include "common/common_pch.h"
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace mtx {
+
+class thread_pool_c {
+protected:
+  std::vector<std::thread> m_workers;
+  std::deque<std::function<void()>> m_queue;
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  bool m_stopping{};
+
+public:
+  explicit thread_pool_c(unsigned int num_threads = 0);
+  ~thread_pool_c();
+
+  thread_pool_c(thread_pool_c const &) = delete;
+  thread_pool_c &operator =(thread_pool_c const &) = delete;
+
+  std::size_t get_num_threads() const {
+    return m_workers.size();
+  }
+
+  // Queues a task for execution by one of the worker threads. The
+  // returned future can be used for retrieving the task's result in
+  // whichever order the caller requires; exceptions thrown by the
+  // task are re-thrown by std::future::get().
+  template<typename Tfunc>
+  auto
+  submit(Tfunc &&func)
+    -> std::future<std::invoke_result_t<Tfunc>> {
+    using result_t = std::invoke_result_t<Tfunc>;
+
+    auto task   = std::make_shared<std::packaged_task<result_t()>>(std::forward<Tfunc>(func));
+    auto future = task->get_future();
+
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      m_queue.emplace_back([task]() { (*task)(); });
+    }
+
+    m_condition.notify_one();
+
+    return future;
+  }
+
+public:
+  static unsigned int default_num_threads();
+
+  // Returns true if the calling thread is a worker of any pool.
+  static bool is_worker_thread();
+
+protected:
+  void worker_loop();
+};
+
+// Runs task(0) … task(num_tasks - 1) on up to num_threads threads and
+// waits for all of them to finish. If one or more tasks throw, the
+// exception of the task with the lowest index is re-thrown. When
+// called from a worker thread the tasks are run sequentially on that
+// thread instead of creating a nested pool.
+void run_in_parallel(std::size_t num_tasks, std::function<void(std::size_t)> const &task, unsigned int num_threads = 0);
+
+}
@@ -81,6 +81,16 @@ public:
     m_max_timestamp_and_duration  = std::max(timestamp + duration, m_max_timestamp_and_duration ? *m_max_timestamp_and_duration : std::numeric_limits<int64_t>::min());
   }
 
+  void merge(track_statistics_c const &other) {
+    m_num_frames += other.m_num_frames;
+    m_num_bytes  += other.m_num_bytes;
+
+    if (other.m_min_timestamp)
+      m_min_timestamp              = std::min(*other.m_min_timestamp,              m_min_timestamp              ? *m_min_timestamp              : std::numeric_limits<int64_t>::max());
+    if (other.m_max_timestamp_and_duration)
+      m_max_timestamp_and_duration = std::max(*other.m_max_timestamp_and_duration, m_max_timestamp_and_duration ? *m_max_timestamp_and_duration : std::numeric_limits<int64_t>::min());
+  }
+
   std::string to_string() const {
     auto duration = get_duration();
     auto bps      = get_bits_per_second();
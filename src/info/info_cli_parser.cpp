@@ -35,11 +35,13 @@ info_cli_parser_c::init_parser() {
   add_option("a|all",           std::bind(&info_cli_parser_c::set_show_all_elements,   this), YT("Show all sub-elements (including cues & seek heads entries) and don't stop at the first cluster."));
   add_option("c|checksum",      std::bind(&info_cli_parser_c::set_checksum,            this), YT("Calculate and display checksums of frame contents."));
   add_option("C|check-mode",    std::bind(&info_cli_parser_c::set_check_mode,          this), YT("Calculate and display checksums and use verbosity level 4."));
+  add_option("no-checksums",    std::bind(&info_cli_parser_c::set_no_checksums,        this), YT("Don't calculate checksums of frame contents, not even in summary mode."));
   add_option("o|continue",      std::bind(&info_cli_parser_c::set_continue_at_cluster, this), YT("Don't stop processing at the first cluster."));
   add_option("P|positions",     std::bind(&info_cli_parser_c::set_dec_positions,       this), YT("Show the position of each element in decimal."));
   add_option("p|hex-positions", std::bind(&info_cli_parser_c::set_hex_positions,       this), YT("Show the position of each element in hexadecimal."));
   add_option("s|summary",       std::bind(&info_cli_parser_c::set_summary,             this), YT("Only show summaries of the contents, not each element."));
   add_option("t|track-info",    std::bind(&info_cli_parser_c::set_track_info,          this), YT("Show statistics for each track in verbose mode."));
+  add_option("threads=<n>",     std::bind(&info_cli_parser_c::set_num_threads,         this), YT("Use this many threads for calculating checksums and hex dumps of frames (default: 1)."));
   add_option("x|hexdump",       std::bind(&info_cli_parser_c::set_hexdump,             this), YT("Show the first 16 bytes of each frame as a hex dump."));
   add_option("X|full-hexdump",  std::bind(&info_cli_parser_c::set_full_hexdump,        this), YT("Show all bytes of each frame and other binary elements as a hex dump."));
   add_option("z|size",          std::bind(&info_cli_parser_c::set_size,                this), YT("Show the size of each element including its header."));
@@ -61,6 +63,11 @@ info_cli_parser_c::set_checksum() {
   m_options.m_calc_checksums = true;
 }
 
+void
+info_cli_parser_c::set_no_checksums() {
+  m_no_checksums = true;
+}
+
 void
 info_cli_parser_c::set_check_mode() {
   m_options.m_calc_checksums = true;
@@ -78,7 +85,6 @@ info_cli_parser_c::set_summary() {
   m_options.m_show_summary   = true;
 }
 
-
 void
 info_cli_parser_c::set_hexdump() {
   m_options.m_show_hexdump = true;
@@ -101,6 +107,12 @@ info_cli_parser_c::set_track_info() {
   m_options.m_continue_at_cluster = true;
 }
 
+void
+info_cli_parser_c::set_num_threads() {
+  if (!mtx::string::parse_number(m_next_arg, m_options.m_num_threads) || !m_options.m_num_threads)
+    mxerror(fmt::format(FY("Invalid number of threads in '{0} {1}'.\n"), m_current_arg, m_next_arg));
+}
+
 void
 info_cli_parser_c::set_file_name() {
   if (!m_options.m_file_name.empty())
@@ -127,5 +139,9 @@ info_cli_parser_c::run() {
   m_options.m_verbose = verbose;
   verbose             = 0;
 
+  // Regardless of the order of the options.
+  if (m_no_checksums)
+    m_options.m_calc_checksums = false;
+
   return m_options;
 }
@@ -18,6 +18,7 @@
 class info_cli_parser_c: public mtx::cli::parser_c {
 protected:
   options_c m_options;
+  bool m_no_checksums{};
 
 public:
   info_cli_parser_c(const std::vector<std::string> &args);
@@ -29,6 +30,7 @@ protected:
 
   void set_checksum();
   void set_check_mode();
+  void set_no_checksums();
   void set_continue_at_cluster();
   void set_summary();
   void set_hexdump();
@@ -36,6 +38,7 @@ protected:
   void set_size();
   void set_file_name();
   void set_track_info();
+  void set_num_threads();
   void set_dec_positions();
   void set_hex_positions();
   void set_show_all_elements();
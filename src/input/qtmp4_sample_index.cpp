@@ -0,0 +1,281 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit https://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+
+   the compact sample index of the Quicktime & MP4 reader
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include "input/qtmp4_sample_index.h"
+
+namespace {
+
+// The lower four bits of each entry's first byte signal which values
+// differ from the predicted ones. They're followed by the
+// differences. If none differs the upper four bits contain the
+// number of entries in the run minus one.
+constexpr uint8_t EXPLICIT_FILE_POS  = 0x01;
+constexpr uint8_t EXPLICIT_SIZE      = 0x02;
+constexpr uint8_t EXPLICIT_DURATION  = 0x04;
+constexpr uint8_t EXPLICIT_TIMESTAMP = 0x08;
+constexpr uint8_t MAX_RUN_LENGTH     = 16;
+
+int64_t
+difference(int64_t value,
+           int64_t predicted) {
+  return static_cast<int64_t>(static_cast<uint64_t>(value) - static_cast<uint64_t>(predicted));
+}
+
+void
+put_number(std::vector<uint8_t> &data,
+           uint64_t value) {
+  while (value >= 0x80) {
+    data.push_back(static_cast<uint8_t>(value) | 0x80);
+    value >>= 7;
+  }
+
+  data.push_back(static_cast<uint8_t>(value));
+}
+
+void
+put_signed_number(std::vector<uint8_t> &data,
+                  int64_t value) {
+  put_number(data, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+uint64_t
+get_number(uint8_t const *&ptr) {
+  auto value = uint64_t{};
+  auto shift = 0u;
+
+  while (*ptr & 0x80) {
+    value |= static_cast<uint64_t>(*ptr & 0x7f) << shift;
+    shift += 7;
+    ++ptr;
+  }
+
+  value |= static_cast<uint64_t>(*ptr) << shift;
+  ++ptr;
+
+  return value;
+}
+
+int64_t
+get_signed_number(uint8_t const *&ptr) {
+  auto value = get_number(ptr);
+  return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+qt_index_t
+predict_following(qt_index_t const &previous) {
+  return { previous.file_pos + previous.size, previous.size, previous.timestamp + previous.duration, previous.duration, false };
+}
+
+}
+
+void
+qt_sample_index_c::push_back(qt_index_t const &entry) {
+  if (!(m_num_entries % ENTRIES_PER_BLOCK)) {
+    m_block_offsets.push_back(m_data.size());
+    m_previous = qt_index_t{};
+    m_run_pos.reset();
+  }
+
+  if (m_expanded_block && (*m_expanded_block == (m_num_entries / ENTRIES_PER_BLOCK)))
+    m_expanded_block.reset();
+
+  auto predicted = predict_following(m_previous);
+  auto timestamp = entry.timestamp - m_timestamp_offset;
+  auto flags     = uint8_t{};
+
+  if (entry.file_pos != predicted.file_pos)
+    flags |= EXPLICIT_FILE_POS;
+  if (entry.size != predicted.size)
+    flags |= EXPLICIT_SIZE;
+  if (entry.duration != predicted.duration)
+    flags |= EXPLICIT_DURATION;
+  if (timestamp != predicted.timestamp)
+    flags |= EXPLICIT_TIMESTAMP;
+
+  if (!flags && m_run_pos && ((m_data[*m_run_pos] >> 4) < (MAX_RUN_LENGTH - 1)))
+    m_data[*m_run_pos] += 0x10;
+
+  else if (!flags) {
+    m_run_pos = m_data.size();
+    m_data.push_back(0);
+
+  } else {
+    m_run_pos.reset();
+    m_data.push_back(flags);
+
+    if (flags & EXPLICIT_FILE_POS)
+      put_signed_number(m_data, difference(entry.file_pos, predicted.file_pos));
+    if (flags & EXPLICIT_SIZE)
+      put_number(m_data, entry.size);
+    if (flags & EXPLICIT_DURATION)
+      put_signed_number(m_data, difference(entry.duration, predicted.duration));
+    if (flags & EXPLICIT_TIMESTAMP)
+      put_signed_number(m_data, difference(timestamp, predicted.timestamp));
+  }
+
+  m_previous = { entry.file_pos, entry.size, timestamp, entry.duration, false };
+  m_keyframes.push_back(entry.is_keyframe);
+  ++m_num_entries;
+}
+
+void
+qt_sample_index_c::expand_block(std::size_t block)
+  const {
+  auto const num_entries = std::min(ENTRIES_PER_BLOCK, m_num_entries - block * ENTRIES_PER_BLOCK);
+  auto ptr               = m_data.data() + m_block_offsets[block];
+  auto previous          = qt_index_t{};
+
+  m_expanded.clear();
+  m_expanded.reserve(ENTRIES_PER_BLOCK);
+
+  while (m_expanded.size() < num_entries) {
+    auto flags     = *ptr++;
+    auto predicted = predict_following(previous);
+
+    if (!(flags & 0x0f)) {
+      for (auto num_in_run = (flags >> 4) + 1; num_in_run > 0; --num_in_run) {
+        m_expanded.push_back(predicted);
+        predicted = predict_following(predicted);
+      }
+
+      previous = m_expanded.back();
+      continue;
+    }
+
+    if (flags & EXPLICIT_FILE_POS)
+      predicted.file_pos  += get_signed_number(ptr);
+    if (flags & EXPLICIT_SIZE)
+      predicted.size       = static_cast<uint32_t>(get_number(ptr));
+    if (flags & EXPLICIT_DURATION)
+      predicted.duration  += get_signed_number(ptr);
+    if (flags & EXPLICIT_TIMESTAMP)
+      predicted.timestamp += get_signed_number(ptr);
+
+    m_expanded.push_back(predicted);
+    previous = predicted;
+  }
+
+  m_expanded_block = block;
+}
+
+qt_index_t
+qt_sample_index_c::get(std::size_t idx)
+  const {
+  assert(idx < m_num_entries);
+
+  auto block = idx / ENTRIES_PER_BLOCK;
+
+  if (!m_expanded_block || (*m_expanded_block != block))
+    expand_block(block);
+
+  auto entry         = m_expanded[idx % ENTRIES_PER_BLOCK];
+  entry.timestamp   += m_timestamp_offset;
+  entry.is_keyframe  = m_keyframes[idx];
+
+  return entry;
+}
+
+void
+qt_sample_index_c::set_keyframe(std::size_t idx) {
+  m_keyframes[idx] = true;
+}
+
+void
+qt_sample_index_c::adjust_timestamps(int64_t delta) {
+  m_timestamp_offset += delta;
+}
+
+void
+qt_sample_index_c::erase_front(std::size_t num_entries) {
+  qt_sample_index_c remaining;
+
+  for (auto idx = std::min(num_entries, m_num_entries); idx < m_num_entries; ++idx)
+    remaining.push_back(get(idx));
+
+  *this = std::move(remaining);
+}
+
+void
+qt_sample_index_c::shrink_to_fit() {
+  m_data.shrink_to_fit();
+  m_block_offsets.shrink_to_fit();
+  m_keyframes.shrink_to_fit();
+}
+
+void
+qt_sample_index_c::clear() {
+  *this = qt_sample_index_c{};
+}
+
+uint64_t
+qt_sample_index_c::get_memory_usage()
+  const {
+  return m_data.capacity()
+       + m_block_offsets.capacity() * sizeof(std::size_t)
+       + m_keyframes.capacity()     / 8
+       + m_expanded.capacity()      * sizeof(qt_index_t);
+}
+
+// ------------------------------------------------------------
+
+void
+qt_file_order_index_c::push_back(qt_file_order_entry_t const &entry) {
+  if (   !m_runs.empty()
+      && (m_runs.back().dmx_idx                               == entry.dmx_idx)
+      && ((m_runs.back().index_idx + m_runs.back().num_entries) == entry.index_idx))
+    ++m_runs.back().num_entries;
+
+  else
+    m_runs.push_back({ entry.dmx_idx, entry.index_idx, 1 });
+
+  ++m_num_entries;
+}
+
+std::optional<qt_file_order_entry_t>
+qt_file_order_index_c::get(std::size_t offset)
+  const {
+  offset += m_run_offset;
+
+  for (auto run_idx = m_run_idx; run_idx < m_runs.size(); ++run_idx) {
+    auto const &run = m_runs[run_idx];
+
+    if (offset < run.num_entries)
+      return qt_file_order_entry_t{ run.dmx_idx, static_cast<uint32_t>(run.index_idx + offset) };
+
+    offset -= run.num_entries;
+  }
+
+  return {};
+}
+
+void
+qt_file_order_index_c::skip_in_current_run(std::size_t num_entries) {
+  if (m_run_idx >= m_runs.size())
+    return;
+
+  m_run_offset += num_entries;
+
+  if (m_run_offset < m_runs[m_run_idx].num_entries)
+    return;
+
+  ++m_run_idx;
+  m_run_offset = 0;
+}
+
+uint64_t
+qt_file_order_index_c::get_memory_usage()
+  const {
+  return m_runs.capacity() * sizeof(run_t);
+}
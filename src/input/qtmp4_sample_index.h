@@ -0,0 +1,138 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit https://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+
+   the compact sample index of the Quicktime & MP4 reader
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#pragma once
+
+#include "common/common_pch.h"
+
+// One entry per sample that will be read. Sample sizes are limited to
+// 32 bits by the 'stsz' atom anyway. Bigger chunks of uncompressed
+// audio are split into several entries.
+struct qt_index_t {
+  int64_t  file_pos;
+  int64_t  timestamp, duration;
+  uint32_t size;
+  bool     is_keyframe;
+
+  qt_index_t()
+    : file_pos{}
+    , timestamp{}
+    , duration{}
+    , size{}
+    , is_keyframe{}
+  {
+  };
+
+  qt_index_t(int64_t p_file_pos, uint32_t p_size, int64_t p_timestamp, int64_t p_duration, bool p_is_keyframe)
+    : file_pos{p_file_pos}
+    , timestamp{p_timestamp}
+    , duration{p_duration}
+    , size{p_size}
+    , is_keyframe{p_is_keyframe}
+  {
+  }
+};
+
+// There can be several million samples in long files. Instead of
+// storing all of their entries the index stores each entry as the
+// difference to the values predicted from the previous one, just like
+// the 'stsz', 'stco' & 'stts' atoms describe runs of samples: each
+// sample starts where the previous one ended, has the same size &
+// duration and starts when the previous one ends. Runs of samples
+// matching the prediction take a single byte for up to 16 samples.
+//
+// The entries are grouped into blocks which can be decoded on their
+// own. Entries are expanded on demand one block at a time.
+class qt_sample_index_c {
+public:
+  static constexpr std::size_t ENTRIES_PER_BLOCK = 256;
+
+protected:
+  std::vector<uint8_t> m_data;
+  std::vector<std::size_t> m_block_offsets;
+  std::vector<bool> m_keyframes;
+  std::size_t m_num_entries{};
+
+  // Added to all timestamps when entries are expanded.
+  int64_t m_timestamp_offset{};
+
+  // The encoder's state: the previous entry & the position of the
+  // last run in m_data if it can still be extended.
+  qt_index_t m_previous;
+  std::optional<std::size_t> m_run_pos;
+
+  // The most recently expanded block.
+  mutable std::vector<qt_index_t> m_expanded;
+  mutable std::optional<std::size_t> m_expanded_block;
+
+public:
+  void push_back(qt_index_t const &entry);
+  template<typename... Args> void
+  emplace_back(Args &&... args) {
+    push_back(qt_index_t(std::forward<Args>(args)...));
+  }
+
+  qt_index_t get(std::size_t idx) const;
+  qt_index_t operator [](std::size_t idx) const {
+    return get(idx);
+  }
+
+  std::size_t size() const {
+    return m_num_entries;
+  }
+  bool empty() const {
+    return !m_num_entries;
+  }
+
+  void set_keyframe(std::size_t idx);
+  void adjust_timestamps(int64_t delta);
+  void erase_front(std::size_t num_entries);
+  void shrink_to_fit();
+  void clear();
+
+  uint64_t get_memory_usage() const;
+
+protected:
+  void expand_block(std::size_t block) const;
+};
+
+struct qt_file_order_entry_t {
+  uint32_t dmx_idx{}, index_idx{};
+};
+
+// All tracks' samples sorted by their position in the file. Well
+// interleaved files store several consecutive samples of one track
+// next to each other. Therefore the index only stores runs of
+// consecutive samples of the same track just like the sample index
+// only stores what cannot be predicted. It is read front to back.
+class qt_file_order_index_c {
+protected:
+  struct run_t {
+    uint32_t dmx_idx{}, index_idx{}, num_entries{};
+  };
+
+  std::vector<run_t> m_runs;
+  std::size_t m_num_entries{}, m_run_idx{}, m_run_offset{};
+
+public:
+  void push_back(qt_file_order_entry_t const &entry);
+
+  std::optional<qt_file_order_entry_t> get(std::size_t offset = 0) const;
+  void skip_in_current_run(std::size_t num_entries);
+
+  std::size_t size() const {
+    return m_num_entries;
+  }
+
+  uint64_t get_memory_usage() const;
+};
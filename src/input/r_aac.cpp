@@ -83,6 +83,8 @@ aac_reader_c::read_headers() {
         || (mtx::includes(m_ti.m_all_aac_is_sbr, -1) && !m_ti.m_all_aac_is_sbr[-1]))
       m_aacheader.config.profile = detected_profile;
 
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
     throw mtx::input::open_x();
   }
@@ -143,6 +145,8 @@ aac_reader_c::find_valid_headers(mm_io_c &in,
     in.setFilePointer(0);
 
     return mtx::aac::parser_c::find_consecutive_frames(buf->get_buffer(), num_read, num_headers);
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
     return -1;
   }
@@ -113,6 +113,8 @@ ac3_reader_c::find_valid_headers(mm_io_c &in,
 
     return pos;
 
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
     return -1;
   }
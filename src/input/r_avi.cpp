@@ -169,6 +169,8 @@ avi_reader_c::parse_subtitle_chunks() {
           m_subtitle_demuxers.push_back(demuxer);
       }
 
+    } catch (mtx::output::captured_error_x &) {
+      throw;
     } catch (...) {
     }
   }
@@ -136,9 +136,7 @@ coreaudio_reader_c::read(generic_packetizer_c *,
 
   try {
     m_in->setFilePointer(m_current_packet->m_position);
-    auto mem = memory_c::alloc(m_current_packet->m_size);
-    if (m_in->read(mem, m_current_packet->m_size) != m_current_packet->m_size)
-      throw false;
+    auto mem = m_in->read_shared(m_current_packet->m_size);
 
     ptzr(0).process(std::make_shared<packet_t>(mem, m_current_packet->m_timestamp * m_frames_to_timestamp, m_current_packet->m_duration * m_frames_to_timestamp));
 
@@ -173,6 +171,8 @@ coreaudio_reader_c::scan_chunks() {
       m_in->setFilePointer(chunk.m_size, libebml::seek_current);
 
     }
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
   }
 }
@@ -221,6 +221,8 @@ coreaudio_reader_c::read_chunk(std::string const &type,
   } catch (mtx::input::header_parsing_x &) {
     throw;
 
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
     debug_error_and_throw(fmt::format("Generic error reading the '{0}' chunk", type));
   }
@@ -255,6 +257,8 @@ coreaudio_reader_c::parse_desc_chunk() {
 
   } catch (mtx::mm_io::exception &ex) {
     debug_error_and_throw(fmt::format("I/O exception during 'desc' parsing: {0}", ex.what()));
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
     debug_error_and_throw(fmt::format("Unknown exception during 'desc' parsing"));
   }
@@ -298,6 +302,8 @@ coreaudio_reader_c::parse_pakt_chunk() {
 
   } catch (mtx::mm_io::exception &ex) {
     debug_error_and_throw(fmt::format("I/O exception during 'pakt' parsing: {0}", ex.what()));
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
     debug_error_and_throw(fmt::format("Unknown exception during 'pakt' parsing"));
   }
@@ -61,6 +61,8 @@ dirac_es_reader_c::read_headers() {
 
     m_in->setFilePointer(0);
 
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
     throw mtx::input::open_x();
   }
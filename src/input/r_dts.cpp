@@ -68,6 +68,8 @@ dts_reader_c::read_headers() {
       throw mtx::input::header_parsing_x();
     m_in->setFilePointer(m_current_chunk->data_start);
 
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
     throw mtx::input::open_x();
   }
@@ -21,6 +21,7 @@
 #include "common/id_info.h"
 #include "common/id3.h"
 #include "common/mime.h"
+#include "common/mm_io_x.h"
 #include "input/r_flac.h"
 #include "merge/input_x.h"
 #include "merge/file_status.h"
@@ -61,6 +62,8 @@ flac_reader_c::read_headers() {
       block_size += current_block->len;
     }
 
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (mtx::exception &) {
     mxerror(Y("flac_reader: could not initialize the FLAC packetizer.\n"));
   }
@@ -168,10 +171,13 @@ flac_reader_c::read(generic_packetizer_c *,
   if (current_block == blocks.end())
     return flush_packetizers();
 
-  memory_cptr buf = memory_c::alloc(current_block->len);
+  memory_cptr buf;
   m_in->setFilePointer(current_block->filepos + tag_size_start);
-  if (m_in->read(buf, current_block->len) != current_block->len)
+  try {
+    buf = m_in->read_shared(current_block->len);
+  } catch (mtx::mm_io::exception &) {
     return flush_packetizers();
+  }
 
   unsigned int samples_here = mtx::flac::get_num_samples(buf->get_buffer(), current_block->len, stream_info);
   ptzr(0).process(std::make_shared<packet_t>(buf, samples * 1000000000 / sample_rate));
@@ -228,6 +228,8 @@ flv_track_c::extract_flv1_width_and_height() {
       m_v_height      = dimensions.second;
     }
 
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (mtx::exception &) {
   }
 
@@ -275,6 +277,8 @@ flv_reader_c::read_headers() {
       m_in->setFilePointer(m_tag.m_next_position);
     }
 
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
     throw mtx::input::invalid_format_x();
   }
@@ -18,6 +18,7 @@
 #include "common/endian.h"
 #include "common/ivf.h"
 #include "common/id_info.h"
+#include "common/mm_io_x.h"
 #include "input/r_ivf.h"
 #include "output/p_av1.h"
 #include "output/p_vpx.h"
@@ -114,8 +115,10 @@ ivf_reader_c::read(generic_packetizer_c *,
     return flush_packetizers();
   }
 
-  memory_cptr buffer = memory_c::alloc(frame_size);
-  if (m_in->read(buffer->get_buffer(), frame_size) < frame_size) {
+  memory_cptr buffer;
+  try {
+    buffer = m_in->read_shared(frame_size);
+  } catch (mtx::mm_io::exception &) {
     m_in->setFilePointer(0, libebml::seek_end);
     return flush_packetizers();
   }
@@ -65,9 +65,12 @@
 #include "common/tags/tags.h"
 #include "common/tags/vorbis.h"
 #include "common/id_info.h"
+#include "common/vint.h"
 #include "common/vobsub.h"
 #include "input/r_matroska.h"
+#include "merge/cluster_helper.h"
 #include "merge/file_status.h"
+#include "merge/filelist.h"
 #include "merge/input_x.h"
 #include "merge/output_control.h"
 #include "output/p_aac.h"
@@ -154,6 +157,10 @@ remap_uids(libebml::EbmlMaster &master,
 
 constexpr auto MAGIC_MKV = 0x1a45dfa3;
 
+// Clusters up to this size are read with a single read operation and
+// their blocks decoded without libebml.
+constexpr uint64_t MAX_ITERATED_CLUSTER_SIZE = 256 * 1024 * 1024;
+
 } // anonymous namespace
 
 void
@@ -408,6 +415,8 @@ kax_reader_c::unlace_vorbis_private_data(kax_track_t *t,
     for (auto const &header : t->headers)
       header->take_ownership();
 
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
     return false;
   }
@@ -494,6 +503,8 @@ kax_reader_c::verify_dts_audio_track(kax_track_t *t) {
     t->a_channels = t->dts_header.get_total_num_audio_channels();
     t->codec.set_specialization(t->dts_header.get_codec_specialization());
 
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
     return false;
   }
@@ -576,6 +587,8 @@ kax_reader_c::verify_truehd_audio_track(kax_track_t *t) {
       num_frames_to_probe *= 20;
     }
 
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
   }
 
@@ -596,6 +609,8 @@ kax_reader_c::verify_ac3_audio_track(kax_track_t *t) {
       return true;
     }
 
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
   }
 
@@ -1570,6 +1585,8 @@ kax_reader_c::handle_seek_head(mm_io_c *io,
         m_deferred_l1_positions[type].push_back(new_seek_pos);
     }
 
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
     return;
   }
@@ -1623,6 +1640,8 @@ kax_reader_c::find_level1_elements_via_analyzer() {
     analyzer->with_elements(EBML_ID(libmatroska::KaxChapters),    [this](kax_analyzer_data_c const &data) { m_deferred_l1_positions[dl1t_chapters   ].push_back(data.m_pos); });
     analyzer->with_elements(EBML_ID(libmatroska::KaxTags),        [this](kax_analyzer_data_c const &data) { m_deferred_l1_positions[dl1t_tags       ].push_back(data.m_pos); });
 
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
   }
 }
@@ -1760,6 +1779,8 @@ kax_reader_c::read_headers_internal() {
 
     read_deferred_level1_elements(static_cast<libmatroska::KaxSegment &>(*l0));
 
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
     mxwarn(fmt::format("{0} {1} {2}\n",
                        fmt::format(FY("{0}: an unknown exception occurred."), "kax_reader_c::read_headers_internal()"),
@@ -1836,6 +1857,70 @@ kax_reader_c::init_passthrough_packetizer(kax_track_t *t,
 
 }
 
+/** \brief Determines whether the clusters can be copied block by block
+
+   In fast remuxing mode the blocks of the selected tracks are copied
+   to the destination file as they are; only their track numbers are
+   changed. This is only valid if nothing the user has requested
+   requires the frames' content, their timestamps or the way they're
+   stored to change.
+*/
+bool
+kax_reader_c::can_copy_blocks(std::string &error_message)
+  const {
+  if (g_files.size() > 1)
+    error_message = Y("More than one source file is used.");
+
+  else if (g_cluster_helper->splitting())
+    error_message = Y("Splitting is active.");
+
+  else if (g_cluster_helper->get_chapter_generation_mode() != chapter_generation_mode_e::none)
+    error_message = Y("Chapters are to be generated.");
+
+  else if (g_no_lacing || mtx::hacks::is_engaged(mtx::hacks::NO_SIMPLE_BLOCKS))
+    error_message = Y("Lacing or SimpleBlocks are disabled.");
+
+  else if (g_write_meta_seek_for_clusters)
+    error_message = Y("Clusters are to be indexed in the meta seek element.");
+
+  else if (m_global_timestamp_offset)
+    error_message = Y("The file contains negative timestamps.");
+
+  if (!error_message.empty())
+    return false;
+
+  for (auto const &t : m_tracks) {
+    if (!t->ok || !demuxing_requested(t->type, t->tnum, t->effective_language))
+      continue;
+
+    auto requested = [&t](auto const &specs) {
+      return mtx::includes(specs, static_cast<int64_t>(t->tnum)) || mtx::includes(specs, -1);
+    };
+
+    if (t->content_decoder.has_encodings())
+      error_message = Y("The frames are compressed or encrypted.");
+
+    else if (requested(m_ti.m_timestamp_syncs) || requested(m_ti.m_reset_timestamps_specs) || requested(m_ti.m_all_ext_timestamps))
+      error_message = Y("The timestamps are to be modified.");
+
+    else if (requested(m_ti.m_default_durations) || requested(m_ti.m_fix_bitstream_frame_rate_flags))
+      error_message = Y("The default duration is to be modified.");
+
+    else if (requested(m_ti.m_compression_list))
+      error_message = Y("The compression is to be modified.");
+
+    else if (requested(m_ti.m_sub_charsets) || requested(m_ti.m_all_aac_is_sbr) || requested(m_ti.m_reduce_to_core) || requested(m_ti.m_remove_dialog_normalization_gain))
+      error_message = Y("The content is to be modified.");
+
+    if (!error_message.empty()) {
+      error_message = fmt::format(FY("Track {0}: {1}"), t->tnum, error_message);
+      return false;
+    }
+  }
+
+  return true;
+}
+
 void
 kax_reader_c::set_packetizer_headers(kax_track_t *t) {
   if (m_appending)
@@ -2293,10 +2378,13 @@ kax_reader_c::create_packetizer(int64_t tid) {
   if (t->tags && demuxing_requested('T', t->tnum))
     nti.m_tags       = clone(t->tags);
 
-  if (mtx::hacks::is_engaged(mtx::hacks::FORCE_PASSTHROUGH_PACKETIZER)) {
+  if (m_block_copier || mtx::hacks::is_engaged(mtx::hacks::FORCE_PASSTHROUGH_PACKETIZER)) {
     init_passthrough_packetizer(t, nti);
     set_packetizer_headers(t);
 
+    if (m_block_copier)
+      m_block_copier->add_track(t->tnum, *t->ptzr_ptr);
+
     return;
   }
 
@@ -2330,6 +2418,15 @@ void
 kax_reader_c::create_packetizers() {
   m_in->save_pos();
 
+  if (g_fast_remux) {
+    std::string error_message;
+
+    if (can_copy_blocks(error_message))
+      m_block_copier = std::make_unique<mtx::merge::block_copier_c>(m_tc_scale);
+    else
+      mxwarn_fn(m_ti.m_fname, fmt::format(FY("Fast remuxing is not possible: {0} The file will be processed normally.\n"), error_message));
+  }
+
   for (auto &track : m_tracks)
     create_packetizer(track->tnum);
 
@@ -2454,6 +2551,8 @@ kax_reader_c::read_first_frames(kax_track_t *t,
       if (t->first_frames_data.size() >= num_wanted)
         break;
     }
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
   }
 }
@@ -2475,6 +2574,12 @@ kax_reader_c::read(generic_packetizer_c *requested_ptzr,
   }
 
   try {
+    if (m_block_copier && copy_cluster_with_block_iterator())
+      return FILE_STATUS_MOREDATA;
+
+    if (read_cluster_with_block_iterator())
+      return FILE_STATUS_MOREDATA;
+
     auto cluster = m_in_file->read_next_cluster();
     if (!cluster)
       return finish_file();
@@ -2503,6 +2608,11 @@ kax_reader_c::read(generic_packetizer_c *requested_ptzr,
   return FILE_STATUS_MOREDATA;
 }
 
+void
+kax_reader_c::follow_growing_input(std::shared_ptr<mm_follow_io_c> const &) {
+  m_in_file->follow_growing_file();
+}
+
 file_status_e
 kax_reader_c::finish_file() {
   flush_packetizers();
@@ -2513,6 +2623,189 @@ kax_reader_c::finish_file() {
   return FILE_STATUS_DONE;
 }
 
+bool
+kax_reader_c::read_cluster_with_block_iterator() {
+  // Anything but a cluster with a known size and a valid structure,
+  // e.g. other level 1 elements or damaged data requiring a resync,
+  // is left to kax_file_c.
+  auto segment_end = m_in_file->get_segment_end();
+  if (!segment_end)
+    segment_end = m_in->get_size();
+
+  if ((m_in->getFilePointer() >= segment_end) || !m_block_iterator.load_cluster(*m_in, segment_end, MAX_ITERATED_CLUSTER_SIZE))
+    return false;
+
+  auto cluster_timestamp = m_block_iterator.get_timestamp();
+
+  while (auto block = m_block_iterator.next())
+    process_block(*block, cluster_timestamp);
+
+  return true;
+}
+
+bool
+kax_reader_c::copy_cluster_with_block_iterator() {
+  static auto const s_cluster_id = EBML_ID(libmatroska::KaxCluster).GetValue();
+
+  // The blocks' timestamps are copied unchanged. The destination
+  // file's timestamp scale is only known once its headers have been
+  // written.
+  if (static_cast<int64_t>(m_tc_scale) != static_cast<int64_t>(g_timestamp_scale)) {
+    stop_copying_blocks(Y("The destination file's timestamp scale differs from the source file's."));
+    return false;
+  }
+
+  auto segment_end = m_in_file->get_segment_end();
+  if (!segment_end)
+    segment_end = m_in->get_size();
+
+  try {
+    // Other level 1 elements between clusters, e.g. EBML Void
+    // elements, are skipped just like kax_file_c does.
+    while (m_in->getFilePointer() < segment_end) {
+      if (m_block_iterator.load_cluster(*m_in, segment_end, MAX_ITERATED_CLUSTER_SIZE)) {
+        m_block_copier->copy_cluster(m_block_iterator);
+        return true;
+      }
+
+      auto position = m_in->getFilePointer();
+      auto id       = vint_c::read_ebml_id(*m_in);
+      auto size     = vint_c::read(*m_in);
+
+      if (   !id.is_valid()
+          || !size.is_valid()
+          || size.is_unknown()
+          || (id.m_value == s_cluster_id)
+          || ((m_in->getFilePointer() + size.m_value) > segment_end)) {
+        m_in->setFilePointer(position);
+        stop_copying_blocks(fmt::format(FY("The element at position {0} cannot be copied."), position));
+        return false;
+      }
+
+      m_in->setFilePointer(size.m_value, libebml::seek_current);
+    }
+
+  } catch (mtx::mm_io::exception &ex) {
+    stop_copying_blocks(ex.what());
+  }
+
+  return false;
+}
+
+// Everything copied so far has been written already. Switching to
+// creating packets from here on keeps the order in the destination
+// file intact.
+void
+kax_reader_c::stop_copying_blocks(std::string const &reason) {
+  mxwarn_fn(m_ti.m_fname, fmt::format(FY("Fast remuxing stopped: {0} The rest of the file will be processed normally.\n"), reason));
+  m_block_copier.reset();
+}
+
+void
+kax_reader_c::process_block(mtx::kax::block_t const &block,
+                            uint64_t cluster_timestamp) {
+  // This mirrors process_simple_block() & process_block_group() for
+  // blocks decoded by the block iterator.
+  auto const &header    = block.header;
+  auto const tc_scale   = static_cast<int64_t>(m_tc_scale);
+  auto const num_frames = block.frames.size();
+  auto block_track      = find_track_by_num(header.track_number);
+  auto block_timestamp  = (static_cast<int64_t>(cluster_timestamp) + header.relative_timestamp) * tc_scale - m_global_timestamp_offset;
+
+  if (!block_track) {
+    if (!m_known_bad_track_numbers[header.track_number])
+      mxwarn_fn(m_ti.m_fname,
+                fmt::format(FY("A block was found at timestamp {0} for track number {1}. However, no headers were found for that track number. "
+                               "The block will be skipped.\n"), mtx::string::format_timestamp(block_timestamp), header.track_number));
+    return;
+  }
+
+  auto block_duration = header.duration                   ? static_cast<int64_t>(*header.duration * m_tc_scale / std::max<std::size_t>(num_frames, 1))
+                      : 0 < block_track->default_duration ? block_track->default_duration
+                      :                                     int64_t{-1};
+  auto frame_duration = -1 == block_duration ? int64_t{0} : block_duration;
+
+  if (block_track->ignore_duration_hack) {
+    frame_duration = 0;
+    if (0 < block_duration)
+      block_duration = 0;
+  }
+
+  m_last_timestamp = block_timestamp;
+  if (0 < num_frames)
+    m_in_file->set_last_timestamp(m_last_timestamp + (num_frames - 1) * frame_duration);
+
+  if (-1 == block_track->ptzr) {
+    if (header.is_simple_block) {
+      block_track->previous_timestamp  = m_last_timestamp;
+      block_track->units_processed    += num_frames;
+    }
+    return;
+  }
+
+  auto block_bref = int64_t{VFT_IFRAME};
+  auto block_fref = int64_t{VFT_NOBFRAME};
+
+  if (header.is_simple_block) {
+    if (!header.is_key_frame()) {
+      if (header.is_discardable())
+        block_fref = block_track->previous_timestamp;
+      else
+        block_bref = block_track->previous_timestamp;
+    }
+
+  } else {
+    for (auto reference : block.references) {
+      if (0 >= reference)
+        block_bref = reference * tc_scale + m_last_timestamp;
+      else
+        block_fref = reference * tc_scale + m_last_timestamp;
+    }
+  }
+
+  for (auto frame_idx = 0u; frame_idx < num_frames; ++frame_idx) {
+    auto data = block.frames[frame_idx];
+    block_track->content_decoder.reverse(data, CONTENT_ENCODING_SCOPE_BLOCK);
+
+    auto packet = std::make_shared<packet_t>(data, m_last_timestamp + frame_idx * frame_duration, block_duration, block_bref, block_fref);
+
+    if (header.is_simple_block) {
+      packet->key_flag         = header.is_key_frame();
+      packet->discardable_flag = header.is_discardable();
+
+    } else {
+      packet->duration_mandatory = block_track->passthrough ? !!header.duration : (header.duration && !*header.duration);
+
+      if (block.codec_state)
+        packet->codec_state = block.codec_state->clone();
+
+      if (block.discard_padding)
+        packet->discard_padding = timestamp_c::ns(*block.discard_padding);
+
+      for (auto const &addition : block.additions) {
+        block_add_t add{ addition.data };
+
+        block_track->content_decoder.reverse(add.data, CONTENT_ENCODING_SCOPE_BLOCK);
+
+        add.id = addition.id;
+        packet->data_adds.push_back(add);
+
+        if (m_is_webm)
+          block_track->register_use_of_webm_block_addition_id(add.id.value());
+      }
+    }
+
+    ptzr(block_track->ptzr).process(packet);
+  }
+
+  // Block groups in passthrough mode have never updated these.
+  if (!header.is_simple_block && block_track->passthrough)
+    return;
+
+  block_track->previous_timestamp  = m_last_timestamp;
+  block_track->units_processed    += num_frames;
+}
+
 void
 kax_reader_c::process_simple_block(libmatroska::KaxCluster *cluster,
                                    libmatroska::KaxSimpleBlock *block_simple) {
@@ -2825,6 +3118,8 @@ kax_reader_c::determine_minimum_timestamps() {
         }
       }
 
+    } catch (mtx::output::captured_error_x &) {
+      throw;
     } catch (...) {
       break;
     }
@@ -22,9 +22,11 @@
 #include "common/content_decoder.h"
 #include "common/dts.h"
 #include "common/error.h"
+#include "common/kax_block_iterator.h"
 #include "common/kax_file.h"
 #include "common/mm_io.h"
 #include "merge/block_addition_mapping.h"
+#include "merge/block_copier.h"
 #include "merge/generic_reader.h"
 #include "merge/track_info.h"
 
@@ -202,6 +204,8 @@ private:
   uint64_t m_tc_scale;
 
   kax_file_cptr m_in_file;
+  mtx::kax::block_iterator_c m_block_iterator;
+  std::unique_ptr<mtx::merge::block_copier_c> m_block_copier;
 
   std::shared_ptr<libebml::EbmlStream> m_es;
 
@@ -236,6 +240,7 @@ public:
   }
 
   virtual void read_headers();
+  virtual void follow_growing_input(std::shared_ptr<mm_follow_io_c> const &follow_in) override;
 
   virtual void set_headers();
   virtual void identify();
@@ -251,6 +256,7 @@ protected:
 
   virtual void set_track_packetizer(kax_track_t *t, generic_packetizer_c *packetizer);
   virtual void init_passthrough_packetizer(kax_track_t *t, track_info_c &nti);
+  virtual bool can_copy_blocks(std::string &error_message) const;
   virtual void set_packetizer_headers(kax_track_t *t);
   virtual void read_first_frames(kax_track_t *t, unsigned num_wanted = 1);
   virtual kax_track_t *find_track_by_num(uint64_t num, kax_track_t *c = nullptr);
@@ -326,6 +332,10 @@ protected:
   virtual void read_deferred_level1_elements(libmatroska::KaxSegment &segment);
   virtual void find_level1_elements_via_analyzer();
 
+  virtual bool read_cluster_with_block_iterator();
+  virtual bool copy_cluster_with_block_iterator();
+  virtual void stop_copying_blocks(std::string const &reason);
+  virtual void process_block(mtx::kax::block_t const &block, uint64_t cluster_timestamp);
   virtual void process_simple_block(libmatroska::KaxCluster *cluster, libmatroska::KaxSimpleBlock *block_simple);
   virtual void process_block_group(libmatroska::KaxCluster *cluster, libmatroska::KaxBlockGroup *block_group);
   virtual void process_block_group_common(libmatroska::KaxBlockGroup *block_group, packet_t *packet, kax_track_t &track);
@@ -125,6 +125,8 @@ mp3_reader_c::find_valid_headers(mm_io_c &io,
     // auto result = find_consecutive_mp3_headers(buf->get_buffer(), nread, num_headers);
     // return -1 == result ? -1 : result + idx;
 
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
     return -1;
   }
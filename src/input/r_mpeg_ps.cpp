@@ -168,6 +168,8 @@ mpeg_ps_reader_c::read_headers() {
       done |= m_in->eof() || (m_in->getFilePointer() >= m_probe_range);
     } // while (!done)
 
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
   }
 
@@ -297,6 +299,8 @@ mpeg_ps_reader_c::parse_program_stream_map() {
       es_map_len -= 4 + plen;
     }
 
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
   }
 
@@ -436,6 +440,8 @@ mpeg_ps_reader_c::parse_packet(mpeg_ps_id_t id,
             packet.m_id.sub_id = bc.get_bits(8);
         }
       }
+    } catch (mtx::output::captured_error_x &) {
+      throw;
     } catch (...) {
     }
 
@@ -591,6 +597,8 @@ mpeg_ps_reader_c::new_stream_v_avc_or_mpeg_1_2(mpeg_ps_id_t id,
       return;
     }
 
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
   }
 
@@ -898,6 +906,8 @@ mpeg_ps_reader_c::new_stream_a_pcm(mpeg_ps_id_t,
     track->a_channels        = bc.get_bits(3) + 1;
     bc.skip_bits(8);            // dynamic range control(8)
 
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
     throw false;
   }
@@ -1078,6 +1088,8 @@ mpeg_ps_reader_c::found_new_stream(mpeg_ps_id_t id) {
   } catch (bool) {
     m_blocked_ids[id.idx()] = true;
 
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
     mxerror_fn(m_ti.m_fname, Y("Error parsing a MPEG PS packet during the header reading phase. This stream seems to be badly damaged.\n"));
   }
@@ -1187,6 +1199,8 @@ mpeg_ps_reader_c::resync_stream(uint32_t &header) {
 
     return true;
 
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
     mxdebug_if(m_debug_resync, "resync failed: exception caught\n");
     return false;
@@ -733,6 +733,8 @@ track_c::parse_dovi_pmt_descriptor(pmt_descriptor_t const &pmt_descriptor,
     mxdebug_if(reader.m_debug_dovi, fmt::format("parse_dovi_pmt_descriptor: I/O exception\n"));
     return false;
 
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
     mxdebug_if(reader.m_debug_dovi, fmt::format("parse_dovi_pmt_descriptor: unknown exception\n"));
     return false;
@@ -1312,6 +1314,8 @@ reader_c::detect_packet_size(mm_io_c &in,
         }
       }
     }
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
   }
 
@@ -1402,6 +1406,8 @@ reader_c::read_headers_for_file(std::size_t file_num) {
 
       setup_initial_tracks();
     }
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
     mxdebug_if(m_debug_headers, fmt::format("read_headers: caught exception\n"));
   }
@@ -1610,6 +1616,8 @@ reader_c::determine_global_timestamp_offset() {
 
       parse_packet(&buf[f.m_header_offset]);
     }
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
     mxdebug_if(m_debug_timestamp_offset, fmt::format("determine_global_timestamp_offset: caught exception\n"));
   }
@@ -2516,6 +2524,8 @@ reader_c::probe_packet_complete(track_c &track,
 
   try {
     result = determine_track_parameters(track, end_of_detection);
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
   }
 
@@ -2897,6 +2907,8 @@ reader_c::resync(int64_t start_at) {
       return true;
     }
 
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
     return false;
   }
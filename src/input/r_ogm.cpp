@@ -782,6 +782,8 @@ ogm_reader_c::handle_chapters(mtx::tags::vorbis_comments_t const &comments) {
                      :                                                                         timestamp_sync_t{};
     mtx::chapters::adjust_timestamps(*m_chapters, sync.displacement, sync.factor);
 
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
     m_exception_parsing_chapters = true;
   }
@@ -38,6 +38,7 @@
 #include "common/iso639.h"
 #include "common/list_utils.h"
 #include "common/math.h"
+#include "common/mm_follow_io.h"
 #include "common/mm_io_x.h"
 #include "common/mm_mem_io.h"
 #include "common/mm_proxy_io.h"
@@ -80,6 +81,26 @@
 
 constexpr auto MAX_INTERLEAVING_BADNESS = 0.4;
 
+// Samples that are stored close to each other are read with a single
+// read operation of up to this size. Gaps up to the given size are
+// read over instead of seeking.
+constexpr int64_t MAX_READ_WINDOW_SIZE = 4 * 1024 * 1024;
+constexpr int64_t MAX_READ_WINDOW_GAP  = 64 * 1024;
+
+// Samples are served in file order as long as the requested track's
+// next sample is at most this far away from the current position in
+// file order. Otherwise the requested track is served on its own in
+// order not to queue too much data for the other tracks.
+constexpr int64_t MAX_FILE_ORDER_DISTANCE = 16 * 1024 * 1024;
+
+// Number of fragments parsed along with the headers when streaming
+// fragments. More are parsed if a track hasn't had any samples yet.
+constexpr unsigned int NUM_INITIAL_FRAGMENTS = 4;
+
+// Chunks of uncompressed audio too big for an index entry are split
+// into pieces of about this size.
+constexpr uint64_t MAX_SPLIT_CHUNK_SIZE = 1024 * 1024 * 1024;
+
 namespace mtx {
 
 class atom_chunk_size_x: public exception {
@@ -203,11 +224,50 @@ qtmp4_reader_c::read_headers() {
   }
 }
 
+void
+qtmp4_reader_c::follow_growing_input(std::shared_ptr<mm_follow_io_c> const &follow_in) {
+  // Only fragmented files are extended by appending further fragments
+  // while they're written.
+  if (!m_parsed_fragments_end) {
+    mxwarn_fn(m_ti.m_fname, Y("The file is not a fragmented MP4 file. It will only be read up to its current end.\n"));
+    return;
+  }
+
+  m_follow_in         = follow_in;
+  m_stream_fragments  = true;
+  m_next_fragment_pos = *m_parsed_fragments_end;
+
+  update_num_bytes_to_process();
+
+  mxdebug_if(m_debug_headers, fmt::format("Following: parsing the next fragments starting at {0}\n", *m_next_fragment_pos));
+}
+
+void
+qtmp4_reader_c::wait_for_data(uint64_t end) {
+  // Seeking is limited to the file's current size.
+  if (m_follow_in)
+    m_follow_in->wait_for_size(end);
+}
+
 void
 qtmp4_reader_c::calculate_num_bytes_to_process() {
   for (auto const &dmx : m_demuxers)
     if (demuxing_requested(dmx->type, dmx->id, dmx->language))
-      m_bytes_to_process += std::accumulate(dmx->m_index.begin(), dmx->m_index.end(), 0ull, [](int64_t num, auto const &entry) { return num + entry.size; });
+      for (auto idx = 0u, num_entries = dmx->m_index.size(); idx < num_entries; ++idx)
+        m_indexed_bytes_to_process += dmx->m_index[idx].size;
+
+  update_num_bytes_to_process();
+}
+
+void
+qtmp4_reader_c::update_num_bytes_to_process() {
+  // Progress is measured in sample bytes delivered. When streaming
+  // fragments only the samples of the fragments parsed so far are
+  // known. The size of the rest of the file serves as an estimate for
+  // the remaining ones until they're parsed, too.
+  auto unparsed_size = !m_next_fragment_pos ? 0 : std::max<int64_t>(m_in->get_size() - static_cast<int64_t>(*m_next_fragment_pos), 0);
+
+  m_bytes_to_process = m_indexed_bytes_to_process + unparsed_size;
 }
 
 qt_atom_t
@@ -269,8 +329,12 @@ qtmp4_reader_c::parse_headers() {
 
   m_in->setFilePointer(0);
 
-  bool headers_parsed = false;
-  bool mdat_found     = false;
+  bool headers_parsed       = false;
+  bool mdat_found           = false;
+  auto num_fragments_parsed = 0u;
+
+  m_stream_fragments        = mtx::hacks::is_engaged(mtx::hacks::STREAM_MP4_FRAGMENTS);
+  m_file_order              = mtx::hacks::is_engaged(mtx::hacks::MP4_FILE_ORDER);
 
   try {
     while (!m_in->eof()) {
@@ -300,7 +364,26 @@ qtmp4_reader_c::parse_headers() {
         mdat_found = true;
 
       } else if (atom.fourcc == "moof") {
+        // The last fragment of a file that is still being written to
+        // may be incomplete. It's parsed once it has been completed.
+        if (m_ti.m_follow_idle_timeout && ((atom.pos + atom.size) > static_cast<uint64_t>(m_in->get_size()))) {
+          mxdebug_if(m_debug_headers, fmt::format("Following: incomplete 'moof' atom at {0}\n", atom.pos));
+          m_parsed_fragments_end = atom.pos;
+          break;
+        }
+
         handle_moof_atom(atom.to_parent(), 0, atom);
+        ++num_fragments_parsed;
+        m_parsed_fragments_end = atom.pos + atom.size;
+
+        if (m_stream_fragments && headers_parsed && initial_fragments_parsed(num_fragments_parsed)) {
+          // The fragment's data follows in an 'mdat' atom.
+          m_next_fragment_pos = atom.pos + atom.size;
+          mdat_found          = true;
+
+          mxdebug_if(m_debug_headers, fmt::format("Streaming fragments: stopping header parsing after {0} fragments; continuing at {1}\n", num_fragments_parsed, *m_next_fragment_pos));
+          break;
+        }
 
       } else if (atom.fourcc.human_readable())
         m_in->setFilePointer(atom.pos + atom.size);
@@ -335,6 +418,81 @@ qtmp4_reader_c::parse_headers() {
   create_global_tags_from_meta_data();
 }
 
+bool
+qtmp4_reader_c::initial_fragments_parsed(unsigned int num_fragments_parsed)
+  const {
+  if (num_fragments_parsed < NUM_INITIAL_FRAGMENTS)
+    return false;
+
+  // Codec detection requires each track's first samples.
+  return std::all_of(m_demuxers.begin(), m_demuxers.end(), [](qtmp4_demuxer_cptr const &dmx) { return !dmx->sample_table.empty(); });
+}
+
+bool
+qtmp4_reader_c::parse_next_fragment() {
+  if (!m_next_fragment_pos)
+    return false;
+
+  for (auto const &dmx : m_demuxers)
+    dmx->prepare_for_next_fragment();
+
+  auto moof_found = false;
+
+  try {
+    wait_for_data(*m_next_fragment_pos);
+    m_in->setFilePointer(*m_next_fragment_pos);
+    m_next_fragment_pos.reset();
+
+    while (!m_in->eof()) {
+      auto atom = read_atom(nullptr, false);
+
+      wait_for_data(atom.pos + atom.size);
+
+      if (atom.fourcc == "moof") {
+        handle_moof_atom(atom.to_parent(), 0, atom);
+
+        m_next_fragment_pos = atom.pos + atom.size;
+        moof_found          = true;
+
+        break;
+      }
+
+      m_in->setFilePointer(atom.pos + atom.size);
+    }
+
+  } catch (mtx::mm_io::exception &ex) {
+    mxdebug_if(m_debug_headers, fmt::format("Streaming fragments: I/O exception while looking for the next fragment: {0}\n", ex.what()));
+  } catch (mtx::atom_chunk_size_x &ex) {
+    mxdebug_if(m_debug_headers, fmt::format("Streaming fragments: atom exception while looking for the next fragment: {0}\n", ex.error()));
+  }
+
+  if (moof_found)
+    // Tracks that aren't read would otherwise collect index entries
+    // that are never delivered & therefore never dropped.
+    for (auto const &dmx : m_demuxers)
+      if (-1 != dmx->ptzr)
+        m_indexed_bytes_to_process += dmx->append_fragment_samples_to_index();
+
+  update_num_bytes_to_process();
+
+  return moof_found;
+}
+
+void
+qtmp4_reader_c::make_fragment_samples_available(generic_packetizer_c *packetizer) {
+  if (!m_stream_fragments)
+    return;
+
+  auto has_samples = [this, packetizer]() {
+    return std::any_of(m_demuxers.begin(), m_demuxers.end(), [this, packetizer](qtmp4_demuxer_cptr const &dmx) {
+      return (-1 != dmx->ptzr) && (&ptzr(dmx->ptzr) == packetizer) && (dmx->pos < dmx->m_index.size());
+    });
+  };
+
+  while (!has_samples() && parse_next_fragment())
+    ;
+}
+
 void
 qtmp4_reader_c::verify_track_parameters_and_update_indexes() {
   for (auto &dmx : m_demuxers) {
@@ -1101,6 +1259,8 @@ qtmp4_reader_c::handle_covr_atom(qt_atom_t parent,
       if (ATTACH_MODE_SKIP != attach_mode)
         add_attachment(attachment);
 
+    } catch (mtx::output::captured_error_x &) {
+      throw;
     } catch (mtx::exception const &ex) {
       mxdebug_if(m_debug_headers, fmt::format(fmt::runtime("{0}exception while reading cover art: {1}\n"), space((level + 1) * 2 + 1), ex.what()));
     }
@@ -1132,6 +1292,8 @@ qtmp4_reader_c::handle_ilst_metadata_atom(qt_atom_t parent,
       else if (fourcc == fourcc_c{0xa963'6d74u}) // ©cmt
         m_comment = content;
 
+    } catch (mtx::output::captured_error_x &) {
+      throw;
     } catch (mtx::exception const &ex) {
       mxdebug_if(m_debug_headers, fmt::format("{0}exception while reading title: {1}\n", space((level + 1) * 2 + 1), ex.what()));
     }
@@ -1628,34 +1790,151 @@ qtmp4_reader_c::handle_trak_atom(qtmp4_demuxer_c &dmx,
   mxdebug_if(m_debug_headers, fmt::format("{0}Codec determination result: {1} ok {2} type {3}\n", space(level * 2 + 1), dmx.codec.get_name(), dmx.ok, dmx.type));
 }
 
-file_status_e
-qtmp4_reader_c::read(generic_packetizer_c *packetizer,
-                     bool) {
-  size_t dmx_idx;
+void
+qtmp4_reader_c::build_file_order_index() {
+  m_file_order_index_built = true;
 
-  for (dmx_idx = 0; dmx_idx < m_demuxers.size(); ++dmx_idx) {
+  // Fragments are stored interleaved already; the index is extended
+  // fragment by fragment while reading.
+  if (m_stream_fragments)
+    return;
+
+  struct track_t {
+    uint32_t dmx_idx, index_idx;
+    int64_t file_pos;
+  };
+
+  std::vector<track_t> tracks;
+
+  for (auto dmx_idx = 0u; dmx_idx < m_demuxers.size(); ++dmx_idx) {
     auto &dmx = *m_demuxers[dmx_idx];
 
-    if ((-1 == dmx.ptzr) || (&ptzr(dmx.ptzr) != packetizer))
+    if (-1 == dmx.ptzr)
+      continue;
+
+    // Serving a track in file order requires its samples to be stored
+    // in the order they're presented in, which isn't the case e.g.
+    // with edit lists repeating parts of the track.
+    auto is_ordered = true;
+    auto file_pos   = dmx.pos < dmx.m_index.size() ? dmx.m_index[dmx.pos].file_pos : 0;
+
+    for (auto idx = dmx.pos + 1; is_ordered && (idx < dmx.m_index.size()); ++idx) {
+      auto previous_file_pos = file_pos;
+      file_pos               = dmx.m_index[idx].file_pos;
+      is_ordered             = previous_file_pos < file_pos;
+    }
+
+    if (!is_ordered) {
+      mxdebug_if(m_debug_interleaving, fmt::format("File order: track ID {0} isn't stored in presentation order; serving it separately\n", dmx.id));
       continue;
+    }
 
     if (dmx.pos < dmx.m_index.size())
+      tracks.push_back({ dmx_idx, static_cast<uint32_t>(dmx.pos), dmx.m_index[dmx.pos].file_pos });
+  }
+
+  // Each track's samples are sorted already. Merge them, preferring
+  // the first track for samples at the same position.
+  while (!tracks.empty()) {
+    auto track = std::min_element(tracks.begin(), tracks.end(), [](auto const &a, auto const &b) { return a.file_pos < b.file_pos; });
+    auto &dmx  = *m_demuxers[track->dmx_idx];
+
+    m_file_order_index.push_back({ track->dmx_idx, track->index_idx });
+
+    if (++track->index_idx < dmx.m_index.size())
+      track->file_pos = dmx.m_index[track->index_idx].file_pos;
+    else
+      tracks.erase(track);
+  }
+
+  mxdebug_if(m_debug_interleaving, fmt::format("File order: {0} samples in the file order index using {1} bytes\n", m_file_order_index.size(), m_file_order_index.get_memory_usage()));
+}
+
+qtmp4_demuxer_c *
+qtmp4_reader_c::next_demuxer_in_file_order(qtmp4_demuxer_c &requested_dmx) {
+  // Skip samples that have already been served on their own.
+  auto entry = m_file_order_index.get();
+
+  while (entry && (entry->index_idx < m_demuxers[entry->dmx_idx]->pos)) {
+    m_file_order_index.skip_in_current_run(m_demuxers[entry->dmx_idx]->pos - entry->index_idx);
+    entry = m_file_order_index.get();
+  }
+
+  if (!entry)
+    return nullptr;
+
+  auto &dmx     = *m_demuxers[entry->dmx_idx];
+  auto distance = requested_dmx.m_index[requested_dmx.pos].file_pos - dmx.m_index[entry->index_idx].file_pos;
+
+  // A negative distance means that the requested track isn't part of
+  // the file order index.
+  return (0 <= distance) && (distance <= MAX_FILE_ORDER_DISTANCE) ? &dmx : nullptr;
+}
+
+uint8_t const *
+qtmp4_reader_c::read_sample_data(qt_read_window_t &window,
+                                 qt_index_t const &index,
+                                 std::function<std::optional<qt_index_t>(std::size_t)> const &get_following_index) {
+  if (window.contains(index.file_pos, index.size))
+    return window.data->get_buffer() + (index.file_pos - window.start);
+
+  // Extend the range to read over the following samples as long as
+  // they're stored close enough to each other.
+  auto start = index.file_pos;
+  auto end   = index.file_pos + index.size;
+
+  for (auto offset = 1u; ; ++offset) {
+    auto following = get_following_index(offset);
+
+    if (   !following
+        || (following->file_pos <  start)
+        || (following->file_pos >  (end + MAX_READ_WINDOW_GAP))
+        || ((std::max(end, following->file_pos + following->size) - start) > MAX_READ_WINDOW_SIZE))
       break;
+
+    end = std::max(end, following->file_pos + following->size);
   }
 
-  if (m_demuxers.size() == dmx_idx)
-    return finish();
+  // The samples are handed over to the packetizers as slices of the
+  // window's buffer. It can only be reused once all of them are gone.
+  if (   !window.data
+      || (window.data.use_count() > 1)
+      || (static_cast<int64_t>(window.data->get_size()) < (end - start)))
+    window.data = memory_c::alloc(end - start);
 
-  auto &dmx   = *m_demuxers[dmx_idx];
-  auto &index = dmx.m_index[dmx.pos];
+  wait_for_data(end);
+  m_in->setFilePointer(start);
 
-  m_in->setFilePointer(index.file_pos);
+  window.start = start;
+  window.size  = m_in->read(window.data->get_buffer(), end - start);
+
+  if (!window.contains(index.file_pos, index.size)) {
+    window.data.reset();
+    return nullptr;
+  }
+
+  return window.data->get_buffer() + (index.file_pos - window.start);
+}
+
+bool
+qtmp4_reader_c::deliver_sample(qtmp4_demuxer_c &dmx,
+                               qt_read_window_t &window,
+                               std::function<std::optional<qt_index_t>(std::size_t)> const &get_following_index) {
+  auto index = dmx.m_index[dmx.pos];
+  auto data  = read_sample_data(window, index, get_following_index);
+
+  if (!data) {
+    mxwarn(fmt::format(FY("Quicktime/MP4 reader: Could not read chunk number {0}/{1} with size {2} from position {3}. Aborting.\n"),
+                       dmx.pos, dmx.m_index.size(), index.size, index.file_pos));
+    return false;
+  }
 
   int buffer_offset = 0;
   memory_cptr buffer;
 
   if (   dmx.is_video()
       && !dmx.pos
+      && !dmx.m_num_dropped_index_entries
       && dmx.codec.is(codec_c::type_e::V_MPEG4_P2)
       && dmx.esds_parsed
       && (dmx.esds.decoder_config)) {
@@ -1663,16 +1942,10 @@ qtmp4_reader_c::read(generic_packetizer_c *packetizer,
     buffer_offset = dmx.esds.decoder_config->get_size();
 
     memcpy(buffer->get_buffer(), dmx.esds.decoder_config->get_buffer(), dmx.esds.decoder_config->get_size());
+    memcpy(buffer->get_buffer() + buffer_offset, data, index.size);
 
-  } else {
-    buffer = memory_c::alloc(index.size);
-  }
-
-  if (m_in->read(buffer->get_buffer() + buffer_offset, index.size) != static_cast<uint64_t>(index.size)) {
-    mxwarn(fmt::format(FY("Quicktime/MP4 reader: Could not read chunk number {0}/{1} with size {2} from position {3}. Aborting.\n"),
-                       dmx.pos, dmx.m_index.size(), index.size, index.file_pos));
-    return finish();
-  }
+  } else
+    buffer = memory_c::share(window.data, data - window.data->get_buffer(), index.size);
 
   auto duration = dmx.m_use_frame_rate_for_duration ? *dmx.m_use_frame_rate_for_duration : index.duration;
   auto packet   = std::make_shared<packet_t>(buffer, index.timestamp, duration, index.is_keyframe ? VFT_IFRAME : VFT_PFRAMEAUTOMATIC, VFT_NOBFRAME);
@@ -1682,7 +1955,60 @@ qtmp4_reader_c::read(generic_packetizer_c *packetizer,
 
   m_bytes_processed += index.size;
 
-  if (dmx.pos < dmx.m_index.size())
+  return true;
+}
+
+file_status_e
+qtmp4_reader_c::read(generic_packetizer_c *packetizer,
+                     bool) {
+  size_t dmx_idx;
+
+  make_fragment_samples_available(packetizer);
+
+  for (dmx_idx = 0; dmx_idx < m_demuxers.size(); ++dmx_idx) {
+    auto &dmx = *m_demuxers[dmx_idx];
+
+    if ((-1 == dmx.ptzr) || (&ptzr(dmx.ptzr) != packetizer))
+      continue;
+
+    if (dmx.pos < dmx.m_index.size())
+      break;
+  }
+
+  if (m_demuxers.size() == dmx_idx)
+    return finish();
+
+  if (m_file_order && !m_file_order_index_built)
+    build_file_order_index();
+
+  // Serve the next sample in file order if the requested track's
+  // next sample is close by. This turns reading well-interleaved
+  // files into sequential I/O with large reads.
+  auto &requested_dmx = *m_demuxers[dmx_idx];
+  auto file_order_dmx = m_file_order ? next_demuxer_in_file_order(requested_dmx) : nullptr;
+  auto ok             = false;
+
+  if (file_order_dmx)
+    ok = deliver_sample(*file_order_dmx, m_read_window, [this](std::size_t offset) -> std::optional<qt_index_t> {
+      auto entry = m_file_order_index.get(offset);
+      if (!entry)
+        return {};
+      return m_demuxers[entry->dmx_idx]->m_index[entry->index_idx];
+    });
+
+  else
+    ok = deliver_sample(requested_dmx, requested_dmx.m_read_window, [&requested_dmx](std::size_t offset) -> std::optional<qt_index_t> {
+      if ((requested_dmx.pos + offset) >= requested_dmx.m_index.size())
+        return {};
+      return requested_dmx.m_index[requested_dmx.pos + offset];
+    });
+
+  if (!ok)
+    return finish();
+
+  make_fragment_samples_available(packetizer);
+
+  if (requested_dmx.pos < requested_dmx.m_index.size())
     return FILE_STATUS_MOREDATA;
 
   return finish();
@@ -2121,9 +2447,6 @@ qtmp4_reader_c::identify() {
 
   id_result_container(info.get());
 
-  if (m_tags)
-    id_result_tags(ID_RESULT_GLOBAL_TAGS_ID, mtx::tags::count_simple(*m_tags));
-
   for (i = 0; i < m_demuxers.size(); ++i) {
     auto &dmx = *m_demuxers[i];
     info      = mtx::id::info_c{};
@@ -2166,6 +2489,9 @@ qtmp4_reader_c::identify() {
 
   if (m_chapters)
     id_result_chapters(mtx::chapters::count_atoms(*m_chapters));
+
+  if (m_tags)
+    id_result_tags(ID_RESULT_GLOBAL_TAGS_ID, mtx::tags::count_simple(*m_tags));
 }
 
 void
@@ -2338,14 +2664,12 @@ qtmp4_demuxer_c::calculate_timestamps_constant_sample_size() {
 
   timestamps.reserve(timestamps.size() + chunk_table.size());
   durations.reserve(durations.size() + chunk_table.size());
-  frame_indices.reserve(frame_indices.size() + chunk_table.size());
 
   for (auto const &chunk : chunk_table) {
     auto frame_offset = chunk_index < num_frame_offsets ? frame_offset_table[chunk_index] : 0;
 
     timestamps.push_back(to_nsecs(static_cast<uint64_t>(chunk.samples) * track_duration + frame_offset));
     durations.push_back(to_nsecs(static_cast<uint64_t>(chunk.size)     * track_duration));
-    frame_indices.push_back(chunk_index);
 
     ++chunk_index;
   }
@@ -2361,12 +2685,10 @@ qtmp4_demuxer_c::calculate_timestamps_variable_sample_size() {
   timestamps.reserve(num_samples);
   timestamps_before_offsets.reserve(num_samples);
   durations.reserve(num_samples);
-  frame_indices.reserve(num_samples);
 
   for (int frame = 0; static_cast<int>(num_samples) > frame; ++frame) {
     auto timestamp = to_nsecs(sample_table[frame].pts);
 
-    frame_indices.push_back(frame);
     timestamps_before_offsets.push_back(timestamp);
     timestamps.push_back(timestamp + (static_cast<unsigned int>(frame) < num_frame_offsets ? to_nsecs(frame_offset_table[frame]) : 0));
   }
@@ -2400,6 +2722,8 @@ qtmp4_demuxer_c::calculate_timestamps() {
   if (m_timestamps_calculated)
     return;
 
+  auto start = std::chrono::steady_clock::now();
+
   if (0 != sample_size)
     calculate_timestamps_constant_sample_size();
   else
@@ -2415,17 +2739,46 @@ qtmp4_demuxer_c::calculate_timestamps() {
 
   build_index();
   apply_edit_list();
+  release_index_source_tables();
 
   m_timestamps_calculated = true;
+
+  mxdebug_if(m_debug_headers,
+             fmt::format("Track {0}: index built in {1}: {2} entries using {3} bytes\n",
+                         id, mtx::string::format_timestamp(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()),
+                         m_index.size(), m_index.get_memory_usage()));
+}
+
+void
+qtmp4_demuxer_c::release_index_source_tables() {
+  // Once the index has been built the intermediate timestamp tables
+  // as well as the tables only used for expanding the chunks into
+  // samples aren't needed anymore. The sample table itself is kept as
+  // it is used for detecting the interleaving & the frame rate.
+  auto bytes_released = (timestamps.capacity() + durations.capacity()) * sizeof(int64_t)
+                      + keyframe_table.capacity()         * sizeof(uint32_t)
+                      + raw_frame_offset_table.capacity() * sizeof(qt_frame_offset_t);
+
+  std::vector<int64_t>{}.swap(timestamps);
+  std::vector<int64_t>{}.swap(durations);
+  std::vector<uint32_t>{}.swap(keyframe_table);
+  std::vector<qt_frame_offset_t>{}.swap(raw_frame_offset_table);
+
+  if (0 == sample_size) {
+    bytes_released += chunk_table.capacity() * sizeof(qt_chunk_t);
+    std::vector<qt_chunk_t>{}.swap(chunk_table);
+  }
+
+  m_index.shrink_to_fit();
+
+  mxdebug_if(m_debug_headers, fmt::format("Track {0}: released {1} bytes of tables no longer needed after building the index\n", id, bytes_released));
 }
 
 void
 qtmp4_demuxer_c::adjust_timestamps(int64_t delta) {
-  for (auto &timestamp : timestamps)
-    timestamp += delta;
+  m_index.adjust_timestamps(delta);
 
-  for (auto &index : m_index)
-    index.timestamp += delta;
+  m_fragment_timestamp_shift += delta;
 }
 
 std::optional<int64_t>
@@ -2435,7 +2788,12 @@ qtmp4_demuxer_c::min_timestamp()
     return {};
   }
 
-  return std::accumulate(m_index.begin(), m_index.end(), std::numeric_limits<int64_t>::max(), [](int64_t min, auto const &entry) { return std::min(min, entry.timestamp); });
+  auto min = std::numeric_limits<int64_t>::max();
+
+  for (auto idx = 0u, num_entries = m_index.size(); idx < num_entries; ++idx)
+    min = std::min(min, m_index[idx].timestamp);
+
+  return min;
 }
 
 bool
@@ -2515,6 +2873,8 @@ qtmp4_demuxer_c::update_tables() {
     }
   }
 
+  m_next_sample_pts = pts;
+
   if (s < num_samples) {
     mxdebug_if(m_debug_headers, fmt::format("Track {0}: fewer timestamps assigned than entries in the sample table: {1} < {2}; dropping the excessive items\n", id, s, num_samples));
     sample_table.resize(s);
@@ -2566,15 +2926,31 @@ qtmp4_demuxer_c::apply_edit_list() {
              fmt::format("Applying edit list for track {0}: {1} entries; track time scale {2}, global time scale {3}\n",
                          id, editlist_table.size(), time_scale, m_reader.m_time_scale));
 
-  std::vector<qt_index_t> edited_index;
+  qt_sample_index_c edited_index;
+
+  // The timestamps of the entries taken over by an edit are shifted,
+  // and following edits see the shifted timestamps. The index itself
+  // cannot be modified, therefore the shifts are recorded per range.
+  std::vector<std::tuple<uint64_t, uint64_t, int64_t>> shifted_ranges;
+
+  auto entry_at = [this, &shifted_ranges](uint64_t idx) {
+    auto entry = m_index[idx];
+
+    for (auto const &[begin, end, shift] : shifted_ranges)
+      if ((idx >= begin) && (idx < end))
+        entry.timestamp += shift;
+
+    return entry;
+  };
 
   auto const num_edits         = editlist_table.size();
   auto const num_index_entries = m_index.size();
-  auto const index_begin       = m_index.begin();
-  auto const index_end         = m_index.end();
   auto const global_time_scale = m_reader.m_time_scale;
   auto timeline_cts            = int64_t{};
   auto entry_index             = 0u;
+  auto timestamp_shift         = int64_t{};
+
+  m_timeline_edits.clear();
 
   for (auto &edit : editlist_table) {
     auto info = fmt::format("{0} [segment_duration {1} media_time {2} media_rate {3}/{4}]", entry_index, edit.segment_duration, edit.media_time, edit.media_rate_integer, edit.media_rate_fraction);
@@ -2628,30 +3004,53 @@ qtmp4_demuxer_c::apply_edit_list() {
     auto const edit_duration  = to_nsecs(edit.segment_duration, global_time_scale);
     auto const edit_start_cts = to_nsecs(edit.media_time);
     auto const edit_end_cts   = edit_start_cts + edit_duration;
-    auto itr                  = std::find_if(m_index.begin(), m_index.end(), [edit_start_cts](auto const &entry) { return (entry.timestamp + entry.duration - (entry.duration > 0 ? 1 : 0)) >= edit_start_cts; });
-    auto const frame_idx      = static_cast<uint64_t>(std::distance(index_begin, itr));
+    auto frame_idx            = uint64_t{};
+
+    while (frame_idx < num_index_entries) {
+      auto const entry = entry_at(frame_idx);
+      if ((entry.timestamp + entry.duration - (entry.duration > 0 ? 1 : 0)) >= edit_start_cts)
+        break;
+      ++frame_idx;
+    }
 
     mxdebug_if(m_debug_editlists,
                fmt::format("  {0}: normal entry; first frame {1} edit CTS {2}–{3} at timeline CTS {4}\n",
                            info, frame_idx >= num_index_entries ? -1 : frame_idx, mtx::string::format_timestamp(edit_start_cts), mtx::string::format_timestamp(edit_end_cts), mtx::string::format_timestamp(timeline_cts)));
 
     // Find active key frame.
-    while ((itr != index_end) && (itr > index_begin) && !itr->is_keyframe) {
-      --itr;
+    auto idx = frame_idx;
+
+    while ((idx < num_index_entries) && (idx > 0) && !m_index[idx].is_keyframe) {
+      --idx;
     }
 
-    while ((itr < index_end) && (!edit_duration || (itr->timestamp < edit_end_cts))) {
-      itr->timestamp = timeline_cts + itr->timestamp - edit_start_cts;
-      edited_index.emplace_back(*itr);
+    timestamp_shift = timeline_cts - edit_start_cts;
+
+    m_timeline_edits.push_back({ edit_start_cts, edit_duration, timeline_cts });
+
+    auto const first_idx = idx;
+
+    for (; idx < num_index_entries; ++idx) {
+      auto entry = entry_at(idx);
+
+      if (edit_duration && (entry.timestamp >= edit_end_cts))
+        break;
 
-      ++itr;
+      entry.timestamp = timeline_cts + entry.timestamp - edit_start_cts;
+      edited_index.push_back(entry);
     }
 
+    shifted_ranges.emplace_back(first_idx, idx, timestamp_shift);
+
     timeline_cts += edit_end_cts - edit_start_cts;
   }
 
-  if (!edited_index.empty())
-    m_index = std::move(edited_index);
+  if (!edited_index.empty()) {
+    m_index                 = std::move(edited_index);
+    m_current_timeline_edit = m_timeline_edits.size() - 1;
+
+  } else
+    m_timeline_edits.clear();
 
   if (m_debug_editlists)
     dump_index_entries("Index after edit list");
@@ -2665,7 +3064,7 @@ qtmp4_demuxer_c::dump_index_entries(std::string const &message)
   auto end = std::min<int>(!m_debug_indexes_full ? 10 : std::numeric_limits<int>::max(), m_index.size());
 
   for (int idx = 0; idx < end; ++idx) {
-    auto const &entry = m_index[idx];
+    auto const entry = m_index[idx];
     mxdebug(fmt::format("  {0}: timestamp {1} duration {2} key? {3} file_pos {4} size {5}\n", idx, mtx::string::format_timestamp(entry.timestamp), mtx::string::format_timestamp(entry.duration), entry.is_keyframe, entry.file_pos, entry.size));
   }
 
@@ -2676,7 +3075,7 @@ qtmp4_demuxer_c::dump_index_entries(std::string const &message)
   end        = m_index.size();
 
   for (int idx = start; idx < end; ++idx) {
-    auto const &entry = m_index[idx];
+    auto const entry = m_index[idx];
     mxdebug(fmt::format("  {0}: timestamp {1} duration {2} key? {3} file_pos {4} size {5}\n", idx, mtx::string::format_timestamp(entry.timestamp), mtx::string::format_timestamp(entry.duration), entry.is_keyframe, entry.file_pos, entry.size));
   }
 }
@@ -2704,8 +3103,6 @@ qtmp4_demuxer_c::build_index_constant_sample_size_mode() {
   auto v1_bytes_per_frame    = 1 == v0_audio_version ? get_uint32_be(&sound_stsd_atom->v1.bytes_per_frame)    : 0;
   auto v1_samples_per_packet = 1 == v0_audio_version ? get_uint32_be(&sound_stsd_atom->v1.samples_per_packet) : 0;
 
-  m_index.reserve(m_index.size() + chunk_table.size());
-
   size_t frame_idx;
   for (frame_idx = 0; frame_idx < chunk_table.size(); ++frame_idx) {
     uint64_t frame_size;
@@ -2725,17 +3122,49 @@ qtmp4_demuxer_c::build_index_constant_sample_size_mode() {
       }
     }
 
-    m_index.emplace_back(chunk_table[frame_idx].pos, frame_size, timestamps[frame_idx], durations[frame_idx], false);
+    if (frame_size <= std::numeric_limits<uint32_t>::max()) {
+      m_index.emplace_back(chunk_table[frame_idx].pos, static_cast<uint32_t>(frame_size), timestamps[frame_idx], durations[frame_idx], false);
+      continue;
+    }
+
+    // Index entries store 32-bit sizes. Bigger chunks only occur with
+    // uncompressed audio, which can be split at any sample boundary:
+    // add several entries for such a chunk, distributing its duration
+    // proportionally.
+    auto block_align = uint64_t{1};
+
+    if (1 != sample_size)
+      block_align = sample_size;
+
+    else if (is_audio && (0 != v1_bytes_per_frame) && (0 != v1_samples_per_packet))
+      block_align = v1_bytes_per_frame;
+
+    else if (is_audio)
+      block_align = std::max<uint64_t>(a_channels * v0_sample_size / 8, 1);
+
+    auto num_pieces = (frame_size + MAX_SPLIT_CHUNK_SIZE - 1) / MAX_SPLIT_CHUNK_SIZE;
+    auto piece_end  = [&](uint64_t piece) -> uint64_t {
+      return piece == num_pieces ? frame_size : frame_size / num_pieces * piece / block_align * block_align;
+    };
+    auto piece_timestamp = [&](uint64_t offset) {
+      return timestamps[frame_idx] + std::llround(static_cast<double>(durations[frame_idx]) * offset / frame_size);
+    };
+
+    mxdebug_if(m_debug_headers, fmt::format("Track {0}: splitting chunk {1} of size {2} into {3} index entries\n", id, frame_idx, frame_size, num_pieces));
+
+    for (auto piece = uint64_t{}; piece < num_pieces; ++piece) {
+      auto start = piece_end(piece);
+      auto end   = piece_end(piece + 1);
+
+      m_index.emplace_back(chunk_table[frame_idx].pos + start, static_cast<uint32_t>(end - start), piece_timestamp(start), piece_timestamp(end) - piece_timestamp(start), false);
+    }
   }
 }
 
 void
 qtmp4_demuxer_c::build_index_chunk_mode() {
-  m_index.reserve(m_index.size() + frame_indices.size());
-
-  for (int frame_idx = 0, num_frames = frame_indices.size(); frame_idx < num_frames; ++frame_idx) {
-    auto act_frame_idx = frame_indices[frame_idx];
-    auto &sample       = sample_table[act_frame_idx];
+  for (int frame_idx = 0, num_frames = timestamps.size(); frame_idx < num_frames; ++frame_idx) {
+    auto &sample = sample_table[frame_idx];
 
     m_index.emplace_back(sample.pos, sample.size, timestamps[frame_idx], durations[frame_idx], false);
   }
@@ -2744,8 +3173,8 @@ qtmp4_demuxer_c::build_index_chunk_mode() {
 void
 qtmp4_demuxer_c::mark_key_frames_from_key_frame_table() {
   if (keyframe_table.empty()) {
-    for (auto &index : m_index)
-      index.is_keyframe = true;
+    for (auto idx = 0u, num_entries = m_index.size(); idx < num_entries; ++idx)
+      m_index.set_keyframe(idx);
     return;
   }
 
@@ -2753,7 +3182,7 @@ qtmp4_demuxer_c::mark_key_frames_from_key_frame_table() {
 
   for (auto const &keyframe_number : keyframe_table)
     if ((keyframe_number > 0) && (keyframe_number <= num_index_entries))
-      m_index[keyframe_number - 1].is_keyframe = true;
+      m_index.set_keyframe(keyframe_number - 1);
 }
 
 void
@@ -2771,7 +3200,7 @@ qtmp4_demuxer_c::mark_open_gop_random_access_points_as_key_frames() {
   for (auto const &s2g : table_itr->second) {
     if (s2g.group_description_index && ((s2g.group_description_index - 1) < num_random_access_points)) {
       for (auto end = std::min<int>(current_sample + s2g.sample_count, num_index_entries); current_sample < end; ++current_sample)
-        m_index[current_sample].is_keyframe = true;
+        m_index.set_keyframe(current_sample);
 
     } else
       current_sample += s2g.sample_count;
@@ -2781,6 +3210,108 @@ qtmp4_demuxer_c::mark_open_gop_random_access_points_as_key_frames() {
   }
 }
 
+std::optional<std::size_t>
+qtmp4_demuxer_c::find_timeline_edit(int64_t timestamp,
+                                    int64_t duration)
+  const {
+  // Same criteria as in apply_edit_list().
+  for (auto idx = 0u; idx < m_timeline_edits.size(); ++idx) {
+    auto const &edit = m_timeline_edits[idx];
+
+    if (   ((timestamp + duration - (duration > 0 ? 1 : 0)) >= edit.start_cts)
+        && (!edit.duration || (timestamp < (edit.start_cts + edit.duration))))
+      return idx;
+  }
+
+  return {};
+}
+
+uint64_t
+qtmp4_demuxer_c::append_fragment_samples_to_index() {
+  // When streaming fragments the tables only contain the samples of
+  // the fragment just parsed. Each sample forms its own chunk.
+  auto const num_samples       = std::min({ sample_table.size(), chunk_table.size(), durmap_table.size() });
+  auto const num_frame_offsets = raw_frame_offset_table.size();
+  auto keyframe_itr            = keyframe_table.begin();
+  auto num_bytes               = uint64_t{};
+
+  std::vector<qt_index_t> samples;
+  samples.reserve(num_samples);
+
+  for (auto idx = 0u; idx < num_samples; ++idx) {
+    auto frame_offset = idx < num_frame_offsets ? raw_frame_offset_table[idx].offset : 0;
+    auto is_keyframe  = (keyframe_table.end() != keyframe_itr) && (*keyframe_itr == (idx + 1));
+
+    if (is_keyframe)
+      ++keyframe_itr;
+
+    samples.emplace_back(chunk_table[idx].pos, sample_table[idx].size, to_nsecs(m_next_sample_pts + frame_offset), to_nsecs(durmap_table[idx].duration), is_keyframe);
+
+    m_next_sample_pts += durmap_table[idx].duration;
+  }
+
+  auto add_sample = [this, &num_bytes](qt_index_t sample, int64_t timestamp) {
+    sample.timestamp  = timestamp + m_fragment_timestamp_shift;
+    num_bytes        += sample.size;
+    m_index.push_back(sample);
+  };
+
+  // The edit list is applied to each sample just like to the whole
+  // index: samples outside of all edits are dropped, and an edit
+  // starts with the key frame preceding its first sample.
+  for (auto idx = 0u; idx < num_samples; ++idx) {
+    auto const &sample = samples[idx];
+
+    if (m_timeline_edits.empty()) {
+      add_sample(sample, sample.timestamp);
+      continue;
+    }
+
+    auto edit_idx = find_timeline_edit(sample.timestamp, sample.duration);
+    if (!edit_idx)
+      continue;
+
+    auto first_idx = idx;
+
+    if (edit_idx != m_current_timeline_edit) {
+      while ((first_idx > 0) && !samples[first_idx].is_keyframe)
+        --first_idx;
+
+      m_current_timeline_edit = edit_idx;
+    }
+
+    auto const &edit = m_timeline_edits[*edit_idx];
+
+    for (; first_idx <= idx; ++first_idx)
+      add_sample(samples[first_idx], edit.timeline_cts + samples[first_idx].timestamp - edit.start_cts);
+  }
+
+  mxdebug_if(m_debug_indexes, fmt::format("Streaming fragments: track ID {0}: {1} samples appended to the index, {2} entries queued\n", id, num_samples, m_index.size() - pos));
+
+  return num_bytes;
+}
+
+void
+qtmp4_demuxer_c::prepare_for_next_fragment() {
+  // The samples of the next fragment are appended to empty tables, and
+  // delivered samples are removed from the index so that memory usage
+  // doesn't grow with the number of fragments.
+  sample_table.clear();
+  chunk_table.clear();
+  durmap_table.clear();
+  keyframe_table.clear();
+  raw_frame_offset_table.clear();
+  m_fragments.clear();
+  num_frames_from_trun = 0;
+
+  if (!pos)
+    return;
+
+  m_index.erase_front(pos);
+  m_num_dropped_index_entries += pos;
+  pos                          = 0;
+}
+
 memory_cptr
 qtmp4_demuxer_c::read_first_bytes(int num_bytes) {
   if (!update_tables())
@@ -2793,7 +3324,7 @@ qtmp4_demuxer_c::read_first_bytes(int num_bytes) {
   size_t idx_pos = 0;
 
   while ((0 < num_bytes) && (idx_pos < m_index.size())) {
-    qt_index_t &index          = m_index[idx_pos];
+    auto index                 = m_index[idx_pos];
     uint64_t num_bytes_to_read = std::min<int64_t>(num_bytes, index.size);
 
     m_reader.m_in->setFilePointer(index.file_pos);
@@ -3188,6 +3719,8 @@ qtmp4_demuxer_c::parse_audio_header_priv_atoms(mm_mem_io_c &mio,
 
       try {
         atom = read_qtmp4_atom(&mio, false);
+      } catch (mtx::output::captured_error_x &) {
+        throw;
       } catch (...) {
         return;
       }
@@ -3250,6 +3783,8 @@ qtmp4_demuxer_c::parse_video_header_priv_atoms(uint64_t atom_size,
 
       try {
         atom = read_qtmp4_atom(&mio);
+      } catch (mtx::output::captured_error_x &) {
+        throw;
       } catch (...) {
         return;
       }
@@ -3302,6 +3837,8 @@ qtmp4_demuxer_c::parse_subtitles_header_priv_atoms(uint64_t atom_size,
 
       try {
         atom = read_qtmp4_atom(&mio);
+      } catch (mtx::output::captured_error_x &) {
+        throw;
       } catch (...) {
         return;
       }
@@ -21,6 +21,7 @@
 #include "common/fourcc.h"
 #include "input/packet_converter.h"
 #include "input/qtmp4_atoms.h"
+#include "input/qtmp4_sample_index.h"
 #include "merge/generic_reader.h"
 #include "output/p_pcm.h"
 #include "output/p_video_for_windows.h"
@@ -110,6 +111,13 @@ struct qt_editlist_t {
   };
 };
 
+// An edit list entry that is actually applied: the samples starting
+// at start_cts are presented at timeline_cts. A duration of 0 means
+// until the end of the track.
+struct qt_timeline_edit_t {
+  int64_t start_cts{}, duration{}, timeline_cts{};
+};
+
 struct qt_sample_t {
   int64_t  pts;
   uint32_t size;
@@ -147,30 +155,6 @@ struct qt_frame_offset_t {
   }
 };
 
-struct qt_index_t {
-  int64_t file_pos, size;
-  int64_t timestamp, duration;
-  bool    is_keyframe;
-
-  qt_index_t()
-    : file_pos{}
-    , size{}
-    , timestamp{}
-    , duration{}
-    , is_keyframe{}
-  {
-  };
-
-  qt_index_t(int64_t p_file_pos, int64_t p_size, int64_t p_timestamp, int64_t p_duration, bool p_is_keyframe)
-    : file_pos{p_file_pos}
-    , size{p_size}
-    , timestamp{p_timestamp}
-    , duration{p_duration}
-    , is_keyframe{p_is_keyframe}
-  {
-  }
-};
-
 struct qt_track_defaults_t {
   unsigned int sample_description_id, sample_duration, sample_size, sample_flags;
 
@@ -222,6 +206,20 @@ struct qt_sample_to_group_t {
 
 class qtmp4_reader_c;
 
+// A range of the file that has been read in one go & from which the
+// payloads of several samples are served.
+struct qt_read_window_t {
+  memory_cptr data;
+  int64_t start{}, size{};
+
+  bool
+  contains(int64_t pos,
+           int64_t length)
+    const {
+    return data && (pos >= start) && ((pos + length) <= (start + size));
+  }
+};
+
 struct qtmp4_demuxer_c {
   qtmp4_reader_c &m_reader;
 
@@ -249,11 +247,23 @@ struct qtmp4_demuxer_c {
   std::vector<qt_random_access_point_t> random_access_point_table;
   std::unordered_map<uint32_t, std::vector<qt_sample_to_group_t> > sample_to_group_tables;
 
-  std::vector<int64_t> timestamps, durations, frame_indices;
+  std::vector<int64_t> timestamps, durations;
 
-  std::vector<qt_index_t> m_index;
+  qt_sample_index_c m_index;
   std::vector<qt_fragment_t> m_fragments;
 
+  // Used when streaming fragments: the track's PTS following the last
+  // sample in the index, the offset the global minimum timestamp has
+  // shifted the index by, and the number of delivered entries that
+  // have been removed from the index.
+  int64_t m_next_sample_pts{}, m_fragment_timestamp_shift{};
+  uint64_t m_num_dropped_index_entries{};
+
+  // The edit list entries applied to the index. They're applied to
+  // the samples of fragments parsed later on, too.
+  std::vector<qt_timeline_edit_t> m_timeline_edits;
+  std::optional<std::size_t> m_current_timeline_edit;
+
   mtx_mp_rational_t frame_rate;
   std::optional<int64_t> m_use_frame_rate_for_duration;
 
@@ -281,6 +291,8 @@ struct qtmp4_demuxer_c {
   int ptzr;
   packet_converter_cptr m_converter;
 
+  qt_read_window_t m_read_window;
+
   mtx::bcp47::language_c language;
 
   debugging_option_c m_debug_tables, m_debug_tables_full, m_debug_frame_rate, m_debug_headers, m_debug_editlists, m_debug_indexes, m_debug_indexes_full;
@@ -330,8 +342,11 @@ struct qtmp4_demuxer_c {
 
   bool update_tables();
   void apply_edit_list();
+  std::optional<std::size_t> find_timeline_edit(int64_t timestamp, int64_t duration) const;
 
   void build_index();
+  uint64_t append_fragment_samples_to_index();
+  void prepare_for_next_fragment();
 
   memory_cptr read_first_bytes(int num_bytes);
 
@@ -393,6 +408,7 @@ struct qtmp4_demuxer_c {
 private:
   void build_index_chunk_mode();
   void build_index_constant_sample_size_mode();
+  void release_index_source_tables();
   void dump_index_entries(std::string const &message) const;
   void mark_key_frames_from_key_frame_table();
   void mark_open_gop_random_access_points_as_key_frames();
@@ -482,6 +498,26 @@ private:
   std::string m_title, m_encoder, m_comment;
 
   int64_t m_bytes_to_process{}, m_bytes_processed{};
+  // The total size of all samples of the tracks read that have been
+  // indexed so far.
+  uint64_t m_indexed_bytes_to_process{};
+
+  // All demuxers' samples sorted by their position in the file.
+  qt_file_order_index_c m_file_order_index;
+  bool m_file_order_index_built{}, m_file_order{};
+  qt_read_window_t m_read_window;
+
+  // Fragmented files are read incrementally if requested: only the
+  // first fragments are parsed along with the headers, the following
+  // ones starting at this position while reading.
+  bool m_stream_fragments{};
+  std::optional<uint64_t> m_next_fragment_pos;
+
+  // Fragmented files can be read while they're still being written to.
+  // Following fragments are parsed starting at the end of the last
+  // fragment parsed along with the headers.
+  std::shared_ptr<mm_follow_io_c> m_follow_in;
+  std::optional<uint64_t> m_parsed_fragments_end;
 
   debugging_option_c
       m_debug_chapters{    "qtmp4|qtmp4_full|qtmp4_chapters"}
@@ -499,6 +535,7 @@ public:
   }
 
   virtual void read_headers();
+  virtual void follow_growing_input(std::shared_ptr<mm_follow_io_c> const &follow_in) override;
   virtual int64_t get_progress() override;
   virtual int64_t get_maximum_progress() override;
   virtual void identify();
@@ -512,11 +549,21 @@ protected:
   virtual file_status_e read(generic_packetizer_c *packetizer, bool force = false) override;
   file_status_e finish();
 
+  virtual void build_file_order_index();
+  virtual qtmp4_demuxer_c *next_demuxer_in_file_order(qtmp4_demuxer_c &requested_dmx);
+  virtual bool deliver_sample(qtmp4_demuxer_c &dmx, qt_read_window_t &window, std::function<std::optional<qt_index_t>(std::size_t)> const &get_following_index);
+  virtual uint8_t const *read_sample_data(qt_read_window_t &window, qt_index_t const &index, std::function<std::optional<qt_index_t>(std::size_t)> const &get_following_index);
+
   virtual void parse_headers();
+  virtual bool initial_fragments_parsed(unsigned int num_fragments_parsed) const;
+  virtual bool parse_next_fragment();
+  virtual void wait_for_data(uint64_t end);
+  virtual void make_fragment_samples_available(generic_packetizer_c *packetizer);
   virtual void verify_track_parameters_and_update_indexes();
   virtual void calculate_timestamps();
   virtual std::optional<int64_t> calculate_global_min_timestamp() const;
   virtual void calculate_num_bytes_to_process();
+  virtual void update_num_bytes_to_process();
 
   virtual void create_global_tags_from_meta_data();
   virtual void process_global_tags();
@@ -644,6 +644,8 @@ real_reader_c::get_rv_dimensions(uint8_t *buf,
 
     return true;
 
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
     return false;
   }
@@ -41,7 +41,7 @@ ssa_reader_c::read_headers() {
   m_encoding   = text_in->get_encoding();
 
   m_subs->set_charset_converter(cc_utf8);
-  m_subs->parse();
+  m_subs->parse(true);
 
   m_bytes_to_process = m_subs->get_total_byte_size();
 
@@ -189,6 +189,8 @@ truehd_reader_c::find_valid_headers(mm_io_c &in,
 
     return num_sync_frames >= num_headers;
 
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
     return false;
   }
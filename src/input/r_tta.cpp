@@ -82,6 +82,8 @@ tta_reader_c::read_headers() {
 
     pos = 0;
 
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
     throw mtx::input::open_x();
   }
@@ -117,6 +117,8 @@ wav_reader_c::parse_fmt_chunk() {
     else
       m_format_tag = get_uint16_le(&m_wheader.common.wFormatTag);
 
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
     throw mtx::input::header_parsing_x();
   }
@@ -333,6 +335,8 @@ wav_reader_c::scan_chunks_wave() {
       m_in->setFilePointer(new_chunk.len, libebml::seek_current);
 
     }
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
   }
 }
@@ -367,6 +371,8 @@ wav_reader_c::scan_chunks_wave64() {
       m_in->setFilePointer(new_chunk.len, libebml::seek_current);
 
     }
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
   }
 }
@@ -42,6 +42,8 @@ wavpack_reader_c::read_headers() {
     int packet_size = mtx::wavpack::parse_frame(*m_in, header, meta, true, true);
     if (0 > packet_size)
       mxerror_fn(m_ti.m_fname, Y("The file header was not read correctly.\n"));
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
     throw mtx::input::open_x();
   }
@@ -33,14 +33,105 @@
 
 subtitles_c::subtitles_c(std::string const &file_name,
                          int64_t track_id)
-  : current{entries.end()}
-  , m_cc_utf8{charset_converter_c::init("UTF-8")}
+  : m_cc_utf8{charset_converter_c::init("UTF-8")}
   , m_invalid_utf8_warned{g_identifying}
   , m_file_name{file_name}
   , m_track_id{track_id}
 {
 }
 
+/** \brief Parses the file
+
+   Without \c streaming all entries are read into memory & sorted by
+   their start timestamps. With \c streaming the file is scanned
+   first. The entries found are kept unless their total size exceeds
+   the limit set with \c set_max_kept_byte_size(). Only in that case
+   the file is parsed a second time: if the entries turn out to be
+   sorted already, they're parsed again on demand by \c empty() & \c
+   process(). Otherwise all of them are read into memory & sorted as
+   before.
+*/
+void
+subtitles_c::parse(bool streaming) {
+  auto try_utf8 = m_try_utf8;
+
+  m_scanning = streaming;
+
+  start_parsing();
+  while (parse_next_line())
+    ;
+
+  m_scanning = false;
+
+  mxdebug_if(m_debug, fmt::format("parse: streaming {0} total size {1} needs sorting {2} entries dropped {3}\n", streaming, m_total_byte_size, m_needs_sorting, m_entries_dropped));
+
+  // The entries themselves aren't needed for identification.
+  if (streaming && g_identifying) {
+    entries.clear();
+    return;
+  }
+
+  if (!m_entries_dropped) {
+    sort();
+    return;
+  }
+
+  // Warnings, global data & attachments have been handled during the
+  // first pass already. The decision whether or not the content is
+  // valid UTF-8 must be made anew.
+  m_second_pass = true;
+  m_try_utf8    = try_utf8;
+  m_num_skipped = 0;
+
+  start_parsing();
+
+  if (!m_needs_sorting) {
+    m_streaming = true;
+    return;
+  }
+
+  while (parse_next_line())
+    ;
+
+  sort();
+}
+
+void
+subtitles_c::add(int64_t start,
+                 int64_t end,
+                 unsigned int number,
+                 std::string const &subs) {
+  if (!m_second_pass) {
+    m_total_byte_size += subs.length();
+    m_needs_sorting    = m_needs_sorting || (start < m_last_start);
+    m_last_start       = start;
+  }
+
+  if (m_scanning && (m_entries_dropped || (m_total_byte_size > m_max_kept_byte_size))) {
+    // Too large for keeping all entries in memory. They'll be parsed
+    // again in a second pass.
+    m_entries_dropped = true;
+    entries.clear();
+    return;
+  }
+
+  entries.emplace_back(start, end, number, subs);
+}
+
+bool
+subtitles_c::empty() {
+  while (entries.empty() && m_streaming && !m_end_of_file)
+    m_end_of_file = !parse_next_line();
+
+  return entries.empty();
+}
+
+void
+subtitles_c::warn(std::string const &message) {
+  if (!m_second_pass)
+    mxwarn_tid(m_file_name, m_track_id, message);
+}
+
 void
 subtitles_c::add_maybe(int64_t start,
                        int64_t end,
@@ -87,13 +178,16 @@ subtitles_c::recode(std::string const &s,
 
 void
 subtitles_c::process(generic_packetizer_c *p) {
-  if (empty() || (entries.end() == current))
+  if (empty())
     return;
 
-  packet_cptr packet(new packet_t(memory_c::borrow(current->subs), current->start, current->end - current->start));
-  packet->extensions.push_back(packet_extension_cptr(new subtitle_number_packet_extension_c(current->number)));
+  auto &entry = entries.front();
+
+  packet_cptr packet(new packet_t(memory_c::clone(entry.subs), entry.start, entry.end - entry.start));
+  packet->extensions.push_back(packet_extension_cptr(new subtitle_number_packet_extension_c(entry.number)));
   p->process(packet);
-  ++current;
+
+  entries.pop_front();
 }
 
 // ------------------------------------------------------------
@@ -125,6 +219,8 @@ srt_parser_c::probe(mm_text_io_c &io) {
     s = io.getline();
     io.setFilePointer(0);
 
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
     return false;
   }
@@ -137,167 +233,168 @@ srt_parser_c::srt_parser_c(mm_text_io_cptr const &io,
                            int64_t track_id)
   : subtitles_c{file_name, track_id}
   , m_io(io)
-  , m_coordinates_warning_shown(false)
+  , m_timestamp_re{SRT_RE_TIMESTAMP_LINE}
+  , m_number_re{"^\\d+$"}
+  , m_coordinates_re{SRT_RE_COORDINATES}
 {
 }
 
 void
-srt_parser_c::parse() {
-  QRegularExpression timestamp_re{SRT_RE_TIMESTAMP_LINE};
-  QRegularExpression number_re{"^\\d+$"};
-  QRegularExpression coordinates_re{SRT_RE_COORDINATES};
-
-  int64_t start                  = 0;
-  int64_t end                    = 0;
-  int64_t previous_start         = 0;
-  bool timestamp_warning_printed = false;
-  parser_state_e state           = STATE_INITIAL;
-  int line_number                = 0;
-  unsigned int subtitle_number   = 0;
-  unsigned int timestamp_number  = 0;
-  std::string subtitles;
+srt_parser_c::start_parsing() {
+  m_start            = 0;
+  m_end              = 0;
+  m_previous_start   = 0;
+  m_state            = STATE_INITIAL;
+  m_line_number      = 0;
+  m_subtitle_number  = 0;
+  m_timestamp_number = 0;
+  m_subtitles.clear();
 
   m_io->setFilePointer(0);
+}
 
-  while (1) {
-    std::string s;
-    if (!m_io->getline2(s))
-      break;
+bool
+srt_parser_c::parse_next_line() {
+  auto finish = [this]() {
+    if (!m_subtitles.empty())
+      add_maybe(m_start, m_end, m_timestamp_number, m_subtitles);
+    m_subtitles.clear();
 
-    s = recode(s);
-    auto unstripped_line = s;
-    mtx::string::strip_back(s);
+    return false;
+  };
 
-    line_number++;
+  std::string s;
+  if (!m_io->getline2(s))
+    return finish();
 
-    mxdebug_if(m_debug, fmt::format("line {0} state {1} content »{2}«\n", line_number, state == STATE_INITIAL ? "initial" : state == STATE_TIME ? "time" : state == STATE_SUBS ? "subs" : "subs-or-number", s));
+  s = recode(s);
+  auto unstripped_line = s;
+  mtx::string::strip_back(s);
 
-    if (s.empty()) {
-      if ((STATE_INITIAL == state) || (STATE_TIME == state))
-        continue;
+  m_line_number++;
 
-      state = STATE_SUBS_OR_NUMBER;
+  mxdebug_if(m_debug, fmt::format("line {0} state {1} content »{2}«\n", m_line_number, m_state == STATE_INITIAL ? "initial" : m_state == STATE_TIME ? "time" : m_state == STATE_SUBS ? "subs" : "subs-or-number", s));
 
-      if (!subtitles.empty())
-        subtitles += "\n";
+  if (s.empty()) {
+    if ((STATE_INITIAL == m_state) || (STATE_TIME == m_state))
+      return true;
 
-      continue;
-    }
+    m_state = STATE_SUBS_OR_NUMBER;
 
-    if (STATE_INITIAL == state) {
-      if (!Q(s).contains(number_re)) {
-        mxwarn_tid(m_file_name, m_track_id, fmt::format(FY("Error in line {0}: expected subtitle number and found some text.\n"), line_number));
-        break;
-      }
-      state = STATE_TIME;
-      mtx::string::parse_number(s, subtitle_number);
-
-    } else if (STATE_TIME == state) {
-      auto matches = timestamp_re.match(Q(s));
-      if (!matches.hasMatch()) {
-        mxwarn_tid(m_file_name, m_track_id, fmt::format(FY("Error in line {0}: expected a SRT timestamp line but found something else. Aborting this file.\n"), line_number));
-        break;
-      }
+    if (!m_subtitles.empty())
+      m_subtitles += "\n";
 
-      int64_t s_h = 0, s_min = 0, s_sec = 0, s_ns = 0, e_h = 0, e_min = 0, e_sec = 0, e_ns = 0;
-
-      //      1       2         3    4          5   6                  7   8
-      // "\\s*(-?)\\s*(\\d+):\\s(-?)*(\\d+):\\s*(-?)(\\d+)(?:[,\\.]\\s*(-?)(\\d+))?"
-
-      mtx::string::parse_number(to_utf8(matches.captured( 2)), s_h);
-      mtx::string::parse_number(to_utf8(matches.captured( 4)), s_min);
-      mtx::string::parse_number(to_utf8(matches.captured( 6)), s_sec);
-      mtx::string::parse_number(to_utf8(matches.captured(10)), e_h);
-      mtx::string::parse_number(to_utf8(matches.captured(12)), e_min);
-      mtx::string::parse_number(to_utf8(matches.captured(14)), e_sec);
-
-      std::string s_rest = to_utf8(matches.captured( 8));
-      std::string e_rest = to_utf8(matches.captured(16));
-
-      auto neg_calculator = [&matches](auto start_idx) -> auto {
-        int64_t neg = 1;
-        for (auto idx = 0; idx < 4; ++idx)
-          if (matches.captured(start_idx + (idx * 2)) == Q("-"))
-            neg *= -1;
-        return neg;
-      };
-
-      int64_t s_neg = neg_calculator(1);
-      int64_t e_neg = neg_calculator(9);
-
-      if (Q(s).contains(coordinates_re) && !m_coordinates_warning_shown) {
-        mxwarn_tid(m_file_name, m_track_id,
-                   Y("This file contains coordinates in the timestamp lines. "
-                     "Such coordinates are not supported by the Matroska SRT subtitle format. "
-                     "The coordinates will be removed automatically.\n"));
-        m_coordinates_warning_shown = true;
-      }
+    return true;
+  }
 
-      // The previous entry is done now. Append it to the list of subtitles.
-      if (!subtitles.empty())
-        add_maybe(start, end, timestamp_number, subtitles);
-
-      while (s_rest.length() < 9)
-        s_rest += "0";
-      if (s_rest.length() > 9)
-        s_rest.erase(9);
-
-      while (e_rest.length() < 9)
-        e_rest += "0";
-      if (e_rest.length() > 9)
-        e_rest.erase(9);
-
-      mtx::string::parse_number(s_rest, s_ns);
-      mtx::string::parse_number(e_rest, e_ns);
-
-      // Calculate the start and end time in ns precision for the following entry.
-      start  = ((s_h * 60 * 60 + s_min * 60 + s_sec) * 1'000'000'000ll + s_ns) * s_neg;
-      end    = ((e_h * 60 * 60 + e_min * 60 + e_sec) * 1'000'000'000ll + e_ns) * e_neg;
-
-      if (0 > start) {
-        mxwarn_tid(m_file_name, m_track_id,
-                   fmt::format(FY("Line {0}: Negative timestamp encountered. The entry will be adjusted to start from 00:00:00.000.\n"), line_number));
-        end   -= start;
-        start  = 0;
-        if (0 > end)
-          end *= -1;
-      }
+  if (STATE_INITIAL == m_state) {
+    if (!Q(s).contains(m_number_re)) {
+      warn(fmt::format(FY("Error in line {0}: expected subtitle number and found some text.\n"), m_line_number));
+      return finish();
+    }
+    m_state = STATE_TIME;
+    mtx::string::parse_number(s, m_subtitle_number);
+
+  } else if (STATE_TIME == m_state) {
+    auto matches = m_timestamp_re.match(Q(s));
+    if (!matches.hasMatch()) {
+      warn(fmt::format(FY("Error in line {0}: expected a SRT timestamp line but found something else. Aborting this file.\n"), m_line_number));
+      return finish();
+    }
 
-      // There are files for which start timestamps overlap. Matroska requires
-      // blocks to be sorted by their timestamp. mkvmerge does this at the end
-      // of this function, but warn the user that the original order is being
-      // changed.
-      if (!timestamp_warning_printed && (start < previous_start)) {
-        mxwarn_tid(m_file_name, m_track_id, fmt::format(FY("Warning in line {0}: The start timestamp is smaller than that of the previous entry. "
-                                                           "All entries from this file will be sorted by their start time.\n"), line_number));
-        timestamp_warning_printed = true;
-      }
+    int64_t s_h = 0, s_min = 0, s_sec = 0, s_ns = 0, e_h = 0, e_min = 0, e_sec = 0, e_ns = 0;
+
+    //      1       2         3    4          5   6                  7   8
+    // "\\s*(-?)\\s*(\\d+):\\s(-?)*(\\d+):\\s*(-?)(\\d+)(?:[,\\.]\\s*(-?)(\\d+))?"
+
+    mtx::string::parse_number(to_utf8(matches.captured( 2)), s_h);
+    mtx::string::parse_number(to_utf8(matches.captured( 4)), s_min);
+    mtx::string::parse_number(to_utf8(matches.captured( 6)), s_sec);
+    mtx::string::parse_number(to_utf8(matches.captured(10)), e_h);
+    mtx::string::parse_number(to_utf8(matches.captured(12)), e_min);
+    mtx::string::parse_number(to_utf8(matches.captured(14)), e_sec);
+
+    std::string s_rest = to_utf8(matches.captured( 8));
+    std::string e_rest = to_utf8(matches.captured(16));
+
+    auto neg_calculator = [&matches](auto start_idx) -> auto {
+      int64_t neg = 1;
+      for (auto idx = 0; idx < 4; ++idx)
+        if (matches.captured(start_idx + (idx * 2)) == Q("-"))
+          neg *= -1;
+      return neg;
+    };
+
+    int64_t s_neg = neg_calculator(1);
+    int64_t e_neg = neg_calculator(9);
+
+    if (Q(s).contains(m_coordinates_re) && !m_coordinates_warning_shown) {
+      warn(Y("This file contains coordinates in the timestamp lines. "
+             "Such coordinates are not supported by the Matroska SRT subtitle format. "
+             "The coordinates will be removed automatically.\n"));
+      m_coordinates_warning_shown = true;
+    }
 
-      previous_start   = start;
-      subtitles        = "";
-      state            = STATE_SUBS;
-      timestamp_number = subtitle_number;
+    // The previous entry is done now. Append it to the list of subtitles.
+    if (!m_subtitles.empty())
+      add_maybe(m_start, m_end, m_timestamp_number, m_subtitles);
+
+    while (s_rest.length() < 9)
+      s_rest += "0";
+    if (s_rest.length() > 9)
+      s_rest.erase(9);
+
+    while (e_rest.length() < 9)
+      e_rest += "0";
+    if (e_rest.length() > 9)
+      e_rest.erase(9);
+
+    mtx::string::parse_number(s_rest, s_ns);
+    mtx::string::parse_number(e_rest, e_ns);
+
+    // Calculate the start and end time in ns precision for the following entry.
+    m_start  = ((s_h * 60 * 60 + s_min * 60 + s_sec) * 1'000'000'000ll + s_ns) * s_neg;
+    m_end    = ((e_h * 60 * 60 + e_min * 60 + e_sec) * 1'000'000'000ll + e_ns) * e_neg;
+
+    if (0 > m_start) {
+      warn(fmt::format(FY("Line {0}: Negative timestamp encountered. The entry will be adjusted to start from 00:00:00.000.\n"), m_line_number));
+      m_end   -= m_start;
+      m_start  = 0;
+      if (0 > m_end)
+        m_end *= -1;
+    }
 
-    } else if (STATE_SUBS == state) {
-      if (!subtitles.empty())
-        subtitles += "\n";
-      subtitles += unstripped_line;
+    // There are files for which start timestamps overlap. Matroska requires
+    // blocks to be sorted by their timestamp. mkvmerge does this once the
+    // whole file has been parsed, but warn the user that the original order
+    // is being changed.
+    if (!m_timestamp_warning_printed && (m_start < m_previous_start)) {
+      warn(fmt::format(FY("Warning in line {0}: The start timestamp is smaller than that of the previous entry. "
+                          "All entries from this file will be sorted by their start time.\n"), m_line_number));
+      m_timestamp_warning_printed = true;
+    }
 
-    } else if (Q(s).contains(number_re)) {
-      state = STATE_TIME;
-      mtx::string::parse_number(s, subtitle_number);
+    m_previous_start   = m_start;
+    m_subtitles        = "";
+    m_state            = STATE_SUBS;
+    m_timestamp_number = m_subtitle_number;
 
-    } else {
-      if (!subtitles.empty())
-        subtitles += "\n";
-      subtitles += unstripped_line;
-    }
-  }
+  } else if (STATE_SUBS == m_state) {
+    if (!m_subtitles.empty())
+      m_subtitles += "\n";
+    m_subtitles += unstripped_line;
 
-  if (!subtitles.empty())
-    add_maybe(start, end, timestamp_number, subtitles);
+  } else if (Q(s).contains(m_number_re)) {
+    m_state = STATE_TIME;
+    mtx::string::parse_number(s, m_subtitle_number);
 
-  sort();
+  } else {
+    if (!m_subtitles.empty())
+      m_subtitles += "\n";
+    m_subtitles += unstripped_line;
+  }
+
+  return true;
 }
 
 // ------------------------------------------------------------
@@ -332,6 +429,8 @@ ssa_parser_c::probe(mm_text_io_c &io) {
       // Neither a wanted line nor an empty one/a comment: negative result.
       return false;
     }
+  } catch (mtx::output::captured_error_x &) {
+    throw;
   } catch (...) {
   }
 
@@ -347,151 +446,153 @@ ssa_parser_c::ssa_parser_c(generic_reader_c &reader,
   , m_io(io)
   , m_is_ass(false)
   , m_attachment_id(0)
+  , m_sec_styles_ass_re{"^\\s*\\[V4\\+\\s+Styles\\]", QRegularExpression::CaseInsensitiveOption}
+  , m_sec_styles_re{    "^\\s*\\[V4\\s+Styles\\]",    QRegularExpression::CaseInsensitiveOption}
+  , m_sec_info_re{      "^\\s*\\[Script\\s+Info\\]",  QRegularExpression::CaseInsensitiveOption}
+  , m_sec_events_re{    "^\\s*\\[Events\\]",          QRegularExpression::CaseInsensitiveOption}
+  , m_sec_graphics_re{  "^\\s*\\[Graphics\\]",        QRegularExpression::CaseInsensitiveOption}
+  , m_sec_fonts_re{     "^\\s*\\[Fonts\\]",           QRegularExpression::CaseInsensitiveOption}
 {
 }
 
 void
-ssa_parser_c::parse() {
-  QRegularExpression sec_styles_ass_re{"^\\s*\\[V4\\+\\s+Styles\\]", QRegularExpression::CaseInsensitiveOption};
-  QRegularExpression sec_styles_re{    "^\\s*\\[V4\\s+Styles\\]",    QRegularExpression::CaseInsensitiveOption};
-  QRegularExpression sec_info_re{      "^\\s*\\[Script\\s+Info\\]",  QRegularExpression::CaseInsensitiveOption};
-  QRegularExpression sec_events_re{    "^\\s*\\[Events\\]",          QRegularExpression::CaseInsensitiveOption};
-  QRegularExpression sec_graphics_re{  "^\\s*\\[Graphics\\]",        QRegularExpression::CaseInsensitiveOption};
-  QRegularExpression sec_fonts_re{     "^\\s*\\[Fonts\\]",           QRegularExpression::CaseInsensitiveOption};
-
-  int num                        = 0;
-  ssa_section_e section          = SSA_SECTION_NONE;
-  ssa_section_e previous_section = SSA_SECTION_NONE;
-  std::string name_field         = "Name";
-
-  std::string attachment_name, attachment_data_uu;
+ssa_parser_c::start_parsing() {
+  m_num              = 0;
+  m_section          = SSA_SECTION_NONE;
+  m_previous_section = SSA_SECTION_NONE;
+  m_name_field       = "Name";
+  m_format.clear();
+  m_attachment_name.clear();
+  m_attachment_data_uu.clear();
 
   m_io->setFilePointer(0);
+}
 
-  while (!m_io->eof()) {
-    std::string line;
-    if (!m_io->getline2(line))
-      break;
+bool
+ssa_parser_c::parse_next_line() {
+  std::string line;
+  if (m_io->eof() || !m_io->getline2(line))
+    return false;
 
-    line               = recode(line);
-    auto qline         = Q(line);
-    bool add_to_global = true;
+  line               = recode(line);
+  auto qline         = Q(line);
+  bool add_to_global = true;
 
-    // A normal line. Let's see if this file is ASS and not SSA.
-    if (!strcasecmp(line.c_str(), "ScriptType: v4.00+"))
-      m_is_ass = true;
+  // A normal line. Let's see if this file is ASS and not SSA.
+  if (!strcasecmp(line.c_str(), "ScriptType: v4.00+"))
+    m_is_ass = true;
 
-    else if (qline.contains(sec_styles_ass_re)) {
-      m_is_ass = true;
-      section  = SSA_SECTION_V4STYLES;
+  else if (qline.contains(m_sec_styles_ass_re)) {
+    m_is_ass  = true;
+    m_section = SSA_SECTION_V4STYLES;
 
-    } else if (qline.contains(sec_styles_re))
-      section = SSA_SECTION_V4STYLES;
+  } else if (qline.contains(m_sec_styles_re))
+    m_section = SSA_SECTION_V4STYLES;
 
-    else if (qline.contains(sec_info_re))
-      section = SSA_SECTION_INFO;
+  else if (qline.contains(m_sec_info_re))
+    m_section = SSA_SECTION_INFO;
 
-    else if (qline.contains(sec_events_re))
-      section = SSA_SECTION_EVENTS;
+  else if (qline.contains(m_sec_events_re))
+    m_section = SSA_SECTION_EVENTS;
 
-    else if (qline.contains(sec_graphics_re)) {
-      section       = SSA_SECTION_GRAPHICS;
-      add_to_global = false;
+  else if (qline.contains(m_sec_graphics_re)) {
+    m_section     = SSA_SECTION_GRAPHICS;
+    add_to_global = false;
 
-    } else if (qline.contains(sec_fonts_re)) {
-      section       = SSA_SECTION_FONTS;
-      add_to_global = false;
+  } else if (qline.contains(m_sec_fonts_re)) {
+    m_section     = SSA_SECTION_FONTS;
+    add_to_global = false;
+
+  } else if (SSA_SECTION_EVENTS == m_section) {
+    if (balg::istarts_with(line, "Format: ")) {
+      // Analyze the format string.
+      m_format = mtx::string::split(&line.c_str()[strlen("Format: ")]);
+      mtx::string::strip(m_format);
 
-    } else if (SSA_SECTION_EVENTS == section) {
-      if (balg::istarts_with(line, "Format: ")) {
-        // Analyze the format string.
-        m_format = mtx::string::split(&line.c_str()[strlen("Format: ")]);
-        mtx::string::strip(m_format);
-
-        // Let's see if "Actor" is used in the format instead of "Name".
-        size_t i;
-        for (i = 0; m_format.size() > i; ++i)
-          if (balg::iequals(m_format[i], "actor")) {
-            name_field = "Actor";
-            break;
-          }
-
-      } else if (balg::istarts_with(line, "Dialogue: ")) {
-        if (m_format.empty())
-          throw mtx::input::extended_x(Y("ssa_reader: Invalid format. Could not find the \"Format\" line in the \"[Events]\" section."));
-
-        std::string orig_line = line;
-
-        line.erase(0, strlen("Dialogue: ")); // Trim the start.
-
-        // Split the line into fields.
-        std::vector<std::string> fields = mtx::string::split(line.c_str(), ",", m_format.size());
-        while (fields.size() < m_format.size())
-          fields.push_back(""s);
-
-        // Parse the start time.
-        auto stime = get_element("Start", fields);
-        auto start = parse_time(stime);
-        stime      = get_element("End", fields);
-        auto end   = parse_time(stime);
-
-        if (   (0     > start)
-            || (0     > end)
-            || (start > end)) {
-          mxwarn_tid(m_file_name, m_track_id, fmt::format(FY("SSA/ASS: The following line will be skipped as one of the timestamps is less than 0, or the end timestamp is less than the start timestamp: {0}\n"), orig_line));
-          continue;
+      // Let's see if "Actor" is used in the format instead of "Name".
+      size_t i;
+      for (i = 0; m_format.size() > i; ++i)
+        if (balg::iequals(m_format[i], "actor")) {
+          m_name_field = "Actor";
+          break;
         }
 
-        // Specs say that the following fields are to put into the block:
-        // ReadOrder, Layer, Style, Name, MarginL, MarginR, MarginV, Effect,
-        //   Text
-
-        std::string comma = ",";
-        line
-          = fmt::to_string(num)                     + comma
-          + get_element("Layer", fields)            + comma
-          + get_element("Style", fields)            + comma
-          + get_element(name_field.c_str(), fields) + comma
-          + get_element("MarginL", fields)          + comma
-          + get_element("MarginR", fields)          + comma
-          + get_element("MarginV", fields)          + comma
-          + get_element("Effect", fields)           + comma
-          + get_element("Text", fields);
-
-        add(start, end, num, line);
-        num++;
-
-        add_to_global = false;
-      }
+    } else if (balg::istarts_with(line, "Dialogue: ")) {
+      if (m_format.empty())
+        throw mtx::input::extended_x(Y("ssa_reader: Invalid format. Could not find the \"Format\" line in the \"[Events]\" section."));
+
+      std::string orig_line = line;
+
+      line.erase(0, strlen("Dialogue: ")); // Trim the start.
 
-    } else if ((SSA_SECTION_FONTS == section) || (SSA_SECTION_GRAPHICS == section)) {
-      if (balg::istarts_with(line, "fontname:")) {
-        add_attachment_maybe(attachment_name, attachment_data_uu, section);
+      // Split the line into fields.
+      std::vector<std::string> fields = mtx::string::split(line.c_str(), ",", m_format.size());
+      while (fields.size() < m_format.size())
+        fields.push_back(""s);
 
-        line.erase(0, strlen("fontname:"));
-        mtx::string::strip(line, true);
-        attachment_name = line;
+      // Parse the start time.
+      auto stime = get_element("Start", fields);
+      auto start = parse_time(stime);
+      stime      = get_element("End", fields);
+      auto end   = parse_time(stime);
 
-      } else {
-        mtx::string::strip(line, true);
-        attachment_data_uu += line;
+      if (   (0     > start)
+          || (0     > end)
+          || (start > end)) {
+        warn(fmt::format(FY("SSA/ASS: The following line will be skipped as one of the timestamps is less than 0, or the end timestamp is less than the start timestamp: {0}\n"), orig_line));
+        return true;
       }
 
+      // Specs say that the following fields are to put into the block:
+      // ReadOrder, Layer, Style, Name, MarginL, MarginR, MarginV, Effect,
+      //   Text
+
+      std::string comma = ",";
+      line
+        = fmt::to_string(m_num)                       + comma
+        + get_element("Layer", fields)              + comma
+        + get_element("Style", fields)              + comma
+        + get_element(m_name_field.c_str(), fields) + comma
+        + get_element("MarginL", fields)            + comma
+        + get_element("MarginR", fields)            + comma
+        + get_element("MarginV", fields)            + comma
+        + get_element("Effect", fields)             + comma
+        + get_element("Text", fields);
+
+      add(start, end, m_num, line);
+      m_num++;
+
       add_to_global = false;
     }
 
-    if (add_to_global) {
-      m_global += line;
-      m_global += "\r\n";
+  } else if ((SSA_SECTION_FONTS == m_section) || (SSA_SECTION_GRAPHICS == m_section)) {
+    if (balg::istarts_with(line, "fontname:")) {
+      add_attachment_maybe(m_attachment_name, m_attachment_data_uu, m_section);
+
+      line.erase(0, strlen("fontname:"));
+      mtx::string::strip(line, true);
+      m_attachment_name = line;
+
+    } else {
+      mtx::string::strip(line, true);
+      m_attachment_data_uu += line;
     }
 
-    if (previous_section != section)
-      add_attachment_maybe(attachment_name, attachment_data_uu, previous_section);
+    add_to_global = false;
+  }
 
-    previous_section = section;
+  // The global data is complete after the first pass already.
+  if (add_to_global && !m_second_pass) {
+    m_global += line;
+    m_global += "\r\n";
   }
 
-  sort();
+  if (m_previous_section != m_section)
+    add_attachment_maybe(m_attachment_name, m_attachment_data_uu, m_previous_section);
+
+  m_previous_section = m_section;
+
+  return true;
 }
 
 std::string
@@ -547,7 +648,7 @@ void
 ssa_parser_c::add_attachment_maybe(std::string &name,
                                    std::string &data_uu,
                                    ssa_section_e section) {
-  if (name.empty() || data_uu.empty() || ((SSA_SECTION_FONTS != section) && (SSA_SECTION_GRAPHICS != section))) {
+  if (m_second_pass || name.empty() || data_uu.empty() || ((SSA_SECTION_FONTS != section) && (SSA_SECTION_GRAPHICS != section))) {
     name    = "";
     data_uu = "";
     return;
@@ -15,6 +15,8 @@
 
 #include "common/common_pch.h"
 
+#include <QRegularExpression>
+
 #include "merge/output_control.h"
 #include "output/p_textsubs.h"
 
@@ -35,7 +37,6 @@ struct sub_t {
 class subtitles_c {
 protected:
   std::deque<sub_t> entries;
-  std::deque<sub_t>::iterator current;
   charset_converter_cptr m_cc_utf8;
   bool m_try_utf8{}, m_invalid_utf8_warned{};
   std::string m_file_name;
@@ -43,42 +44,56 @@ protected:
   unsigned int m_num_skipped{};
   debugging_option_c m_debug{"srt_parser|ssa_parser|subtitle_parser"};
 
+  // Streaming: the first pass over the file determines whether or
+  // not the entries are sorted (and outputs warnings). Its entries are
+  // kept as long as their total size doesn't exceed
+  // m_max_kept_byte_size, making a second pass unnecessary. Otherwise
+  // the second pass is done on demand while muxing if the entries are
+  // sorted, and only the entries not processed yet are kept in memory.
+  bool m_scanning{}, m_second_pass{}, m_streaming{}, m_end_of_file{}, m_needs_sorting{}, m_entries_dropped{};
+  int64_t m_last_start{}, m_total_byte_size{}, m_max_kept_byte_size{16 * 1024 * 1024};
+
 public:
   subtitles_c(std::string const &file_name, int64_t track_id);
+  virtual ~subtitles_c() = default;
+
+  void parse(bool streaming = false);
+
   void add_maybe(int64_t start, int64_t end, unsigned int number, const std::string &subs);
-  void add(int64_t start, int64_t end, unsigned int number, const std::string &subs) {
-    entries.push_back(sub_t(start, end, number, subs));
-  }
-  void reset() {
-    current = entries.begin();
-  }
-  int get_num_entries() {
-    return entries.size();
-  }
-  int get_num_processed() {
-    return std::distance(entries.begin(), current);
-  }
+  void add(int64_t start, int64_t end, unsigned int number, const std::string &subs);
   void process(generic_packetizer_c *);
   void sort() {
     std::stable_sort(entries.begin(), entries.end());
-    reset();
   }
-  bool empty() {
-    return current == entries.end();
+  bool empty();
+
+  bool is_streaming() const {
+    return m_streaming;
+  }
+
+  void set_max_kept_byte_size(int64_t max_kept_byte_size) {
+    m_max_kept_byte_size = max_kept_byte_size;
   }
 
   int64_t get_total_byte_size() {
-    return std::accumulate(entries.begin(), entries.end(), 0ull, [](int64_t num, auto const &entry) { return num + entry.subs.length(); });
+    return m_total_byte_size;
   }
 
   int64_t get_next_byte_size() {
-    if (empty() || (entries.end() == current))
-      return 0;
-    return current->subs.length();
+    return empty() ? 0 : entries.front().subs.length();
   }
 
   void set_charset_converter(charset_converter_cptr const &cc_utf8);
   std::string recode(std::string const &s, uint32_t replacement_marker = 0xfffdu);
+
+protected:
+  // Seeks to the start of the file & resets the parser's state.
+  virtual void start_parsing() = 0;
+  // Parses the next line. Returns false at the end of the file or if
+  // parsing had to be aborted.
+  virtual bool parse_next_line() = 0;
+
+  void warn(std::string const &message);
 };
 using subtitles_cptr = std::shared_ptr<subtitles_c>;
 
@@ -93,14 +108,24 @@ public:
 
 protected:
   mm_text_io_cptr m_io;
-  bool m_coordinates_warning_shown;
+  bool m_coordinates_warning_shown{}, m_timestamp_warning_printed{};
+  QRegularExpression m_timestamp_re, m_number_re, m_coordinates_re;
+
+  int64_t m_start{}, m_end{}, m_previous_start{};
+  parser_state_e m_state{STATE_INITIAL};
+  int m_line_number{};
+  unsigned int m_subtitle_number{}, m_timestamp_number{};
+  std::string m_subtitles;
 
 public:
   srt_parser_c(mm_text_io_cptr const &io, const std::string &file_name, int64_t track_id);
-  void parse();
 
 public:
   static bool probe(mm_text_io_c &io);
+
+protected:
+  virtual void start_parsing() override;
+  virtual bool parse_next_line() override;
 };
 using srt_parser_cptr = std::shared_ptr<srt_parser_c>;
 
@@ -123,12 +148,16 @@ protected:
   std::string m_global;
   int64_t m_attachment_id;
 
+  QRegularExpression m_sec_styles_ass_re, m_sec_styles_re, m_sec_info_re, m_sec_events_re, m_sec_graphics_re, m_sec_fonts_re;
+  int m_num{};
+  ssa_section_e m_section{SSA_SECTION_NONE}, m_previous_section{SSA_SECTION_NONE};
+  std::string m_name_field, m_attachment_name, m_attachment_data_uu;
+
 public:
   std::vector<attachment_t> m_attachments;
 
 public:
   ssa_parser_c(generic_reader_c &reader, mm_text_io_cptr const &io, const std::string &file_name, int64_t track_id);
-  void parse();
 
   bool is_ass() {
     return m_is_ass;
@@ -146,6 +175,9 @@ public:
   static bool probe(mm_text_io_c &io);
 
 protected:
+  virtual void start_parsing() override;
+  virtual bool parse_next_line() override;
+
   int64_t parse_time(std::string &time);
   std::string get_element(const char *index, std::vector<std::string> &fields);
   void add_attachment_maybe(std::string &name, std::string &data_uu, ssa_section_e section);
@@ -0,0 +1,248 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit https://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+
+   copying Matroska clusters block by block
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <matroska/KaxBlock.h>
+#include <matroska/KaxCluster.h>
+#include <matroska/KaxSegment.h>
+
+#include "common/doc_type_version_handler.h"
+#include "common/ebml.h"
+#include "common/mm_mem_io.h"
+#include "common/vint.h"
+#include "merge/block_copier.h"
+#include "merge/checkpoint.h"
+#include "merge/cluster_helper.h"
+#include "merge/cues.h"
+#include "merge/ebml_crc32.h"
+#include "merge/generic_packetizer.h"
+#include "merge/libmatroska_extensions.h"
+#include "merge/output_control.h"
+
+namespace mtx::merge {
+
+namespace {
+
+debugging_option_c s_debug{"block_copier"};
+
+void
+write_uint_element(mm_io_c &out,
+                   libebml::EbmlId const &id,
+                   uint64_t value) {
+  uint8_t buffer[8];
+  auto size = 1u;
+
+  while ((size < 8) && (value >> (8 * size)))
+    ++size;
+
+  for (auto idx = 0u; idx < size; ++idx)
+    buffer[idx] = value >> (8 * (size - idx - 1));
+
+  write_ebml_element_head(out, id, size);
+  out.write(buffer, size);
+}
+
+}
+
+block_copier_c::block_copier_c(int64_t timestamp_scale)
+  : m_timestamp_scale{timestamp_scale}
+{
+}
+
+void
+block_copier_c::add_track(uint64_t track_number,
+                          generic_packetizer_c &packetizer) {
+  m_packetizers[track_number] = &packetizer;
+}
+
+void
+block_copier_c::copy_cluster(mtx::kax::block_iterator_c &iterator) {
+  auto &out              = *g_cluster_helper->get_output();
+  auto cluster_timestamp = static_cast<int64_t>(iterator.get_timestamp());
+  auto data_offset       = g_write_crc32 ? crc32_element_size : 0u;
+  auto num_blocks        = 0u;
+
+  mm_mem_io_c content{nullptr, 0, 1024 * 1024};
+  std::vector<cue_point_t> cue_points;
+
+  write_uint_element(content, EBML_ID(kax_cluster_timestamp_c), cluster_timestamp);
+
+  while (auto block = iterator.next()) {
+    auto const &header = block->header;
+    auto itr           = m_packetizers.find(header.track_number);
+
+    if (itr == m_packetizers.end())
+      continue;
+
+    auto &packetizer        = *itr->second;
+    auto relative_position  = data_offset + content.getFilePointer();
+    auto num_frames         = static_cast<int64_t>(block->frames.size());
+    auto timestamp          = (cluster_timestamp + header.relative_timestamp) * m_timestamp_scale;
+    auto block_duration     = header.duration ? static_cast<int64_t>(*header.duration) * m_timestamp_scale : std::max<int64_t>(packetizer.get_track_default_duration(), 0) * num_frames;
+    auto frame_duration     = num_frames ? block_duration / num_frames : 0;
+
+    copy_block(content, *iterator.get_raw_element(header), packetizer.get_track_num());
+    ++num_blocks;
+
+    for (auto idx = 0; idx < num_frames; ++idx)
+      g_cluster_helper->account_copied_frame(packetizer, timestamp + idx * frame_duration, frame_duration, block->frames[idx]->get_size());
+
+    if (g_write_cues && add_to_cues_maybe(packetizer, *block, timestamp))
+      cue_points.push_back({ static_cast<uint64_t>(timestamp), packetizer.wants_cue_duration() ? static_cast<uint64_t>(block_duration) : 0, 0,
+                             static_cast<uint32_t>(packetizer.get_track_num()), static_cast<uint32_t>(relative_position) });
+  }
+
+  if (!num_blocks) {
+    mxdebug_if(s_debug, fmt::format("copy_cluster: no blocks to copy in cluster at {0}\n", iterator.get_position()));
+    return;
+  }
+
+  auto cluster_position = out.getFilePointer();
+  auto content_size     = data_offset + content.getFilePointer();
+  auto write_cluster    = [&content, content_size](mm_io_c &cluster_out) {
+    write_ebml_element_head(cluster_out, EBML_ID(libmatroska::KaxCluster), content_size);
+    if (g_write_crc32)
+      write_crc32_placeholder(cluster_out);
+    cluster_out.write(content.get_buffer(), content.getFilePointer());
+  };
+
+  if (g_write_crc32)
+    render_with_crc32(out, write_cluster);
+  else
+    write_cluster(out);
+
+  auto cluster_size = out.getFilePointer() - cluster_position;
+
+  mxdebug_if(s_debug, fmt::format("copy_cluster: copied {0} blocks from cluster at {1} to {2}; size {3} timestamp {4}\n", num_blocks, iterator.get_position(), cluster_position, cluster_size, cluster_timestamp));
+
+  for (auto &point : cue_points) {
+    point.cluster_position = g_kax_segment->GetRelativePosition(cluster_position);
+    cues_c::get().add(point);
+  }
+
+  g_cluster_helper->account_copied_cluster(cluster_timestamp * m_timestamp_scale, cluster_size);
+
+  checkpoint::cluster_rendered(out, cluster_timestamp * m_timestamp_scale);
+
+  if (g_flush_after_clusters)
+    out.flush();
+}
+
+void
+block_copier_c::copy_block(mm_io_c &out,
+                           memory_c const &element,
+                           uint64_t track_number) {
+  static auto const s_simple_block_id = EBML_ID(libmatroska::KaxSimpleBlock).GetValue();
+  static auto const s_block_id        = EBML_ID(libmatroska::KaxBlock).GetValue();
+
+  // The element's structure has been verified by the block iterator
+  // when the cluster was loaded.
+  auto buffer = element.get_buffer();
+  mm_mem_io_c in{element};
+
+  auto id            = vint_c::read_ebml_id(in);
+  auto size          = vint_c::read(in);
+  auto content_start = in.getFilePointer();
+
+  account_element_id(id);
+
+  if (id.m_value == s_simple_block_id) {
+    copy_block_with_track_number(out, id, buffer + content_start, size.m_value, track_number);
+    return;
+  }
+
+  // Only the Block child of a BlockGroup contains the track number.
+  // All other children are copied as they are.
+  mm_mem_io_c group_content{nullptr, 0, 1024};
+
+  while (in.getFilePointer() < element.get_size()) {
+    auto child_position = in.getFilePointer();
+    auto child_id       = vint_c::read_ebml_id(in);
+    auto child_size     = vint_c::read(in);
+    auto child_start    = in.getFilePointer();
+
+    account_element_id(child_id);
+
+    if (child_id.m_value == s_block_id)
+      copy_block_with_track_number(group_content, child_id, buffer + child_start, child_size.m_value, track_number);
+    else
+      group_content.write(buffer + child_position, child_start + child_size.m_value - child_position);
+
+    in.setFilePointer(child_start + child_size.m_value);
+  }
+
+  write_ebml_element_head(out, id.to_ebml_id(), group_content.getFilePointer());
+  out.write(group_content.get_buffer(), group_content.getFilePointer());
+}
+
+void
+block_copier_c::copy_block_with_track_number(mm_io_c &out,
+                                             vint_c const &id,
+                                             uint8_t const *content,
+                                             uint64_t content_size,
+                                             uint64_t track_number) {
+  mm_mem_io_c in{content, content_size};
+
+  auto old_track_number = vint_c::read(in);
+  auto remaining_size   = content_size - old_track_number.m_coded_size;
+  auto coded_size       = libebml::CodedSizeLength(track_number, 0);
+  uint8_t coded_track_number[8];
+
+  libebml::CodedValueLength(track_number, coded_size, coded_track_number);
+
+  write_ebml_element_head(out, id.to_ebml_id(), coded_size + remaining_size);
+  out.write(coded_track_number, coded_size);
+  out.write(content + old_track_number.m_coded_size, remaining_size);
+}
+
+bool
+block_copier_c::add_to_cues_maybe(generic_packetizer_c &packetizer,
+                                  mtx::kax::block_t const &block,
+                                  int64_t timestamp) {
+  // The same rules as in cluster_helper_c::add_to_cues_maybe().
+  auto strategy     = packetizer.get_cue_creation();
+  auto is_key_frame = block.header.is_key_frame();
+
+  auto add = ((CUE_STRATEGY_IFRAMES == strategy) && is_key_frame)
+          || !!block.codec_state
+          || (CUE_STRATEGY_ALL == strategy)
+          || (   (CUE_STRATEGY_SPARSE == strategy)
+              && (track_audio         == packetizer.get_track_type())
+              && !g_video_packetizer
+              && is_key_frame
+              && (   (0 > packetizer.get_last_cue_timestamp())
+                  || ((timestamp - packetizer.get_last_cue_timestamp()) >= 500'000'000)));
+
+  if (!add)
+    return false;
+
+  packetizer.set_last_cue_timestamp(timestamp);
+  g_cue_writing_requested = 1;
+
+  return true;
+}
+
+void
+block_copier_c::account_element_id(vint_c const &id) {
+  // The DocTypeVersion depends on the elements used, e.g. on
+  // SimpleBlock or DiscardPadding.
+  if (!m_accounted_ids.insert(id.m_value).second)
+    return;
+
+  auto element = std::unique_ptr<libebml::EbmlElement>(create_ebml_element(EBML_INFO(libmatroska::KaxCluster), id.to_ebml_id()));
+  if (element)
+    g_doc_type_version_handler->account(*element, true);
+}
+
+}
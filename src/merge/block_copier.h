@@ -0,0 +1,54 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit https://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+
+   copying Matroska clusters block by block
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#pragma once
+
+#include "common/common_pch.h"
+
+#include "common/kax_block_iterator.h"
+
+class generic_packetizer_c;
+class vint_c;
+
+namespace mtx::merge {
+
+// Copies clusters read from a Matroska file to the destination file
+// without creating packets for their frames. Only the track numbers
+// in the blocks are rewritten; blocks of tracks without a packetizer
+// are dropped. The cues & track statistics are generated from the
+// blocks' headers. The packetizers are only used for the track
+// headers.
+class block_copier_c {
+protected:
+  std::unordered_map<uint64_t, generic_packetizer_c *> m_packetizers;
+  std::unordered_set<int64_t> m_accounted_ids;
+  int64_t m_timestamp_scale;
+
+public:
+  explicit block_copier_c(int64_t timestamp_scale);
+
+  void add_track(uint64_t track_number, generic_packetizer_c &packetizer);
+
+  // Writes a cluster containing the blocks of the cluster loaded into
+  // iterator whose tracks have been added. Nothing is written if none
+  // of them has.
+  void copy_cluster(mtx::kax::block_iterator_c &iterator);
+
+protected:
+  void copy_block(mm_io_c &out, memory_c const &element, uint64_t track_number);
+  void copy_block_with_track_number(mm_io_c &out, vint_c const &id, uint8_t const *content, uint64_t content_size, uint64_t track_number);
+  bool add_to_cues_maybe(generic_packetizer_c &packetizer, mtx::kax::block_t const &block, int64_t timestamp);
+  void account_element_id(vint_c const &id);
+};
+
+}
@@ -0,0 +1,386 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit https://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+
+   checkpoints for restarting interrupted multiplexing jobs
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <chrono>
+
+#include "common/checksums/base.h"
+#include "common/json.h"
+#include "common/mm_file_io.h"
+#include "common/mm_io_x.h"
+#include "common/mm_proxy_io.h"
+#include "common/mm_proxy_io_p.h"
+#include "common/mm_text_io.h"
+#include "common/path.h"
+#include "common/random.h"
+#include "common/strings/formatting.h"
+#include "merge/checkpoint.h"
+#include "merge/cluster_helper.h"
+#include "merge/output_control.h"
+
+namespace mtx::merge::checkpoint {
+
+namespace {
+
+unsigned int const s_format_version = 1;
+auto const s_interval               = std::chrono::seconds{10};
+
+debugging_option_c s_debug{"checkpoint"};
+
+std::string s_file_name, s_arguments_hash;
+bool s_restart{};
+std::optional<uint64_t> s_random_seed;
+std::optional<int64_t> s_writing_date;
+uint64_t s_position{}, s_checksum{};
+int64_t s_timestamp{-1};
+std::chrono::steady_clock::time_point s_next_checkpoint;
+std::weak_ptr<output_io_c> s_output;
+
+std::string
+hash_arguments(std::vector<std::string> const &args) {
+  std::string all;
+
+  for (auto const &arg : args)
+    if (arg != "--restart")
+      all += arg + '\0';
+
+  return mtx::checksum::calculate_as_hex_string(mtx::checksum::algorithm_e::md5, all.c_str(), all.size());
+}
+
+void
+load() {
+  std::string buffer;
+
+  try {
+    mm_text_io_c in{std::make_shared<mm_file_io_c>(s_file_name)};
+    in.read(buffer, in.get_size());
+
+  } catch (mtx::mm_io::exception &ex) {
+    mxerror(fmt::format(FY("The checkpoint file '{0}' could not be opened for reading: {1}.\n"), s_file_name, ex));
+  }
+
+  try {
+    auto doc = mtx::json::parse(buffer);
+
+    if (doc.value("version", 0u) != s_format_version)
+      throw std::domain_error{Y("unsupported format version")};
+
+    if (doc.value("arguments_hash", std::string{}) != s_arguments_hash)
+      throw std::domain_error{Y("the command line differs from the one used for creating the checkpoint")};
+
+    s_position  = doc.at("position").get<uint64_t>();
+    s_checksum  = doc.at("checksum").get<uint64_t>();
+    s_timestamp = doc.at("timestamp").get<int64_t>();
+
+    if (doc.contains("random_seed"))
+      s_random_seed = doc["random_seed"].get<uint64_t>();
+    if (doc.contains("writing_date"))
+      s_writing_date = doc["writing_date"].get<int64_t>();
+
+  } catch (std::exception &ex) {
+    mxerror(fmt::format(FY("The checkpoint file '{0}' cannot be used: {1}.\n"), s_file_name, ex.what()));
+  }
+}
+
+void
+save() {
+  auto doc = nlohmann::json{
+    { "version",        s_format_version },
+    { "output_file",    g_outfile        },
+    { "arguments_hash", s_arguments_hash },
+    { "position",       s_position       },
+    { "checksum",       s_checksum       },
+    { "timestamp",      s_timestamp      },
+  };
+
+  if (s_random_seed)
+    doc["random_seed"] = *s_random_seed;
+  if (s_writing_date)
+    doc["writing_date"] = *s_writing_date;
+
+  // Write to a temporary file first so that an interruption while
+  // writing doesn't destroy the previous checkpoint.
+  auto temp_file_name = s_file_name + ".tmp";
+
+  try {
+    {
+      mm_file_io_c out{temp_file_name, libebml::MODE_CREATE};
+      out.write(mtx::json::dump(doc, 2) + "\n");
+    }
+
+    boost::filesystem::rename(mtx::fs::to_path(temp_file_name), mtx::fs::to_path(s_file_name));
+
+  } catch (mtx::mm_io::exception &ex) {
+    mxwarn(fmt::format(FY("The checkpoint file '{0}' could not be written: {1}.\n"), s_file_name, ex));
+
+  } catch (boost::filesystem::filesystem_error &ex) {
+    mxwarn(fmt::format(FY("The checkpoint file '{0}' could not be written: {1}.\n"), s_file_name, ex.what()));
+  }
+
+  mxdebug_if(s_debug, fmt::format("checkpoint: saved at position {0} timestamp {1}\n", s_position, mtx::string::format_timestamp(s_timestamp)));
+}
+
+}
+
+output_io_c::output_io_c(mm_io_cptr const &proxy_io)
+  : mm_proxy_io_c{proxy_io}
+{
+}
+
+output_io_c::output_io_c(mm_io_cptr const &proxy_io,
+                         uint64_t restart_position,
+                         uint64_t restart_checksum)
+  : mm_proxy_io_c{proxy_io}
+  , m_restart_position{restart_position}
+  , m_restart_checksum{restart_checksum}
+  , m_skipping{true}
+{
+}
+
+output_io_c::~output_io_c() {
+}
+
+void
+output_io_c::setFilePointer(int64_t offset,
+                            libebml::seek_mode mode) {
+  // The file's actual size is the checkpoint's position. While
+  // replaying report the size the destination file would have at
+  // this point instead.
+  if (m_skipping && (libebml::seek_end == mode))
+    mm_proxy_io_c::setFilePointer(m_end + offset, libebml::seek_beginning);
+  else
+    mm_proxy_io_c::setFilePointer(offset, mode);
+}
+
+bool
+output_io_c::preallocate(int64_t size) {
+  return !m_skipping && mm_proxy_io_c::preallocate(size);
+}
+
+uint64_t
+output_io_c::get_appended_size()
+  const {
+  return m_end;
+}
+
+uint64_t
+output_io_c::get_checksum()
+  const {
+  return m_checksum.get_result_as_uint();
+}
+
+uint32_t
+output_io_c::_read(void *buffer,
+                   size_t size) {
+  // Data is only read back from the destination file when it has to
+  // be moved, e.g. when the track headers grow. The interrupted run
+  // may have moved it already.
+  if (m_skipping)
+    mxerror(fmt::format(FY("The file '{0}' cannot be restarted as data written before the checkpoint would have to be moved. Start the multiplexing from the beginning without '--restart'.\n"), get_file_name()));
+
+  return mm_proxy_io_c::_read(buffer, size);
+}
+
+size_t
+output_io_c::_write(const void *buffer,
+                    size_t size) {
+  auto position = getFilePointer();
+  auto data     = static_cast<uint8_t const *>(buffer);
+
+  if (m_skipping && (position == m_end) && ((position + size) <= m_restart_position)) {
+    add_appended(position, data, size);
+    p_func()->cached_size = -1;
+    mm_proxy_io_c::setFilePointer(m_end, libebml::seek_beginning);
+
+    if (m_end == m_restart_position)
+      verify_skipped_data();
+
+    return size;
+  }
+
+  if (m_skipping && ((position + size) > m_restart_position)) {
+    if (position < m_restart_position)
+      add_appended(position, data, m_restart_position - position);
+    verify_skipped_data();
+  }
+
+  add_appended(position, data, size);
+
+  return mm_proxy_io_c::_write(buffer, size);
+}
+
+void
+output_io_c::add_appended(uint64_t position,
+                          uint8_t const *buffer,
+                          std::size_t size) {
+  if ((position + size) <= m_end)
+    return;
+
+  auto already_appended = position < m_end ? m_end - position : 0;
+
+  m_checksum.add(buffer + already_appended, size - already_appended);
+  m_end = position + size;
+}
+
+void
+output_io_c::verify_skipped_data() {
+  m_skipping = false;
+
+  mxdebug_if(s_debug, fmt::format("output_io: end of skipped data at {0} (expected {1}), checksum 0x{2:08x} (expected 0x{3:08x})\n", m_end, m_restart_position, get_checksum(), m_restart_checksum));
+
+  if ((m_end != m_restart_position) || (get_checksum() != m_restart_checksum))
+    mxerror(fmt::format(FY("The file '{0}' cannot be restarted as the data written before the checkpoint differs from the data written now. Start the multiplexing from the beginning without '--restart'.\n"), get_file_name()));
+}
+
+void
+set_file_name(std::string const &file_name) {
+  s_file_name = file_name;
+}
+
+void
+request_restart() {
+  s_restart = true;
+}
+
+void
+prepare(std::vector<std::string> const &args) {
+  if (s_file_name.empty()) {
+    if (s_restart)
+      mxerror(Y("'--restart' requires '--checkpoint'.\n"));
+    return;
+  }
+
+  s_arguments_hash = hash_arguments(args);
+
+  if (s_restart)
+    load();
+
+  // The output must be identical to the one of the interrupted
+  // run. '--deterministic' takes care of that on its own.
+  else if (!g_deterministic)
+    s_random_seed = random_c::generate_64bits();
+
+  if (s_random_seed)
+    random_c::init(*s_random_seed);
+}
+
+void
+init() {
+  if (s_file_name.empty())
+    return;
+
+  if (g_cluster_helper->splitting())
+    mxerror(Y("Checkpoints cannot be used together with splitting.\n"));
+
+  s_next_checkpoint = std::chrono::steady_clock::now() + s_interval;
+
+  if (s_restart)
+    mxinfo(fmt::format(FY("Restarting the multiplexing. The data up to the checkpoint at {0} (position {1}) is verified instead of being written again.\n"), mtx::string::format_timestamp(s_timestamp), s_position));
+}
+
+bool
+is_enabled() {
+  return !s_file_name.empty();
+}
+
+bool
+is_restarting() {
+  return s_restart;
+}
+
+mm_io_cptr
+open_output_file(std::string const &file_name) {
+  if (!s_restart) {
+    auto output = std::make_shared<output_io_c>(std::make_shared<mm_file_io_c>(file_name, libebml::MODE_CREATE));
+    s_output    = output;
+
+    return output;
+  }
+
+  auto file = std::make_shared<mm_file_io_c>(file_name, libebml::MODE_WRITE);
+
+  if (file->get_size() < s_position)
+    mxerror(fmt::format(FY("The file '{0}' is shorter than the position stored in the checkpoint file '{1}'.\n"), file_name, s_file_name));
+
+  // Drop whatever the interrupted run wrote after the checkpoint.
+  file->truncate(s_position);
+
+  auto output = std::make_shared<output_io_c>(file, s_position, s_checksum);
+  s_output    = output;
+
+  return output;
+}
+
+QDateTime
+writing_date(QDateTime const &now) {
+  if (!is_enabled())
+    return now;
+
+  if (s_restart && s_writing_date)
+    return QDateTime::fromSecsSinceEpoch(*s_writing_date, Qt::UTC);
+
+  s_writing_date = now.toSecsSinceEpoch();
+
+  return QDateTime::fromSecsSinceEpoch(*s_writing_date, Qt::UTC);
+}
+
+void
+cluster_rendered(mm_io_c &out,
+                 int64_t timestamp) {
+  if (!is_enabled())
+    return;
+
+  auto now = std::chrono::steady_clock::now();
+  if (now < s_next_checkpoint)
+    return;
+
+  s_next_checkpoint = now + s_interval;
+
+  auto output = s_output.lock();
+  if (!output)
+    return;
+
+  out.flush();
+
+  // Nothing to do while the part written by the interrupted run is
+  // being replayed.
+  auto position = output->get_appended_size();
+  if (position <= s_position)
+    return;
+
+  try {
+    out.sync();
+
+  } catch (mtx::mm_io::exception &ex) {
+    mxwarn(fmt::format(FY("The checkpoint file '{0}' could not be written: {1}.\n"), s_file_name, ex));
+    return;
+  }
+
+  s_position  = position;
+  s_checksum  = output->get_checksum();
+  s_timestamp = timestamp;
+
+  save();
+}
+
+void
+finish() {
+  if (!is_enabled())
+    return;
+
+  boost::system::error_code ec;
+  boost::filesystem::remove(mtx::fs::to_path(s_file_name), ec);
+}
+
+}
@@ -0,0 +1,100 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit https://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+
+   checkpoints for restarting interrupted multiplexing jobs
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#pragma once
+
+#include "common/common_pch.h"
+
+#include <QDateTime>
+
+#include "common/checksums/adler32.h"
+#include "common/mm_proxy_io.h"
+
+namespace mtx::merge::checkpoint {
+
+/* Sits between the write buffer & the destination file. It keeps
+   track of the data appended to the file so far and of its checksum,
+   which is what a checkpoint refers to.
+
+   When restarting the whole multiplexing is done again from the
+   start. All writes are passed through to the destination file with
+   the exception of appending writes ending before the checkpoint's
+   position. Those have already been written by the interrupted run.
+   Their checksum is verified before anything is appended after that
+   position. Writes to earlier positions (e.g. updated track headers)
+   are always passed through so that they're repeated even if the
+   interrupted run didn't finish them.
+*/
+class output_io_c: public mm_proxy_io_c {
+protected:
+  uint64_t m_end{}, m_restart_position{}, m_restart_checksum{};
+  bool m_skipping{};
+  mtx::checksum::adler32_c m_checksum;
+
+public:
+  explicit output_io_c(mm_io_cptr const &proxy_io);
+  output_io_c(mm_io_cptr const &proxy_io, uint64_t restart_position, uint64_t restart_checksum);
+  virtual ~output_io_c();
+
+  virtual void setFilePointer(int64_t offset, libebml::seek_mode mode = libebml::seek_beginning) override;
+  virtual bool preallocate(int64_t size) override;
+
+  uint64_t get_appended_size() const;
+  uint64_t get_checksum() const;
+
+protected:
+  virtual uint32_t _read(void *buffer, size_t size) override;
+  virtual size_t _write(const void *buffer, size_t size) override;
+
+  void add_appended(uint64_t position, uint8_t const *buffer, std::size_t size);
+  void verify_skipped_data();
+};
+
+void set_file_name(std::string const &file_name);
+void request_restart();
+
+// Loads the checkpoint when restarting and seeds the random number
+// generator so that the output is reproducible. Must be called right
+// after the options needed at the beginning (including
+// '--deterministic') have been parsed as parsing the others may
+// already generate random numbers, e.g. for attachment UIDs.
+void prepare(std::vector<std::string> const &args);
+
+// Verifies the settings. Must be called after the command line has
+// been parsed.
+void init();
+
+bool is_enabled();
+bool is_restarting();
+
+// Opens the destination file wrapped in an output_io_c. When
+// restarting the file is only truncated to the checkpoint's position.
+// Everything up to that position is not written again but skipped
+// while the multiplexing is replayed.
+mm_io_cptr open_output_file(std::string const &file_name);
+
+// Returns the date stored in the checkpoint when restarting and
+// remembers `now` for the checkpoint otherwise.
+QDateTime writing_date(QDateTime const &now);
+
+// Called at cluster boundaries. Writes the checkpoint file if enough
+// time has passed since the last one. The destination file is synced
+// to the storage device first so that the checkpoint never refers to
+// data that isn't stored yet.
+void cluster_rendered(mm_io_c &out, int64_t timestamp);
+
+// Removes the checkpoint file after the destination file has been
+// finished successfully.
+void finish();
+
+}
@@ -21,14 +21,17 @@
 #include "common/hacks.h"
 #include "common/strings/formatting.h"
 #include "common/translation.h"
+#include "merge/checkpoint.h"
 #include "merge/cluster_helper.h"
 #include "merge/cues.h"
+#include "merge/ebml_crc32.h"
 #include "merge/generic_packetizer.h"
 #include "merge/generic_reader.h"
 #include "merge/libmatroska_extensions.h"
 #include "merge/output_control.h"
 #include "merge/packet_extensions.h"
 #include "merge/private/cluster_helper.h"
+#include "merge/profiling.h"
 
 #include <matroska/KaxBlock.h>
 #include <matroska/KaxBlockData.h>
@@ -270,6 +273,9 @@ cluster_helper_c::split(packet_cptr const &packet) {
 
 void
 cluster_helper_c::add_packet(packet_cptr const &packet) {
+  auto &profiling = mtx::merge::profiling::stage(mtx::merge::profiling::stage_e::add_packet);
+  mtx::profiling::scoped_timer_c timer{profiling};
+
   if (!m->cluster)
     prepare_new_cluster();
 
@@ -280,6 +286,9 @@ cluster_helper_c::add_packet(packet_cptr const &packet) {
   m->packets.push_back(packet);
   m->cluster_content_size += packet->data->get_size();
 
+  profiling.add(1, packet->data->get_size());
+  profiling.update_queue(m->packets.size(), m->cluster_content_size);
+
   if (packet->assigned_timestamp > m->max_timestamp_in_cluster)
     m->max_timestamp_in_cluster = packet->assigned_timestamp;
 
@@ -400,6 +409,10 @@ cluster_helper_c::must_duration_be_set(render_groups_c *rg,
 
 int
 cluster_helper_c::render() {
+  auto &profiling = mtx::merge::profiling::stage(mtx::merge::profiling::stage_e::render);
+  mtx::profiling::scoped_timer_c timer{profiling};
+
+  profiling.add(m->packets.size(), m->cluster_content_size);
 
   std::vector<render_groups_cptr> render_groups;
   kax_cues_with_cleanup_c cues;
@@ -585,11 +598,21 @@ cluster_helper_c::render() {
       m->cluster->set_min_timestamp(min_cl_timestamp - timestamp_offset);
       m->cluster->set_max_timestamp(max_cl_timestamp - timestamp_offset);
 
+      auto render_cluster = [this, &cues](mm_io_c &out) {
 #if LIBEBML_VERSION >= 0x020000
-      m->cluster->Render(*m->out, cues, std::bind(&cluster_helper_c::write_element_pred, this, std::placeholders::_1));
+        m->cluster->Render(out, cues, std::bind(&cluster_helper_c::write_element_pred, this, std::placeholders::_1));
 #else
-      m->cluster->Render(*m->out, cues);
+        m->cluster->Render(out, cues);
 #endif
+      };
+
+      if (g_write_crc32) {
+        mtx::merge::add_crc32_element(*m->cluster);
+        mtx::merge::render_with_crc32(*m->out, render_cluster);
+
+      } else
+        render_cluster(*m->out);
+
       g_doc_type_version_handler->account(*m->cluster);
       m->bytes_in_file += m->cluster->ElementSize();
 
@@ -600,6 +623,13 @@ cluster_helper_c::render() {
 
       cues_c::get().postprocess_cues(cues, *m->cluster);
 
+      mtx::merge::checkpoint::cluster_rendered(*m->out, m->previous_cluster_ts);
+
+      // Keep the latency low while source files are still being
+      // written to.
+      if (g_flush_after_clusters)
+        m->out->flush();
+
     } else
       m->previous_cluster_ts = -1;
   }
@@ -610,6 +640,39 @@ cluster_helper_c::render() {
   return 1;
 }
 
+/** \brief Accounts for a frame in a cluster that was copied
+
+   Clusters copied by the block copier bypass render(). The values the
+   file's duration, the chapters & the track statistics are based on
+   are updated here instead.
+*/
+void
+cluster_helper_c::account_copied_frame(generic_packetizer_c &source,
+                                       int64_t timestamp,
+                                       int64_t duration,
+                                       uint64_t num_bytes) {
+  if (-1 == m->first_timestamp_in_file)
+    m->first_timestamp_in_file = timestamp;
+  if (-1 == m->first_timestamp_in_part)
+    m->first_timestamp_in_part = timestamp;
+
+  m->min_timestamp_in_file      = std::min(timestamp_c::ns(timestamp), m->min_timestamp_in_file.value_or_max());
+  m->max_timestamp_in_file      = std::max(timestamp,                  m->max_timestamp_in_file);
+  m->max_timestamp_and_duration = std::max(timestamp + duration,       m->max_timestamp_and_duration);
+
+  if (g_video_packetizer == &source)
+    m->max_video_timestamp_rendered = std::max(timestamp + duration, m->max_video_timestamp_rendered);
+
+  m->track_statistics[ source.get_uid() ].account(timestamp, duration, num_bytes);
+}
+
+void
+cluster_helper_c::account_copied_cluster(int64_t timestamp,
+                                         uint64_t size) {
+  m->bytes_in_file       += size;
+  m->previous_cluster_ts  = timestamp;
+}
+
 bool
 cluster_helper_c::add_to_cues_maybe(packet_cptr const &pack) {
   auto &source  = *pack->source;
@@ -54,6 +54,8 @@ public:
   void add_packet(packet_cptr const &packet);
   int64_t get_timestamp();
   int render();
+  void account_copied_frame(generic_packetizer_c &source, int64_t timestamp, int64_t duration, uint64_t num_bytes);
+  void account_copied_cluster(int64_t timestamp, uint64_t size);
   int get_cluster_content_size();
   int64_t get_duration() const;
   int64_t get_first_timestamp_in_file() const;
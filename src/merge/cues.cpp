@@ -18,6 +18,7 @@
 #include "common/ebml.h"
 #include "common/hacks.h"
 #include "merge/cues.h"
+#include "merge/ebml_crc32.h"
 #include "merge/generic_packetizer.h"
 #include "merge/libmatroska_extensions.h"
 #include "merge/output_control.h"
@@ -70,6 +71,21 @@ cues_c::add(libmatroska::KaxCuePoint &point) {
   }
 }
 
+// For cue points whose duration & relative position are already
+// known, e.g. for clusters that were copied instead of rendered.
+void
+cues_c::add(cue_point_t point) {
+  if (m_no_cue_duration)
+    point.duration = 0;
+  if (m_no_cue_relative_position)
+    point.relative_position = 0;
+
+  m_points.push_back(point);
+
+  // Nothing left to determine for them in postprocess_cues().
+  m_num_cue_points_postprocessed = m_points.size();
+}
+
 void
 cues_c::write(mm_io_c &out,
               libmatroska::KaxSeekHead &seek_head) {
@@ -96,8 +112,29 @@ cues_c::write(mm_io_c &out,
   // Forcefully write the correct head and copy its content from the
   // temporary storage location.
   auto total_size = calculate_total_size();
-  write_ebml_element_head(out, EBML_ID(libmatroska::KaxCues), total_size);
 
+  if (g_write_crc32)
+    mtx::merge::render_with_crc32(out, [this, total_size](mm_io_c &crc32_out) {
+      write_ebml_element_head(crc32_out, EBML_ID(libmatroska::KaxCues), total_size + mtx::merge::crc32_element_size);
+      mtx::merge::write_crc32_placeholder(crc32_out);
+      write_points(crc32_out);
+    });
+
+  else {
+    write_ebml_element_head(out, EBML_ID(libmatroska::KaxCues), total_size);
+    write_points(out);
+  }
+
+  m_points.clear();
+  m_codec_state_position_map.clear();
+  m_num_cue_points_postprocessed = 0;
+
+  // auto end_all = mtx::sys::get_current_time_millis();
+  // mxinfo(fmt::format("dur sort {0} write {1} total {2}\n", end_sort - start, end_all - end_sort, end_all - start));
+}
+
+void
+cues_c::write_points(mm_io_c &out) {
   for (auto &point : m_points) {
     libmatroska::KaxCuePoint kc_point;
 
@@ -119,13 +156,6 @@ cues_c::write(mm_io_c &out,
 
     g_doc_type_version_handler->render(kc_point, out);
   }
-
-  m_points.clear();
-  m_codec_state_position_map.clear();
-  m_num_cue_points_postprocessed = 0;
-
-  // auto end_all = mtx::sys::get_current_time_millis();
-  // mxinfo(fmt::format("dur sort {0} write {1} total {2}\n", end_sort - start, end_all - end_sort, end_all - start));
 }
 
 void
@@ -47,6 +47,7 @@ public:
 
   void add(libmatroska::KaxCues &cues);
   void add(libmatroska::KaxCuePoint &point);
+  void add(cue_point_t point);
   void write(mm_io_c &out, libmatroska::KaxSeekHead &seek_head);
   void postprocess_cues(libmatroska::KaxCues &cues, libmatroska::KaxCluster &cluster);
   void set_duration_for_id_timestamp(uint64_t id, uint64_t timestamp, uint64_t duration);
@@ -57,6 +58,7 @@ public:
 
 protected:
   void sort();
+  void write_points(mm_io_c &out);
   std::multimap<id_timestamp_t, uint64_t> calculate_block_positions(libmatroska::KaxCluster &cluster) const;
   uint64_t calculate_total_size() const;
   uint64_t calculate_point_size(cue_point_t const &point) const;
@@ -0,0 +1,123 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit https://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+
+   EBML CRC-32 elements for level 1 elements
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <ebml/EbmlCrc32.h>
+#include <ebml/EbmlMaster.h>
+
+#include "common/checksums/crc.h"
+#include "common/ebml.h"
+#include "common/endian.h"
+#include "common/mm_mem_io.h"
+#include "merge/ebml_crc32.h"
+
+namespace mtx::merge {
+
+namespace {
+
+unsigned int
+get_vint_length(uint8_t first_byte) {
+  auto length = 1u;
+
+  for (auto mask = 0x80u; mask && !(first_byte & mask); mask >>= 1)
+    ++length;
+
+  return length;
+}
+
+/* Collects everything written in memory. Positions are reported as
+   if the data was written to the destination file at `start` so that
+   the rendered elements know where they will end up, e.g. for the
+   cues.
+*/
+class memory_render_io_c: public mm_mem_io_c {
+protected:
+  uint64_t m_start;
+
+public:
+  memory_render_io_c(uint64_t start)
+    : mm_mem_io_c{nullptr, 0, 1024 * 1024}
+    , m_start{start}
+  {
+  }
+
+  virtual ~memory_render_io_c() {
+  }
+
+  virtual uint64_t
+  getFilePointer() override {
+    return m_start + mm_mem_io_c::getFilePointer();
+  }
+
+  virtual void
+  setFilePointer(int64_t offset,
+                 libebml::seek_mode mode = libebml::seek_beginning) override {
+    mm_mem_io_c::setFilePointer(libebml::seek_beginning == mode ? offset - m_start : offset, mode);
+  }
+
+  std::size_t
+  get_rendered_size() {
+    mm_mem_io_c::setFilePointer(0, libebml::seek_end);
+    return mm_mem_io_c::getFilePointer();
+  }
+};
+
+}
+
+void
+add_crc32_element(libebml::EbmlMaster &master) {
+  if (master.ListSize() && is_type<libebml::EbmlCrc32>(master[0]))
+    return;
+
+  auto crc32 = new libebml::EbmlCrc32;
+  crc32->ForceCrc32(0);
+
+  master.InsertElement(*crc32, 0);
+}
+
+void
+write_crc32_placeholder(mm_io_c &out) {
+  uint8_t placeholder[crc32_element_size] = { 0xbf, 0x84, 0x00, 0x00, 0x00, 0x00 };
+  out.write(placeholder, crc32_element_size);
+}
+
+void
+render_with_crc32(mm_io_c &out,
+                  std::function<void(mm_io_c &)> const &render) {
+  memory_render_io_c rendered{out.getFilePointer()};
+
+  render(rendered);
+
+  // All bytes following the master element's head and its EBML
+  // CRC-32 child are covered by the CRC-32 as required by the EBML
+  // specification.
+  auto buffer    = rendered.get_buffer();
+  auto size      = rendered.get_rendered_size();
+  auto id_length = size ? get_vint_length(buffer[0]) : 0;
+  auto head_size = size > id_length ? id_length + get_vint_length(buffer[id_length]) + crc32_element_size : 0;
+
+  if (!head_size || (size < head_size) || (buffer[head_size - crc32_element_size] != 0xbf))
+    mxerror(fmt::format("The EBML CRC-32 element could not be found. {0}\n", BUGMSG));
+
+  mtx::checksum::crc32_ieee_le_c crc32{0xffffffffu};
+  crc32.set_xor_result(0xffffffffu);
+  crc32.add(buffer + head_size, size - head_size);
+  crc32.finish();
+
+  put_uint32_le(buffer + head_size - 4, crc32.get_result_as_uint());
+
+  out.write(buffer, size);
+}
+
+}
@@ -0,0 +1,42 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit https://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+
+   EBML CRC-32 elements for level 1 elements
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#pragma once
+
+#include "common/common_pch.h"
+
+namespace libebml {
+class EbmlMaster;
+}
+
+namespace mtx::merge {
+
+// ID (one byte), size (one byte) and four bytes of data.
+constexpr auto crc32_element_size = 6u;
+
+// Inserts an EBML CRC-32 element as the first child of `master`
+// unless it already has one. Its value is filled in by
+// render_with_crc32().
+void add_crc32_element(libebml::EbmlMaster &master);
+
+// Writes an EBML CRC-32 element whose value will be filled in by
+// render_with_crc32(). For elements whose head is written manually.
+void write_crc32_placeholder(mm_io_c &out);
+
+// Calls `render` with an I/O collecting the data in memory. `render`
+// must write exactly one master element whose first child is an EBML
+// CRC-32 element. The CRC-32 is stored in that child before the
+// element is written to `out` at its current position in one go.
+void render_with_crc32(mm_io_c &out, std::function<void(mm_io_c &)> const &render);
+
+}
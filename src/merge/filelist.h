@@ -20,6 +20,7 @@
 #include "merge/probe_range_info.h"
 
 class generic_reader_c;
+class mm_follow_io_c;
 class track_info_c;
 
 struct filelist_t {
@@ -49,6 +50,8 @@ struct filelist_t {
   size_t playlist_index{}, playlist_previous_filelist_id{};
   mm_mpls_multi_file_io_cptr playlist_mpls_in;
 
+  std::shared_ptr<mm_follow_io_c> follow_in;
+
   timestamp_c restricted_timestamp_min, restricted_timestamp_max;
 
   probe_range_info_t probe_range_info{};
@@ -33,6 +33,7 @@
 #include "merge/generic_packetizer.h"
 #include "merge/generic_reader.h"
 #include "merge/output_control.h"
+#include "merge/profiling.h"
 #include "merge/webm.h"
 
 namespace {
@@ -1527,10 +1528,16 @@ generic_packetizer_c::add_packet2(packet_cptr const &pack) {
   pack->timestamp_before_factory = pack->timestamp;
 
   m_packet_queue.push_back(pack);
+
+  m_profiling_output.add(1, pack->data->get_size());
+  m_profiling_output.update_queue(m_packet_queue.size(), m_enqueued_bytes);
+
   if (!m_timestamp_factory || (TFA_IMMEDIATE == m_timestamp_factory_application_mode))
     apply_factory_once(pack);
-  else
+  else {
+    mtx::profiling::scoped_timer_c timer{mtx::merge::profiling::stage(mtx::merge::profiling::stage_e::timestamp_factory)};
     apply_factory();
+  }
 
   after_packet_timestamped(*pack);
 
@@ -1812,6 +1819,10 @@ generic_packetizer_c::read(bool force) {
 
 void
 generic_packetizer_c::process(packet_cptr const &packet) {
+  mtx::profiling::scoped_timer_c timer{m_profiling_process};
+
+  m_profiling_process.add(1, packet->data ? packet->data->get_size() : 0);
+
   process_impl(packet);
 }
 
@@ -18,6 +18,7 @@
 #include <deque>
 
 #include "common/option_with_source.h"
+#include "common/profiling.h"
 #include "common/timestamp.h"
 #include "common/translation.h"
 #include "merge/block_addition_mapping.h"
@@ -113,6 +114,9 @@ public:
   int64_t m_append_timestamp_offset, m_max_timestamp_seen;
   bool m_relaxed_timestamp_checking;
 
+  // Packets handed over by the reader resp. added to the queue.
+  mtx::profiling::counters_t m_profiling_process, m_profiling_output;
+
 public:
   generic_packetizer_c(generic_reader_c *reader, track_info_c &ti, track_type type);
   virtual ~generic_packetizer_c();
@@ -19,6 +19,77 @@
 #include "merge/generic_reader.h"
 #include "merge/output_control.h"
 
+namespace {
+
+nlohmann::json
+verbose_info_to_object(mtx::id::verbose_info_t const &verbose_info) {
+  auto object = nlohmann::json::object();
+  for (auto const &property : verbose_info)
+    object[property.first] = property.second;
+
+  return object;
+}
+
+nlohmann::json
+container_to_json(id_result_t const &result) {
+  return nlohmann::json{
+    { "recognized", true                                        },
+    { "supported",  true                                        },
+    { "type",       result.info                                 },
+    { "properties", verbose_info_to_object(result.verbose_info) },
+  };
+}
+
+nlohmann::json
+track_to_json(id_result_t const &result) {
+  return nlohmann::json{
+    { "id",         result.id                                   },
+    { "type",       result.type                                 },
+    { "codec",      result.info                                 },
+    { "properties", verbose_info_to_object(result.verbose_info) },
+  };
+}
+
+nlohmann::json
+attachment_to_json(id_result_t const &result) {
+  return nlohmann::json{
+    { "id",           result.id                                   },
+    { "content_type", result.type                                 },
+    { "size",         result.size                                 },
+    { "description",  result.description                          },
+    { "file_name",    result.info                                 },
+    { "properties",   verbose_info_to_object(result.verbose_info) },
+  };
+}
+
+// The order of the top-level keys of the JSON identification output.
+// It's the order readers report their results in so that nothing but
+// the errors, which are added before the warnings, has to be kept
+// until its place has been reached.
+std::vector<std::string> const s_id_results_json_key_order{
+  "identification_format_version",
+  "file_name",
+  "container",
+  "tracks",
+  "attachments",
+  "chapters",
+  "global_tags",
+  "track_tags",
+  "warnings",
+  "errors",
+};
+
+// The keys of the entries readers report one by one.
+std::vector<std::string> const s_id_results_json_sections{
+  "tracks",
+  "attachments",
+  "chapters",
+  "global_tags",
+  "track_tags",
+};
+
+} // anonymous namespace
+
 static mtx_mp_rational_t s_probe_range_percentage{3, 10}; // 0.3%
 
 // ----------------------------------------------------------------------
@@ -68,11 +139,14 @@ generic_reader_c::read_all() {
 file_status_e
 generic_reader_c::read_next(generic_packetizer_c *packetizer,
                             bool force) {
+  mtx::profiling::scoped_timer_c timer{m_profiling};
+
   auto prior_progrss = get_progress();
   auto result        = read(packetizer, force);
   auto new_progress  = get_progress();
 
   add_to_progress(new_progress - prior_progrss);
+  m_profiling.add(0, new_progress - prior_progrss);
 
   return result;
 }
@@ -227,6 +301,12 @@ generic_reader_c::id_result_container(mtx::id::verbose_info_t const &verbose_inf
   m_id_results_container.verbose_info = verbose_info;
   m_id_results_container.verbose_info.emplace_back("container_type",          static_cast<int>(type));
   m_id_results_container.verbose_info.emplace_back("is_providing_timestamps", is_providing_timestamps());
+
+  if (!id_results_are_streamed())
+    return;
+
+  id_results_json_end_section();
+  id_results_json_stream().add("container", container_to_json(m_id_results_container));
 }
 
 void
@@ -236,7 +316,11 @@ generic_reader_c::id_result_track(int64_t track_id,
                                   mtx::id::verbose_info_t const &verbose_info) {
   id_result_t result(track_id, type, info, {}, 0);
   result.verbose_info = verbose_info;
-  m_id_results_tracks.push_back(result);
+
+  if (id_results_are_streamed())
+    id_results_json_add_to_section("tracks", track_to_json(result));
+  else
+    m_id_results_tracks.push_back(result);
 }
 
 void
@@ -249,20 +333,39 @@ generic_reader_c::id_result_attachment(int64_t attachment_id,
   id_result_t result(attachment_id, type, file_name, description, size);
   if (id)
     result.verbose_info.emplace_back("uid", *id);
-  m_id_results_attachments.push_back(result);
+
+  if (id_results_are_streamed())
+    id_results_json_add_to_section("attachments", attachment_to_json(result));
+  else
+    m_id_results_attachments.push_back(result);
 }
 
 void
 generic_reader_c::id_result_chapters(int num_entries) {
   id_result_t result(0, ID_RESULT_CHAPTERS, {}, {}, num_entries);
-  m_id_results_chapters.push_back(result);
+
+  if (id_results_are_streamed())
+    id_results_json_add_to_section("chapters", nlohmann::json{ { "num_entries", result.size } });
+  else
+    m_id_results_chapters.push_back(result);
 }
 
 void
 generic_reader_c::id_result_tags(int64_t track_id,
                                  int num_entries) {
   id_result_t result(track_id, ID_RESULT_TAGS, {}, {}, num_entries);
-  m_id_results_tags.push_back(result);
+
+  if (!id_results_are_streamed())
+    m_id_results_tags.push_back(result);
+
+  else if (ID_RESULT_GLOBAL_TAGS_ID == result.id)
+    id_results_json_add_to_section("global_tags", nlohmann::json{ { "num_entries", result.size } });
+
+  else
+    id_results_json_add_to_section("track_tags", nlohmann::json{
+      { "track_id",    result.id   },
+      { "num_entries", result.size },
+    });
 }
 
 void
@@ -311,68 +414,96 @@ generic_reader_c::display_identification_results_as_text() {
   }
 }
 
+/** \brief Whether or not identification results are output right away
+
+   In JSON mode the results aren't collected but written as soon as
+   the reader reports them so that the memory needed doesn't depend on
+   the number of tracks, attachments etc. The top-level keys are
+   written in a fixed order: the container, the tracks, attachments,
+   chapters, global tags & track tags. Readers must report them in that
+   order, and all entries of one kind (e.g. all tracks) must be
+   reported without entries of other kinds in between. Kinds a reader
+   doesn't report are written as empty arrays once a later kind is
+   reported.
+*/
+bool
+generic_reader_c::id_results_are_streamed()
+  const {
+  return g_identifying && (identification_output_format_e::json == g_identification_output_format);
+}
+
+mtx::json::streaming_writer_c &
+generic_reader_c::id_results_json_stream() {
+  if (auto stream = get_json_output_stream(); stream)
+    return *stream;
+
+  auto &stream = start_json_output_stream(s_id_results_json_key_order);
+
+  stream.add("identification_format_version", ID_JSON_FORMAT_VERSION);
+  stream.add("file_name",                     m_ti.m_fname);
+
+  return stream;
+}
+
 void
-generic_reader_c::display_identification_results_as_json() {
-  auto verbose_info_to_object = [](mtx::id::verbose_info_t const &verbose_info) -> nlohmann::json {
-    auto object = nlohmann::json{};
-    for (auto const &property : verbose_info)
-      object[property.first] = property.second;
+generic_reader_c::id_results_json_end_section() {
+  if (m_id_results_json_section.empty())
+    return;
 
-    return object.is_null() ? nlohmann::json::object() : object;
-  };
+  id_results_json_stream().end();
+  m_id_results_json_section.clear();
+}
 
-  auto json = nlohmann::json{
-    { "identification_format_version", ID_JSON_FORMAT_VERSION  },
-    { "file_name",                     m_ti.m_fname            },
-    { "tracks",                        nlohmann::json::array() },
-    { "attachments",                   nlohmann::json::array() },
-    { "chapters",                      nlohmann::json::array() },
-    { "global_tags",                   nlohmann::json::array() },
-    { "track_tags",                    nlohmann::json::array() },
-    { "container", {
-        { "recognized", true                                                        },
-        { "supported",  true                                                        },
-        { "type",       m_id_results_container.info                                 },
-        { "properties", verbose_info_to_object(m_id_results_container.verbose_info) },
-      } },
-  };
+void
+generic_reader_c::id_results_json_add_to_section(std::string const &section,
+                                                 nlohmann::json const &entry) {
+  auto &stream = id_results_json_stream();
 
-  for (auto const &result : m_id_results_tracks)
-    json["tracks"] += nlohmann::json{
-      { "id",         result.id                                   },
-      { "type",       result.type                                 },
-      { "codec",      result.info                                 },
-      { "properties", verbose_info_to_object(result.verbose_info) },
-    };
-
-  for (auto const &result : m_id_results_attachments)
-    json["attachments"] += nlohmann::json{
-      { "id",           result.id                                   },
-      { "content_type", result.type                                 },
-      { "size",         result.size                                 },
-      { "description",  result.description                          },
-      { "file_name",    result.info                                 },
-      { "properties",   verbose_info_to_object(result.verbose_info) },
-    };
-
-  for (auto const &result : m_id_results_chapters)
-    json["chapters"] += nlohmann::json{
-      { "num_entries", result.size },
-    };
+  if (m_id_results_json_section != section) {
+    id_results_json_end_section();
 
-  for (auto const &result : m_id_results_tags) {
-    if (ID_RESULT_GLOBAL_TAGS_ID == result.id)
-      json["global_tags"] += nlohmann::json{
-        { "num_entries", result.size },
-      };
-    else
-      json["track_tags"] += nlohmann::json{
-        { "track_id",    result.id   },
-        { "num_entries", result.size },
-      };
+    if (stream.has_key(section))
+      mxerror(fmt::format("generic_reader_c::id_results_json_add_to_section(): programming error: entries for '{0}' reported after other entries\n", section));
+
+    id_results_json_add_missing(section);
+
+    stream.start_array(section);
+    m_id_results_json_section = section;
   }
 
-  display_json_output(json);
+  stream.add(entry);
+}
+
+void
+generic_reader_c::display_identification_results_as_json() {
+  auto &stream = id_results_json_stream();
+
+  id_results_json_end_section();
+  id_results_json_add_missing({});
+
+  display_json_output(nlohmann::json::object());
+}
+
+/** \brief Writes placeholders for results a reader hasn't reported
+
+   Adds the container and empty arrays for all kinds of entries before
+   \c section in the key order which haven't been reported. If
+   \c section is empty, all of them are added.
+*/
+void
+generic_reader_c::id_results_json_add_missing(std::string const &section) {
+  auto &stream = id_results_json_stream();
+
+  if (!stream.has_key("container"))
+    stream.add("container", container_to_json(m_id_results_container));
+
+  for (auto const &missing : s_id_results_json_sections) {
+    if (missing == section)
+      break;
+
+    if (!stream.has_key(missing))
+      stream.add(missing, nlohmann::json::array());
+  }
 }
 
 void
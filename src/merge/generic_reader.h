@@ -20,6 +20,7 @@
 #include "common/file_types.h"
 #include "common/chapters/chapters.h"
 #include "common/math_fwd.h"
+#include "common/profiling.h"
 #include "common/translation.h"
 #include "merge/file_status.h"
 #include "merge/id_result.h"
@@ -30,6 +31,7 @@
 #include "merge/webm.h"
 
 class generic_packetizer_c;
+class mm_follow_io_c;
 
 constexpr auto DEFTRACK_TYPE_AUDIO = 0;
 constexpr auto DEFTRACK_TYPE_VIDEO = 1;
@@ -54,9 +56,12 @@ public:
 
   probe_range_info_t m_probe_range_info{};
 
+  mtx::profiling::counters_t m_profiling;
+
 protected:
   id_result_t m_id_results_container;
   std::vector<id_result_t> m_id_results_tracks, m_id_results_attachments, m_id_results_chapters, m_id_results_tags;
+  std::string m_id_results_json_section;
 
   timestamp_c m_restricted_timestamps_min, m_restricted_timestamps_max;
 
@@ -77,6 +82,10 @@ public:
   virtual void set_probe_range_info(probe_range_info_t const &info);
   virtual void set_track_info(track_info_c const &info);
   virtual void read_headers() = 0;
+  // Called after read_headers() if the source file is still being
+  // written to while it's read.
+  virtual void follow_growing_input(std::shared_ptr<mm_follow_io_c> const &) {
+  }
   virtual file_status_e read_next(generic_packetizer_c *packetizer, bool force = false);
   virtual file_status_e read(generic_packetizer_c *packetizer, bool force = false) = 0;
   virtual void read_all();
@@ -145,6 +154,12 @@ protected:
   virtual void display_identification_results_as_json();
   virtual void display_identification_results_as_text();
 
+  virtual bool id_results_are_streamed() const;
+  virtual mtx::json::streaming_writer_c &id_results_json_stream();
+  virtual void id_results_json_end_section();
+  virtual void id_results_json_add_to_section(std::string const &section, nlohmann::json const &entry);
+  virtual void id_results_json_add_missing(std::string const &section);
+
   virtual void add_track_tags_to_identification(libmatroska::KaxTags const &tags, mtx::id::info_c &info);
 
   virtual generic_packetizer_c &ptzr(int64_t track_idx);
@@ -47,6 +47,7 @@
 #include "common/ebml.h"
 #include "common/file_types.h"
 #include "common/fs_sys_helpers.h"
+#include "common/hacks.h"
 #include "common/iso639.h"
 #include "common/kax_analyzer.h"
 #include "common/list_utils.h"
@@ -64,10 +65,12 @@
 #include "common/webm.h"
 #include "common/xml/ebml_segmentinfo_converter.h"
 #include "common/xml/ebml_tags_converter.h"
+#include "merge/checkpoint.h"
 #include "merge/cluster_helper.h"
 #include "merge/filelist.h"
 #include "merge/generic_reader.h"
 #include "merge/output_control.h"
+#include "merge/profiling.h"
 #include "merge/reader_detection_and_creation.h"
 #include "merge/track_info.h"
 
@@ -147,6 +150,23 @@ set_usage() {
                   "                           form or not at all (default: canonical form).\n");
   usage_text += Y("  --stop-after-video-ends  Stops processing after the primary video track ends,\n"
                   "                           discarding any remaining packets of other tracks.\n");
+  usage_text += Y("  --preallocate-output     Reserves storage for the destination file based\n"
+                  "                           on the source files' sizes in order to reduce\n"
+                  "                           fragmentation.\n");
+  usage_text += Y("  --write-crc32            Writes EBML CRC-32 elements into clusters, cues\n"
+                  "                           and track headers.\n");
+  usage_text += Y("  --checkpoint <file>      Regularly saves the progress to 'file' so that\n"
+                  "                           an interrupted run can be restarted.\n");
+  usage_text += Y("  --restart                Restarts the interrupted run the checkpoint\n"
+                  "                           file given with '--checkpoint' belongs to,\n"
+                  "                           verifying the data written up to the checkpoint\n"
+                  "                           instead of writing it again.\n");
+  usage_text += Y("  --fast-remux             Copies the clusters of a single Matroska source\n"
+                  "                           file block by block without parsing the frames\n"
+                  "                           if no option requires changing them.\n");
+  usage_text += Y("  --profile-report <file>  Writes a JSON report with the time spent in and\n"
+                  "                           the amount of data processed by each stage,\n"
+                  "                           reader & packetizer to 'file'.\n");
   usage_text +=   "\n";
   usage_text += Y(" File splitting, linking, appending and concatenating (more global options):\n");
   usage_text += Y("  --split <d[K,M,G]|HH:MM:SS|s>\n"
@@ -235,6 +255,9 @@ set_usage() {
   usage_text += Y("  --no-chapters            Don't keep chapters from the source file.\n");
   usage_text += Y("  --regenerate-track-uids  Generate new random track UIDs instead of keeping\n"
                   "                           existing ones.\n");
+  usage_text += Y("  --follow <seconds>       The file is still being written to. Wait for\n"
+                  "                           more data at its end until it hasn't grown for\n"
+                  "                           the given number of seconds.\n");
   usage_text += Y("  -y, --sync <TID:d[,o[/p]]>\n"
                   "                           Synchronize, adjust the track's timestamps with\n"
                   "                           the id TID by 'd' ms.\n"
@@ -407,6 +430,8 @@ set_usage() {
                   "                           Redirects all messages into this file.\n");
   usage_text += Y("  --flush-on-close         Flushes all cached data to storage when closing\n"
                   "                           a file opened for writing.\n");
+  usage_text += Y("  --direct-io <write|all>  Bypasses the operating system's cache when writing\n"
+                  "                           files or when reading & writing files.\n");
   usage_text += Y("  --abort-on-warnings      Aborts the program after the first warning is\n"
                   "                           emitted.\n");
   usage_text += Y("  --deterministic <seed>   Enables the creation of byte-identical files\n"
@@ -1935,6 +1960,17 @@ parse_arg_attachments(const std::string &param,
   }
 }
 
+static void
+handle_probe_result(filelist_t &file) {
+  if (!file.reader)
+    mxerror(fmt::format(FY("The type of file '{0}' could not be recognized.\n"), file.name));
+
+  if (file.is_playlist) {
+    file.name        = file.playlist_mpls_in->get_file_name();
+    file.ti->m_fname = file.name;
+  }
+}
+
 void
 handle_file_name_arg(const std::string &this_arg,
                      std::vector<std::string>::const_iterator &sit,
@@ -2031,18 +2067,15 @@ handle_file_name_arg(const std::string &this_arg,
 
   ti->m_fname = file.name;
 
-  file.reader = probe_file_format(file);
-
-  if (!file.reader)
-    mxerror(fmt::format(FY("The type of file '{0}' could not be recognized.\n"), file.name));
+  file.ti.swap(ti);
 
-  if (file.is_playlist) {
-    file.name   = file.playlist_mpls_in->get_file_name();
-    ti->m_fname = file.name;
+  // With the hack the files are probed concurrently once all
+  // arguments have been parsed.
+  if (!mtx::hacks::is_engaged(mtx::hacks::PARALLEL_FILE_HEADERS)) {
+    file.reader = probe_file_format(file);
+    handle_probe_result(file);
   }
 
-  file.ti.swap(ti);
-
   g_files.push_back(file_p);
 
   g_chapter_charset.clear();
@@ -2280,6 +2313,17 @@ parse_args(std::vector<std::string> args) {
     } else if (this_arg == "--enable-legacy-font-mime-types") {
       g_use_legacy_font_mime_types = true;
       num_handled                  = 1;
+
+    } else if (this_arg == "--checkpoint") {
+      if (!next_arg)
+        mxerror(fmt::format(FY("'{0}' lacks the file name.\n"), this_arg));
+
+      mtx::merge::checkpoint::set_file_name(*next_arg);
+      num_handled = 2;
+
+    } else if (this_arg == "--restart") {
+      mtx::merge::checkpoint::request_restart();
+      num_handled = 1;
     }
 
     if (num_handled == 2)
@@ -2289,6 +2333,9 @@ parse_args(std::vector<std::string> args) {
       unhandled_args.emplace_back(this_arg);
   }
 
+  // Parsing the remaining options may generate random numbers already.
+  mtx::merge::checkpoint::prepare(args);
+
   if (g_outfile.empty()) {
     mxinfo(Y("Error: no destination file name was given.\n\n"));
     mtx::cli::display_usage(2);
@@ -2402,7 +2449,23 @@ parse_args(std::vector<std::string> args) {
     else if (this_arg == "--stop-after-video-ends")
       g_stop_after_video_ends = true;
 
-    else if (this_arg == "--attachment-description") {
+    else if (this_arg == "--preallocate-output")
+      g_preallocate_output = true;
+
+    else if (this_arg == "--write-crc32")
+      g_write_crc32 = true;
+
+    else if (this_arg == "--fast-remux")
+      g_fast_remux = true;
+
+    else if (this_arg == "--profile-report") {
+      if (!next_arg)
+        mxerror(fmt::format(FY("'{0}' lacks the file name.\n"), this_arg));
+
+      mtx::merge::profiling::enable(*next_arg);
+      sit++;
+
+    } else if (this_arg == "--attachment-description") {
       if (!next_arg)
         mxerror(Y("'--attachment-description' lacks the description.\n"));
 
@@ -2525,7 +2588,19 @@ parse_args(std::vector<std::string> args) {
     else if (this_arg == "--regenerate-track-uids")
       ti->m_regenerate_track_uids = true;
 
-    else if (this_arg == "--meta-seek-size") {
+    else if (this_arg == "--follow") {
+      if (!next_arg)
+        mxerror(fmt::format(FY("'{0}' lacks its argument.\n"), this_arg));
+
+      int64_t seconds{};
+      if (!mtx::string::parse_number(*next_arg, seconds) || (0 >= seconds))
+        mxerror(fmt::format(FY("Invalid idle timeout in '--follow {0}'.\n"), *next_arg));
+
+      ti->m_follow_idle_timeout = std::chrono::seconds{seconds};
+      g_flush_after_clusters    = true;
+      sit++;
+
+    } else if (this_arg == "--meta-seek-size") {
       mxwarn(Y("The option '--meta-seek-size' is no longer supported. Please read mkvmerge's documentation, especially the section about the MATROSKA FILE LAYOUT.\n"));
       sit++;
 
@@ -3171,6 +3246,24 @@ setup(int argc,
   return args;
 }
 
+static void
+display_direct_io_statistics() {
+  static debugging_option_c s_debug{"direct_io"};
+
+  if (!s_debug)
+    return;
+
+  auto stats   = mm_file_io_c::get_direct_io_statistics();
+  auto seconds = std::chrono::duration<double>(stats.duration).count();
+  auto total   = stats.bytes_read_directly + stats.bytes_read_buffered + stats.bytes_written_directly + stats.bytes_written_buffered;
+
+  mxdebug(fmt::format("direct I/O: files {0} fallbacks {1}; read directly {2} buffered {3}; written directly {4} buffered {5}; {6:.1f} MiB/s\n",
+                      stats.num_files, stats.num_fallbacks,
+                      stats.bytes_read_directly,    stats.bytes_read_buffered,
+                      stats.bytes_written_directly, stats.bytes_written_buffered,
+                      seconds > 0 ? total / seconds / 1024 / 1024 : 0.0));
+}
+
 /** \brief Setup and high level program control
 
    Calls the functions for setup, handling the command line arguments,
@@ -3186,8 +3279,13 @@ main(int argc,
 
   parse_args(args);
 
+  mtx::merge::checkpoint::init();
+
   int64_t start = mtx::sys::get_current_time_millis();
 
+  if (mtx::hacks::is_engaged(mtx::hacks::PARALLEL_FILE_HEADERS))
+    probe_file_formats_in_parallel(g_files, handle_probe_result);
+
   add_filelists_for_playlists();
   read_file_headers();
 
@@ -3210,6 +3308,7 @@ main(int argc,
     create_next_output_file();
     main_loop();
     finish_file(true);
+    mtx::merge::checkpoint::finish();
   } catch (mtx::mm_io::exception &ex) {
     force_close_output_file();
     mxerror(fmt::format("{0} {1} {2} {3}; {4}\n",
@@ -3221,7 +3320,11 @@ main(int argc,
 
   mxinfo(fmt::format(FY("Multiplexing took {0}.\n"), mtx::string::create_minutes_seconds_time_string((mtx::sys::get_current_time_millis() - start + 500) / 1000, true)));
 
+  mtx::merge::profiling::write_report();
+
   cleanup();
 
+  display_direct_io_statistics();
+
   mxexit();
 }
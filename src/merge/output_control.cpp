@@ -55,6 +55,7 @@
 #include "common/fs_sys_helpers.h"
 #include "common/hacks.h"
 #include "common/list_utils.h"
+#include "common/mm_file_io.h"
 #include "common/mm_io_x.h"
 #include "common/mm_null_io.h"
 #include "common/mm_proxy_io.h"
@@ -66,12 +67,15 @@
 #include "common/translation.h"
 #include "common/unique_numbers.h"
 #include "common/version.h"
+#include "merge/checkpoint.h"
 #include "merge/cluster_helper.h"
 #include "merge/cues.h"
+#include "merge/ebml_crc32.h"
 #include "merge/filelist.h"
 #include "merge/generic_packetizer.h"
 #include "merge/generic_reader.h"
 #include "merge/output_control.h"
+#include "merge/profiling.h"
 #include "merge/webm.h"
 
 using namespace mtx::construct;
@@ -111,6 +115,10 @@ bool g_use_durations                                          = false;
 bool g_no_track_statistics_tags                               = false;
 bool g_write_date                                             = true;
 bool g_stop_after_video_ends                                  = false;
+bool g_preallocate_output                                     = false;
+bool g_flush_after_clusters                                   = false;
+bool g_write_crc32                                            = false;
+bool g_fast_remux                                             = false;
 
 double g_timestamp_scale                                      = TIMESTAMP_SCALE;
 timestamp_scale_mode_e g_timestamp_scale_mode                 = timestamp_scale_mode_e{TIMESTAMP_SCALE_MODE_NORMAL};
@@ -176,6 +184,7 @@ static std::unique_ptr<libebml::EbmlVoid> s_void_after_track_headers;
 static std::vector<std::tuple<timestamp_c, std::string, mtx::bcp47::language_c>> s_additional_chapter_atoms;
 
 static mm_io_cptr s_out;
+static bool s_out_preallocated{};
 
 static mtx::bits::value_c s_seguid_prev(128), s_seguid_current(128), s_seguid_next(128);
 
@@ -306,9 +315,16 @@ add_to_progress(int64_t num_bytes_processed) {
 }
 
 static int64_t
-get_maximum_progress() {
-  if (!s_maximum_progress)
-    s_maximum_progress = std::accumulate(g_files.begin(), g_files.end(), 0ull, [](int64_t num, auto const &file) { return num + file->reader->get_maximum_progress(); });
+get_maximum_progress(int64_t current_time) {
+  static auto s_following    = std::any_of(g_files.begin(), g_files.end(), [](auto const &file) { return !!file->follow_in; });
+  static int64_t s_refreshed = 0;
+
+  // Files that are still being written to grow while they're read.
+  if (s_maximum_progress && (!s_following || ((current_time - s_refreshed) < 1000)))
+    return *s_maximum_progress;
+
+  s_maximum_progress = std::accumulate(g_files.begin(), g_files.end(), 0ull, [](int64_t num, auto const &file) { return num + file->reader->get_maximum_progress(); });
+  s_refreshed        = current_time;
 
   return *s_maximum_progress;
 }
@@ -333,9 +349,11 @@ display_progress(bool is_100percent = false) {
   }
 
   bool display_progress  = false;
-  auto maximum_progress  = get_maximum_progress();
-  int current_percentage = maximum_progress ? (s_current_progress * 100) / maximum_progress : 0;
   int64_t current_time   = mtx::sys::get_current_time_millis();
+  auto maximum_progress  = get_maximum_progress(current_time);
+  // Some readers only know the size of a file that's still being
+  // written to as of when it was opened.
+  int current_percentage = maximum_progress ? std::min<int64_t>((s_current_progress * 100) / maximum_progress, 100) : 0;
 
   if (   (-1 == s_previous_percentage)
       || ((100 == current_percentage) && (100 > s_previous_percentage))
@@ -570,6 +588,20 @@ sort_tracks_by_track_number() {
   });
 }
 
+static void
+render_track_headers(libmatroska::KaxTracks &tracks,
+                     mm_io_c &out) {
+  if (!g_write_crc32) {
+    g_doc_type_version_handler->render(tracks, out);
+    return;
+  }
+
+  mtx::merge::add_crc32_element(tracks);
+  mtx::merge::render_with_crc32(out, [&tracks](mm_io_c &crc32_out) {
+    g_doc_type_version_handler->render(tracks, crc32_out);
+  });
+}
+
 /** \brief Render the basic EBML and Matroska headers
 
    Renders the segment information and track headers. Also reserves
@@ -598,7 +630,7 @@ render_headers(mm_io_c *out) {
       auto info_data = get_default_segment_info_data("mkvmerge");
       s_muxing_app   = info_data.muxing_app;
       s_writing_app  = info_data.writing_app;
-      s_writing_date = info_data.writing_date;
+      s_writing_date = mtx::merge::checkpoint::writing_date(info_data.writing_date);
     }
 
     get_child<libmatroska::KaxMuxingApp >(*s_kax_infos).SetValueUTF8(s_muxing_app);
@@ -708,11 +740,14 @@ render_headers(mm_io_c *out) {
     g_kax_sh_main->IndexThis(*s_kax_infos, *g_kax_segment);
 
     if (!g_packetizers.empty()) {
+      if (g_write_crc32)
+        mtx::merge::add_crc32_element(*g_kax_tracks);
+
       g_kax_tracks->UpdateSize(render_should_write_arg(true));
       uint64_t full_header_size = g_kax_tracks->ElementSize(render_should_write_arg(true));
       g_kax_tracks->UpdateSize(render_should_write_arg(false));
 
-      g_doc_type_version_handler->render(*g_kax_tracks, *out);
+      render_track_headers(*g_kax_tracks, *out);
       g_kax_sh_main->IndexThis(*g_kax_tracks, *g_kax_segment);
 
       // Reserve some small amount of space for header changes by the
@@ -854,7 +889,7 @@ shrink_void_and_rerender_track_headers(int64_t new_void_size) {
 
   s_out->setFilePointer(g_kax_tracks->GetElementPosition());
 
-  g_doc_type_version_handler->render(*g_kax_tracks, *s_out);
+  render_track_headers(*g_kax_tracks, *s_out);
   render_void(new_void_size);
 
   s_out->setFilePointer(0, libebml::seek_end);
@@ -1395,6 +1430,51 @@ prepare_tags_for_rendering() {
   g_tags_size = s_kax_tags->ElementSize();
 }
 
+static mm_io_cptr
+open_output_file(std::string const &file_name) {
+  auto const buffer_size = 20 * 1024 * 1024;
+
+  if (!mtx::profiling::g_enabled && !mtx::merge::checkpoint::is_enabled())
+    return mm_write_buffer_io_c::open(file_name, buffer_size);
+
+  auto io = mtx::merge::checkpoint::is_enabled() ? mtx::merge::checkpoint::open_output_file(file_name)
+          :                                        std::make_shared<mm_file_io_c>(file_name, libebml::MODE_CREATE);
+
+  // Account the time spent in the actual I/O operations below the
+  // write buffer.
+  if (mtx::profiling::g_enabled)
+    io = std::make_shared<mtx::profiling::counting_io_c>(io, mtx::merge::profiling::output_read_counters(), mtx::merge::profiling::output_write_counters());
+
+  return std::make_shared<mm_write_buffer_io_c>(io, buffer_size);
+}
+
+/** \brief Reserve storage for the output file
+
+   The size is estimated from the sizes of all source files and of the
+   attachments. It's an upper bound in most cases as usually not all
+   of the source data is kept. Anything not used will be released
+   when the file is finished.
+*/
+static void
+preallocate_output_file() {
+  static debugging_option_c s_debug{"preallocate_output"};
+
+  s_out_preallocated = false;
+
+  if (!g_preallocate_output || g_cluster_helper->discarding())
+    return;
+
+  if (g_cluster_helper->split_mode_produces_many_files()) {
+    mxdebug_if(s_debug, "preallocate_output: not pre-allocating when splitting into many files\n");
+    return;
+  }
+
+  auto estimated_size = g_file_sizes + g_attachment_sizes_first;
+  s_out_preallocated  = s_out->preallocate(estimated_size);
+
+  mxdebug_if(s_debug, fmt::format("preallocate_output: estimated size {0} pre-allocated? {1}\n", estimated_size, s_out_preallocated));
+}
+
 /** \brief Creates the next output file
 
    Creates a new file name depending on the split settings. Opens that
@@ -1413,7 +1493,7 @@ create_next_output_file() {
 
   // Open the output file.
   try {
-    s_out = !g_cluster_helper->discarding() ? mm_write_buffer_io_c::open(this_outfile, 20 * 1024 * 1024) : mm_io_cptr{ new mm_null_io_c{this_outfile} };
+    s_out = g_cluster_helper->discarding() ? mm_io_cptr{ new mm_null_io_c{this_outfile} } : open_output_file(this_outfile);
   } catch (mtx::mm_io::exception &ex) {
     mxerror(fmt::format(FY("The file '{0}' could not be opened for writing: {1}.\n"), this_outfile, ex));
   }
@@ -1421,6 +1501,8 @@ create_next_output_file() {
   if (verbose && !g_cluster_helper->discarding())
     mxinfo(fmt::format(FY("The file '{0}' has been opened for writing.\n"), this_outfile));
 
+  preallocate_output_file();
+
   g_cluster_helper->set_output(s_out.get());
 
   render_headers(s_out.get());
@@ -1655,6 +1737,8 @@ void
 finish_file(bool last_file,
             bool create_new_file,
             bool previously_discarding) {
+  mtx::profiling::scoped_timer_c timer{mtx::merge::profiling::stage(mtx::merge::profiling::stage_e::finish_file)};
+
   if (g_kax_chapters && !previously_discarding)
     add_chapters_for_current_part();
 
@@ -1668,7 +1752,7 @@ finish_file(bool last_file,
   // Render the track headers a second time if the user has requested that.
   if (mtx::hacks::is_engaged(mtx::hacks::WRITE_HEADERS_TWICE)) {
     auto second_tracks = clone(g_kax_tracks);
-    g_doc_type_version_handler->render(*second_tracks, *s_out);
+    render_track_headers(*second_tracks, *s_out);
     g_kax_sh_main->IndexThis(*second_tracks, *g_kax_segment);
   }
 
@@ -1803,6 +1887,14 @@ finish_file(bool last_file,
 
   update_ebml_head();
 
+  // Release the storage reserved beyond the file's end.
+  if (s_out_preallocated) {
+    s_out->flush();
+    s_out->setFilePointer(0, libebml::seek_end);
+    s_out->truncate(s_out->getFilePointer());
+    s_out_preallocated = false;
+  }
+
   auto original_file_name = mtx::fs::to_path(s_out->get_file_name());
 
   s_out.reset();
@@ -2230,12 +2322,26 @@ main_loop() {
   while (1) {
     // Step 1: Make sure a packet is available for each output
     // as long we haven't already processed the last one.
-    auto end_of_video_reached1                 = pull_packetizers_for_packets();
-    auto [end_of_video_reached2, force_pulled] = force_pull_packetizers_of_fully_held_files();
+    auto end_of_video_reached1 = false, end_of_video_reached2 = false, force_pulled = false;
+
+    {
+      mtx::profiling::scoped_timer_c timer{mtx::merge::profiling::stage(mtx::merge::profiling::stage_e::pull_packets)};
+      end_of_video_reached1 = pull_packetizers_for_packets();
+    }
+
+    {
+      mtx::profiling::scoped_timer_c timer{mtx::merge::profiling::stage(mtx::merge::profiling::stage_e::force_pull_packets)};
+      std::tie(end_of_video_reached2, force_pulled) = force_pull_packetizers_of_fully_held_files();
+    }
 
     // Step 2: Pick the packet with the lowest timestamp and
     // stuff it into the Matroska file.
-    auto winner = select_winning_packetizer();
+    packetizer_t *winner{};
+
+    {
+      mtx::profiling::scoped_timer_c timer{mtx::merge::profiling::stage(mtx::merge::profiling::stage_e::select_packet)};
+      winner = select_winning_packetizer();
+    }
 
     // Append the next track if appending is wanted.
     bool appended_a_track = s_appending_files && append_tracks_maybe();
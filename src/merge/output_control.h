@@ -160,7 +160,7 @@ extern mtx::bcp47::language_c g_default_language;
 extern double g_video_fps;
 extern generic_packetizer_c *g_video_packetizer;
 
-extern bool g_write_cues, g_cue_writing_requested, g_write_date, g_stop_after_video_ends;
+extern bool g_write_cues, g_cue_writing_requested, g_write_date, g_stop_after_video_ends, g_preallocate_output, g_flush_after_clusters, g_write_crc32, g_fast_remux;
 extern bool g_no_lacing, g_no_linking, g_use_durations, g_no_track_statistics_tags;
 
 extern bool g_identifying;
@@ -0,0 +1,149 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit https://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+
+   performance report for the multiplexing process
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include "common/json.h"
+#include "common/mm_file_io.h"
+#include "common/mm_io_x.h"
+#include "merge/filelist.h"
+#include "merge/generic_packetizer.h"
+#include "merge/generic_reader.h"
+#include "merge/id_result.h"
+#include "merge/output_control.h"
+#include "merge/profiling.h"
+
+namespace mtx::merge::profiling {
+
+namespace {
+
+std::string s_report_file_name;
+std::chrono::steady_clock::time_point s_wall_start;
+std::chrono::nanoseconds s_cpu_start{};
+std::array<mtx::profiling::counters_t, static_cast<std::size_t>(stage_e::num_stages)> s_stages;
+mtx::profiling::counters_t s_output_read, s_output_write;
+
+nlohmann::json
+to_json(mtx::profiling::counters_t const &counters) {
+  auto to_seconds = [](std::chrono::nanoseconds duration) {
+    return std::chrono::duration<double>(duration).count();
+  };
+
+  return nlohmann::json{
+    { "wall_time",                    to_seconds(counters.wall_time)        },
+    { "cpu_time",                     to_seconds(counters.cpu_time)         },
+    { "calls",                        counters.calls                        },
+    { "packets",                      counters.packets                      },
+    { "bytes",                        counters.bytes                        },
+    { "allocations",                  counters.allocations                  },
+    { "allocated_bytes",              counters.allocated_bytes              },
+    { "queue_high_water_mark",        counters.queue_high_water_mark        },
+    { "queued_bytes_high_water_mark", counters.queued_bytes_high_water_mark },
+  };
+}
+
+char const *
+stage_name(stage_e which) {
+  return stage_e::read_headers       == which ? "read_headers"
+       : stage_e::pull_packets       == which ? "pull_packets"
+       : stage_e::force_pull_packets == which ? "force_pull_packets"
+       : stage_e::select_packet      == which ? "select_packet"
+       : stage_e::add_packet         == which ? "add_packet"
+       : stage_e::timestamp_factory  == which ? "timestamp_factory"
+       : stage_e::render             == which ? "render"
+       :                                        "finish_file";
+}
+
+char const *
+track_type_name(int track_type) {
+  return track_audio    == track_type ? ID_RESULT_TRACK_AUDIO
+       : track_video    == track_type ? ID_RESULT_TRACK_VIDEO
+       : track_subtitle == track_type ? ID_RESULT_TRACK_SUBTITLES
+       : track_buttons  == track_type ? ID_RESULT_TRACK_BUTTONS
+       :                                ID_RESULT_TRACK_UNKNOWN;
+}
+
+}
+
+void
+enable(std::string const &report_file_name) {
+  mtx::profiling::g_enabled = true;
+  s_report_file_name        = report_file_name;
+  s_wall_start              = std::chrono::steady_clock::now();
+  s_cpu_start               = mtx::profiling::get_thread_cpu_time();
+}
+
+mtx::profiling::counters_t &
+stage(stage_e which) {
+  return s_stages[static_cast<std::size_t>(which)];
+}
+
+mtx::profiling::counters_t &
+output_read_counters() {
+  return s_output_read;
+}
+
+mtx::profiling::counters_t &
+output_write_counters() {
+  return s_output_write;
+}
+
+void
+write_report() {
+  if (!mtx::profiling::g_enabled)
+    return;
+
+  auto stages = nlohmann::json::object();
+  for (auto idx = 0u; idx < static_cast<unsigned int>(stage_e::num_stages); ++idx)
+    stages[stage_name(static_cast<stage_e>(idx))] = to_json(s_stages[idx]);
+
+  auto readers = nlohmann::json::array();
+  for (auto const &file : g_files)
+    if (file->reader)
+      readers.push_back(nlohmann::json{
+        { "file_name", file->name                                         },
+        { "format",    file->reader->get_format_name().get_untranslated() },
+        { "read",      to_json(file->reader->m_profiling)                 },
+      });
+
+  auto packetizers = nlohmann::json::array();
+  for (auto const &ptzr : g_packetizers)
+    packetizers.push_back(nlohmann::json{
+      { "file",         ptzr.file                                             },
+      { "source_track", ptzr.packetizer->get_source_track_num()               },
+      { "track_number", ptzr.packetizer->get_track_num()                      },
+      { "type",         track_type_name(ptzr.packetizer->get_track_type())    },
+      { "format",       ptzr.packetizer->get_format_name().get_untranslated() },
+      { "process",      to_json(ptzr.packetizer->m_profiling_process)         },
+      { "output",       to_json(ptzr.packetizer->m_profiling_output)          },
+    });
+
+  auto report = nlohmann::json{
+    { "wall_time",   std::chrono::duration<double>(std::chrono::steady_clock::now() - s_wall_start).count()      },
+    { "cpu_time",    std::chrono::duration<double>(mtx::profiling::get_thread_cpu_time() - s_cpu_start).count() },
+    { "stages",      stages                                                                                      },
+    { "output",      nlohmann::json{ { "read", to_json(s_output_read) }, { "write", to_json(s_output_write) } }   },
+    { "readers",     readers                                                                                     },
+    { "packetizers", packetizers                                                                                 },
+  };
+
+  try {
+    mm_file_io_c out{s_report_file_name, libebml::MODE_CREATE};
+    out.write(mtx::json::dump(report, 2) + "\n");
+
+  } catch (mtx::mm_io::exception &ex) {
+    mxerror(fmt::format(FY("The file '{0}' could not be opened for writing: {1}.\n"), s_report_file_name, ex));
+  }
+}
+
+}
@@ -0,0 +1,41 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit https://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+
+   performance report for the multiplexing process
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#pragma once
+
+#include "common/common_pch.h"
+
+#include "common/profiling.h"
+
+namespace mtx::merge::profiling {
+
+enum class stage_e {
+  read_headers,
+  pull_packets,
+  force_pull_packets,
+  select_packet,
+  add_packet,
+  timestamp_factory,
+  render,
+  finish_file,
+
+  num_stages,
+};
+
+void enable(std::string const &report_file_name);
+mtx::profiling::counters_t &stage(stage_e which);
+mtx::profiling::counters_t &output_read_counters();
+mtx::profiling::counters_t &output_write_counters();
+void write_report();
+
+}
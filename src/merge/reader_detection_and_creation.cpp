@@ -12,15 +12,21 @@
 
 #include "common/common_pch.h"
 
+#include <atomic>
 #include <typeinfo>
 
+#include "common/hacks.h"
 #include "common/mm_file_io.h"
+#include "common/mm_follow_io.h"
+#include "common/mm_mem_io.h"
 #include "common/mm_mpls_multi_file_io.h"
 #include "common/mm_proxy_io.h"
 #include "common/mm_read_buffer_io.h"
 #include "common/mm_text_io.h"
+#include "common/output.h"
 #include "common/path.h"
 #include "common/strings/formatting.h"
+#include "common/thread_pool.h"
 #include "common/xml/xml.h"
 #include "input/r_aac.h"
 #include "input/r_ac3.h"
@@ -61,6 +67,7 @@
 #include "merge/filelist.h"
 #include "merge/input_x.h"
 #include "merge/probe_range_info.h"
+#include "merge/profiling.h"
 #include "merge/reader_detection_and_creation.h"
 
 static std::vector<boost::filesystem::path>
@@ -75,8 +82,21 @@ file_names_to_paths(const std::vector<std::string> &file_names) {
 static mm_io_cptr
 open_input_file(filelist_t &file) {
   try {
-    if (file.all_names.size() == 1)
-      return std::make_shared<mm_read_buffer_io_c>(std::make_shared<mm_file_io_c>(file.name));
+    if ((file.all_names.size() == 1) && file.ti && file.ti->m_follow_idle_timeout) {
+      // The file grows while it's read. The read buffer asks the
+      // follower for its current size each time it's refilled.
+      file.follow_in = std::make_shared<mm_follow_io_c>(std::make_shared<mm_file_io_c>(file.name), *file.ti->m_follow_idle_timeout);
+      auto in        = std::make_shared<mm_read_buffer_io_c>(file.follow_in);
+      in->advise_sequential_access();
+      return in;
+    }
+
+    else if (file.all_names.size() == 1) {
+      auto in = std::make_shared<mm_read_buffer_io_c>(std::make_shared<mm_file_io_c>(file.name));
+      // Source files are mostly read from start to end.
+      in->advise_sequential_access();
+      return in;
+    }
 
     else {
       auto paths = file_names_to_paths(file.all_names);
@@ -167,39 +187,43 @@ using prober_t = std::function<std::unique_ptr<generic_reader_c>(mm_io_cptr cons
 
 static prober_t
 prober_for_type(mtx::file_type_e type) {
-  static std::map<mtx::file_type_e, prober_t> type_probe_map;
-
-  if (type_probe_map.empty()) {
-    type_probe_map[mtx::file_type_e::avc_es]      = &do_probe<avc_es_reader_c>;
-    type_probe_map[mtx::file_type_e::avi]         = &do_probe<avi_reader_c>;
-    type_probe_map[mtx::file_type_e::coreaudio]   = &do_probe<coreaudio_reader_c>;
-    type_probe_map[mtx::file_type_e::dirac]       = &do_probe<dirac_es_reader_c>;
-    type_probe_map[mtx::file_type_e::dts]         = &do_probe<dts_reader_c>;
-    type_probe_map[mtx::file_type_e::dv]          = &do_probe<dv_reader_c>;
-    type_probe_map[mtx::file_type_e::flac]        = &do_probe<flac_reader_c>;
-    type_probe_map[mtx::file_type_e::flv]         = &do_probe<flv_reader_c>;
-    type_probe_map[mtx::file_type_e::hdmv_textst] = &do_probe<hdmv_textst_reader_c>;
-    type_probe_map[mtx::file_type_e::hevc_es]     = &do_probe<hevc_es_reader_c>;
-    type_probe_map[mtx::file_type_e::ivf]         = &do_probe<ivf_reader_c>;
-    type_probe_map[mtx::file_type_e::matroska]    = &do_probe<kax_reader_c>;
-    type_probe_map[mtx::file_type_e::mpeg_es]     = &do_probe<mpeg_es_reader_c>;
-    type_probe_map[mtx::file_type_e::mpeg_ps]     = &do_probe<mpeg_ps_reader_c>;
-    type_probe_map[mtx::file_type_e::mpeg_ts]     = &do_probe<mtx::mpeg_ts::reader_c>;
-    type_probe_map[mtx::file_type_e::obu]         = &do_probe<obu_reader_c>;
-    type_probe_map[mtx::file_type_e::ogm]         = &do_probe<ogm_reader_c>;
-    type_probe_map[mtx::file_type_e::pgssup]      = &do_probe<hdmv_pgs_reader_c>;
-    type_probe_map[mtx::file_type_e::qtmp4]       = &do_probe<qtmp4_reader_c>;
-    type_probe_map[mtx::file_type_e::real]        = &do_probe<real_reader_c>;
-    type_probe_map[mtx::file_type_e::truehd]      = &do_probe<truehd_reader_c>;
-    type_probe_map[mtx::file_type_e::tta]         = &do_probe<tta_reader_c>;
-    type_probe_map[mtx::file_type_e::vc1]         = &do_probe<vc1_es_reader_c>;
-    type_probe_map[mtx::file_type_e::vobbtn]      = &do_probe<vobbtn_reader_c>;
-    type_probe_map[mtx::file_type_e::wav]         = &do_probe<wav_reader_c>;
-    type_probe_map[mtx::file_type_e::wavpack4]    = &do_probe<wavpack_reader_c>;
-  }
-
-  auto res = type_probe_map.find(type);
-  if (res == type_probe_map.end()) {
+  // Initialized exactly once even if several files are probed
+  // concurrently.
+  static auto const s_type_probe_map = []() {
+    std::map<mtx::file_type_e, prober_t> map;
+
+    map[mtx::file_type_e::avc_es]      = &do_probe<avc_es_reader_c>;
+    map[mtx::file_type_e::avi]         = &do_probe<avi_reader_c>;
+    map[mtx::file_type_e::coreaudio]   = &do_probe<coreaudio_reader_c>;
+    map[mtx::file_type_e::dirac]       = &do_probe<dirac_es_reader_c>;
+    map[mtx::file_type_e::dts]         = &do_probe<dts_reader_c>;
+    map[mtx::file_type_e::dv]          = &do_probe<dv_reader_c>;
+    map[mtx::file_type_e::flac]        = &do_probe<flac_reader_c>;
+    map[mtx::file_type_e::flv]         = &do_probe<flv_reader_c>;
+    map[mtx::file_type_e::hdmv_textst] = &do_probe<hdmv_textst_reader_c>;
+    map[mtx::file_type_e::hevc_es]     = &do_probe<hevc_es_reader_c>;
+    map[mtx::file_type_e::ivf]         = &do_probe<ivf_reader_c>;
+    map[mtx::file_type_e::matroska]    = &do_probe<kax_reader_c>;
+    map[mtx::file_type_e::mpeg_es]     = &do_probe<mpeg_es_reader_c>;
+    map[mtx::file_type_e::mpeg_ps]     = &do_probe<mpeg_ps_reader_c>;
+    map[mtx::file_type_e::mpeg_ts]     = &do_probe<mtx::mpeg_ts::reader_c>;
+    map[mtx::file_type_e::obu]         = &do_probe<obu_reader_c>;
+    map[mtx::file_type_e::ogm]         = &do_probe<ogm_reader_c>;
+    map[mtx::file_type_e::pgssup]      = &do_probe<hdmv_pgs_reader_c>;
+    map[mtx::file_type_e::qtmp4]       = &do_probe<qtmp4_reader_c>;
+    map[mtx::file_type_e::real]        = &do_probe<real_reader_c>;
+    map[mtx::file_type_e::truehd]      = &do_probe<truehd_reader_c>;
+    map[mtx::file_type_e::tta]         = &do_probe<tta_reader_c>;
+    map[mtx::file_type_e::vc1]         = &do_probe<vc1_es_reader_c>;
+    map[mtx::file_type_e::vobbtn]      = &do_probe<vobbtn_reader_c>;
+    map[mtx::file_type_e::wav]         = &do_probe<wav_reader_c>;
+    map[mtx::file_type_e::wavpack4]    = &do_probe<wavpack_reader_c>;
+
+    return map;
+  }();
+
+  auto res = s_type_probe_map.find(type);
+  if (res == s_type_probe_map.end()) {
     return {};
   }
   return (*res).second;
@@ -245,98 +269,77 @@ detect_text_file_formats(filelist_t const &file) {
   return {};
 }
 
-/** \brief Probe the file type
+struct probe_step_t {
+  std::function<std::unique_ptr<generic_reader_c>(mm_io_cptr const &)> m_probe;
+  // Steps that don't work on the I/O object they're given (e.g. the
+  // text file detection which opens the file itself) are always run on
+  // the main thread.
+  bool m_parallel{true};
+};
 
-   Opens the input file and calls the \c probe_file function for each known
-   file reader class. Uses \c mm_text_io_c for subtitle probing.
-*/
-std::unique_ptr<generic_reader_c>
-probe_file_format(filelist_t &file) {
-  auto io          = open_input_file(file);
-  auto is_playlist = !file.is_playlist && open_playlist_file(file, *io);
-
-  std::unique_ptr<generic_reader_c> reader;
+template<typename Treader>
+void
+add_probe_step(std::vector<probe_step_t> &steps,
+               probe_range_info_t const &probe_range_info = {}) {
+  steps.push_back({ [probe_range_info](mm_io_cptr const &io) { return do_probe<Treader>(io, probe_range_info); } });
+}
 
-  if (is_playlist)
-    io = std::make_shared<mm_read_buffer_io_c>(file.playlist_mpls_in);
+/** \brief Build the ordered list of probers for a file
 
-  // File types that can be detected unambiguously but are not
-  // supported. The prober does not return if it detects the type.
-  do_probe<unsupported_types_signature_prober_c>(io);
+   The order of the returned list is the order of priority: the first
+   step that returns a reader determines the file's type.
+*/
+static std::vector<probe_step_t>
+probe_steps_for(filelist_t &file) {
+  std::vector<probe_step_t> steps;
 
   // File types that can be detected unambiguously
-  if ((reader = do_probe<avi_reader_c>(io)))
-    return reader;
-  if ((reader = do_probe<flv_reader_c>(io)))
-    return reader;
-  if ((reader = do_probe<kax_reader_c>(io)))
-    return reader;
-  if ((reader = do_probe<wav_reader_c>(io)))
-    return reader;
-  if ((reader = do_probe<ogm_reader_c>(io)))
-    return reader;
-  if ((reader = do_probe<hdmv_textst_reader_c>(io)))
-    return reader;
-  if ((reader = do_probe<flac_reader_c>(io)))
-    return reader;
-  if ((reader = do_probe<hdmv_pgs_reader_c>(io)))
-    return reader;
-  if ((reader = do_probe<real_reader_c>(io)))
-    return reader;
-  if ((reader = do_probe<qtmp4_reader_c>(io)))
-    return reader;
-  if ((reader = do_probe<tta_reader_c>(io)))
-    return reader;
-  if ((reader = do_probe<vc1_es_reader_c>(io)))
-    return reader;
-  if ((reader = do_probe<wavpack_reader_c>(io)))
-    return reader;
-  if ((reader = do_probe<ivf_reader_c>(io)))
-    return reader;
-  if ((reader = do_probe<coreaudio_reader_c>(io)))
-    return reader;
-  if ((reader = do_probe<dirac_es_reader_c>(io)))
-    return reader;
+  add_probe_step<avi_reader_c>(steps);
+  add_probe_step<flv_reader_c>(steps);
+  add_probe_step<kax_reader_c>(steps);
+  add_probe_step<wav_reader_c>(steps);
+  add_probe_step<ogm_reader_c>(steps);
+  add_probe_step<hdmv_textst_reader_c>(steps);
+  add_probe_step<flac_reader_c>(steps);
+  add_probe_step<hdmv_pgs_reader_c>(steps);
+  add_probe_step<real_reader_c>(steps);
+  add_probe_step<qtmp4_reader_c>(steps);
+  add_probe_step<tta_reader_c>(steps);
+  add_probe_step<vc1_es_reader_c>(steps);
+  add_probe_step<wavpack_reader_c>(steps);
+  add_probe_step<ivf_reader_c>(steps);
+  add_probe_step<coreaudio_reader_c>(steps);
+  add_probe_step<dirac_es_reader_c>(steps);
 
   // Prefer types hinted by extension
   auto extension = mtx::fs::to_path(file.name).extension().string();
   if (!extension.empty()) {
     for (auto type : mtx::file_type_t::by_extension(extension.substr(1))) {
       auto p = prober_for_type(type);
-      if (p && (reader = p(io, {})))
-        return reader;
+      if (p)
+        steps.push_back({ [p](mm_io_cptr const &io) { return p(io, {}); } });
     }
   }
 
   // All text file types (subtitles).
-  if ((reader = detect_text_file_formats(file)))
-    return reader;
+  steps.push_back({ [&file](mm_io_cptr const &) { return detect_text_file_formats(file); }, false });
 
   // AVC & HEVC, even though often mis-detected, have a very high
   // probability of correct detection with headers right at the start.
-  if ((reader = do_probe<avc_es_reader_c>(io, { 0, 0, true })))
-    return reader;
-  if ((reader = do_probe<hevc_es_reader_c>(io, { 0, 0, true })))
-    return reader;
+  add_probe_step<avc_es_reader_c>(steps, { 0, 0, true });
+  add_probe_step<hevc_es_reader_c>(steps, { 0, 0, true });
 
   // Try raw audio formats and require eight consecutive frames at the
   // start of the file.
-  if ((reader = do_probe<mp3_reader_c>(io, { 128 * 1024, 8, true })))
-    return reader;
-  if ((reader = do_probe<ac3_reader_c>(io, { 128 * 1024, 8, true })))
-    return reader;
-  if ((reader = do_probe<aac_reader_c>(io, { 128 * 1024, 8, true })))
-    return reader;
+  add_probe_step<mp3_reader_c>(steps, { 128 * 1024, 8, true });
+  add_probe_step<ac3_reader_c>(steps, { 128 * 1024, 8, true });
+  add_probe_step<aac_reader_c>(steps, { 128 * 1024, 8, true });
 
   // File types that are mis-detected sometimes
-  if ((reader = do_probe<dts_reader_c>(io, { 0, 0, true })))
-    return reader;
-  if ((reader = do_probe<mtx::mpeg_ts::reader_c>(io)))
-    return reader;
-  if ((reader = do_probe<mpeg_ps_reader_c>(io)))
-    return reader;
-  if ((reader = do_probe<obu_reader_c>(io)))
-    return reader;
+  add_probe_step<dts_reader_c>(steps, { 0, 0, true });
+  add_probe_step<mtx::mpeg_ts::reader_c>(steps);
+  add_probe_step<mpeg_ps_reader_c>(steps);
+  add_probe_step<obu_reader_c>(steps);
 
   // File types which are the same in raw format and in other container formats.
   // Detection requires 20 or more consecutive packets.
@@ -344,39 +347,27 @@ probe_file_format(filelist_t &file) {
   static int const s_probe_num_required_consecutive_packets1 = 64;
 
   for (auto probe_size : s_probe_sizes1) {
-    if ((reader = do_probe<mp3_reader_c>(io, { probe_size, s_probe_num_required_consecutive_packets1 })))
-      return reader;
-    if ((reader = do_probe<ac3_reader_c>(io, { probe_size, s_probe_num_required_consecutive_packets1 })))
-      return reader;
-    if ((reader = do_probe<aac_reader_c>(io, { probe_size, s_probe_num_required_consecutive_packets1 })))
-      return reader;
+    add_probe_step<mp3_reader_c>(steps, { probe_size, s_probe_num_required_consecutive_packets1 });
+    add_probe_step<ac3_reader_c>(steps, { probe_size, s_probe_num_required_consecutive_packets1 });
+    add_probe_step<aac_reader_c>(steps, { probe_size, s_probe_num_required_consecutive_packets1 });
   }
 
   // More file types with detection issues.
-  if ((reader = do_probe<truehd_reader_c>(io)))
-    return reader;
-  if ((reader = do_probe<dts_reader_c>(io)))
-    return reader;
-  if ((reader = do_probe<vobbtn_reader_c>(io)))
-    return reader;
+  add_probe_step<truehd_reader_c>(steps);
+  add_probe_step<dts_reader_c>(steps);
+  add_probe_step<vobbtn_reader_c>(steps);
 
   // Try some more of the raw audio formats before trying elementary
   // stream video formats (MPEG 1/2, AVC/H.264, HEVC/H.265; those
   // often enough simply work). However, require that the first frame
   // starts at the beginning of the file.
-  if ((reader = do_probe<mp3_reader_c>(io, { 32 * 1024, 1, true })))
-    return reader;
-  if ((reader = do_probe<ac3_reader_c>(io, { 32 * 1024, 1, true })))
-    return reader;
-  if ((reader = do_probe<aac_reader_c>(io, { 32 * 1024, 1, true })))
-    return reader;
+  add_probe_step<mp3_reader_c>(steps, { 32 * 1024, 1, true });
+  add_probe_step<ac3_reader_c>(steps, { 32 * 1024, 1, true });
+  add_probe_step<aac_reader_c>(steps, { 32 * 1024, 1, true });
 
-  if ((reader = do_probe<mpeg_es_reader_c>(io)))
-    return reader;
-  if ((reader = do_probe<avc_es_reader_c>(io, { 0, 0, false })))
-    return reader;
-  if ((reader = do_probe<hevc_es_reader_c>(io, { 0, 0, false })))
-    return reader;
+  add_probe_step<mpeg_es_reader_c>(steps);
+  add_probe_step<avc_es_reader_c>(steps, { 0, 0, false });
+  add_probe_step<hevc_es_reader_c>(steps, { 0, 0, false });
 
   // File types which are the same in raw format and in other container formats.
   // Detection requires 20 or more consecutive packets.
@@ -384,11 +375,146 @@ probe_file_format(filelist_t &file) {
   static int const s_probe_num_required_consecutive_packets2 = 20;
 
   for (auto probe_size : s_probe_sizes2) {
-    if ((reader = do_probe<mp3_reader_c>(io, { probe_size, s_probe_num_required_consecutive_packets2 })))
-      return reader;
-    else if ((reader = do_probe<ac3_reader_c>(io, { probe_size, s_probe_num_required_consecutive_packets2 })))
-      return reader;
-    else if ((reader = do_probe<aac_reader_c>(io, { probe_size, s_probe_num_required_consecutive_packets2 })))
+    add_probe_step<mp3_reader_c>(steps, { probe_size, s_probe_num_required_consecutive_packets2 });
+    add_probe_step<ac3_reader_c>(steps, { probe_size, s_probe_num_required_consecutive_packets2 });
+    add_probe_step<aac_reader_c>(steps, { probe_size, s_probe_num_required_consecutive_packets2 });
+  }
+
+  return steps;
+}
+
+/** \brief Run all probers concurrently and determine the winner
+
+   Each worker gets its own I/O object. Files up to a certain size are
+   read into memory once, and all workers share that read-only
+   buffer. Larger files are opened separately by each worker. Steps
+   that cannot run on a worker are skipped here.
+
+   The messages output by each step are captured in \c messages. An
+   error (either output via \c mxerror() or an exception) is treated
+   like a match: it would have ended the sequential cascade, too.
+
+   Returns the index of the first step that either succeeded or failed
+   with an error, which is the same one at which the sequential cascade
+   would have stopped, or the number of steps if there's no such
+   step. All steps with a lower index have been run completely.
+*/
+static std::size_t
+find_first_matching_step_in_parallel(filelist_t const &file,
+                                     mm_io_c &io,
+                                     std::vector<probe_step_t> const &steps,
+                                     std::vector<mtx::output::captured_messages_t> &messages) {
+  static int64_t const s_max_shared_buffer_size = 16 * 1024 * 1024;
+
+  memory_cptr shared_buffer;
+  auto file_size = io.get_size();
+
+  if (file_size <= s_max_shared_buffer_size) {
+    io.setFilePointer(0);
+    shared_buffer = io.read(file_size);
+    io.setFilePointer(0);
+  }
+
+  auto create_worker_io = [&file, &shared_buffer]() -> mm_io_cptr {
+    if (!shared_buffer)
+      return std::make_shared<mm_read_buffer_io_c>(std::make_shared<mm_file_io_c>(file.name));
+
+    auto mem_io = std::make_shared<mm_mem_io_c>(static_cast<uint8_t const *>(shared_buffer->get_buffer()), shared_buffer->get_size());
+    mem_io->set_file_name(file.name);
+
+    return mem_io;
+  };
+
+  std::atomic<std::size_t> first_match{steps.size()};
+
+  messages.clear();
+  messages.resize(steps.size());
+
+  mtx::run_in_parallel(steps.size(), [&](std::size_t idx) {
+    // A step with a higher priority has already succeeded; no need
+    // to try this one. Steps that can only run on the main thread are
+    // left to the caller.
+    if (!steps[idx].m_parallel || (idx > first_match.load()))
+      return;
+
+    auto matched = false;
+
+    {
+      mtx::output::message_capture_c capture{messages[idx]};
+
+      try {
+        matched = !!steps[idx].m_probe(create_worker_io());
+      } catch (...) {
+        matched = true;
+      }
+    }
+
+    matched = matched || std::any_of(messages[idx].begin(), messages[idx].end(), [](auto const &message) { return MXMSG_ERROR == message.level; });
+    if (!matched)
+      return;
+
+    auto current = first_match.load();
+    while ((idx < current) && !first_match.compare_exchange_weak(current, idx))
+      ;
+  });
+
+  auto idx = first_match.load();
+
+  mxdebug_if(s_debug_probe, fmt::format("find_first_matching_step_in_parallel: {0} steps, shared buffer: {1}, first match: {2}\n", steps.size(), !!shared_buffer, idx));
+
+  return idx;
+}
+
+/** \brief Probe the file type
+
+   Opens the input file and calls the \c probe_file function for each known
+   file reader class. Uses \c mm_text_io_c for subtitle probing.
+
+   If the hack \c parallel_probing is engaged, the independent probers
+   are evaluated concurrently first. The priority order is still
+   respected when picking the winner, and all output as well as errors
+   happen on the calling thread in the same order as in sequential
+   mode.
+*/
+std::unique_ptr<generic_reader_c>
+probe_file_format(filelist_t &file) {
+  auto io          = open_input_file(file);
+  auto is_playlist = !file.is_playlist && open_playlist_file(file, *io);
+
+  std::unique_ptr<generic_reader_c> reader;
+
+  if (is_playlist)
+    io = std::make_shared<mm_read_buffer_io_c>(file.playlist_mpls_in);
+
+  // File types that can be detected unambiguously but are not
+  // supported. The prober does not return if it detects the type.
+  do_probe<unsupported_types_signature_prober_c>(io);
+
+  auto steps  = probe_steps_for(file);
+  auto probed = std::size_t{};
+  std::vector<mtx::output::captured_messages_t> messages;
+
+  // Parallel probing requires that each worker can open the file on
+  // its own, which isn't the case for playlists and multi-file sets.
+  // It also isn't done when several files are probed concurrently already
+  // as that would multiply the number of threads.
+  if (   mtx::hacks::is_engaged(mtx::hacks::PARALLEL_PROBING)
+      && !mtx::thread_pool_c::is_worker_thread()
+      && !file.is_playlist
+      && (file.all_names.size() == 1))
+    probed = find_first_matching_step_in_parallel(file, *io, steps, messages);
+
+  // In parallel mode the steps that have already failed on a worker
+  // are skipped; only their output is replayed. The step that decided
+  // the outcome is re-run on the real I/O object, falling back to the
+  // remaining steps should it not succeed.
+  for (auto idx = 0u, num_steps = steps.size(); idx < num_steps; ++idx) {
+    if ((idx < probed) && steps[idx].m_parallel) {
+      mtx::output::replay_captured_messages(messages[idx]);
+      continue;
+    }
+
+    if ((reader = steps[idx].m_probe(io)))
       return reader;
   }
 
@@ -398,41 +524,143 @@ probe_file_format(filelist_t &file) {
   return {};
 }
 
+/** \brief Probe the types of several source files concurrently
+
+   Used if the hack \c parallel_file_headers is engaged. All files that
+   don't have a reader yet are probed on multiple threads. The messages
+   emitted while probing are captured and output in the order of the
+   files afterwards, each file's followed by calling \c handle_result
+   for it, just like when probing one file after the other.
+*/
 void
-read_file_headers() {
-  static auto s_debug_timestamp_restrictions = debugging_option_c{"timestamp_restrictions"};
+probe_file_formats_in_parallel(std::vector<filelist_cptr> const &files,
+                               std::function<void(filelist_t &)> const &handle_result) {
+  std::vector<mtx::output::captured_messages_t> messages(files.size());
+  std::vector<std::exception_ptr> exceptions(files.size());
+  std::vector<bool> probed(files.size());
 
-  g_file_sizes = 0;
+  for (auto idx = 0u; idx < files.size(); ++idx)
+    probed[idx] = !files[idx]->reader;
+
+  mtx::run_in_parallel(files.size(), [&](std::size_t idx) {
+    if (!probed[idx])
+      return;
+
+    mtx::output::message_capture_c capture{messages[idx]};
 
-  for (auto &file : g_files) {
     try {
-      file->reader->m_appending = file->appending;
-      file->reader->set_track_info(*file->ti);
-      file->reader->set_timestamp_restrictions(file->restricted_timestamp_min, file->restricted_timestamp_max);
-      file->reader->read_headers();
+      files[idx]->reader = probe_file_format(*files[idx]);
 
-      // Re-calculate file size because the reader might switch to a
-      // multi I/O reader in read_headers().
-      file->size    = file->reader->get_file_size();
-      g_file_sizes += file->size;
+    } catch (mtx::output::captured_error_x &) {
+    } catch (...) {
+      exceptions[idx] = std::current_exception();
+    }
+  });
+
+  for (auto idx = 0u; idx < files.size(); ++idx) {
+    if (!probed[idx])
+      continue;
+
+    mtx::output::replay_captured_messages(messages[idx]);
+
+    if (exceptions[idx])
+      std::rethrow_exception(exceptions[idx]);
+
+    handle_result(*files[idx]);
+  }
+}
+
+static void
+read_headers_of(filelist_t &file) {
+  static auto s_debug_timestamp_restrictions = debugging_option_c{"timestamp_restrictions"};
+
+  try {
+    file.reader->read_headers();
+
+    // Re-calculate file size because the reader might switch to a
+    // multi I/O reader in read_headers().
+    file.size = file.reader->get_file_size();
+
+    mxdebug_if(s_debug_timestamp_restrictions,
+               fmt::format("Timestamp restrictions for {2}: min {0} max {1}\n", file.restricted_timestamp_min, file.restricted_timestamp_max, file.ti->m_fname));
+
+    // Only wait for more data once the headers have been read, not
+    // while probing or parsing them.
+    if (file.follow_in) {
+      file.follow_in->enable_following();
+      file.reader->follow_growing_input(file.follow_in);
+    }
 
-      mxdebug_if(s_debug_timestamp_restrictions,
-                 fmt::format("Timestamp restrictions for {2}: min {0} max {1}\n", file->restricted_timestamp_min, file->restricted_timestamp_max, file->ti->m_fname));
+  } catch (mtx::mm_io::open_x &error) {
+    mxerror(fmt::format(FY("The demultiplexer for the file '{0}' failed to initialize:\n{1}\n"), file.ti->m_fname, Y("The file could not be opened for reading, or there was not enough data to parse its headers.")));
+
+  } catch (mtx::input::open_x &error) {
+    mxerror(fmt::format(FY("The demultiplexer for the file '{0}' failed to initialize:\n{1}\n"), file.ti->m_fname, Y("The file could not be opened for reading, or there was not enough data to parse its headers.")));
+
+  } catch (mtx::input::invalid_format_x &error) {
+    mxerror(fmt::format(FY("The demultiplexer for the file '{0}' failed to initialize:\n{1}\n"), file.ti->m_fname, Y("The file content does not match its format type and was not recognized.")));
+
+  } catch (mtx::input::header_parsing_x &error) {
+    mxerror(fmt::format(FY("The demultiplexer for the file '{0}' failed to initialize:\n{1}\n"), file.ti->m_fname, Y("The file headers could not be parsed, e.g. because they're incomplete, invalid or damaged.")));
+
+  } catch (mtx::input::exception &error) {
+    mxerror(fmt::format(FY("The demultiplexer for the file '{0}' failed to initialize:\n{1}\n"), file.ti->m_fname, error.error()));
+  }
+}
 
-    } catch (mtx::mm_io::open_x &error) {
-      mxerror(fmt::format(FY("The demultiplexer for the file '{0}' failed to initialize:\n{1}\n"), file->ti->m_fname, Y("The file could not be opened for reading, or there was not enough data to parse its headers.")));
+/** \brief Read the headers of all source files concurrently
 
-    } catch (mtx::input::open_x &error) {
-      mxerror(fmt::format(FY("The demultiplexer for the file '{0}' failed to initialize:\n{1}\n"), file->ti->m_fname, Y("The file could not be opened for reading, or there was not enough data to parse its headers.")));
+   The readers are independent of each other. Their messages are
+   captured and output in the order of the files afterwards so that
+   warnings & errors are reported just like when reading the headers
+   one file after the other.
+*/
+static void
+read_file_headers_in_parallel() {
+  std::vector<mtx::output::captured_messages_t> messages(g_files.size());
+  std::vector<std::exception_ptr> exceptions(g_files.size());
 
-    } catch (mtx::input::invalid_format_x &error) {
-      mxerror(fmt::format(FY("The demultiplexer for the file '{0}' failed to initialize:\n{1}\n"), file->ti->m_fname, Y("The file content does not match its format type and was not recognized.")));
+  mtx::run_in_parallel(g_files.size(), [&](std::size_t idx) {
+    mtx::output::message_capture_c capture{messages[idx]};
 
-    } catch (mtx::input::header_parsing_x &error) {
-      mxerror(fmt::format(FY("The demultiplexer for the file '{0}' failed to initialize:\n{1}\n"), file->ti->m_fname, Y("The file headers could not be parsed, e.g. because they're incomplete, invalid or damaged.")));
+    try {
+      read_headers_of(*g_files[idx]);
 
-    } catch (mtx::input::exception &error) {
-      mxerror(fmt::format(FY("The demultiplexer for the file '{0}' failed to initialize:\n{1}\n"), file->ti->m_fname, error.error()));
+    } catch (mtx::output::captured_error_x &) {
+    } catch (...) {
+      exceptions[idx] = std::current_exception();
     }
+  });
+
+  for (auto idx = 0u; idx < g_files.size(); ++idx) {
+    mtx::output::replay_captured_messages(messages[idx]);
+
+    if (exceptions[idx])
+      std::rethrow_exception(exceptions[idx]);
+
+    g_file_sizes += g_files[idx]->size;
+  }
+}
+
+void
+read_file_headers() {
+  mtx::profiling::scoped_timer_c timer{mtx::merge::profiling::stage(mtx::merge::profiling::stage_e::read_headers)};
+
+  g_file_sizes = 0;
+
+  for (auto &file : g_files) {
+    file->reader->m_appending = file->appending;
+    file->reader->set_track_info(*file->ti);
+    file->reader->set_timestamp_restrictions(file->restricted_timestamp_min, file->restricted_timestamp_max);
+  }
+
+  if (mtx::hacks::is_engaged(mtx::hacks::PARALLEL_FILE_HEADERS) && (g_files.size() > 1)) {
+    read_file_headers_in_parallel();
+    return;
+  }
+
+  for (auto &file : g_files) {
+    read_headers_of(*file);
+    g_file_sizes += file->size;
   }
 }
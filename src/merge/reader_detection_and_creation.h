@@ -17,6 +17,8 @@
 #include "common/common_pch.h"
 
 struct filelist_t;
+using filelist_cptr = std::shared_ptr<filelist_t>;
 
 std::unique_ptr<generic_reader_c> probe_file_format(filelist_t &file);
+void probe_file_formats_in_parallel(std::vector<filelist_cptr> const &files, std::function<void(filelist_t &)> const &handle_result);
 void read_file_headers();
@@ -201,6 +201,7 @@ track_info_c::operator =(const track_info_c &src) {
   m_no_chapters                      = src.m_no_chapters;
   m_no_global_tags                   = src.m_no_global_tags;
   m_regenerate_track_uids            = src.m_regenerate_track_uids;
+  m_follow_idle_timeout              = src.m_follow_idle_timeout;
 
   m_chapter_charset                  = src.m_chapter_charset;
   m_chapter_language                 = src.m_chapter_language;
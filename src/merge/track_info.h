@@ -321,6 +321,9 @@ public:
 
   bool m_no_chapters, m_no_global_tags, m_regenerate_track_uids;
 
+  // For source files that are still being written to
+  std::optional<std::chrono::milliseconds> m_follow_idle_timeout;
+
   // Some file formats can contain chapters, but for some the charset
   // cannot be identified unambiguously (*cough* OGM *cough*).
   std::string m_chapter_charset;
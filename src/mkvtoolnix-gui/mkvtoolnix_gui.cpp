@@ -6,6 +6,10 @@
 #include <QSettings>
 
 #include "common/fs_sys_helpers.h"
+#include "common/iana_language_subtag_registry.h"
+#include "common/iso639.h"
+#include "common/iso3166.h"
+#include "common/iso15924.h"
 #include "common/kax_info.h"
 #include "common/version.h"
 #include "mkvtoolnix-gui/app.h"
@@ -78,6 +82,13 @@ main(int argc,
      char **argv) {
   mtx_common_init("mkvtoolnix-gui", argv[0]);
 
+  // The GUI accesses the lists directly, e.g. for populating combo
+  // boxes, instead of only looking up single entries.
+  mtx::iana::language_subtag_registry::ensure_initialized();
+  mtx::iso639::ensure_initialized();
+  mtx::iso3166::ensure_initialized();
+  mtx::iso15924::ensure_initialized();
+
   initiateSettings();
 
   enableOrDisableHighDPIScaling();
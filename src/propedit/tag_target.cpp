@@ -17,11 +17,15 @@
 #include "common/ebml.h"
 #include "common/hacks.h"
 #include "common/kax_analyzer.h"
+#include "common/kax_cluster_scanner.h"
 #include "common/kax_file.h"
 #include "common/list_utils.h"
+#include "common/mm_file_io.h"
+#include "common/mm_read_buffer_io.h"
 #include "common/output.h"
 #include "common/strings/editing.h"
 #include "common/strings/parsing.h"
+#include "common/thread_pool.h"
 #include "common/version.h"
 #include "common/xml/ebml_tags_converter.h"
 #include "propedit/tag_target.h"
@@ -367,6 +371,79 @@ tag_target_c::account_all_clusters() {
   mxinfo(fmt::format(FY("Progress: {0}%{1}"), 100, "\n"));
 }
 
+bool
+tag_target_c::can_account_from_block_headers()
+  const {
+  // The frame sizes can only be determined from the block headers
+  // if reversing the content encodings doesn't require decoding the
+  // frames' content.
+  return std::all_of(m_content_decoders_by_number.begin(), m_content_decoders_by_number.end(), [](auto const &elt) {
+    return !elt.second || elt.second->get_block_size_increase();
+  });
+}
+
+void
+tag_target_c::account_cluster_block_headers(mtx::kax::cluster_t const &cluster,
+                                            std::unordered_map<uint64_t, track_statistics_c> &statistics)
+  const {
+  for (auto const &block : cluster.blocks) {
+    auto num_frames = block.frame_sizes.size();
+    auto stats_itr  = statistics.find(block.track_number);
+
+    if (!num_frames || (stats_itr == statistics.end()))
+      continue;
+
+    auto default_duration_itr = m_default_durations_by_number.find(block.track_number);
+    auto default_duration     = default_duration_itr != m_default_durations_by_number.end() ? default_duration_itr->second : 0;
+    auto decoder_itr          = m_content_decoders_by_number.find(block.track_number);
+    auto size_increase        = (decoder_itr != m_content_decoders_by_number.end()) && decoder_itr->second ? decoder_itr->second->get_block_size_increase().value_or(0) : 0;
+    auto frame_duration       = block.duration ? static_cast<uint64_t>(*block.duration * m_timestamp_scale / num_frames) : default_duration;
+    auto first_timestamp      = (static_cast<int64_t>(cluster.timestamp) + block.relative_timestamp) * static_cast<int64_t>(m_timestamp_scale);
+
+    for (auto idx = 0u; idx < num_frames; ++idx)
+      stats_itr->second.account(first_timestamp + idx * frame_duration, frame_duration, block.frame_sizes[idx] + size_increase);
+  }
+}
+
+void
+tag_target_c::account_all_clusters_from_block_headers() {
+  auto &file      = m_analyzer->get_file();
+  auto file_name  = file.get_file_name();
+  auto positions  = mtx::kax::cluster_scanner_c{file}.find_cluster_positions(m_analyzer->get_segment_data_start_pos());
+  auto num_ranges = std::min<std::size_t>(positions.size(), mtx::thread_pool_c::default_num_threads() * 4);
+
+  mxinfo(Y("The block headers are read in order to create track statistics.\n"));
+
+  if (!num_ranges)
+    return;
+
+  // Each range of clusters is scanned by its own worker with its own
+  // file handle & its own set of statistics. The results are merged
+  // afterwards as the order of accounting is irrelevant.
+  std::vector<std::unordered_map<uint64_t, track_statistics_c>> statistics_by_range(num_ranges);
+
+  mtx::run_in_parallel(num_ranges, [&](std::size_t range_idx) {
+    auto &statistics = statistics_by_range[range_idx];
+    auto range_start = positions.size() *  range_idx      / num_ranges;
+    auto range_end   = positions.size() * (range_idx + 1) / num_ranges;
+    auto in          = std::make_shared<mm_read_buffer_io_c>(std::make_shared<mm_file_io_c>(file_name), 16 * 1024);
+    auto scanner     = mtx::kax::cluster_scanner_c{*in};
+
+    for (auto const &elt : m_track_statistics_by_number)
+      statistics.emplace(elt.first, track_statistics_c{});
+
+    for (auto idx = range_start; idx < range_end; ++idx) {
+      auto cluster = scanner.scan_cluster(positions[idx]);
+      if (cluster)
+        account_cluster_block_headers(*cluster, statistics);
+    }
+  });
+
+  for (auto const &statistics : statistics_by_range)
+    for (auto const &elt : statistics)
+      m_track_statistics_by_number[elt.first].merge(elt.second);
+}
+
 void
 tag_target_c::create_track_statistics_tags() {
   auto no_variable_data = mtx::hacks::is_engaged(mtx::hacks::NO_VARIABLE_DATA);
@@ -391,7 +468,10 @@ tag_target_c::add_or_replace_track_statistics_tags() {
 
   delete_track_statistics_tags();
 
-  account_all_clusters();
+  if (can_account_from_block_headers())
+    account_all_clusters_from_block_headers();
+  else
+    account_all_clusters();
 
   create_track_statistics_tags();
 
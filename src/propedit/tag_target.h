@@ -25,6 +25,10 @@ class KaxCluster;
 
 class content_decoder_c;
 
+namespace mtx::kax {
+struct cluster_t;
+}
+
 class tag_target_c: public track_target_c {
 public:
   enum tag_operation_mode_e {
@@ -79,5 +83,8 @@ protected:
   virtual void account_simple_block(libmatroska::KaxSimpleBlock &simple_block, libmatroska::KaxCluster &cluster);
   virtual void account_one_cluster(libmatroska::KaxCluster &cluster);
   virtual void account_all_clusters();
+  virtual bool can_account_from_block_headers() const;
+  virtual void account_cluster_block_headers(mtx::kax::cluster_t const &cluster, std::unordered_map<uint64_t, track_statistics_c> &statistics) const;
+  virtual void account_all_clusters_from_block_headers();
   virtual void create_track_statistics_tags();
 };
@@ -10,29 +10,35 @@
 
 #include "common/common_pch.h"
 
+#include <chrono>
+
 #include "common/bswap.h"
 #include "common/checksums/crc.h"
+#include "common/checksums/md5.h"
 #include "common/command_line.h"
 #include "common/endian.h"
 #include "common/mm_io_x.h"
 #include "common/mm_file_io.h"
+#include "common/random.h"
 #include "common/strings/parsing.h"
 
 class cli_options_c {
 public:
-  std::string m_file_name;
+  std::vector<std::string> m_file_names;
   mtx::checksum::algorithm_e m_algorithm{mtx::checksum::algorithm_e::adler32};
-  size_t m_chunk_size{4096};
+  size_t m_chunk_size{4096}, m_benchmark_size{};
   uint64_t m_initial_value{}, m_xor_result{};
   bool m_result_in_le{};
 };
 
 static void
 setup_help() {
-  mtx::cli::g_usage_text = "checksum [options] file_name\n"
+  mtx::cli::g_usage_text = "checksum [options] file_name [file_name ...]\n"
+                           "checksum [options] --benchmark size\n"
                            "\n"
-                           "Calculates a checksum of a file. Used for testing MKVToolNix' checksumming\n"
-                           "algorithms. The defaults are:\n"
+                           "Calculates a checksum of each file. Used for testing MKVToolNix' checksumming\n"
+                           "algorithms. With MD5 all files are hashed at the same time using several\n"
+                           "SIMD lanes. The defaults are:\n"
                            "- Algorithm: Adler-32\n"
                            "- Chunk size 4096\n"
                            "- Initial vlaue: 0\n"
@@ -58,6 +64,9 @@ setup_help() {
                            "                         (default: 0)\n"
                            "  --result-in-le         Output the result in Little Endian (default:\n"
                            "                         Big Endian)\n"
+                           "  --benchmark size       Instead of reading a file calculate the checksum\n"
+                           "                         of \"size\" MiB of random data held in memory and\n"
+                           "                         output the throughput\n"
                            "\n"
                            "General options:\n"
                            "\n"
@@ -131,26 +140,31 @@ parse_args(std::vector<std::string> &args) {
     } else if (arg == "--result-in-le")
       options.m_result_in_le = true;
 
-    else if (!options.m_file_name.empty())
-      mxerror("More than one source file was given.\n");
+    else if (arg == "--benchmark") {
+      if (next_arg.empty())
+        mxerror(fmt::format("Missing argument to {0}\n", arg));
+
+      if (!mtx::string::parse_number(next_arg, options.m_benchmark_size) || !options.m_benchmark_size)
+        mxerror(fmt::format("Invalid argument to {0}: {1}\n", arg, next_arg));
+
+      ++current;
+    }
 
     else
-      options.m_file_name = arg;
+      options.m_file_names.push_back(arg);
   }
 
-  if (options.m_file_name.empty())
+  if (options.m_benchmark_size && !options.m_file_names.empty())
+    mxerror("A file name cannot be used together with --benchmark.\n");
+
+  if (!options.m_benchmark_size && options.m_file_names.empty())
     mxerror("No file name given\n");
 
   return options;
 }
 
-static void
-parse_file(cli_options_c const &options) {
-  mm_file_io_c in{options.m_file_name};
-  auto file_size  = in.get_size();
-  auto chunk_size = !options.m_chunk_size ? file_size : std::min<int64_t>(file_size, options.m_chunk_size);
-  auto total_read = 0ll;
-  auto buffer     = memory_c::alloc(chunk_size);
+static mtx::checksum::base_uptr
+create_worker(cli_options_c const &options) {
   auto worker     = mtx::checksum::for_algorithm(options.m_algorithm);
   auto crc_worker = dynamic_cast<mtx::checksum::crc_base_c *>(worker.get());
 
@@ -160,6 +174,62 @@ parse_file(cli_options_c const &options) {
     crc_worker->set_result_in_le(options.m_result_in_le);
   }
 
+  return worker;
+}
+
+static std::string
+format_result(mtx::checksum::base_c &worker) {
+  auto result   = worker.get_result();
+  auto ptr      = result->get_buffer();
+  auto res_size = result->get_size();
+  std::string output;
+
+  for (auto idx = 0u; idx < res_size; idx++)
+    output += fmt::format("{0:02x}", static_cast<unsigned int>(ptr[idx]));
+
+  return output;
+}
+
+static void
+run_benchmark(cli_options_c const &options) {
+  auto data_size  = static_cast<int64_t>(options.m_benchmark_size) * 1024 * 1024;
+  auto chunk_size = !options.m_chunk_size ? data_size : std::min<int64_t>(data_size, options.m_chunk_size);
+  auto data       = memory_c::alloc(data_size);
+  auto worker     = create_worker(options);
+
+  random_c::generate_bytes(data->get_buffer(), data_size);
+
+  auto start     = std::chrono::steady_clock::now();
+  auto ptr       = data->get_buffer();
+  auto remaining = data_size;
+
+  while (remaining) {
+    auto to_handle = std::min<int64_t>(remaining, chunk_size);
+
+    worker->add(ptr, to_handle);
+
+    ptr       += to_handle;
+    remaining -= to_handle;
+  }
+
+  worker->finish();
+
+  auto duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  mxinfo(fmt::format("{0}  {1} MiB in chunks of {2} bytes in {3:.3f}s: {4:.1f} MiB/s\n",
+                     format_result(*worker), options.m_benchmark_size, chunk_size, duration, duration > 0 ? options.m_benchmark_size / duration : 0.0));
+}
+
+static void
+parse_file(cli_options_c const &options,
+           std::string const &file_name) {
+  mm_file_io_c in{file_name};
+  auto file_size  = in.get_size();
+  auto chunk_size = !options.m_chunk_size ? file_size : std::min<int64_t>(file_size, options.m_chunk_size);
+  auto total_read = 0ll;
+  auto buffer     = memory_c::alloc(chunk_size);
+  auto worker     = create_worker(options);
+
   while (total_read < file_size) {
     auto remaining = file_size - total_read;
     chunk_size     = std::min<int64_t>(chunk_size, remaining);
@@ -174,15 +244,56 @@ parse_file(cli_options_c const &options) {
 
   worker->finish();
 
-  auto result   = worker->get_result();
-  auto ptr      = result->get_buffer();
-  auto res_size = result->get_size();
-  std::string output;
+  mxinfo(fmt::format("{0}  {1}\n", format_result(*worker), file_name));
+}
 
-  for (auto idx = 0u; idx < res_size; idx++)
-    output += fmt::format("{0:02x}", static_cast<unsigned int>(ptr[idx]));
+static void
+parse_files_with_md5_multi(cli_options_c const &options) {
+  auto num_files = options.m_file_names.size();
+  std::vector<std::unique_ptr<mm_file_io_c>> files;
+  std::vector<memory_cptr> buffers;
+  std::vector<mtx::checksum::md5_multi_c::chunk_t> chunks(num_files);
+  mtx::checksum::md5_multi_c md5{num_files};
+
+  for (auto const &file_name : options.m_file_names) {
+    files.emplace_back(std::make_unique<mm_file_io_c>(file_name));
+
+    auto file_size  = static_cast<int64_t>(files.back()->get_size());
+    auto chunk_size = !options.m_chunk_size ? file_size : std::min<int64_t>(file_size, options.m_chunk_size);
+    buffers.emplace_back(memory_c::alloc(chunk_size));
+  }
 
-  mxinfo(fmt::format("{0}  {1}\n", output, options.m_file_name));
+  while (true) {
+    auto done = true;
+
+    for (auto idx = 0u; idx < num_files; ++idx) {
+      auto &in       = *files[idx];
+      auto remaining = in.get_size() - in.getFilePointer();
+      auto to_read   = std::min<int64_t>(remaining, buffers[idx]->get_size());
+
+      if (to_read && (in.read(buffers[idx], to_read) != static_cast<uint64_t>(to_read)))
+        mxerror("Could not read the file.\n");
+
+      chunks[idx] = { buffers[idx]->get_buffer(), static_cast<size_t>(to_read) };
+      done        = done && !to_read;
+    }
+
+    if (done)
+      break;
+
+    md5.add(chunks);
+  }
+
+  auto results = md5.finish();
+
+  for (auto idx = 0u; idx < num_files; ++idx) {
+    std::string output;
+
+    for (auto byte_idx = 0u; byte_idx < results[idx]->get_size(); byte_idx++)
+      output += fmt::format("{0:02x}", static_cast<unsigned int>(results[idx]->get_buffer()[byte_idx]));
+
+    mxinfo(fmt::format("{0}  {1}\n", output, options.m_file_names[idx]));
+  }
 }
 
 int
@@ -197,8 +308,19 @@ main(int argc,
 
   auto options = parse_args(args);
 
+  if (options.m_benchmark_size) {
+    run_benchmark(options);
+    mxexit();
+  }
+
   try {
-    parse_file(options);
+    if ((options.m_algorithm == mtx::checksum::algorithm_e::md5) && (options.m_file_names.size() > 1))
+      parse_files_with_md5_multi(options);
+
+    else
+      for (auto const &file_name : options.m_file_names)
+        parse_file(options, file_name);
+
   } catch (mtx::mm_io::exception &) {
     mxerror("File not found\n");
   }
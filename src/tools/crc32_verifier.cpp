@@ -0,0 +1,361 @@
+/*
+   crc32_verifier - A tool for verifying the EBML CRC-32 elements of Matroska files
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit https://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <ebml/EbmlHead.h>
+#include <matroska/KaxSegment.h>
+
+#include "common/checksums/crc.h"
+#include "common/command_line.h"
+#include "common/endian.h"
+#include "common/json.h"
+#include "common/kax_element_names.h"
+#include "common/kax_file.h"
+#include "common/mm_file_io.h"
+#include "common/mm_io_x.h"
+#include "common/strings/parsing.h"
+#include "common/thread_pool.h"
+#include "common/vint.h"
+
+namespace {
+
+auto const s_chunk_size = 1024u * 1024u;
+
+class cli_options_c {
+public:
+  std::string m_file_name;
+  unsigned int m_num_threads{};
+};
+
+struct level1_element_t {
+  uint32_t m_id{};
+  uint64_t m_position{}, m_data_position{}, m_data_size{};
+};
+
+struct crc32_result_t {
+  bool m_has_crc32{}, m_read_error{};
+  uint32_t m_stored{}, m_calculated{};
+};
+
+struct byte_range_t {
+  uint64_t m_start{}, m_end{};
+};
+
+void
+setup_help() {
+  mtx::cli::g_usage_text = "crc32_verifier [options] file_name\n"
+                           "\n"
+                           "Verifies the EBML CRC-32 elements of all level 1 elements (e.g. clusters,\n"
+                           "cues and track headers) of a Matroska file using several threads. Outputs\n"
+                           "the result including the byte ranges of corrupted elements as JSON.\n"
+                           "Exits with 0 if no corruption was found and with 1 otherwise.\n"
+                           "\n"
+                           "Options:\n"
+                           "\n"
+                           "  -t, --threads number   Use this many threads (default: number of CPUs)\n"
+                           "\n"
+                           "General options:\n"
+                           "\n"
+                           "  -h, --help             This help text\n"
+                           "  -V, --version          Print version information\n";
+}
+
+cli_options_c
+parse_args(std::vector<std::string> &args) {
+  auto options = cli_options_c{};
+
+  for (auto current = args.begin(), end = args.end(); current != end; ++current) {
+    auto arg      = *current;
+    auto next     = current + 1;
+    auto next_arg = next != end ? *next : "";
+
+    if ((arg == "-t") || (arg == "--threads")) {
+      if (next_arg.empty())
+        mxerror(fmt::format("Missing argument to {0}\n", arg));
+
+      if (!mtx::string::parse_number(next_arg, options.m_num_threads) || !options.m_num_threads)
+        mxerror(fmt::format("Invalid argument to {0}: {1}\n", arg, next_arg));
+
+      ++current;
+
+    } else if (!options.m_file_name.empty())
+      mxerror("More than one source file was given.\n");
+
+    else
+      options.m_file_name = arg;
+  }
+
+  if (options.m_file_name.empty())
+    mxerror("No file name given\n");
+
+  return options;
+}
+
+/** \brief Determines the end of an element with an unknown size
+
+   Such an element (usually a cluster of a live stream) ends where the
+   next level 1 element starts or at the end of the file. Its children
+   are skipped one after the other in order to find that
+   position. Returns nothing if one of them is damaged.
+*/
+std::optional<uint64_t>
+find_end_of_unknown_size_element(mm_io_c &in,
+                                 uint64_t position,
+                                 uint64_t file_size) {
+  while (position < file_size) {
+    in.setFilePointer(position);
+
+    auto id   = vint_c::read_ebml_id(in);
+    auto size = vint_c::read(in);
+
+    if (!id.is_valid())
+      return {};
+
+    if (   kax_file_c::is_level1_element_id(id)
+        || (id.m_value == EBML_ID(libmatroska::KaxSegment).GetValue())
+        || (id.m_value == EBML_ID(libebml::EbmlHead).GetValue()))
+      return position;
+
+    if (!size.is_valid() || size.is_unknown())
+      return {};
+
+    position = in.getFilePointer() + size.m_value;
+  }
+
+  if (position > file_size)
+    return {};
+
+  return position;
+}
+
+/** \brief Locates all level 1 elements without reading their content
+
+   Only the IDs and sizes are read so that the actual work can be
+   distributed over several threads. Damaged parts of the file are
+   skipped by resyncing to the next level 1 element; the skipped byte
+   ranges are recorded as they cannot be verified.
+*/
+std::vector<level1_element_t>
+find_level1_elements(mm_io_c &in,
+                     std::vector<byte_range_t> &unparsable) {
+  std::vector<level1_element_t> elements;
+  kax_file_c file{in};
+  auto file_size = static_cast<uint64_t>(in.get_size());
+  auto position  = uint64_t{};
+
+  file.enable_reporting(false);
+
+  while (position < file_size) {
+    in.setFilePointer(position);
+
+    auto id            = vint_c::read_ebml_id(in);
+    auto size          = vint_c::read(in);
+    auto data_position = in.getFilePointer();
+
+    if (id.is_valid() && size.is_valid()) {
+      if (id.m_value == EBML_ID(libebml::EbmlHead).GetValue()) {
+        position = data_position + size.m_value;
+        continue;
+      }
+
+      // Descend into the segment regardless of its size.
+      if (id.m_value == EBML_ID(libmatroska::KaxSegment).GetValue()) {
+        position = data_position;
+        continue;
+      }
+
+      if (   (kax_file_c::is_level1_element_id(id) || kax_file_c::is_global_element_id(id))
+          && !size.is_unknown()
+          && ((data_position + size.m_value) <= file_size)) {
+        elements.push_back({ static_cast<uint32_t>(id.m_value), position, data_position, static_cast<uint64_t>(size.m_value) });
+        position = data_position + size.m_value;
+        continue;
+      }
+
+      auto end = kax_file_c::is_level1_element_id(id) && size.is_unknown() ? find_end_of_unknown_size_element(in, data_position, file_size) : std::optional<uint64_t>{};
+      if (end) {
+        elements.push_back({ static_cast<uint32_t>(id.m_value), position, data_position, *end - data_position });
+        position = *end;
+        continue;
+      }
+    }
+
+    // The element is damaged. Its content cannot be verified.
+    in.setFilePointer(position + 1);
+    auto next_element  = file.resync_to_level1_element();
+    auto next_position = next_element ? next_element->GetElementPosition() : file_size;
+
+    unparsable.push_back({ position, next_position });
+    position = next_position;
+  }
+
+  return elements;
+}
+
+crc32_result_t
+verify_element(mm_io_c &in,
+               level1_element_t const &element,
+               memory_c &buffer) {
+  crc32_result_t result;
+
+  if (element.m_data_size < 6)
+    return result;
+
+  try {
+    in.setFilePointer(element.m_data_position);
+
+    auto head = in.read(buffer.get_buffer(), 6);
+    if ((6 != head) || (buffer.get_buffer()[0] != 0xbf) || (buffer.get_buffer()[1] != 0x84))
+      return result;
+
+    result.m_has_crc32 = true;
+    result.m_stored    = get_uint32_le(buffer.get_buffer() + 2);
+
+    mtx::checksum::crc32_ieee_le_c crc32{0xffffffffu};
+    crc32.set_xor_result(0xffffffffu);
+
+    auto remaining = element.m_data_size - 6;
+
+    while (remaining) {
+      auto to_read = std::min<uint64_t>(remaining, buffer.get_size());
+      if (in.read(buffer.get_buffer(), to_read) != to_read) {
+        result.m_read_error = true;
+        return result;
+      }
+
+      crc32.add(buffer.get_buffer(), to_read);
+      remaining -= to_read;
+    }
+
+    crc32.finish();
+    result.m_calculated = crc32.get_result_as_uint();
+
+  } catch (mtx::mm_io::exception &) {
+    result.m_read_error = true;
+  }
+
+  return result;
+}
+
+std::vector<crc32_result_t>
+verify_elements(std::string const &file_name,
+                std::vector<level1_element_t> const &elements,
+                unsigned int num_threads) {
+  std::vector<crc32_result_t> results(elements.size());
+
+  if (!num_threads)
+    num_threads = mtx::thread_pool_c::default_num_threads();
+
+  // Several batches per thread even out differently sized elements.
+  // Each batch uses its own file handle.
+  auto num_batches = std::min<std::size_t>(elements.size(), num_threads * 4);
+
+  mtx::run_in_parallel(num_batches, [&](std::size_t batch) {
+    mm_file_io_c in{file_name};
+    auto buffer = memory_c::alloc(s_chunk_size);
+    auto end    = elements.size() * (batch + 1) / num_batches;
+
+    for (auto idx = elements.size() * batch / num_batches; idx < end; ++idx)
+      results[idx] = verify_element(in, elements[idx], *buffer);
+  }, num_threads);
+
+  return results;
+}
+
+std::string
+format_crc32(uint32_t value) {
+  return fmt::format("0x{0:08x}", value);
+}
+
+bool
+verify_file(cli_options_c const &options) {
+  std::vector<byte_range_t> unparsable;
+  std::vector<level1_element_t> elements;
+
+  {
+    mm_file_io_c in{options.m_file_name};
+    elements = find_level1_elements(in, unparsable);
+  }
+
+  auto results     = verify_elements(options.m_file_name, elements, options.m_num_threads);
+  auto corrupted   = nlohmann::json::array();
+  auto num_checked = 0u;
+
+  for (auto idx = 0u; idx < elements.size(); ++idx) {
+    auto const &element = elements[idx];
+    auto const &result  = results[idx];
+
+    if (!result.m_has_crc32)
+      continue;
+
+    ++num_checked;
+
+    if (!result.m_read_error && (result.m_stored == result.m_calculated))
+      continue;
+
+    auto entry = nlohmann::json{
+      { "type",             result.m_read_error ? "read_error" : "crc32_mismatch"      },
+      { "element",          mtx::kax_element_names_c::get(element.m_id)                 },
+      { "element_position", element.m_position                                          },
+      { "start",            element.m_data_position + 6                                 },
+      { "end",              element.m_data_position + element.m_data_size               },
+    };
+
+    if (!result.m_read_error) {
+      entry["stored_crc32"]     = format_crc32(result.m_stored);
+      entry["calculated_crc32"] = format_crc32(result.m_calculated);
+    }
+
+    corrupted.push_back(entry);
+  }
+
+  for (auto const &range : unparsable)
+    corrupted.push_back(nlohmann::json{
+      { "type",  "unparsable"  },
+      { "start", range.m_start },
+      { "end",   range.m_end   },
+    });
+
+  auto doc = nlohmann::json{
+    { "file_name",            options.m_file_name },
+    { "level1_elements",      elements.size()     },
+    { "elements_with_crc32",  num_checked         },
+    { "corrupted",            corrupted           },
+  };
+
+  mxinfo(mtx::json::dump(doc, 2) + "\n");
+
+  return corrupted.empty();
+}
+
+}
+
+int
+main(int argc,
+     char **argv) {
+  mtx_common_init("crc32_verifier", argv[0]);
+  setup_help();
+
+  auto args = mtx::cli::args_in_utf8(argc, argv);
+  while (mtx::cli::handle_common_args(args, "-r"))
+    ;
+
+  auto options = parse_args(args);
+  auto ok      = false;
+
+  try {
+    ok = verify_file(options);
+  } catch (mtx::mm_io::exception &) {
+    mxerror("File not found\n");
+  }
+
+  mxexit(ok ? 0 : 1);
+}
@@ -0,0 +1,18 @@
+#!/usr/bin/ruby -w
+
+# T_767parallel_file_headers
+describe "mkvmerge / probing & reading headers of several files concurrently"
+
+sources = "data/avi/v.avi data/simple/v.mp3 data/mp4/v.mp4 data/subtitles/srt/ven.srt"
+
+[ "parallel_file_headers", "parallel_file_headers,parallel_probing" ].each do |hacks|
+  test "#{hacks} vs. sequential" do
+    merge sources
+    sequential = hash_tmp
+
+    merge "--engage #{hacks} #{sources}"
+    parallel = hash_tmp
+
+    sequential == parallel ? "ok" : "different"
+  end
+end
@@ -0,0 +1,42 @@
+#!/usr/bin/ruby -w
+
+# T_768write_crc32
+describe "mkvmerge / writing EBML CRC-32 elements; crc32_verifier"
+
+def verify_crc32_768 file_name, exit_code = 0
+  output, _ = sys "../src/tools/crc32_verifier #{file_name}", :exit_code => exit_code, :no_result => true
+  JSON.load(output.join(''))
+end
+
+[ "data/avi/v.avi data/subtitles/srt/ven.srt", "data/webm/live-stream.webm" ].each do |sources|
+  test "writing & verifying #{sources}" do
+    merge "--write-crc32 #{sources}", :exit_code => (sources =~ /live-stream/ ? :warning : :success)
+    json = verify_crc32_768 tmp
+
+    (json["elements_with_crc32"] > 0) && json["corrupted"].empty? ? "ok" : "failed"
+  end
+end
+
+test "detecting corruption" do
+  merge "--write-crc32 data/avi/v.avi"
+
+  content           = IO.binread(tmp)
+  position          = content.size * 3 / 4
+  content[position] = (content[position].ord ^ 0xff).chr
+  IO.binwrite(tmp, content)
+
+  json = verify_crc32_768 tmp, 1
+
+  ok = (json["corrupted"].size == 1)                     \
+    && (json["corrupted"][0]["type"] == "crc32_mismatch") \
+    && (json["corrupted"][0]["start"] <= position)        \
+    && (json["corrupted"][0]["end"]   >  position)
+
+  ok ? "ok" : "failed"
+end
+
+test "clusters with an unknown size" do
+  json = verify_crc32_768 "data/webm/live-stream.webm"
+
+  json["corrupted"].empty? ? "ok" : "failed"
+end
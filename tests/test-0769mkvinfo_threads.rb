@@ -0,0 +1,15 @@
+#!/usr/bin/ruby -w
+
+# T_769mkvinfo_threads
+describe "mkvinfo / calculating checksums & hex dumps with several threads"
+
+%w{complex.mkv attachments.mkv vobsubs.mks}.each do |file|
+  [ "-v -v -c", "-v -v -X" ].each do |args|
+    test "#{file} #{args}" do
+      info "#{args} data/mkv/#{file}", :output => "#{tmp}-1"
+      info "#{args} --threads 4 data/mkv/#{file}", :output => "#{tmp}-4"
+
+      hash_file("#{tmp}-1") == hash_file("#{tmp}-4") ? "ok" : "different"
+    end
+  end
+end
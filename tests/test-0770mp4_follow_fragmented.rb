@@ -0,0 +1,29 @@
+#!/usr/bin/ruby -w
+
+# T_770mp4_follow_fragmented
+describe "mkvmerge / MP4 reader / following fragmented files that are still being written to"
+
+%w{car-20120827-85.mp4 car-20120827-8c.mp4}.each do |file|
+  test "#{file} truncated & extended while being read" do
+    source   = "data/mp4/dash/#{file}"
+    partial  = "#{tmp}-partial.mp4"
+    complete = "#{tmp}-complete"
+    followed = "#{tmp}-followed"
+    content  = IO.binread(source)
+    cut      = content.size / 2
+
+    merge source, :output => complete
+
+    IO.binwrite(partial, content[0, cut])
+
+    appender = Thread.new do
+      sleep 1
+      File.open(partial, "ab") { |out| out.write(content[cut..-1]) }
+    end
+
+    merge "--follow 3 #{partial}", :output => followed
+    appender.join
+
+    hash_file(complete) == hash_file(followed) ? "ok" : "different"
+  end
+end
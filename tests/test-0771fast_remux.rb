@@ -0,0 +1,35 @@
+#!/usr/bin/ruby -w
+
+# T_771fast_remux
+describe "mkvmerge / fast remuxing by copying Matroska clusters block by block"
+
+def hash_tracks_771 file_name
+  identify_json(file_name, :no_result => true)["tracks"].collect do |track|
+    extract file_name, track["id"] => "#{tmp}-#{track["id"]}", :no_result => true
+    hash_file "#{tmp}-#{track["id"]}"
+  end.join('+')
+end
+
+[
+  [ "data/webm/yt3.webm",                "",            :success ],
+  [ "data/webm/yt3.webm",                "--no-audio ", :success ],
+  [ "data/vp9/alpha_channel_data.mkv",   "",            :success ],
+  [ "data/webm/live-stream.webm",        "",            :warning ],
+].each do |file, args, exit_code|
+  test "#{args}#{file}" do
+    normal = "#{tmp}-normal"
+    fast   = "#{tmp}-fast"
+
+    merge "#{args}#{file}",               :output => normal, :exit_code => exit_code == :warning ? :warning : :success
+    merge "--fast-remux #{args}#{file}", :output => fast,   :exit_code => exit_code
+
+    same_frames = hash_tracks_771(normal) == hash_tracks_771(fast) ? "ok" : "different"
+
+    [ same_frames, hash_file(fast) ].join('-')
+  end
+end
+
+test "falling back when timestamps are modified" do
+  merge "--fast-remux --sync 0:100 data/webm/yt3.webm", :exit_code => :warning
+  hash_tmp
+end
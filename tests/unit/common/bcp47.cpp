@@ -48,6 +48,28 @@ TEST(BCP47LanguageTags, ParsingInvalid) {
   EXPECT_FALSE(language_c::parse("es-0").is_valid());                 // invalid (no such region)
 }
 
+TEST(BCP47LanguageTags, ParsingGeneralStructure) {
+  language_c::set_normalization_mode(norm_e::none);
+  EXPECT_TRUE(language_c::parse("DE-ch-U-CA-gregory-x-A-b").is_valid());
+  EXPECT_TRUE(language_c::parse("de-1996-u-ca-gregory-co-phonebk").is_valid());
+  EXPECT_TRUE(language_c::parse("x-a").is_valid());
+  EXPECT_TRUE(language_c::parse("i-klingon").is_valid());
+
+  EXPECT_FALSE(language_c::parse("").is_valid());
+  EXPECT_FALSE(language_c::parse("x").is_valid());
+  EXPECT_FALSE(language_c::parse("de-").is_valid());
+  EXPECT_FALSE(language_c::parse("-de").is_valid());
+  EXPECT_FALSE(language_c::parse("de--CH").is_valid());
+  EXPECT_FALSE(language_c::parse("de-x").is_valid());
+  EXPECT_FALSE(language_c::parse("de-u").is_valid());
+  EXPECT_FALSE(language_c::parse("de-u-ca-x").is_valid());
+  EXPECT_FALSE(language_c::parse("de-CH-Latn").is_valid());             // script after region
+  EXPECT_FALSE(language_c::parse("de-u-ca-x-ab-123456789").is_valid()); // private use subtag too long
+  EXPECT_FALSE(language_c::parse("zh-cmn-yue").is_valid());             // more than one extlang
+  EXPECT_FALSE(language_c::parse("de_CH").is_valid());
+  EXPECT_FALSE(language_c::parse("dé").is_valid());
+}
+
 TEST(BCP47LanguageTags, Formatting) {
   language_c::set_normalization_mode(norm_e::none);
   EXPECT_EQ(""s, language_c{}.format());
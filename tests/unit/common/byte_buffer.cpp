@@ -74,4 +74,36 @@ TEST(ByteBuffer, Prepend) {
   ASSERT_EQ("Hello world"s, s);
 }
 
+TEST(ByteBuffer, AddAndRemoveAcrossChunks) {
+  mtx::bytes::buffer_c b{16};
+  std::string expected, chunk;
+
+  for (auto idx = 0u; idx < 200u; ++idx) {
+    chunk = fmt::format("{0:x}", idx * idx * 7919);
+
+    b.add(reinterpret_cast<unsigned char const *>(chunk.c_str()), chunk.size());
+    expected += chunk;
+
+    auto to_remove = std::min<std::size_t>(expected.size(), idx % 2 ? 3 : 11);
+    b.remove(to_remove);
+    expected.erase(0, to_remove);
+
+    if (!(idx % 17)) {
+      b.prepend(reinterpret_cast<unsigned char const *>("ab"), 2);
+      expected = "ab"s + expected;
+    }
+
+    ASSERT_EQ(expected.size(), b.get_size());
+    ASSERT_EQ(expected, std::string(reinterpret_cast<char *>(b.get_buffer()), b.get_size()));
+  }
+
+  b.trim();
+
+  ASSERT_EQ(expected, std::string(reinterpret_cast<char *>(b.get_buffer()), b.get_size()));
+
+  b.clear();
+
+  ASSERT_EQ(0u, b.get_size());
+}
+
 }
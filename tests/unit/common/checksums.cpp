@@ -1,6 +1,9 @@
 #include "common/common_pch.h"
 
+#include "common/checksums/adler32.h"
 #include "common/checksums/base.h"
+#include "common/checksums/crc.h"
+#include "common/checksums/md5.h"
 #include "common/mm_file_io.h"
 #include "common/mm_proxy_io.h"
 #include "common/mm_text_io.h"
@@ -73,6 +76,7 @@ public:
 TEST_F(ChecksumTest, OneTwoThree) {
   auto ptr  = reinterpret_cast<unsigned char const *>(m_onetwothree.c_str());
 
+  EXPECT_EQ(0x091e01de, mtx::checksum::calculate_as_uint(mtx::checksum::algorithm_e::adler32,       ptr, m_onetwothree.length(),          0));
   EXPECT_EQ(0xf4,       mtx::checksum::calculate_as_uint(mtx::checksum::algorithm_e::crc8_atm,      ptr, m_onetwothree.length(),          0));
   EXPECT_EQ(0xe8fe,     mtx::checksum::calculate_as_uint(mtx::checksum::algorithm_e::crc16_ansi,    ptr, m_onetwothree.length(),          0));
   EXPECT_EQ(0xc331,     mtx::checksum::calculate_as_uint(mtx::checksum::algorithm_e::crc16_ccitt,   ptr, m_onetwothree.length(),          0));
@@ -136,4 +140,92 @@ TEST_F(ChecksumTest, FileChunked1000) {
   EXPECT_EQ(*m_data_md5, *calculate_bin(mtx::checksum::algorithm_e::md5,                       1000));
 }
 
+TEST_F(ChecksumTest, FileChunkedSmallSizes) {
+  // Exercises all combinations of the CRC's multi-byte loop with the
+  // remaining single bytes & unaligned buffers.
+  for (auto chunk_size = 1u; chunk_size <= 17u; ++chunk_size) {
+    EXPECT_EQ(0xab,         calculate_int(mtx::checksum::algorithm_e::crc8_atm,               0, chunk_size));
+    EXPECT_EQ(0x18fe,       calculate_int(mtx::checksum::algorithm_e::crc16_ansi,             0, chunk_size));
+    EXPECT_EQ(0x218f,       calculate_int(mtx::checksum::algorithm_e::crc16_ccitt,            0, chunk_size));
+    EXPECT_EQ(0x5a0a3951,   calculate_int(mtx::checksum::algorithm_e::crc32_ieee,    0xffffffff, chunk_size));
+    EXPECT_EQ(0x88c5b46f,   calculate_int(mtx::checksum::algorithm_e::crc32_ieee_le, 0xffffffff, chunk_size));
+  }
+}
+
+TEST_F(ChecksumTest, Adler32Implementations) {
+  // Larger than the number of bytes after which the sums must be
+  // reduced so that the reduction is exercised by the SIMD variants.
+  std::string data;
+  while (data.size() < 20000)
+    data.append(reinterpret_cast<char const *>(m_data->get_buffer()), m_data->get_size());
+
+  auto ptr = reinterpret_cast<uint8_t const *>(data.c_str());
+
+  for (auto const &implementation : mtx::checksum::adler32::get_implementations()) {
+    for (auto offset = 0u; offset < 4u; ++offset)
+      for (auto size : std::vector<std::size_t>{ 0, 1, 31, 32, 33, 64, 1000, 5552, 5553, 5584, 19000 }) {
+        auto reference = mtx::checksum::adler32::get_implementations().front().update(1, ptr + offset, size);
+        EXPECT_EQ(reference, implementation.update(1, ptr + offset, size)) << implementation.name << " offset " << offset << " size " << size;
+      }
+
+    EXPECT_EQ(0x091e01deu, implementation.update(1, reinterpret_cast<uint8_t const *>(m_onetwothree.c_str()), m_onetwothree.size())) << implementation.name;
+  }
+}
+
+TEST_F(ChecksumTest, Crc32IeeeLeImplementations) {
+  std::string data;
+  while (data.size() < 5000)
+    data.append(reinterpret_cast<char const *>(m_data->get_buffer()), m_data->get_size());
+
+  auto ptr = reinterpret_cast<uint8_t const *>(data.c_str());
+
+  // Around the sizes of the folding variant's blocks of 16 & 64 bytes.
+  for (auto const &implementation : mtx::checksum::crc32_ieee_le::get_implementations())
+    for (auto offset = 0u; offset < 4u; ++offset)
+      for (auto size : std::vector<std::size_t>{ 0, 1, 15, 16, 17, 63, 64, 65, 79, 80, 127, 128, 129, 1000, 4096 }) {
+        auto reference = mtx::checksum::crc32_ieee_le::get_implementations().front().update(0xffffffff, ptr + offset, size);
+        EXPECT_EQ(reference, implementation.update(0xffffffff, ptr + offset, size)) << implementation.name << " offset " << offset << " size " << size;
+      }
+}
+
+TEST_F(ChecksumTest, MD5MultiBuffer) {
+  std::vector<memory_cptr> buffers{ m_data };
+
+  // Around one & two blocks as well as all the padding variants.
+  for (auto size = 0u; size <= 150u; size += 7u)
+    buffers.emplace_back(memory_c::clone(m_data->get_buffer() + size, size));
+
+  auto results = mtx::checksum::md5_multi_c::calculate(buffers);
+
+  ASSERT_EQ(buffers.size(), results.size());
+  EXPECT_EQ(*m_data_md5, *results[0]);
+
+  for (auto idx = 1u; idx < buffers.size(); ++idx)
+    EXPECT_EQ(*mtx::checksum::calculate(mtx::checksum::algorithm_e::md5, *buffers[idx]), *results[idx]) << "size " << buffers[idx]->get_size();
+}
+
+TEST_F(ChecksumTest, MD5MultiBufferChunked) {
+  auto num_streams = 11u;
+  mtx::checksum::md5_multi_c md5{num_streams};
+  std::vector<std::size_t> positions(num_streams);
+
+  // Each stream hashes the whole file in chunks of a different size.
+  for (auto done = false; !done;) {
+    std::vector<mtx::checksum::md5_multi_c::chunk_t> chunks(num_streams);
+    done = true;
+
+    for (auto idx = 0u; idx < num_streams; ++idx) {
+      auto size        = std::min<std::size_t>(m_data->get_size() - positions[idx], 13 + idx * 11);
+      chunks[idx]      = { m_data->get_buffer() + positions[idx], size };
+      positions[idx]  += size;
+      done             = done && !size;
+    }
+
+    md5.add(chunks);
+  }
+
+  for (auto const &result : md5.finish())
+    EXPECT_EQ(*m_data_md5, *result);
+}
+
 }
@@ -0,0 +1,122 @@
+#include "common/common_pch.h"
+
+#include "common/json.h"
+
+#include "tests/unit/init.h"
+
+namespace {
+
+TEST(JSON, StreamingWriterMatchesDump) {
+  std::string output;
+  mtx::json::streaming_writer_c writer{[&output](std::string const &text) { output += text; }};
+
+  writer.start_object();
+  writer.start_array("attachments");
+  writer.end();
+  writer.add("container", nlohmann::json{ { "properties", { { "a", 1 }, { "b", nlohmann::json::array() } } }, { "type", "Matroska" } });
+  writer.add("file_name", "a\nb\"c");
+  writer.start_array("tracks");
+  writer.add(nlohmann::json{ { "id", 0 }, { "properties", nlohmann::json::object() } });
+  writer.add(nlohmann::json{ { "id", 1 }, { "properties", { { "x", { 1, 2 } } } } });
+  writer.end();
+  writer.start_object("z");
+  writer.end();
+  writer.end();
+
+  auto expected = nlohmann::json{
+    { "attachments", nlohmann::json::array()                                                                    },
+    { "container",   { { "properties", { { "a", 1 }, { "b", nlohmann::json::array() } } }, { "type", "Matroska" } } },
+    { "file_name",   "a\nb\"c"                                                                                  },
+    { "tracks",      { nlohmann::json{ { "id", 0 }, { "properties", nlohmann::json::object() } },
+                       nlohmann::json{ { "id", 1 }, { "properties", { { "x", { 1, 2 } } } } } }                 },
+    { "z",           nlohmann::json::object()                                                                   },
+  };
+
+  EXPECT_EQ(mtx::json::dump(expected, 2), output);
+  EXPECT_EQ(expected, mtx::json::parse(output));
+  EXPECT_EQ(0u, writer.get_depth());
+}
+
+TEST(JSON, StreamingWriterEndToDepth) {
+  std::string output;
+  mtx::json::streaming_writer_c writer{[&output](std::string const &text) { output += text; }};
+
+  writer.start_object();
+  writer.start_array("tracks");
+  writer.start_object();
+  writer.add("id", 42);
+
+  EXPECT_EQ(3u, writer.get_depth());
+  EXPECT_FALSE(writer.has_key("tracks"));
+
+  writer.end_to_depth(1);
+
+  EXPECT_TRUE(writer.has_key("tracks"));
+  EXPECT_FALSE(writer.has_key("errors"));
+
+  writer.add("errors", nlohmann::json::array());
+  writer.end();
+
+  EXPECT_EQ((nlohmann::json{ { "tracks", { { { "id", 42 } } } }, { "errors", nlohmann::json::array() } }), mtx::json::parse(output));
+}
+
+
+TEST(JSON, StreamingWriterTopLevelKeyOrder) {
+  std::string output;
+  mtx::json::streaming_writer_c writer{[&output](std::string const &text) { output += text; }, 2, { "version", "container", "tracks", "attachments", "warnings", "errors" }};
+
+  writer.start_object();
+  writer.add("version", 12);
+  writer.add("container", nlohmann::json{ { "type", "Matroska" } });
+  writer.start_array("tracks");
+  writer.add(nlohmann::json{ { "id", 0 }, { "properties", { { "x", { 1, 2 } } } } });
+
+  // Everything up to here has been written already.
+  EXPECT_NE(std::string::npos, output.find("\"id\": 0"));
+
+  writer.add(nlohmann::json{ { "id", 1 }, { "properties", nlohmann::json::object() } });
+  writer.end();
+  writer.add("errors", nlohmann::json::array({ "error" }));
+
+  EXPECT_TRUE(writer.has_key("errors"));
+  EXPECT_EQ(std::string::npos, output.find("errors"));
+
+  writer.start_array("attachments");
+  writer.start_object();
+  writer.end_to_depth(1);
+  writer.add("warnings", nlohmann::json::array());
+  writer.end();
+
+  auto expected = "{\n"
+                  "  \"version\": 12,\n"
+                  "  \"container\": {\n"
+                  "    \"type\": \"Matroska\"\n"
+                  "  },\n"
+                  "  \"tracks\": [\n"
+                  "    {\n"
+                  "      \"id\": 0,\n"
+                  "      \"properties\": {\n"
+                  "        \"x\": [\n"
+                  "          1,\n"
+                  "          2\n"
+                  "        ]\n"
+                  "      }\n"
+                  "    },\n"
+                  "    {\n"
+                  "      \"id\": 1,\n"
+                  "      \"properties\": {}\n"
+                  "    }\n"
+                  "  ],\n"
+                  "  \"attachments\": [\n"
+                  "    {}\n"
+                  "  ],\n"
+                  "  \"warnings\": [],\n"
+                  "  \"errors\": [\n"
+                  "    \"error\"\n"
+                  "  ]\n"
+                  "}"s;
+
+  EXPECT_EQ(expected, output);
+}
+
+}
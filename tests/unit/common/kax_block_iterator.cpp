@@ -0,0 +1,111 @@
+#include "common/common_pch.h"
+
+#include "common/kax_block_iterator.h"
+#include "common/mm_mem_io.h"
+
+#include "tests/unit/init.h"
+
+namespace {
+
+std::vector<uint8_t> const s_clusters{
+  // Cluster with a known size
+  0x1f, 0x43, 0xb6, 0x75, 0xb4,
+  // ClusterTimestamp 100
+  0xe7, 0x81, 0x64,
+  // SimpleBlock, track 1, timestamp 10, key frame, no lacing
+  0xa3, 0x89, 0x81, 0x00, 0x0a, 0x80, 0x01, 0x02, 0x03, 0x04, 0x05,
+  // BlockGroup
+  0xa0, 0xa4,
+  // Block, track 1, timestamp 40
+  0xa1, 0x87, 0x81, 0x00, 0x28, 0x00, 0x0a, 0x0b, 0x0c,
+  // BlockDuration 32
+  0x9b, 0x81, 0x20,
+  // ReferenceBlock -2
+  0xfb, 0x81, 0xfe,
+  // DiscardPadding 5
+  0x75, 0xa2, 0x81, 0x05,
+  // CodecState
+  0xa4, 0x82, 0xaa, 0xbb,
+  // BlockAdditions with one BlockMore: BlockAddID 2, BlockAdditional
+  0x75, 0xa1, 0x8a, 0xa6, 0x88, 0xee, 0x81, 0x02, 0xa5, 0x83, 0x11, 0x22, 0x33,
+
+  // Cluster with an unknown size
+  0x1f, 0x43, 0xb6, 0x75, 0xff,
+  // ClusterTimestamp 200
+  0xe7, 0x81, 0xc8,
+};
+
+TEST(KaxBlockIterator, IteratesBlocks) {
+  mm_mem_io_c in{s_clusters.data(), s_clusters.size()};
+  mtx::kax::block_iterator_c iterator;
+
+  ASSERT_TRUE(iterator.load_cluster(in, in.get_size(), 1024));
+  EXPECT_EQ(57u,  in.getFilePointer());
+  EXPECT_EQ(0u,   iterator.get_position());
+  EXPECT_EQ(100u, iterator.get_timestamp());
+
+  auto block = iterator.next();
+  ASSERT_NE(nullptr, block);
+  EXPECT_TRUE(block->header.is_simple_block);
+  EXPECT_TRUE(block->header.is_key_frame());
+  EXPECT_EQ(1u,  block->header.track_number);
+  EXPECT_EQ(10,  block->header.relative_timestamp);
+  EXPECT_EQ(8u,  block->header.position);
+  EXPECT_EQ(14u, block->header.frames_position);
+  ASSERT_EQ(1u,  block->frames.size());
+  EXPECT_EQ(*block->frames[0], *memory_c::clone("\x01\x02\x03\x04\x05", 5));
+
+  block = iterator.next();
+  ASSERT_NE(nullptr, block);
+  EXPECT_FALSE(block->header.is_simple_block);
+  EXPECT_FALSE(block->header.is_key_frame());
+  EXPECT_EQ(40,  block->header.relative_timestamp);
+  EXPECT_EQ(19u, block->header.position);
+  EXPECT_EQ(27u, block->header.frames_position);
+  ASSERT_TRUE(!!block->header.duration);
+  EXPECT_EQ(32u, *block->header.duration);
+  EXPECT_EQ(std::vector<int64_t>{ -2 }, block->references);
+  ASSERT_TRUE(!!block->discard_padding);
+  EXPECT_EQ(5, *block->discard_padding);
+  ASSERT_TRUE(!!block->codec_state);
+  EXPECT_EQ(*block->codec_state, *memory_c::clone("\xaa\xbb", 2));
+  ASSERT_EQ(1u, block->additions.size());
+  EXPECT_EQ(2u, block->additions[0].id);
+  EXPECT_EQ(*block->additions[0].data, *memory_c::clone("\x11\x22\x33", 3));
+  ASSERT_EQ(1u, block->frames.size());
+  EXPECT_EQ(*block->frames[0], *memory_c::clone("\x0a\x0b\x0c", 3));
+
+  EXPECT_EQ(nullptr, iterator.next());
+}
+
+TEST(KaxBlockIterator, RejectsUnsupportedClusters) {
+  mm_mem_io_c in{s_clusters.data(), s_clusters.size()};
+  mtx::kax::block_iterator_c iterator;
+
+  // Bigger than the maximum size
+  EXPECT_FALSE(iterator.load_cluster(in, in.get_size(), 32));
+  EXPECT_EQ(0u, in.getFilePointer());
+
+  // Exceeding the end
+  EXPECT_FALSE(iterator.load_cluster(in, 50, 1024));
+  EXPECT_EQ(0u, in.getFilePointer());
+
+  // Unknown size
+  in.setFilePointer(57);
+  EXPECT_FALSE(iterator.load_cluster(in, in.get_size(), 1024));
+  EXPECT_EQ(57u, in.getFilePointer());
+  EXPECT_EQ(nullptr, iterator.next());
+}
+
+TEST(KaxBlockIterator, RejectsInvalidStructure) {
+  auto data = s_clusters;
+  data[20]  = 0xb4;             // BlockGroup exceeding the cluster
+
+  mm_mem_io_c in{data.data(), data.size()};
+  mtx::kax::block_iterator_c iterator;
+
+  EXPECT_FALSE(iterator.load_cluster(in, in.get_size(), 1024));
+  EXPECT_EQ(0u, in.getFilePointer());
+}
+
+}
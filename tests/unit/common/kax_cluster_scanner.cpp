@@ -0,0 +1,129 @@
+#include "common/common_pch.h"
+
+#include "common/kax_cluster_scanner.h"
+#include "common/mm_mem_io.h"
+
+#include "tests/unit/init.h"
+
+namespace {
+
+std::vector<uint8_t> const s_clusters{
+  // Cluster with a known size
+  0x1f, 0x43, 0xb6, 0x75, 0xd6,
+  // ClusterTimestamp 100
+  0xe7, 0x81, 0x64,
+  // SimpleBlock, track 1, timestamp 10, key frame, no lacing
+  0xa3, 0x89, 0x81, 0x00, 0x0a, 0x80, 0x01, 0x02, 0x03, 0x04, 0x05,
+  // SimpleBlock, track 2, timestamp -2, key frame, Xiph lacing with frame sizes 2, 3, 4
+  0xa3, 0x90, 0x82, 0xff, 0xfe, 0x82, 0x02, 0x02, 0x03, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09,
+  // SimpleBlock, track 1, timestamp 20, EBML lacing with frame sizes 4, 6, 5
+  0xa3, 0x96, 0x81, 0x00, 0x14, 0x06, 0x02, 0x84, 0xc1,
+  0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+  // SimpleBlock, track 1, timestamp 30, fixed-size lacing with two frames of three bytes
+  0xa3, 0x8b, 0x81, 0x00, 0x1e, 0x04, 0x01, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+  // BlockGroup with a Block (track 1, timestamp 40), a BlockDuration (32) & a ReferenceBlock (-1)
+  0xa0, 0x8f,
+  0xa1, 0x87, 0x81, 0x00, 0x28, 0x00, 0x01, 0x02, 0x03,
+  0x9b, 0x81, 0x20,
+  0xfb, 0x81, 0xff,
+
+  // Cluster with an unknown size
+  0x1f, 0x43, 0xb6, 0x75, 0xff,
+  // ClusterTimestamp 200
+  0xe7, 0x81, 0xc8,
+  // SimpleBlock, track 1, timestamp 0, no lacing
+  0xa3, 0x86, 0x81, 0x00, 0x00, 0x00, 0x01, 0x02,
+
+  // Empty Cues terminating the previous cluster
+  0x1c, 0x53, 0xbb, 0x6b, 0x80,
+};
+
+TEST(KaxClusterScanner, FindClusterPositions) {
+  mm_mem_io_c in{s_clusters.data(), s_clusters.size()};
+
+  auto positions = mtx::kax::cluster_scanner_c{in}.find_cluster_positions(0);
+
+  ASSERT_EQ(2u,  positions.size());
+  EXPECT_EQ(0u,  positions[0]);
+  EXPECT_EQ(91u, positions[1]);
+}
+
+TEST(KaxClusterScanner, ScanClusterWithKnownSize) {
+  mm_mem_io_c in{s_clusters.data(), s_clusters.size()};
+
+  auto cluster = mtx::kax::cluster_scanner_c{in}.scan_cluster(0);
+
+  ASSERT_TRUE(!!cluster);
+  EXPECT_EQ(100u, cluster->timestamp);
+  EXPECT_EQ(91u,  cluster->size);
+  EXPECT_FALSE(cluster->damaged);
+  ASSERT_EQ(5u,   cluster->blocks.size());
+
+  auto const &plain = cluster->blocks[0];
+  EXPECT_TRUE(plain.is_simple_block);
+  EXPECT_TRUE(plain.is_key_frame());
+  EXPECT_EQ(mtx::kax::lacing_e::none, plain.get_lacing());
+  EXPECT_EQ(1u,  plain.track_number);
+  EXPECT_EQ(10,  plain.relative_timestamp);
+  EXPECT_EQ(8u,  plain.position);
+  EXPECT_EQ(11u, plain.size);
+  EXPECT_EQ(14u, plain.frames_position);
+  EXPECT_EQ(std::vector<uint64_t>{ 5 }, plain.frame_sizes);
+
+  auto const &xiph = cluster->blocks[1];
+  EXPECT_EQ(mtx::kax::lacing_e::xiph, xiph.get_lacing());
+  EXPECT_EQ(2u, xiph.track_number);
+  EXPECT_EQ(-2, xiph.relative_timestamp);
+  EXPECT_EQ((std::vector<uint64_t>{ 2, 3, 4 }), xiph.frame_sizes);
+
+  auto const &ebml = cluster->blocks[2];
+  EXPECT_EQ(mtx::kax::lacing_e::ebml, ebml.get_lacing());
+  EXPECT_FALSE(ebml.is_key_frame());
+  EXPECT_EQ((std::vector<uint64_t>{ 4, 6, 5 }), ebml.frame_sizes);
+  EXPECT_EQ(15u, ebml.get_payload_size());
+
+  auto const &fixed = cluster->blocks[3];
+  EXPECT_EQ(mtx::kax::lacing_e::fixed, fixed.get_lacing());
+  EXPECT_EQ((std::vector<uint64_t>{ 3, 3 }), fixed.frame_sizes);
+
+  auto const &group = cluster->blocks[4];
+  EXPECT_FALSE(group.is_simple_block);
+  EXPECT_FALSE(group.is_key_frame());
+  EXPECT_EQ(1u, group.num_references);
+  EXPECT_EQ(40, group.relative_timestamp);
+  ASSERT_TRUE(!!group.duration);
+  EXPECT_EQ(32u, *group.duration);
+  EXPECT_EQ(std::vector<uint64_t>{ 3 }, group.frame_sizes);
+}
+
+TEST(KaxClusterScanner, ScanClusterWithUnknownSize) {
+  mm_mem_io_c in{s_clusters.data(), s_clusters.size()};
+
+  auto cluster = mtx::kax::cluster_scanner_c{in}.scan_cluster(91);
+
+  ASSERT_TRUE(!!cluster);
+  EXPECT_EQ(200u, cluster->timestamp);
+  EXPECT_EQ(16u,  cluster->size);
+  EXPECT_FALSE(cluster->damaged);
+  ASSERT_EQ(1u,   cluster->blocks.size());
+  EXPECT_EQ(std::vector<uint64_t>{ 2 }, cluster->blocks[0].frame_sizes);
+}
+
+TEST(KaxClusterScanner, ScanTruncatedCluster) {
+  // Cut off in the middle of the fixed-size laced SimpleBlock.
+  mm_mem_io_c in{s_clusters.data(), 70};
+
+  auto cluster = mtx::kax::cluster_scanner_c{in}.scan_cluster(0);
+
+  ASSERT_TRUE(!!cluster);
+  EXPECT_TRUE(cluster->damaged);
+  EXPECT_EQ(3u, cluster->blocks.size());
+}
+
+TEST(KaxClusterScanner, ScanInvalidPosition) {
+  mm_mem_io_c in{s_clusters.data(), s_clusters.size()};
+
+  EXPECT_FALSE(mtx::kax::cluster_scanner_c{in}.scan_cluster(8));
+}
+
+}
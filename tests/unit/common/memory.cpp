@@ -268,4 +268,31 @@ TEST(Memory, OperatorBrackets) {
   ASSERT_EQ('o', buffer3[4]);
 }
 
+TEST(Memory, Share) {
+  auto parent = memory_c::clone("0123456789");
+  auto slice  = memory_c::share(parent, 3, 4);
+
+  ASSERT_TRUE(slice->is_shared());
+  ASSERT_FALSE(slice->is_owned());
+  ASSERT_EQ(parent->get_buffer() + 3, slice->get_buffer());
+  ASSERT_EQ("3456"s,                  slice->to_string());
+
+  // Shared slices aren't copied when taking ownership.
+  slice->take_ownership();
+
+  ASSERT_EQ(parent->get_buffer() + 3, slice->get_buffer());
+
+  // They keep their parent's storage alive.
+  parent.reset();
+
+  ASSERT_EQ("3456"s, slice->to_string());
+
+  // Resizing creates a copy of their own.
+  slice->resize(2);
+
+  ASSERT_FALSE(slice->is_shared());
+  ASSERT_TRUE(slice->is_owned());
+  ASSERT_EQ("34"s, slice->to_string());
+}
+
 }
@@ -0,0 +1,121 @@
+#include "common/common_pch.h"
+
+#include <fstream>
+#include <thread>
+
+#include "common/mm_file_io.h"
+#include "common/mm_follow_io.h"
+#include "common/mm_read_buffer_io.h"
+
+#include "tests/unit/init.h"
+
+namespace {
+
+class MmFollowIo: public ::testing::Test {
+protected:
+  std::string m_file_name;
+  std::ofstream m_out;
+
+  virtual void SetUp() override {
+    m_file_name = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("mtx-unit-test-%%%%-%%%%-%%%%.tmp")).string();
+    m_out.open(m_file_name, std::ios::binary);
+    append("0123456789");
+  }
+
+  virtual void TearDown() override {
+    m_out.close();
+    boost::filesystem::remove(m_file_name);
+  }
+
+  void append(std::string const &data) {
+    m_out << data;
+    m_out.flush();
+  }
+
+  std::thread append_later(std::string const &data) {
+    return std::thread{[this, data]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds{100});
+      append(data);
+    }};
+  }
+
+  std::shared_ptr<mm_follow_io_c> open(std::chrono::milliseconds idle_timeout = std::chrono::milliseconds{2000}) {
+    return std::make_shared<mm_follow_io_c>(std::make_shared<mm_file_io_c>(m_file_name), idle_timeout);
+  }
+};
+
+TEST_F(MmFollowIo, EndOfFileBeforeFollowing) {
+  auto in = open();
+  std::string buffer;
+
+  EXPECT_EQ(10u, in->read(buffer, 20));
+  EXPECT_EQ("0123456789"s, buffer);
+  EXPECT_FALSE(in->is_following());
+}
+
+TEST_F(MmFollowIo, WaitsForGrowth) {
+  auto in = open();
+  std::string buffer;
+
+  in->enable_following();
+
+  auto writer = append_later("abcdefghij");
+  auto result = in->read(buffer, 20);
+  writer.join();
+
+  EXPECT_EQ(20u, result);
+  EXPECT_EQ("0123456789abcdefghij"s, buffer);
+  EXPECT_EQ(20, in->get_size());
+}
+
+TEST_F(MmFollowIo, EndOfFileAfterIdleTimeout) {
+  auto in = open(std::chrono::milliseconds{200});
+  std::string buffer;
+
+  in->enable_following();
+
+  auto start = std::chrono::steady_clock::now();
+
+  EXPECT_EQ(10u, in->read(buffer, 20));
+  EXPECT_LE(std::chrono::milliseconds{200}, std::chrono::steady_clock::now() - start);
+}
+
+TEST_F(MmFollowIo, WaitForSize) {
+  auto in = open(std::chrono::milliseconds{200});
+
+  EXPECT_TRUE(in->wait_for_size(10));
+  EXPECT_FALSE(in->wait_for_size(15));
+
+  in->enable_following();
+
+  auto writer = append_later("abcdefghij");
+  auto result = in->wait_for_size(15);
+  writer.join();
+
+  EXPECT_TRUE(result);
+  EXPECT_FALSE(in->wait_for_size(25));
+}
+
+TEST_F(MmFollowIo, ThroughReadBuffer) {
+  auto follow = open();
+  mm_read_buffer_io_c in{follow, 8};
+  std::string buffer;
+
+  follow->enable_following();
+
+  auto writer = append_later("abcdefghij");
+  auto result = in.read(buffer, 20);
+  writer.join();
+
+  EXPECT_EQ(20u, result);
+  EXPECT_EQ("0123456789abcdefghij"s, buffer);
+
+  writer = append_later("ABCDEF");
+  auto slice = in.read_shared(6);
+  writer.join();
+
+  EXPECT_EQ("ABCDEF"s, slice->to_string());
+  EXPECT_EQ(26u, in.getFilePointer());
+}
+
+}
@@ -2,12 +2,57 @@
 
 #include "common/mm_io_x.h"
 #include "common/mm_file_io.h"
+#include "common/mm_mem_io.h"
+#include "common/mm_read_buffer_io.h"
+#include "common/mm_write_buffer_io.h"
 
 #include "tests/unit/init.h"
 #include "tests/unit/util.h"
 
 namespace {
 
+// Records the sizes of the vectored writes it's asked to do.
+class vectored_mem_io_c: public mm_mem_io_c {
+public:
+  std::vector<std::size_t> m_vectored_write_sizes;
+  std::optional<std::size_t> m_max_vectored_write_size;
+
+  vectored_mem_io_c()
+    : mm_mem_io_c{nullptr, 0, 64 * 1024}
+  {
+  }
+
+  virtual bool can_write_vectored() override {
+    return true;
+  }
+
+  virtual size_t writev(chunks_t const &chunks) override {
+    auto limited   = chunks;
+    auto remaining = m_max_vectored_write_size.value_or(std::numeric_limits<std::size_t>::max());
+
+    // Simulates running out of space after writing a couple of bytes.
+    for (auto &chunk : limited) {
+      chunk.second = std::min(chunk.second, remaining);
+      remaining   -= chunk.second;
+    }
+
+    auto written = mm_mem_io_c::writev(limited);
+    m_vectored_write_sizes.push_back(written);
+
+    return written;
+  }
+};
+
+std::string
+create_pattern(std::size_t size) {
+  std::string pattern(size, ' ');
+
+  for (auto idx = 0u; idx < size; ++idx)
+    pattern[idx] = 'a' + (idx % 26);
+
+  return pattern;
+}
+
 TEST(MmIo, Slurp) {
   memory_cptr m;
 
@@ -17,4 +62,118 @@ TEST(MmIo, Slurp) {
   ASSERT_THROW(mm_file_io_c::slurp("doesnotexist"), mtx::mm_io::exception);
 }
 
+TEST(MmIo, ReadBufferReadShared) {
+  std::string const content{"0123456789abcdefghij"};
+  auto mem = std::make_shared<mm_mem_io_c>(reinterpret_cast<uint8_t const *>(content.c_str()), content.length());
+  mm_read_buffer_io_c in{mem, 8};
+
+  auto first = in.read_shared(6);
+  EXPECT_TRUE(first->is_shared());
+  EXPECT_EQ("012345"s, first->to_string());
+
+  // Data spanning the end of the buffer must not overwrite the first
+  // slice.
+  auto second = in.read_shared(5);
+  EXPECT_TRUE(second->is_shared());
+  EXPECT_EQ("6789a"s,  second->to_string());
+  EXPECT_EQ("012345"s, first->to_string());
+  EXPECT_EQ(11u,       in.getFilePointer());
+
+  // Regular reads continue after the slices.
+  EXPECT_EQ('b', in.read_uint8());
+
+  // Seeking back over shared data reads it again from the file as the
+  // slice's user may have modified it.
+  (*second)[0] = 'X';
+  in.setFilePointer(6);
+  EXPECT_EQ('6', in.read_uint8());
+
+  // Data bigger than the buffer is returned in its own buffer.
+  in.setFilePointer(0);
+  auto big = in.read_shared(10);
+  EXPECT_FALSE(big->is_shared());
+  EXPECT_EQ("0123456789"s, big->to_string());
+
+  in.setFilePointer(16);
+  EXPECT_THROW(in.read_shared(5), mtx::mm_io::end_of_file_x);
+}
+
+TEST(MmIo, WriteVectored) {
+  mm_mem_io_c out{nullptr, 0, 100};
+
+  EXPECT_FALSE(out.can_write_vectored());
+  EXPECT_EQ(9u, out.writev({ { "abc", 3 }, { "", 0 }, { "defghi", 6 } }));
+  EXPECT_EQ(9u, out.getFilePointer());
+  EXPECT_EQ("abcdefghi"s, out.get_and_lock_buffer()->to_string());
+}
+
+TEST(MmIo, FileWriteVectored) {
+  auto file_name = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("mtx-unit-test-%%%%-%%%%-%%%%.tmp")).string();
+  auto large     = create_pattern(300 * 1024);
+
+  {
+    mm_file_io_c out{file_name, libebml::MODE_CREATE};
+
+#if !defined(SYS_WINDOWS)
+    EXPECT_TRUE(out.can_write_vectored());
+#endif
+
+    // Data buffered by stdio must end up in front of the vectored
+    // write, and regular writes must continue after it.
+    out.write("head"s);
+    EXPECT_EQ(3 + large.size(), out.writev({ { "abc", 3 }, { "", 0 }, { large.c_str(), large.size() } }));
+    EXPECT_EQ(7 + large.size(), out.getFilePointer());
+    out.write("tail"s);
+  }
+
+  auto content = mm_file_io_c::slurp(file_name);
+  boost::filesystem::remove(file_name);
+
+  EXPECT_EQ("headabc"s + large + "tail"s, content->to_string());
+}
+
+TEST(MmIo, WriteBufferWritesLargeChunksVectored) {
+  auto mem       = std::make_shared<vectored_mem_io_c>();
+  auto small     = create_pattern(1000);
+  auto large     = create_pattern(256 * 1024);
+  auto not_large = create_pattern(256 * 1024 - 1);
+
+  mm_write_buffer_io_c out{mem, 64 * 1024};
+
+  out.write(small);
+  out.write(large);
+  out.write(small);
+  out.write(not_large);
+  out.flush();
+
+  // Only the large chunk is written directly, together with the data
+  // buffered before it.
+  ASSERT_EQ(1u, mem->m_vectored_write_sizes.size());
+  EXPECT_EQ(small.size() + large.size(), mem->m_vectored_write_sizes[0]);
+  EXPECT_EQ(2 * small.size() + large.size() + not_large.size(), out.getFilePointer());
+  EXPECT_EQ(small + large + small + not_large, mem->get_and_lock_buffer()->to_string());
+}
+
+TEST(MmIo, WriteBufferKeepsUnwrittenDataAfterShortVectoredWrite) {
+  auto mem   = std::make_shared<vectored_mem_io_c>();
+  auto small = create_pattern(1000);
+  auto large = create_pattern(256 * 1024);
+
+  mm_write_buffer_io_c out{mem, 64 * 1024};
+
+  out.write(small);
+
+  mem->m_max_vectored_write_size = 600;
+  EXPECT_THROW(out.write(large), mtx::mm_io::insufficient_space_x);
+
+  // The 400 buffered bytes that didn't fit are still there while the
+  // new data that wasn't written completely is not.
+  EXPECT_EQ(small.size(), out.getFilePointer());
+
+  mem->m_max_vectored_write_size.reset();
+  out.flush();
+
+  EXPECT_EQ(small, mem->get_and_lock_buffer()->to_string());
+}
+
 }
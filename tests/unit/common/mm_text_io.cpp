@@ -55,4 +55,65 @@ TEST(MmTextIo, BomUtf32Be) {
   EXPECT_EQ("world"s, in.getline());
 }
 
+TEST(MmTextIo, LineEndings) {
+  std::string text{"first\nsecond\r\nthird\rfourth\r\rfifth"};
+  mm_text_io_c in{std::make_shared<mm_mem_io_c>(reinterpret_cast<uint8_t const *>(text.c_str()), text.length())};
+
+  EXPECT_EQ("first"s,  in.getline());
+  EXPECT_EQ("second"s, in.getline());
+  EXPECT_EQ("third"s,  in.getline());
+  EXPECT_EQ("fourth"s, in.getline());
+  EXPECT_EQ("fifth"s,  in.getline());
+  EXPECT_TRUE(in.eof());
+}
+
+TEST(MmTextIo, MaxChars) {
+  unsigned char const text[13] = { 0xef, 0xbb, 0xbf, 'a', 0xc3, 0xa4, 'b', 'c', 0xe2, 0x82, 0xac, 'd', '\n' };
+  mm_text_io_c in{std::make_shared<mm_mem_io_c>(text, 13)};
+
+  EXPECT_EQ("a\xc3\xa4"s,      in.getline(2));
+  EXPECT_EQ("bc\xe2\x82\xac"s, in.getline(3));
+  EXPECT_EQ("d"s,              in.getline(3));
+  EXPECT_EQ(13u,               in.getFilePointer());
+}
+
+TEST(MmTextIo, LinesSpanningReadAheadBuffer) {
+  std::string text;
+  std::vector<std::string> lines;
+  std::vector<uint64_t> positions;
+
+  for (auto idx = 0; idx < 5000; ++idx) {
+    lines.emplace_back(idx == 2500 ? std::string(100000, 'x') : fmt::format("line {0} \xc3\xa4\xc3\xb6\xc3\xbc", idx));
+    text += lines.back() + (idx % 2 ? "\r\n" : "\n");
+    positions.push_back(text.length());
+  }
+
+  mm_text_io_c in{std::make_shared<mm_mem_io_c>(reinterpret_cast<uint8_t const *>(text.c_str()), text.length())};
+
+  for (auto idx = 0u; idx < lines.size(); ++idx) {
+    ASSERT_EQ(lines[idx], in.getline());
+    ASSERT_EQ(positions[idx], in.getFilePointer());
+  }
+
+  EXPECT_TRUE(in.eof());
+  EXPECT_THROW(in.getline(), mtx::mm_io::end_of_file_x);
+
+  in.setFilePointer(positions[2499]);
+  EXPECT_FALSE(in.eof());
+  EXPECT_EQ(lines[2500], in.getline());
+  EXPECT_EQ(lines[2501], in.getline());
+
+  in.setFilePointer(positions[3]);
+  EXPECT_EQ(lines[4], in.getline());
+}
+
+TEST(MmTextIo, InvalidUtf8) {
+  unsigned char const text[9] = { 0xef, 0xbb, 0xbf, 'a', 0xff, 'b', '\n', 'c', '\n' };
+  mm_text_io_c in{std::make_shared<mm_mem_io_c>(text, 9)};
+
+  EXPECT_THROW(in.getline(), mtx::mm_io::text::invalid_utf8_char_x);
+  EXPECT_EQ("b"s, in.getline());
+  EXPECT_EQ("c"s, in.getline());
+}
+
 }
@@ -0,0 +1,97 @@
+#include "common/common_pch.h"
+
+#include "common/mm_mem_io.h"
+#include "common/profiling.h"
+
+#include "tests/unit/init.h"
+
+namespace {
+
+class Profiling: public ::testing::Test {
+protected:
+  bool m_previously_enabled{};
+
+  virtual void SetUp() override {
+    m_previously_enabled      = mtx::profiling::g_enabled;
+    mtx::profiling::g_enabled = true;
+  }
+
+  virtual void TearDown() override {
+    mtx::profiling::g_enabled = m_previously_enabled;
+  }
+};
+
+TEST_F(Profiling, ScopedTimerCountsCalls) {
+  mtx::profiling::counters_t counters;
+
+  for (auto idx = 0; idx < 3; ++idx)
+    mtx::profiling::scoped_timer_c timer{counters};
+
+  EXPECT_EQ(3u, counters.calls);
+  EXPECT_LE(0, counters.wall_time.count());
+  EXPECT_LE(0, counters.cpu_time.count());
+}
+
+TEST_F(Profiling, DisabledCountersStayEmpty) {
+  mtx::profiling::counters_t counters;
+  mtx::profiling::g_enabled = false;
+
+  {
+    mtx::profiling::scoped_timer_c timer{counters};
+    counters.add(1, 100);
+    counters.update_queue(10, 1000);
+  }
+
+  EXPECT_EQ(0u, counters.calls);
+  EXPECT_EQ(0u, counters.packets);
+  EXPECT_EQ(0u, counters.bytes);
+  EXPECT_EQ(0u, counters.queue_high_water_mark);
+}
+
+TEST_F(Profiling, ScopedTimerCountsAllocations) {
+  mtx::profiling::counters_t counters;
+
+  {
+    mtx::profiling::scoped_timer_c timer{counters};
+    auto mem = memory_c::alloc(1000);
+    mem->resize(3000);
+  }
+
+  memory_c::alloc(500);
+
+  EXPECT_EQ(2u,    counters.allocations);
+  EXPECT_EQ(4000u, counters.allocated_bytes);
+}
+
+TEST_F(Profiling, QueueHighWaterMarks) {
+  mtx::profiling::counters_t counters;
+
+  counters.update_queue(5, 500);
+  counters.update_queue(8, 100);
+  counters.update_queue(2, 900);
+
+  EXPECT_EQ(8u,   counters.queue_high_water_mark);
+  EXPECT_EQ(900u, counters.queued_bytes_high_water_mark);
+}
+
+TEST_F(Profiling, CountingIO) {
+  mtx::profiling::counters_t read_counters, write_counters;
+
+  auto mem = std::make_shared<mm_mem_io_c>(nullptr, 0, 100);
+  mtx::profiling::counting_io_c io{mem, read_counters, write_counters};
+
+  std::string const data{"0123456789"};
+  io.write(data);
+  io.write(data);
+  io.setFilePointer(0);
+
+  uint8_t buffer[5];
+  io.read(buffer, 5);
+
+  EXPECT_EQ(2u,  write_counters.calls);
+  EXPECT_EQ(20u, write_counters.bytes);
+  EXPECT_EQ(1u,  read_counters.calls);
+  EXPECT_EQ(5u,  read_counters.bytes);
+}
+
+}
@@ -0,0 +1,71 @@
+#include "common/common_pch.h"
+
+#include <atomic>
+
+#include "common/thread_pool.h"
+
+#include "tests/unit/init.h"
+
+namespace {
+
+TEST(ThreadPool, ResultsInSubmissionOrder) {
+  mtx::thread_pool_c pool{4};
+  std::vector<std::future<int>> results;
+
+  for (auto idx = 0; idx < 100; ++idx)
+    results.emplace_back(pool.submit([idx]() { return idx * idx; }));
+
+  for (auto idx = 0; idx < 100; ++idx)
+    EXPECT_EQ(idx * idx, results[idx].get());
+}
+
+TEST(ThreadPool, ExceptionsArePropagated) {
+  mtx::thread_pool_c pool{2};
+
+  auto result = pool.submit([]() -> int { throw std::runtime_error{"failure"}; });
+
+  EXPECT_THROW(result.get(), std::runtime_error);
+}
+
+TEST(ThreadPool, RunInParallel) {
+  std::atomic<std::size_t> sum{};
+
+  mtx::run_in_parallel(1000, [&sum](std::size_t idx) { sum += idx; }, 4);
+
+  EXPECT_EQ(999u * 1000u / 2u, sum.load());
+}
+
+TEST(ThreadPool, RunInParallelRethrowsLowestIndex) {
+  try {
+    mtx::run_in_parallel(10, [](std::size_t idx) {
+      if ((idx == 3) || (idx == 7))
+        throw std::runtime_error{std::to_string(idx)};
+    }, 4);
+
+    FAIL() << "no exception thrown";
+
+  } catch (std::runtime_error &ex) {
+    EXPECT_EQ("3"s, ex.what());
+  }
+}
+
+TEST(ThreadPool, NestedRunInParallelRunsSequentially) {
+  EXPECT_FALSE(mtx::thread_pool_c::is_worker_thread());
+
+  std::vector<std::thread::id> outer_ids(4), inner_ids(4 * 4);
+
+  mtx::run_in_parallel(4, [&](std::size_t outer_idx) {
+    EXPECT_TRUE(mtx::thread_pool_c::is_worker_thread());
+
+    outer_ids[outer_idx] = std::this_thread::get_id();
+
+    mtx::run_in_parallel(4, [&](std::size_t inner_idx) {
+      inner_ids[outer_idx * 4 + inner_idx] = std::this_thread::get_id();
+    }, 4);
+  }, 4);
+
+  for (auto idx = 0u; idx < inner_ids.size(); ++idx)
+    EXPECT_EQ(outer_ids[idx / 4], inner_ids[idx]);
+}
+
+}
@@ -0,0 +1,135 @@
+#include "common/common_pch.h"
+
+#include "common/checksums/base.h"
+#include "common/mm_mem_io.h"
+#include "merge/checkpoint.h"
+
+#include "tests/unit/init.h"
+
+namespace {
+
+using namespace mtx::merge::checkpoint;
+
+std::string
+create_data(std::size_t size,
+            char base) {
+  std::string data(size, ' ');
+
+  for (auto idx = 0u; idx < size; ++idx)
+    data[idx] = base + (idx % 23);
+
+  return data;
+}
+
+void
+append(mm_io_c &out,
+       std::string const &data,
+       std::size_t chunk_size) {
+  for (auto offset = 0u; offset < data.size(); offset += chunk_size)
+    out.write(data.c_str() + offset, std::min(chunk_size, data.size() - offset));
+}
+
+// Writes a header, appends data, updates the header & appends more
+// data, similar to what the multiplexer does.
+void
+write_file(mm_io_c &out,
+           std::string const &header,
+           std::string const &first,
+           std::string const &second,
+           std::size_t chunk_size) {
+  out.write(header);
+  append(out, first, chunk_size);
+
+  out.setFilePointer(10);
+  out.write("updated"s);
+  out.setFilePointer(0, libebml::seek_end);
+
+  append(out, second, chunk_size);
+}
+
+std::string
+content_of(mm_mem_io_c &mem) {
+  return mem.get_content();
+}
+
+class CheckpointOutputIo: public ::testing::Test {
+protected:
+  std::string m_header{create_data(100, 'A')}, m_first{create_data(50000, 'a')}, m_second{create_data(50000, 'b')};
+  std::string m_complete_file, m_file_at_checkpoint;
+  uint64_t m_position{}, m_checksum{};
+
+  virtual void SetUp() override {
+    // The interrupted run: a checkpoint is created after the first
+    // 10000 bytes of the second part have been written.
+    auto mem = std::make_shared<mm_mem_io_c>(nullptr, 0, 1024);
+    output_io_c out{mem};
+
+    out.write(m_header);
+    append(out, m_first, 4096);
+    out.setFilePointer(10);
+    out.write("updated"s);
+    out.setFilePointer(0, libebml::seek_end);
+    append(out, m_second.substr(0, 10000), 4096);
+
+    m_position           = out.get_appended_size();
+    m_checksum           = out.get_checksum();
+    m_file_at_checkpoint = content_of(*mem);
+
+    append(out, m_second.substr(10000), 4096);
+
+    m_complete_file      = content_of(*mem);
+  }
+
+  std::shared_ptr<mm_mem_io_c> open_file_at_checkpoint() {
+    auto mem = std::make_shared<mm_mem_io_c>(nullptr, 0, 1024);
+    mem->write(m_file_at_checkpoint);
+    mem->setFilePointer(0);
+
+    return mem;
+  }
+};
+
+TEST_F(CheckpointOutputIo, ChecksumOfAppendedData) {
+  auto appended = m_header + m_first + m_second.substr(0, 10000);
+
+  EXPECT_EQ(appended.size(), m_position);
+  EXPECT_EQ(mtx::checksum::calculate_as_uint(mtx::checksum::algorithm_e::adler32, appended.c_str(), appended.size()), m_checksum);
+
+  // The updated header isn't part of the appended data.
+  EXPECT_EQ("updated"s, m_file_at_checkpoint.substr(10, 7));
+}
+
+TEST_F(CheckpointOutputIo, Restarting) {
+  auto mem = open_file_at_checkpoint();
+  output_io_c out{mem, m_position, m_checksum};
+
+  // Different chunk sizes than the interrupted run so that one write
+  // spans the checkpoint's position.
+  write_file(out, m_header, m_first, m_second, 7000);
+
+  EXPECT_EQ(m_complete_file, content_of(*mem));
+  EXPECT_EQ(m_complete_file.size(), out.get_appended_size());
+}
+
+TEST_F(CheckpointOutputIo, RestartingWithDifferentData) {
+  auto mem = open_file_at_checkpoint();
+  output_io_c out{mem, m_position, m_checksum};
+
+  auto changed_first = m_first;
+  changed_first[1234] ^= 1;
+
+  EXPECT_THROW(write_file(out, m_header, changed_first, m_second, 7000), mtxut::mxerror_x);
+
+  // Nothing has been written after the checkpoint's position.
+  EXPECT_EQ(m_file_at_checkpoint, content_of(*mem));
+}
+
+TEST_F(CheckpointOutputIo, RestartingWithLessData) {
+  auto mem = open_file_at_checkpoint();
+  output_io_c out{mem, m_position, m_checksum};
+
+  // Replaying ends before the checkpoint's position.
+  EXPECT_THROW(write_file(out, m_header, m_first.substr(0, 49000), m_second, 7000), mtxut::mxerror_x);
+}
+
+}
@@ -0,0 +1,41 @@
+#include "common/common_pch.h"
+
+#include <matroska/KaxCues.h>
+
+#include "common/ebml.h"
+#include "common/endian.h"
+#include "common/mm_mem_io.h"
+#include "merge/ebml_crc32.h"
+
+#include "tests/unit/init.h"
+
+namespace {
+
+TEST(EbmlCrc32, RenderWithCrc32) {
+  mm_mem_io_c out{nullptr, 0, 1024};
+  uint64_t payload_position{};
+
+  out.write("0123456789"s);
+
+  mtx::merge::render_with_crc32(out, [&payload_position](mm_io_c &crc32_out) {
+    write_ebml_element_head(crc32_out, EBML_ID(libmatroska::KaxCues), 9 + mtx::merge::crc32_element_size);
+    mtx::merge::write_crc32_placeholder(crc32_out);
+
+    payload_position = crc32_out.getFilePointer();
+    crc32_out.write("123456789"s);
+  });
+
+  auto content = out.get_content();
+
+  // Positions are reported as if the element was written to `out`
+  // directly.
+  EXPECT_EQ(10u + 5u + mtx::merge::crc32_element_size, payload_position);
+  EXPECT_EQ(10u + 5u + mtx::merge::crc32_element_size + 9u, out.getFilePointer());
+  ASSERT_EQ(out.getFilePointer(), content.size());
+
+  EXPECT_EQ("\xbf\x84"s, content.substr(15, 2));
+  EXPECT_EQ(0xcbf43926u, get_uint32_le(content.c_str() + 17));
+  EXPECT_EQ("123456789"s, content.substr(21));
+}
+
+}
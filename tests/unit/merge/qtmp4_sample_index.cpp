@@ -0,0 +1,134 @@
+#include "common/common_pch.h"
+
+#include "input/qtmp4_sample_index.h"
+
+#include "tests/unit/init.h"
+
+namespace {
+
+void
+expect_equal(qt_index_t const &expected,
+             qt_index_t const &actual) {
+  EXPECT_EQ(expected.file_pos,    actual.file_pos);
+  EXPECT_EQ(expected.size,        actual.size);
+  EXPECT_EQ(expected.timestamp,   actual.timestamp);
+  EXPECT_EQ(expected.duration,    actual.duration);
+  EXPECT_EQ(expected.is_keyframe, actual.is_keyframe);
+}
+
+std::vector<qt_index_t>
+create_entries() {
+  std::vector<qt_index_t> entries;
+  auto file_pos = int64_t{1000};
+
+  for (auto idx = 0; idx < 1000; ++idx) {
+    // Runs of samples following each other, chunks at different
+    // positions, varying sizes & reordered timestamps.
+    auto size      = static_cast<uint32_t>(idx < 600 ? 417 : 1000 + (idx * 7919) % 5000);
+    auto timestamp = (idx < 600 ? idx : idx + ((idx % 3) == 1 ? 2 : (idx % 3) == 2 ? -1 : 0)) * 40'000'000ll;
+
+    if (!(idx % 50))
+      file_pos += 123'456;
+
+    entries.emplace_back(file_pos, size, timestamp, 40'000'000ll, !(idx % 25));
+    file_pos += size;
+  }
+
+  entries.emplace_back(0, 0, -5, 0, false);
+  entries.emplace_back(1ll << 42, std::numeric_limits<uint32_t>::max(), -5'000'000'000'000ll, -1, true);
+
+  return entries;
+}
+
+qt_sample_index_c
+create_index(std::vector<qt_index_t> const &entries) {
+  qt_sample_index_c index;
+
+  for (auto const &entry : entries)
+    index.push_back(entry);
+
+  return index;
+}
+
+TEST(QtMp4SampleIndex, EncodingAndExpanding) {
+  auto entries = create_entries();
+  auto index   = create_index(entries);
+
+  ASSERT_EQ(entries.size(), index.size());
+  EXPECT_LT(index.get_memory_usage(), entries.size() * sizeof(qt_index_t) / 2);
+
+  for (auto idx = 0u; idx < entries.size(); ++idx)
+    expect_equal(entries[idx], index[idx]);
+
+  // Random access in reverse order.
+  for (auto idx = entries.size(); idx > 0; --idx)
+    expect_equal(entries[idx - 1], index[idx - 1]);
+}
+
+TEST(QtMp4SampleIndex, RunsOfPredictableEntries) {
+  qt_sample_index_c index;
+
+  for (auto idx = 0u; idx < 100'000; ++idx)
+    index.emplace_back(4711 + idx * 6, 6u, idx * 20'000'000ll, 20'000'000ll, true);
+
+  EXPECT_LT(index.get_memory_usage(), 40'000u);
+
+  expect_equal(qt_index_t{4711 + 54'321 * 6, 6u, 54'321 * 20'000'000ll, 20'000'000ll, true}, index[54'321]);
+}
+
+TEST(QtMp4SampleIndex, Modifications) {
+  auto entries = create_entries();
+  auto index   = create_index(entries);
+
+  index.adjust_timestamps(-500);
+  index.set_keyframe(1);
+  index.push_back({ 42, 1, 4711, 1, false });
+
+  EXPECT_EQ(entries[0].timestamp - 500, index[0].timestamp);
+  EXPECT_TRUE(index[1].is_keyframe);
+  expect_equal(qt_index_t{ 42, 1, 4711, 1, false }, index[index.size() - 1]);
+
+  index.erase_front(300);
+
+  ASSERT_EQ(entries.size() + 1 - 300, index.size());
+  EXPECT_EQ(entries[300].timestamp - 500, index[0].timestamp);
+  EXPECT_EQ(entries[300].file_pos,        index[0].file_pos);
+  expect_equal(qt_index_t{ 42, 1, 4711, 1, false }, index[index.size() - 1]);
+
+  index.clear();
+
+  EXPECT_TRUE(index.empty());
+}
+
+TEST(QtMp4FileOrderIndex, Runs) {
+  qt_file_order_index_c index;
+
+  for (auto idx = 0u; idx < 10; ++idx) {
+    index.push_back({ 0, idx * 2 });
+    index.push_back({ 0, idx * 2 + 1 });
+    index.push_back({ 1, idx });
+  }
+
+  ASSERT_EQ(30u, index.size());
+
+  auto entry = index.get();
+  ASSERT_TRUE(!!entry);
+  EXPECT_EQ(0u, entry->dmx_idx);
+  EXPECT_EQ(0u, entry->index_idx);
+
+  entry = index.get(4);
+  ASSERT_TRUE(!!entry);
+  EXPECT_EQ(0u, entry->dmx_idx);
+  EXPECT_EQ(3u, entry->index_idx);
+
+  index.skip_in_current_run(1);
+  EXPECT_EQ(1u, index.get()->index_idx);
+
+  index.skip_in_current_run(5);
+  EXPECT_EQ(1u, index.get()->dmx_idx);
+  EXPECT_EQ(0u, index.get()->index_idx);
+
+  EXPECT_FALSE(index.get(28));
+}
+
+}
@@ -0,0 +1,191 @@
+#include "common/common_pch.h"
+
+#include "common/mm_mem_io.h"
+#include "common/mm_text_io.h"
+#include "input/subtitles.h"
+#include "merge/generic_reader.h"
+#include "merge/output_control.h"
+
+#include "tests/unit/init.h"
+
+namespace {
+
+class reader_for_tests_c: public generic_reader_c {
+public:
+  virtual mtx::file_type_e get_format_type() const override {
+    return mtx::file_type_e::ssa;
+  }
+
+  virtual void read_headers() override {
+  }
+
+  virtual file_status_e read(generic_packetizer_c *, bool) override {
+    return FILE_STATUS_DONE;
+  }
+
+  virtual void identify() override {
+  }
+
+  virtual void create_packetizer(int64_t) override {
+  }
+
+  virtual bool probe_file() override {
+    return true;
+  }
+};
+
+// Takes the entries in the order they'd be muxed without requiring a
+// packetizer.
+template<typename T>
+class parser_for_tests_c: public T {
+public:
+  using T::T;
+
+  std::vector<std::pair<int64_t, std::string>>
+  read_all_entries() {
+    std::vector<std::pair<int64_t, std::string>> result;
+
+    while (!this->empty()) {
+      result.emplace_back(this->entries.front().start / 1'000'000, this->entries.front().subs);
+      this->entries.pop_front();
+    }
+
+    return result;
+  }
+};
+
+using srt_parser_for_tests_c = parser_for_tests_c<srt_parser_c>;
+using ssa_parser_for_tests_c = parser_for_tests_c<ssa_parser_c>;
+
+std::string const s_srt_sorted{
+  "1\n"
+  "00:00:01,000 --> 00:00:02,000\n"
+  "one\n"
+  "\n"
+  "2\n"
+  "00:00:03,000 --> 00:00:04,000 X1:100 X2:200 Y1:100 Y2:200\n"
+  "two\n"
+  "\n"
+  "3\n"
+  "00:00:05,000 --> 00:00:06,000\n"
+  "three\n"
+};
+
+std::string const s_srt_unsorted{
+  "1\n"
+  "00:00:03,000 --> 00:00:04,000\n"
+  "one\n"
+  "\n"
+  "2\n"
+  "00:00:01,000 --> 00:00:02,000\n"
+  "two\n"
+  "\n"
+  "3\n"
+  "00:00:05,000 --> 00:00:06,000\n"
+  "three\n"
+};
+
+std::string const s_ssa{
+  "[Script Info]\n"
+  "ScriptType: v4.00+\n"
+  "\n"
+  "[Fonts]\n"
+  "fontname: font.ttf\n"
+  "!!!!!!!!\n"
+  "\n"
+  "[Events]\n"
+  "Format: Layer, Start, End, Style, Name, MarginL, MarginR, MarginV, Effect, Text\n"
+  "Dialogue: 0,0:00:01.00,0:00:02.00,Default,,0,0,0,,one\n"
+  "Dialogue: 0,0:00:03.00,0:00:04.00,Default,,0,0,0,,two\n"
+};
+
+mm_text_io_cptr
+text_io_for(std::string const &content) {
+  return std::make_shared<mm_text_io_c>(std::make_shared<mm_mem_io_c>(reinterpret_cast<uint8_t const *>(content.c_str()), content.length()));
+}
+
+class Subtitles: public ::testing::Test {
+protected:
+  virtual void SetUp() override {
+    mtxut::init_case();
+    g_attachments.clear();
+  }
+
+  virtual void TearDown() override {
+    g_attachments.clear();
+  }
+};
+
+TEST_F(Subtitles, SrtSmallFileParsedOnce) {
+  srt_parser_for_tests_c parser{text_io_for(s_srt_sorted), "test.srt", 0};
+
+  parser.parse(true);
+
+  EXPECT_FALSE(parser.is_streaming());
+  EXPECT_EQ(11, parser.get_total_byte_size());
+  EXPECT_EQ((std::vector<std::pair<int64_t, std::string>>{ { 1000, "one" }, { 3000, "two" }, { 5000, "three" } }), parser.read_all_entries());
+}
+
+TEST_F(Subtitles, SrtStreaming) {
+  srt_parser_for_tests_c parser{text_io_for(s_srt_sorted), "test.srt", 0};
+
+  parser.set_max_kept_byte_size(0);
+  parser.parse(true);
+
+  EXPECT_TRUE(parser.is_streaming());
+  EXPECT_EQ(11, parser.get_total_byte_size());
+  EXPECT_EQ(3, parser.get_next_byte_size());
+  EXPECT_EQ((std::vector<std::pair<int64_t, std::string>>{ { 1000, "one" }, { 3000, "two" }, { 5000, "three" } }), parser.read_all_entries());
+}
+
+TEST_F(Subtitles, SrtStreamingFallsBackToSortingUnsortedFiles) {
+  srt_parser_for_tests_c parser{text_io_for(s_srt_unsorted), "test.srt", 0};
+
+  parser.set_max_kept_byte_size(0);
+  parser.parse(true);
+
+  EXPECT_FALSE(parser.is_streaming());
+  EXPECT_TRUE(g_warning_issued);
+  EXPECT_EQ((std::vector<std::pair<int64_t, std::string>>{ { 1000, "two" }, { 3000, "one" }, { 5000, "three" } }), parser.read_all_entries());
+}
+
+TEST_F(Subtitles, SrtStreamingWarnsDuringFirstPassOnly) {
+  srt_parser_for_tests_c parser{text_io_for(s_srt_sorted), "test.srt", 0};
+
+  parser.set_max_kept_byte_size(0);
+  parser.parse(true);
+
+  // The coordinates in the second entry's timestamp line.
+  EXPECT_TRUE(g_warning_issued);
+
+  g_warning_issued = false;
+
+  EXPECT_EQ(3u, parser.read_all_entries().size());
+  EXPECT_FALSE(g_warning_issued);
+}
+
+TEST_F(Subtitles, SsaStreamingAddsAttachmentsOnce) {
+  reader_for_tests_c reader;
+  ssa_parser_for_tests_c parser{reader, text_io_for(s_ssa), "test.ass", 0};
+
+  parser.set_max_kept_byte_size(0);
+  parser.parse(true);
+
+  EXPECT_TRUE(parser.is_streaming());
+  EXPECT_TRUE(parser.is_ass());
+  ASSERT_EQ(1u, g_attachments.size());
+  EXPECT_EQ("font.ttf"s, g_attachments[0]->name);
+  EXPECT_EQ(6u, g_attachments[0]->data->get_size());
+
+  auto global  = parser.get_global();
+  auto entries = parser.read_all_entries();
+
+  ASSERT_EQ(2u, entries.size());
+  EXPECT_EQ(1000, entries[0].first);
+  EXPECT_EQ("0,0,Default,,0,0,0,,one"s, entries[0].second);
+  EXPECT_EQ(3000, entries[1].first);
+  EXPECT_EQ(1u, g_attachments.size());
+  EXPECT_EQ(global, parser.get_global());
+}
+
+}